@@ -0,0 +1,1141 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Sustituto de chip.h para compilar el firmware en Linux
+ **
+ ** Simula los registros de GPIO, el multiplexado de pines del SCU, el SysTick, el SCT y el TIMER1.
+ ** Las interrupciones se ejecutan en un hilo aparte que respeta el enmascaramiento de
+ ** __disable_irq, y cada acceso a registros se cuenta en las metricas.
+ **
+ ** La UART2 se conecta a una pseudoterminal: otro hilo entrega lo que se escribe en ella al canal
+ ** del GPDMA que recibe de la UART, al ritmo de los baudios configurados, y las transferencias de
+ ** transmision se escriben en la pseudoterminal y mantienen el canal ocupado el tiempo que tardaria
+ ** la UART en enviarlas.
+ **
+ ** Un reinicio, pedido con NVIC_SystemReset o provocado por el perro guardian, reemplaza el proceso
+ ** por uno nuevo con execv: la seccion retenida (noinit) y la pseudoterminal de la consola pasan al
+ ** proceso nuevo como descriptores abiertos, igual que en la placa la memoria conserva su contenido
+ ** y el cable sigue conectado. El indicador de vencimiento del perro tambien se conserva.
+ **
+ ** \addtogroup host Host
+ ** \brief Ejecucion del firmware en Linux
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#define _GNU_SOURCE
+#include "chip.h"
+#include "host.h"
+#include <pthread.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define HOST_CORE_CLOCK   MAX_CLOCK_FREQ // frecuencia nominal del LPC4337 en la EDU-CIAA
+#define NS_PER_SECOND     1000000000ULL
+
+// Bits del MCR correspondientes a cada match: interrupcion, reinicio y detencion
+#define MCR_INT(match)    (1UL << (3 * (match)))
+#define MCR_RESET(match)  (1UL << (3 * (match) + 1))
+#define MCR_STOP(match)   (1UL << (3 * (match) + 2))
+
+#define CONTAR(contador)  __atomic_fetch_add(&metrics.contador, 1, __ATOMIC_RELAXED)
+
+#define UART_BITS_POR_CARACTER 10 // inicio, 8 de datos y parada
+#define SERIAL_POLL_MS         100
+
+// Variables del entorno con las que un reinicio le pasa su estado al proceso nuevo
+#define ENTORNO_RETENIDA       "HOST_RETENIDA"
+#define ENTORNO_PERRO          "HOST_WWDT_MOD"
+#define ENTORNO_SERIE          "HOST_SERIE"
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+static host_metrics_s metrics;
+
+// Nivel impuesto desde afuera sobre los pines configurados como entrada
+static volatile uint32_t gpio_inputs[HOST_GPIO_PORTS];
+// Con una funcion de tick instalada el firmware lee esta copia, que se toma al comenzar cada SysTick
+static volatile uint32_t gpio_sampled[HOST_GPIO_PORTS];
+static host_gpio_hook_t gpio_hook = NULL;
+
+static uint16_t scu_modes[HOST_SCU_PORTS][HOST_SCU_PINS];
+static uint8_t nvic_priorities[HOST_IRQ_COUNT + 2]; // desplazado 2 por PendSV y SysTick
+static bool nvic_enabled[HOST_IRQ_COUNT + 2];
+
+// El hilo de interrupciones toma este mutex mientras ejecuta un handler. __disable_irq lo toma
+// desde el lazo principal, de modo que una seccion critica no puede ser interrumpida.
+static pthread_mutex_t irq_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread bool irq_masked = false;
+
+static SysTick_Type systick_regs;
+static pthread_t systick_thread;
+static bool systick_running = false;
+static volatile uint64_t systick_last_ns = 0;
+static volatile uint64_t systick_count = 0;
+static volatile uint64_t systick_served_ns = 0; // comienzo del periodo cuyo tick ya se atendio
+static host_tick_hook_t tick_hook = NULL;
+static bool lockstep = false;
+
+// __WFI espera en esta condicion hasta que el hilo de interrupciones atienda una interrupcion
+static pthread_mutex_t wfi_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wfi_wakeup = PTHREAD_COND_INITIALIZER;
+static uint64_t wfi_interrupts = 0;
+// En la ejecucion sincronizada el hilo de interrupciones espera en esta condicion a que el lazo
+// principal se duerma despues de atender la interrupcion anterior
+static pthread_cond_t wfi_asleep = PTHREAD_COND_INITIALIZER;
+static bool wfi_sleeping = false;
+
+static DWT_Type dwt_regs;
+static SCB_Type scb_regs;
+static uint64_t dwt_base_ns = 0;
+static uint32_t dwt_last = 0;
+
+static uint64_t timer1_frac = 0;
+
+static LPC_GPDMA_T gpdma_regs;
+static uint8_t gpdma_used = 0;                        // canales entregados por GetFreeChannel
+static volatile uint64_t gpdma_end_ns[HOST_DMA_CHANNELS]; // fin de cada transmision en curso
+
+static int serial_master = -1;
+static int serial_slave = -1; // se mantiene abierto para que la terminal no se cierre sin clientes
+static char serial_path[64];
+static pthread_t serial_thread;
+
+static volatile uint64_t wwdt_fed_ns = 0;
+static char ** host_argv = NULL;
+static void (*reset_hooks[HOST_RESET_HOOKS])(void);
+
+// Limites de la seccion retenida, que define el enlazador si algun modulo la usa
+extern char __start_noinit[] __attribute__((weak));
+extern char __stop_noinit[] __attribute__((weak));
+
+static volatile sig_atomic_t exit_requested = 0;
+static volatile sig_atomic_t exit_code = 0;
+
+/* === Private function declarations =========================================================== */
+
+uint64_t HostNow(void);
+void HostGpioWritten(uint8_t port);
+void HostTimerAdvance(LPC_TIMER_T * timer, uint64_t ns, void (*handler)(void));
+void HostInterruptServed(void);
+void HostWaitAsleep(void);
+void * HostSysTickThread(void * arg);
+uint64_t HostUartCharacterNs(void);
+void HostSerialReceive(char byte);
+void * HostSerialThread(void * arg);
+void HostWatchdogCheck(void);
+void HostReset(bool watchdog) __attribute__((noreturn));
+void HostRestore(void);
+void HostSignal(int signal);
+void HostExit(void);
+void HostInit(int argc, char * argv[]) __attribute__((constructor));
+
+/* === Public variable definitions ============================================================= */
+
+uint32_t SystemCoreClock = HOST_CORE_CLOCK;
+LPC_GPIO_T host_gpio_port;
+LPC_SCT_T host_sct;
+LPC_TIMER_T host_timer1;
+LPC_TIMER_T host_timer3;
+LPC_CREG_T host_creg;
+LPC_RITIMER_T host_ritimer;
+LPC_USART_T host_usart2;
+LPC_WWDT_T host_wwdt;
+CoreDebug_Type host_core_debug;
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+// Handlers por defecto, reemplazados por los que defina el firmware (igual que en el startup)
+__attribute__((weak)) void SysTick_Handler(void) {
+}
+
+__attribute__((weak)) void TIMER1_IRQHandler(void) {
+}
+
+__attribute__((weak)) void PendSV_Handler(void) {
+}
+
+uint64_t HostNow(void) {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * NS_PER_SECOND + (uint64_t)now.tv_nsec;
+}
+
+void HostGpioWritten(uint8_t port) {
+
+    CONTAR(gpio_writes);
+    if (gpio_hook) {
+        gpio_hook(port);
+    }
+}
+
+// Avanza el contador del temporizador el tiempo indicado y aplica las acciones de cada match
+void HostTimerAdvance(LPC_TIMER_T * timer, uint64_t ns, void (*handler)(void)) {
+
+    if (!(timer->TCR & 1)) {
+        return;
+    }
+    uint64_t hz = Chip_Clock_GetRate(CLK_MX_TIMER1) / (timer->PR + 1);
+    timer1_frac += ns * hz;
+    timer->TC += (uint32_t)(timer1_frac / NS_PER_SECOND);
+    timer1_frac %= NS_PER_SECOND;
+
+    for (int8_t match = 0; match < 4; match++) {
+        if (!(timer->MCR & (MCR_INT(match) | MCR_RESET(match) | MCR_STOP(match))) ||
+            timer->TC < timer->MR[match]) {
+            continue;
+        }
+        if (timer->MCR & MCR_RESET(match)) {
+            timer->TC = 0;
+        }
+        if (timer->MCR & MCR_STOP(match)) {
+            timer->TCR &= ~1UL;
+        }
+        if (timer->MCR & MCR_INT(match)) {
+            timer->IR |= 1UL << match;
+            CONTAR(timer1_interrupts);
+            handler();
+        }
+    }
+}
+
+void HostInterruptServed(void) {
+
+    pthread_mutex_lock(&wfi_lock);
+    wfi_interrupts++;
+    wfi_sleeping = false;
+    pthread_cond_broadcast(&wfi_wakeup);
+    pthread_mutex_unlock(&wfi_lock);
+}
+
+void HostWaitAsleep(void) {
+
+    pthread_mutex_lock(&wfi_lock);
+    while (!wfi_sleeping && !exit_requested) {
+        pthread_cond_wait(&wfi_asleep, &wfi_lock);
+    }
+    pthread_mutex_unlock(&wfi_lock);
+}
+
+void * HostSysTickThread(void * arg) {
+
+    (void)arg;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    // Los periodos se cuentan desde aca, no desde SysTick_Config
+    systick_last_ns = (uint64_t)next.tv_sec * NS_PER_SECOND + (uint64_t)next.tv_nsec;
+    systick_served_ns = systick_last_ns;
+
+    while (!exit_requested) {
+        // El periodo sale de LOAD y de la frecuencia actual, que el firmware puede cambiar
+        uint64_t period = (uint64_t)(systick_regs.LOAD + 1) * NS_PER_SECOND / SystemCoreClock;
+        if (lockstep) {
+            // Sin esperar el periodo: el tick siguiente llega apenas el lazo principal termina
+            HostWaitAsleep();
+            clock_gettime(CLOCK_MONOTONIC, &next);
+        } else {
+            next.tv_nsec += (long)period;
+            while (next.tv_nsec >= (long)NS_PER_SECOND) {
+                next.tv_nsec -= (long)NS_PER_SECOND;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+
+        // El perro guardian no depende del nucleo: se lo sigue vigilando aunque el firmware tenga
+        // las interrupciones enmascaradas
+        HostWatchdogCheck();
+        struct timespec espera = next;
+        while (pthread_mutex_timedlock(&irq_lock, &espera) != 0) {
+            HostWatchdogCheck();
+            espera.tv_nsec += (long)period;
+            while (espera.tv_nsec >= (long)NS_PER_SECOND) {
+                espera.tv_nsec -= (long)NS_PER_SECOND;
+                espera.tv_sec++;
+            }
+        }
+        irq_masked = true;
+        if (tick_hook) {
+            tick_hook(systick_count + 1);
+            for (uint8_t port = 0; port < HOST_GPIO_PORTS; port++) {
+                gpio_sampled[port] = gpio_inputs[port];
+            }
+            if (exit_requested) {
+                irq_masked = false;
+                pthread_mutex_unlock(&irq_lock);
+                break;
+            }
+        }
+        // Sin sincronizar, el periodo siguiente empieza en el instante nominal de este tick aunque
+        // el handler llegue tarde, como en el contador del nucleo
+        systick_last_ns = lockstep ? HostNow()
+                                   : (uint64_t)next.tv_sec * NS_PER_SECOND + (uint64_t)next.tv_nsec;
+        systick_count++;
+        CONTAR(systick_interrupts);
+        HostTimerAdvance(&host_timer1, period, TIMER1_IRQHandler);
+        systick_served_ns = systick_last_ns;
+        SysTick_Handler();
+        // PendSV tiene la menor prioridad: si el SysTick la dejo pendiente corre a continuacion,
+        // encadenada sin volver al lazo principal. Pedida desde el lazo espera al tick siguiente.
+        if (scb_regs.ICSR & SCB_ICSR_PENDSVSET_Msk) {
+            scb_regs.ICSR &= ~SCB_ICSR_PENDSVSET_Msk;
+            CONTAR(pendsv_interrupts);
+            PendSV_Handler();
+        }
+        irq_masked = false;
+        pthread_mutex_unlock(&irq_lock);
+        HostInterruptServed();
+    }
+    exit(exit_code);
+    return NULL;
+}
+
+uint64_t HostUartCharacterNs(void) {
+
+    uint32_t baudrate = host_usart2.baudrate ? host_usart2.baudrate : 9600;
+    return UART_BITS_POR_CARACTER * NS_PER_SECOND / baudrate;
+}
+
+// Lo recibido solo llega a memoria si hay un canal del GPDMA atendiendo a la UART en modo DMA
+void HostSerialReceive(char byte) {
+
+    for (uint8_t canal = 0; canal < HOST_DMA_CHANNELS; canal++) {
+        GPDMA_CH_T * ch = &gpdma_regs.CH[canal];
+
+        if (!(gpdma_regs.ENBLDCHNS & (1UL << canal)) || ch->SRCADDR != GPDMA_CONN_UART2_Rx ||
+            !(host_usart2.FCR & UART_FCR_DMAMODE_SEL)) {
+            continue;
+        }
+        *(volatile char *)ch->DESTADDR = byte;
+        CONTAR(uart_rx_bytes);
+
+        uint32_t restantes = GPDMA_DMACCxControl_TransferSize(ch->CONTROL) - 1;
+        if (!restantes && (ch->CONTROL & GPDMA_DMACCxControl_I)) {
+            __atomic_fetch_or(&gpdma_regs.RAWINTTCSTAT, 1UL << canal, __ATOMIC_RELEASE);
+        }
+        if (restantes) {
+            ch->CONTROL = (ch->CONTROL & ~0xFFFUL) | restantes;
+            __atomic_store_n(&ch->DESTADDR, ch->DESTADDR + 1, __ATOMIC_RELEASE);
+        } else if (ch->LLI) {
+            // Fin del bloque: el canal sigue con el descriptor enlazado, como en el GPDMA
+            const DMA_TransferDescriptor_t * siguiente = (const DMA_TransferDescriptor_t *)ch->LLI;
+            ch->SRCADDR = siguiente->src;
+            ch->LLI = siguiente->lli;
+            ch->CONTROL = siguiente->ctrl;
+            __atomic_store_n(&ch->DESTADDR, siguiente->dst, __ATOMIC_RELEASE);
+        } else {
+            ch->CONTROL &= ~0xFFFUL;
+            __atomic_fetch_and(&gpdma_regs.ENBLDCHNS, ~(1UL << canal), __ATOMIC_RELEASE);
+        }
+        return;
+    }
+    CONTAR(uart_overruns);
+}
+
+void * HostSerialThread(void * arg) {
+
+    (void)arg;
+    uint64_t siguiente = 0;
+
+    while (!exit_requested) {
+        struct pollfd espera = {.fd = serial_master, .events = POLLIN};
+        char byte;
+
+        if (poll(&espera, 1, SERIAL_POLL_MS) <= 0 || read(serial_master, &byte, 1) != 1) {
+            continue;
+        }
+        // Cada caracter ocupa la linea el tiempo de sus bits, aunque llegue todo junto
+        uint64_t ahora = HostNow();
+        siguiente = (siguiente > ahora ? siguiente : ahora) + HostUartCharacterNs();
+        struct timespec hasta = {
+            .tv_sec = (time_t)(siguiente / NS_PER_SECOND),
+            .tv_nsec = (long)(siguiente % NS_PER_SECOND),
+        };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &hasta, NULL);
+        HostSerialReceive(byte);
+    }
+    return NULL;
+}
+
+void HostWatchdogCheck(void) {
+
+    if (!(host_wwdt.MOD & WWDT_WDMOD_WDEN)) {
+        return;
+    }
+    uint64_t timeout = (uint64_t)host_wwdt.TC * 4 * NS_PER_SECOND / WDT_OSC;
+    if (HostNow() - wwdt_fed_ns > timeout) {
+        host_wwdt.MOD |= WWDT_WDMOD_WDTOF;
+        if (host_wwdt.MOD & WWDT_WDMOD_WDRESET) {
+            HostReset(true);
+        }
+    }
+}
+
+void HostReset(bool watchdog) {
+
+    char valor[96];
+    size_t tamano = (size_t)(__stop_noinit - __start_noinit);
+    int retenida = memfd_create("noinit", 0);
+
+    if (retenida >= 0 && write(retenida, __start_noinit, tamano) == (ssize_t)tamano) {
+        snprintf(valor, sizeof(valor), "%d", retenida);
+        setenv(ENTORNO_RETENIDA, valor, 1);
+    }
+    snprintf(valor, sizeof(valor), "%u", (unsigned)(watchdog ? WWDT_WDMOD_WDTOF : 0));
+    setenv(ENTORNO_PERRO, valor, 1);
+    if (serial_master >= 0) {
+        snprintf(valor, sizeof(valor), "%d %d %s", serial_master, serial_slave, serial_path);
+        setenv(ENTORNO_SERIE, valor, 1);
+    }
+    for (int hook = 0; hook < HOST_RESET_HOOKS && reset_hooks[hook]; hook++) {
+        reset_hooks[hook]();
+    }
+    fprintf(stderr, "\n--- reinicio %s ---\n", watchdog ? "por el perro guardian" : "pedido");
+    execv("/proc/self/exe", host_argv);
+    perror("execv");
+    _exit(EXIT_FAILURE);
+}
+
+// Toma lo que dejo el proceso anterior si este arranque es un reinicio
+void HostRestore(void) {
+
+    const char * valor;
+
+    if ((valor = getenv(ENTORNO_RETENIDA))) {
+        int retenida = atoi(valor);
+        size_t tamano = (size_t)(__stop_noinit - __start_noinit);
+        if (pread(retenida, __start_noinit, tamano, 0) != (ssize_t)tamano) {
+            memset(__start_noinit, 0, tamano);
+        }
+        close(retenida);
+        unsetenv(ENTORNO_RETENIDA);
+    }
+    if ((valor = getenv(ENTORNO_PERRO))) {
+        host_wwdt.MOD = (uint32_t)strtoul(valor, NULL, 10);
+        unsetenv(ENTORNO_PERRO);
+    }
+    if ((valor = getenv(ENTORNO_SERIE))) {
+        if (sscanf(valor, "%d %d %63s", &serial_master, &serial_slave, serial_path) != 3) {
+            serial_master = -1;
+        }
+        unsetenv(ENTORNO_SERIE);
+    }
+}
+
+void HostSignal(int signal) {
+
+    (void)signal;
+    if (!systick_running) {
+        _exit(0);
+    }
+    HostRequestExit(0);
+}
+
+void HostExit(void) {
+
+    HostMetricsPrint(stderr);
+}
+
+void HostInit(int argc, char * argv[]) {
+
+    (void)argc;
+    host_argv = argv;
+    HostRestore();
+    dwt_base_ns = HostNow();
+    signal(SIGINT, HostSignal);
+    signal(SIGTERM, HostSignal);
+    atexit(HostExit);
+}
+
+/* === Public function implementation ========================================================== */
+
+/* --------------------------NUCLEO-------------------------- */
+
+void SystemCoreClockUpdate(void) {
+}
+
+uint32_t SysTick_Config(uint32_t ticks) {
+
+    systick_regs.LOAD = ticks - 1;
+    systick_regs.CTRL = 0x7; // fuente de reloj del nucleo, interrupcion y contador habilitados
+    systick_last_ns = HostNow();
+    systick_served_ns = systick_last_ns;
+
+    if (!systick_running) {
+        systick_running = true;
+        pthread_create(&systick_thread, NULL, HostSysTickThread, NULL);
+    }
+    return 0;
+}
+
+SysTick_Type * HostSysTick(void) {
+
+    // VAL cuenta hacia abajo desde LOAD segun el tiempo transcurrido desde la ultima interrupcion, y
+    // vuelve a LOAD si la interrupcion todavia no se atendio
+    uint64_t elapsed = HostNow() - systick_last_ns;
+    uint64_t cycles = elapsed * SystemCoreClock / NS_PER_SECOND;
+    systick_regs.VAL = systick_regs.LOAD - (uint32_t)(cycles % (systick_regs.LOAD + 1));
+    CONTAR(systick_reads);
+    return &systick_regs;
+}
+
+SCB_Type * HostScb(void) {
+
+    // La interrupcion del SysTick queda pendiente desde que pasa un periodo hasta que se entra al
+    // handler, aunque VAL ya cuente el periodo siguiente
+    uint64_t elapsed = HostNow() - systick_served_ns;
+    uint64_t cycles = elapsed * SystemCoreClock / NS_PER_SECOND;
+    if (systick_running && cycles > systick_regs.LOAD) {
+        scb_regs.ICSR |= SCB_ICSR_PENDSTSET_Msk;
+    } else {
+        scb_regs.ICSR &= ~SCB_ICSR_PENDSTSET_Msk;
+    }
+    return &scb_regs;
+}
+
+DWT_Type * HostDwt(void) {
+
+    uint64_t now = HostNow();
+
+    // Si el firmware escribio CYCCNT se toma ese valor como nuevo origen de la cuenta
+    if (dwt_regs.CYCCNT != dwt_last) {
+        uint64_t offset = (uint64_t)dwt_regs.CYCCNT * NS_PER_SECOND / SystemCoreClock;
+        dwt_base_ns = now - offset;
+    }
+    if (dwt_regs.CTRL & DWT_CTRL_CYCCNTENA_Msk) {
+        unsigned __int128 cycles = (unsigned __int128)(now - dwt_base_ns) * SystemCoreClock;
+        dwt_regs.CYCCNT = (uint32_t)(cycles / NS_PER_SECOND);
+    }
+    dwt_last = dwt_regs.CYCCNT;
+    return &dwt_regs;
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) {
+
+    CONTAR(nvic_writes);
+    nvic_priorities[irq + 2] = (uint8_t)priority;
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq) {
+
+    CONTAR(nvic_writes);
+    nvic_enabled[irq + 2] = true;
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq) {
+
+    CONTAR(nvic_writes);
+    nvic_enabled[irq + 2] = false;
+}
+
+void __disable_irq(void) {
+
+    CONTAR(irq_masks);
+    if (!irq_masked) {
+        pthread_mutex_lock(&irq_lock);
+        irq_masked = true;
+    }
+}
+
+void __enable_irq(void) {
+
+    if (irq_masked) {
+        irq_masked = false;
+        pthread_mutex_unlock(&irq_lock);
+    }
+}
+
+uint32_t __get_PRIMASK(void) {
+
+    return irq_masked ? 1 : 0;
+}
+
+void __set_PRIMASK(uint32_t primask) {
+
+    if (primask) {
+        __disable_irq();
+    } else {
+        __enable_irq();
+    }
+}
+
+// Como en el nucleo real, WFI con las interrupciones enmascaradas vuelve cuando hay una interrupcion
+// pendiente. Aqui se libera la mascara para que el hilo de interrupciones pueda atenderla.
+void __WFI(void) {
+
+    bool masked = irq_masked;
+
+    CONTAR(wfi_sleeps);
+    pthread_mutex_lock(&wfi_lock);
+    uint64_t seen = wfi_interrupts;
+    pthread_mutex_unlock(&wfi_lock);
+
+    if (masked) {
+        __enable_irq();
+    }
+    pthread_mutex_lock(&wfi_lock);
+    while (wfi_interrupts == seen) {
+        wfi_sleeping = true;
+        pthread_cond_broadcast(&wfi_asleep);
+        pthread_cond_wait(&wfi_wakeup, &wfi_lock);
+    }
+    pthread_mutex_unlock(&wfi_lock);
+    if (masked) {
+        __disable_irq();
+    }
+}
+
+// En Linux no hay otro nucleo que reciba el evento
+void __SEV(void) {
+}
+
+void __DSB(void) {
+
+    __sync_synchronize();
+}
+
+void __DMB(void) {
+
+    __sync_synchronize();
+}
+
+/* --------------------------SCU Y GPIO-------------------------- */
+
+void Chip_SCU_PinMuxSet(uint8_t port, uint8_t pin, uint16_t modefunc) {
+
+    CONTAR(pinmux_writes);
+    scu_modes[port % HOST_SCU_PORTS][pin % HOST_SCU_PINS] = modefunc;
+}
+
+void Chip_GPIO_SetPinState(LPC_GPIO_T * gpio, uint8_t port, uint8_t pin, bool setting) {
+
+    if (setting) {
+        gpio->SET[port] |= 1UL << pin;
+    } else {
+        gpio->SET[port] &= ~(1UL << pin);
+    }
+    HostGpioWritten(port);
+}
+
+void Chip_GPIO_SetPinDIR(LPC_GPIO_T * gpio, uint8_t port, uint8_t pin, bool output) {
+
+    if (output) {
+        gpio->DIR[port] |= 1UL << pin;
+    } else {
+        gpio->DIR[port] &= ~(1UL << pin);
+    }
+    HostGpioWritten(port);
+}
+
+bool Chip_GPIO_GetPinState(LPC_GPIO_T * gpio, uint8_t port, uint8_t pin) {
+
+    CONTAR(gpio_reads);
+    // Los pines de salida leen el latch y los de entrada lo que impone el exterior
+    uint32_t inputs = tick_hook ? gpio_sampled[port] : gpio_inputs[port];
+    gpio->PIN[port] = (gpio->SET[port] & gpio->DIR[port]) | (inputs & ~gpio->DIR[port]);
+    return (gpio->PIN[port] >> pin) & 1;
+}
+
+void Chip_GPIO_SetValue(LPC_GPIO_T * gpio, uint8_t port, uint32_t bitValue) {
+
+    gpio->SET[port] |= bitValue;
+    HostGpioWritten(port);
+}
+
+void Chip_GPIO_ClearValue(LPC_GPIO_T * gpio, uint8_t port, uint32_t bitValue) {
+
+    gpio->SET[port] &= ~bitValue;
+    HostGpioWritten(port);
+}
+
+void Chip_GPIO_SetPinToggle(LPC_GPIO_T * gpio, uint8_t port, uint8_t pin) {
+
+    gpio->SET[port] ^= 1UL << pin;
+    HostGpioWritten(port);
+}
+
+/* --------------------------RELOJES, SCT Y TIMER-------------------------- */
+
+uint32_t Chip_Clock_GetRate(CHIP_CCU_CLK_T clk) {
+
+    (void)clk;
+    return SystemCoreClock;
+}
+
+void Chip_SetupCoreClock(CHIP_CGU_CLKIN_T clkin, uint32_t core_freq, bool setbase) {
+
+    (void)clkin;
+    (void)setbase;
+    CONTAR(clock_switches);
+
+    // CYCCNT sigue desde el valor actual, contando a la nueva frecuencia
+    uint32_t cyccnt = HostDwt()->CYCCNT;
+    SystemCoreClock = core_freq;
+    dwt_base_ns = HostNow() - (uint64_t)cyccnt * NS_PER_SECOND / SystemCoreClock;
+}
+
+void Chip_SCTPWM_Init(LPC_SCT_T * sct) {
+
+    CONTAR(sct_writes);
+    memset(sct, 0, sizeof(*sct));
+}
+
+void Chip_SCTPWM_SetRate(LPC_SCT_T * sct, uint32_t freq) {
+
+    CONTAR(sct_writes);
+    sct->running = false;
+    sct->rate = freq;
+}
+
+void Chip_SCTPWM_SetOutPin(LPC_SCT_T * sct, uint8_t index, uint8_t pin) {
+
+    (void)index;
+    (void)pin;
+    CONTAR(sct_writes);
+    (void)sct;
+}
+
+void Chip_SCTPWM_SetDutyCycle(LPC_SCT_T * sct, uint8_t index, uint32_t ticks) {
+
+    (void)index;
+    CONTAR(sct_writes);
+    sct->duty = ticks;
+}
+
+uint32_t Chip_SCTPWM_GetTicksPerCycle(LPC_SCT_T * sct) {
+
+    return sct->rate ? Chip_Clock_GetRate(CLK_MX_SCT) / sct->rate : 0;
+}
+
+void Chip_SCTPWM_Start(LPC_SCT_T * sct) {
+
+    CONTAR(sct_writes);
+    sct->running = true;
+}
+
+void Chip_SCTPWM_Stop(LPC_SCT_T * sct) {
+
+    CONTAR(sct_writes);
+    sct->running = false;
+}
+
+void Chip_TIMER_Init(LPC_TIMER_T * timer) {
+
+    CONTAR(timer_writes);
+    memset((void *)timer, 0, sizeof(*timer));
+}
+
+void Chip_TIMER_PrescaleSet(LPC_TIMER_T * timer, uint32_t prescale) {
+
+    CONTAR(timer_writes);
+    timer->PR = prescale;
+}
+
+void Chip_TIMER_SetMatch(LPC_TIMER_T * timer, int8_t match, uint32_t count) {
+
+    CONTAR(timer_writes);
+    timer->MR[match] = count;
+}
+
+void Chip_TIMER_MatchEnableInt(LPC_TIMER_T * timer, int8_t match) {
+
+    CONTAR(timer_writes);
+    timer->MCR |= MCR_INT(match);
+}
+
+void Chip_TIMER_ResetOnMatchEnable(LPC_TIMER_T * timer, int8_t match) {
+
+    CONTAR(timer_writes);
+    timer->MCR |= MCR_RESET(match);
+}
+
+void Chip_TIMER_StopOnMatchEnable(LPC_TIMER_T * timer, int8_t match) {
+
+    CONTAR(timer_writes);
+    timer->MCR |= MCR_STOP(match);
+}
+
+void Chip_TIMER_Reset(LPC_TIMER_T * timer) {
+
+    CONTAR(timer_writes);
+    timer->TC = 0;
+    timer->PC = 0;
+    timer1_frac = 0;
+}
+
+void Chip_TIMER_Enable(LPC_TIMER_T * timer) {
+
+    CONTAR(timer_writes);
+    timer->TCR |= 1;
+}
+
+void Chip_TIMER_Disable(LPC_TIMER_T * timer) {
+
+    CONTAR(timer_writes);
+    timer->TCR &= ~1UL;
+}
+
+bool Chip_TIMER_MatchPending(LPC_TIMER_T * timer, int8_t match) {
+
+    return (timer->IR >> match) & 1;
+}
+
+void Chip_TIMER_ClearMatch(LPC_TIMER_T * timer, int8_t match) {
+
+    CONTAR(timer_writes);
+    timer->IR &= ~(1UL << match);
+}
+
+// El RIT del M0 queda programado pero no cuenta: la imagen del M0 solo se compila
+void Chip_RIT_Init(LPC_RITIMER_T * rit) {
+
+    CONTAR(timer_writes);
+    memset((void *)rit, 0, sizeof(*rit));
+}
+
+void Chip_RIT_SetTimerInterval(LPC_RITIMER_T * rit, uint32_t time_interval) {
+
+    CONTAR(timer_writes);
+    rit->COMPVAL = (uint32_t)((uint64_t)Chip_Clock_GetRate(CLK_MX_RITIMER) * time_interval / 1000);
+}
+
+void Chip_RIT_ClearInt(LPC_RITIMER_T * rit) {
+
+    CONTAR(timer_writes);
+    rit->CTRL &= ~1UL;
+}
+
+/* --------------------------UART Y GPDMA-------------------------- */
+
+void Chip_UART_Init(LPC_USART_T * uart) {
+
+    struct termios modo;
+
+    static bool serial_started = false;
+
+    memset((void *)uart, 0, sizeof(*uart));
+    if (serial_started) {
+        return;
+    }
+    // Despues de un reinicio la pseudoterminal ya viene abierta del proceso anterior
+    if (serial_master < 0) {
+        serial_master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (serial_master < 0 || grantpt(serial_master) || unlockpt(serial_master) ||
+            ptsname_r(serial_master, serial_path, sizeof(serial_path))) {
+            serial_master = -1;
+            return;
+        }
+        // Sin eco ni edicion de lineas, como un puerto serie
+        serial_slave = open(serial_path, O_RDWR | O_NOCTTY);
+        if (serial_slave >= 0 && tcgetattr(serial_slave, &modo) == 0) {
+            cfmakeraw(&modo);
+            tcsetattr(serial_slave, TCSANOW, &modo);
+        }
+    }
+    serial_started = true;
+    fprintf(stderr, "consola serie en %s\n", serial_path);
+    pthread_create(&serial_thread, NULL, HostSerialThread, NULL);
+    pthread_detach(serial_thread);
+}
+
+uint32_t Chip_UART_SetBaud(LPC_USART_T * uart, uint32_t baudrate) {
+
+    uart->baudrate = baudrate;
+    return baudrate;
+}
+
+void Chip_UART_ConfigData(LPC_USART_T * uart, uint32_t config) {
+
+    uart->LCR = config;
+}
+
+void Chip_UART_SetupFIFOS(LPC_USART_T * uart, uint32_t fcr) {
+
+    uart->FCR = fcr;
+}
+
+void Chip_UART_TXEnable(LPC_USART_T * uart) {
+
+    uart->TER = 1;
+}
+
+LPC_GPDMA_T * HostGpdma(void) {
+
+    // Una transmision termina cuando la UART habria enviado el ultimo caracter
+    uint64_t now = HostNow();
+    for (uint8_t canal = 0; canal < HOST_DMA_CHANNELS; canal++) {
+        if (gpdma_end_ns[canal] && now >= gpdma_end_ns[canal]) {
+            gpdma_end_ns[canal] = 0;
+            __atomic_fetch_and(&gpdma_regs.ENBLDCHNS, ~(1UL << canal), __ATOMIC_RELEASE);
+        }
+    }
+    return &gpdma_regs;
+}
+
+void Chip_GPDMA_Init(LPC_GPDMA_T * gpdma) {
+
+    (void)gpdma;
+    memset((void *)&gpdma_regs, 0, sizeof(gpdma_regs));
+    memset((void *)gpdma_end_ns, 0, sizeof(gpdma_end_ns));
+    gpdma_used = 0;
+}
+
+uint8_t Chip_GPDMA_GetFreeChannel(LPC_GPDMA_T * gpdma, uint32_t connection) {
+
+    (void)gpdma;
+    (void)connection;
+    for (uint8_t canal = 0; canal < HOST_DMA_CHANNELS; canal++) {
+        if (!(gpdma_used & (1U << canal))) {
+            gpdma_used |= 1U << canal;
+            return canal;
+        }
+    }
+    return 0;
+}
+
+Status Chip_GPDMA_InitDescriptor(LPC_GPDMA_T * gpdma, DMA_TransferDescriptor_t * descriptor,
+                                 uintptr_t src, uintptr_t dst, uint32_t size,
+                                 GPDMA_FLOW_CONTROL_T type, const DMA_TransferDescriptor_t * next) {
+
+    (void)gpdma;
+    (void)type;
+    descriptor->src = src;
+    descriptor->dst = dst;
+    descriptor->lli = (uintptr_t)next;
+    descriptor->ctrl = GPDMA_DMACCxControl_TransferSize(size);
+    return SUCCESS;
+}
+
+Status Chip_GPDMA_SGTransfer(LPC_GPDMA_T * gpdma, uint8_t channel,
+                             const DMA_TransferDescriptor_t * descriptor, GPDMA_FLOW_CONTROL_T type) {
+
+    GPDMA_CH_T * ch = &gpdma_regs.CH[channel];
+
+    (void)gpdma;
+    if (gpdma_regs.ENBLDCHNS & (1UL << channel)) {
+        return ERROR;
+    }
+    ch->SRCADDR = descriptor->src;
+    ch->DESTADDR = descriptor->dst;
+    ch->LLI = descriptor->lli;
+    ch->CONTROL = descriptor->ctrl;
+    ch->CONFIG = ((uint32_t)type << 11) | 1;
+    __atomic_fetch_or(&gpdma_regs.ENBLDCHNS, 1UL << channel, __ATOMIC_RELEASE);
+    return SUCCESS;
+}
+
+// Solo se simulan las transmisiones hacia la UART de la consola
+Status Chip_GPDMA_Transfer(LPC_GPDMA_T * gpdma, uint8_t channel, uintptr_t src, uintptr_t dst,
+                           GPDMA_FLOW_CONTROL_T type, uint32_t size) {
+
+    GPDMA_CH_T * ch = &gpdma_regs.CH[channel];
+
+    (void)gpdma;
+    if ((gpdma_regs.ENBLDCHNS & (1UL << channel)) || type != GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA ||
+        dst != GPDMA_CONN_UART2_Tx || !host_usart2.TER) {
+        return ERROR;
+    }
+    if (serial_master >= 0) {
+        ssize_t escritos = write(serial_master, (const void *)src, size);
+        (void)escritos; // sin nadie leyendo la terminal lo enviado se pierde, como en la linea real
+    }
+    __atomic_fetch_add(&metrics.uart_tx_bytes, size, __ATOMIC_RELAXED);
+    ch->SRCADDR = src + size;
+    ch->DESTADDR = dst;
+    ch->CONTROL = 0;
+    gpdma_end_ns[channel] = HostNow() + size * HostUartCharacterNs();
+    __atomic_fetch_or(&gpdma_regs.ENBLDCHNS, 1UL << channel, __ATOMIC_RELEASE);
+    return SUCCESS;
+}
+
+IntStatus Chip_GPDMA_IntGetStatus(LPC_GPDMA_T * gpdma, IntStatusType type, uint8_t channel) {
+
+    (void)gpdma;
+    (void)type;
+    uint32_t marcas = __atomic_load_n(&gpdma_regs.RAWINTTCSTAT, __ATOMIC_ACQUIRE);
+    return (marcas >> channel) & 1 ? SET : RESET;
+}
+
+void Chip_GPDMA_ClearIntPending(LPC_GPDMA_T * gpdma, IntClearStatusType type, uint8_t channel) {
+
+    (void)gpdma;
+    (void)type;
+    __atomic_fetch_and(&gpdma_regs.RAWINTTCSTAT, ~(1UL << channel), __ATOMIC_RELEASE);
+}
+
+/* --------------------------PERRO GUARDIAN Y REINICIO-------------------------- */
+
+void Chip_WWDT_Init(LPC_WWDT_T * wwdt) {
+
+    wwdt->MOD = 0;
+    wwdt->TC = 0xFF;
+}
+
+void Chip_WWDT_SetTimeOut(LPC_WWDT_T * wwdt, uint32_t timeout) {
+
+    wwdt->TC = timeout;
+}
+
+void Chip_WWDT_SetOption(LPC_WWDT_T * wwdt, uint32_t options) {
+
+    wwdt->MOD |= options;
+}
+
+uint32_t Chip_WWDT_GetStatus(LPC_WWDT_T * wwdt) {
+
+    return wwdt->MOD;
+}
+
+void Chip_WWDT_ClearStatusFlag(LPC_WWDT_T * wwdt, uint32_t flag) {
+
+    wwdt->MOD &= ~flag;
+}
+
+void Chip_WWDT_Start(LPC_WWDT_T * wwdt) {
+
+    wwdt->MOD |= WWDT_WDMOD_WDEN;
+    Chip_WWDT_Feed(wwdt);
+}
+
+void Chip_WWDT_Feed(LPC_WWDT_T * wwdt) {
+
+    wwdt->TV = wwdt->TC;
+    wwdt_fed_ns = HostNow();
+}
+
+// Sacar al M0 de reset arrancaria su imagen: en Linux la imagen del M4 sigue sola
+void Chip_RGU_ClearReset(CHIP_RGU_RST_T reset) {
+
+    (void)reset;
+}
+
+void NVIC_SystemReset(void) {
+
+    HostReset(false);
+}
+
+/* --------------------------CONTROL DEL HOST-------------------------- */
+
+const host_metrics_s * HostMetrics(void) {
+
+    return &metrics;
+}
+
+void HostMetricsPrint(FILE * output) {
+
+    fprintf(output, "\n--- accesos a registros simulados ---\n");
+    fprintf(output, "gpio lecturas      : %llu\n", (unsigned long long)metrics.gpio_reads);
+    fprintf(output, "gpio escrituras    : %llu\n", (unsigned long long)metrics.gpio_writes);
+    fprintf(output, "scu escrituras     : %llu\n", (unsigned long long)metrics.pinmux_writes);
+    fprintf(output, "nvic escrituras    : %llu\n", (unsigned long long)metrics.nvic_writes);
+    fprintf(output, "systick lecturas   : %llu\n", (unsigned long long)metrics.systick_reads);
+    fprintf(output, "sct escrituras     : %llu\n", (unsigned long long)metrics.sct_writes);
+    fprintf(output, "timer escrituras   : %llu\n", (unsigned long long)metrics.timer_writes);
+    fprintf(output, "mascaras de irq    : %llu\n", (unsigned long long)metrics.irq_masks);
+    fprintf(output, "wfi                : %llu\n", (unsigned long long)metrics.wfi_sleeps);
+    fprintf(output, "irq systick        : %llu\n", (unsigned long long)metrics.systick_interrupts);
+    fprintf(output, "irq pendsv         : %llu\n", (unsigned long long)metrics.pendsv_interrupts);
+    fprintf(output, "irq timer1         : %llu\n", (unsigned long long)metrics.timer1_interrupts);
+    fprintf(output, "cambios de reloj   : %llu\n", (unsigned long long)metrics.clock_switches);
+    fprintf(output, "uart recibidos     : %llu (sin dma %llu)\n",
+            (unsigned long long)metrics.uart_rx_bytes, (unsigned long long)metrics.uart_overruns);
+    fprintf(output, "uart enviados      : %llu\n", (unsigned long long)metrics.uart_tx_bytes);
+}
+
+void HostGpioSetInput(uint8_t port, uint8_t pin, bool state) {
+
+    if (state) {
+        __atomic_fetch_or(&gpio_inputs[port], 1UL << pin, __ATOMIC_RELAXED);
+    } else {
+        __atomic_fetch_and(&gpio_inputs[port], ~(1UL << pin), __ATOMIC_RELAXED);
+    }
+}
+
+bool HostGpioGetInput(uint8_t port, uint8_t pin) {
+
+    return (gpio_inputs[port] >> pin) & 1;
+}
+
+uint32_t HostGpioInputs(uint8_t port) {
+
+    return gpio_inputs[port];
+}
+
+void HostGpioSetHook(host_gpio_hook_t hook) {
+
+    gpio_hook = hook;
+}
+
+uint16_t HostPinMux(uint8_t port, uint8_t pin) {
+
+    return scu_modes[port % HOST_SCU_PORTS][pin % HOST_SCU_PINS];
+}
+
+const char * HostSerialPath(void) {
+
+    return serial_master >= 0 ? serial_path : NULL;
+}
+
+uint64_t HostSysTickCount(void) {
+
+    return systick_count;
+}
+
+void HostSetResetHook(void (*hook)(void)) {
+
+    for (int indice = 0; indice < HOST_RESET_HOOKS; indice++) {
+        if (!reset_hooks[indice]) {
+            reset_hooks[indice] = hook;
+            return;
+        }
+    }
+}
+
+void HostSetTickHook(host_tick_hook_t hook) {
+
+    tick_hook = hook;
+}
+
+void HostSetLockstep(bool enabled) {
+
+    lockstep = enabled;
+}
+
+void HostRequestExit(int code) {
+
+    exit_code = code;
+    exit_requested = 1;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
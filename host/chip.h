@@ -0,0 +1,373 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef CHIP_H
+#define CHIP_H
+
+/** \brief Sustituto de chip.h para compilar el firmware en Linux
+ **
+ ** Declara el subconjunto de LPCOpen y CMSIS que usa el firmware con los mismos nombres, de forma
+ ** que bsp.c, digital.c y main.c compilan sin cambios. Los registros se simulan en chip.c.
+ **
+ ** El TIMER3, el CREG, el RGU, el RIT y SEV solo existen para compilar las imagenes de dos nucleos
+ ** (DUAL_CORE y CORE_M0): guardan lo que se escribe pero no cuentan ni disparan interrupciones.
+ **
+ ** \addtogroup host Host
+ ** \brief Ejecucion del firmware en Linux
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+// Modos del SCU, con los mismos valores que scu_18xx_43xx.h
+#define SCU_MODE_PULLUP            (0x0 << 3)
+#define SCU_MODE_REPEATER          (0x1 << 3)
+#define SCU_MODE_INACT             (0x2 << 3)
+#define SCU_MODE_PULLDOWN          (0x3 << 3)
+#define SCU_MODE_HIGHSPEEDSLEW_EN  (0x1 << 5)
+#define SCU_MODE_INBUFF_EN         (0x1 << 6)
+#define SCU_MODE_ZIF_DIS           (0x1 << 7)
+#define SCU_MODE_FUNC0             0x0
+#define SCU_MODE_FUNC1             0x1
+#define SCU_MODE_FUNC2             0x2
+#define SCU_MODE_FUNC3             0x3
+#define SCU_MODE_FUNC4             0x4
+#define SCU_MODE_FUNC5             0x5
+#define SCU_MODE_FUNC6             0x6
+#define SCU_MODE_FUNC7             0x7
+
+#define HOST_GPIO_PORTS            8
+#define HOST_SCU_PORTS             16
+#define HOST_SCU_PINS              32
+#define HOST_DMA_CHANNELS          8
+
+#define __NVIC_PRIO_BITS           3
+
+#define MAX_CLOCK_FREQ             204000000UL // frecuencia maxima del nucleo, igual que en LPCOpen
+
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk     (1UL << 0)
+#define SCB_ICSR_PENDSTSET_Msk     (1UL << 26)
+#define SCB_ICSR_PENDSVSET_Msk     (1UL << 28)
+
+// Configuracion de la UART, con los mismos valores que uart_18xx_43xx.h
+#define UART_LCR_WLEN8             (3 << 0)
+#define UART_LCR_SBS_1BIT          (0 << 2)
+#define UART_LCR_PARITY_DIS        (0 << 3)
+#define UART_FCR_FIFO_EN           (1 << 0)
+#define UART_FCR_RX_RS             (1 << 1)
+#define UART_FCR_TX_RS             (1 << 2)
+#define UART_FCR_DMAMODE_SEL       (1 << 3)
+#define UART_FCR_TRG_LEV0          (0 << 6)
+
+// Perifericos que solicitan transferencias al GPDMA
+#define GPDMA_CONN_UART2_Tx        9
+#define GPDMA_CONN_UART2_Rx        10
+
+#define GPDMA_DMACCxControl_TransferSize(n) ((n) & 0xFFF)
+#define GPDMA_DMACCxControl_I               (1UL << 31)
+
+// Perro guardian, con los mismos valores que wwdt_18xx_43xx.h. Cuenta el IRC dividido por 4.
+#define WDT_OSC                    12000000UL
+#define WWDT_WDMOD_WDEN            (1 << 0)
+#define WWDT_WDMOD_WDRESET         (1 << 1)
+#define WWDT_WDMOD_WDTOF           (1 << 2)
+
+#define LPC_GPIO_PORT              (&host_gpio_port)
+#define LPC_SCT                    (&host_sct)
+#define LPC_TIMER1                 (&host_timer1)
+#define LPC_TIMER3                 (&host_timer3)
+#define LPC_CREG                   (&host_creg)
+#define LPC_RITIMER                (&host_ritimer)
+#define LPC_USART2                 (&host_usart2)
+#define LPC_GPDMA                  (HostGpdma())
+#define LPC_WWDT                   (&host_wwdt)
+#define SysTick                    (HostSysTick())
+#define DWT                        (HostDwt())
+#define SCB                        (HostScb())
+#define CoreDebug                  (&host_core_debug)
+
+/* === Public data type declarations =========================================================== */
+
+typedef enum {
+    PendSV_IRQn = -2,
+    SysTick_IRQn = -1,
+    DAC_IRQn = 0,
+    M0APP_IRQn = 1,
+    DMA_IRQn = 2,
+    RITIMER_IRQn = 11,
+    TIMER0_IRQn = 12,
+    TIMER1_IRQn = 13,
+    USART2_IRQn = 26,
+    WWDT_IRQn = 49,
+    HOST_IRQ_COUNT = 53,
+} IRQn_Type;
+
+typedef enum {
+    CLK_MX_SCT,
+    CLK_MX_TIMER1,
+    CLK_MX_RITIMER,
+} CHIP_CCU_CLK_T;
+
+typedef enum {
+    RGU_M0APP_RST = 56,
+} CHIP_RGU_RST_T;
+
+typedef enum {
+    ERROR = 0,
+    SUCCESS = !ERROR,
+} Status;
+
+typedef enum {
+    RESET = 0,
+    SET = !RESET,
+} IntStatus;
+
+// Solo se simula la marca de fin de bloque, que el canal registra aunque no pida la interrupcion
+typedef enum {
+    GPDMA_STAT_RAWINTTC,
+} IntStatusType;
+
+typedef enum {
+    GPDMA_STATCLR_INTTC,
+} IntClearStatusType;
+
+typedef enum {
+    GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA,
+    GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA,
+    GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA,
+} GPDMA_FLOW_CONTROL_T;
+
+typedef enum {
+    CLKIN_IRC,
+    CLKIN_CRYSTAL,
+} CHIP_CGU_CLKIN_T;
+
+//! Registros del GPIO. SET refleja el latch de salida y PIN el estado de los pines.
+typedef struct {
+    volatile uint32_t DIR[HOST_GPIO_PORTS];
+    volatile uint32_t MASK[HOST_GPIO_PORTS];
+    volatile uint32_t PIN[HOST_GPIO_PORTS];
+    volatile uint32_t MPIN[HOST_GPIO_PORTS];
+    volatile uint32_t SET[HOST_GPIO_PORTS];
+    volatile uint32_t CLR[HOST_GPIO_PORTS];
+    volatile uint32_t NOT[HOST_GPIO_PORTS];
+} LPC_GPIO_T;
+
+typedef struct {
+    volatile uint32_t OUTPUT;
+    uint32_t rate;
+    uint32_t duty;
+    bool running;
+} LPC_SCT_T;
+
+typedef struct {
+    volatile uint32_t IR;
+    volatile uint32_t TCR;
+    volatile uint32_t TC;
+    volatile uint32_t PR;
+    volatile uint32_t PC;
+    volatile uint32_t MCR;
+    volatile uint32_t MR[4];
+} LPC_TIMER_T;
+
+typedef struct {
+    volatile uint32_t M0APPTXEVENT;
+    volatile uint32_t M0APPMEMMAP;
+} LPC_CREG_T;
+
+typedef struct {
+    volatile uint32_t COMPVAL;
+    volatile uint32_t MASK;
+    volatile uint32_t CTRL;
+    volatile uint32_t COUNTER;
+} LPC_RITIMER_T;
+
+typedef struct {
+    volatile uint32_t LCR;
+    volatile uint32_t FCR;
+    volatile uint32_t TER;
+    uint32_t baudrate;
+} LPC_USART_T;
+
+// En la placa las direcciones son registros de 32 bits; aqui deben alojar punteros del host
+typedef struct {
+    volatile uintptr_t SRCADDR;
+    volatile uintptr_t DESTADDR;
+    volatile uintptr_t LLI;
+    volatile uint32_t CONTROL;
+    volatile uint32_t CONFIG;
+} GPDMA_CH_T;
+
+typedef struct {
+    volatile uint32_t RAWINTTCSTAT;
+    volatile uint32_t ENBLDCHNS;
+    GPDMA_CH_T CH[HOST_DMA_CHANNELS];
+} LPC_GPDMA_T;
+
+typedef struct {
+    uintptr_t src;
+    uintptr_t dst;
+    uintptr_t lli;
+    uint32_t ctrl;
+} DMA_TransferDescriptor_t;
+
+typedef struct {
+    volatile uint32_t MOD;
+    volatile uint32_t TC;
+    volatile uint32_t FEED;
+    volatile uint32_t TV;
+} LPC_WWDT_T;
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t LOAD;
+    volatile uint32_t VAL;
+    volatile uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+    volatile uint32_t ICSR;
+} SCB_Type;
+
+/* === Public variable declarations ============================================================ */
+
+extern uint32_t SystemCoreClock;
+extern LPC_GPIO_T host_gpio_port;
+extern LPC_SCT_T host_sct;
+extern LPC_TIMER_T host_timer1;
+extern LPC_TIMER_T host_timer3;
+extern LPC_CREG_T host_creg;
+extern LPC_RITIMER_T host_ritimer;
+extern LPC_USART_T host_usart2;
+extern LPC_WWDT_T host_wwdt;
+extern CoreDebug_Type host_core_debug;
+
+/* === Public function declarations ============================================================ */
+
+SysTick_Type * HostSysTick(void);
+DWT_Type * HostDwt(void);
+SCB_Type * HostScb(void);
+LPC_GPDMA_T * HostGpdma(void);
+
+void SystemCoreClockUpdate(void);
+uint32_t SysTick_Config(uint32_t ticks);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __WFI(void);
+void __SEV(void);
+void __DSB(void);
+void __DMB(void);
+//! Reinicia el firmware en un proceso nuevo que conserva la memoria retenida
+void NVIC_SystemReset(void) __attribute__((noreturn));
+
+void Chip_SCU_PinMuxSet(uint8_t port, uint8_t pin, uint16_t modefunc);
+
+void Chip_GPIO_SetPinState(LPC_GPIO_T * gpio, uint8_t port, uint8_t pin, bool setting);
+void Chip_GPIO_SetPinDIR(LPC_GPIO_T * gpio, uint8_t port, uint8_t pin, bool output);
+bool Chip_GPIO_GetPinState(LPC_GPIO_T * gpio, uint8_t port, uint8_t pin);
+void Chip_GPIO_SetValue(LPC_GPIO_T * gpio, uint8_t port, uint32_t bitValue);
+void Chip_GPIO_ClearValue(LPC_GPIO_T * gpio, uint8_t port, uint32_t bitValue);
+void Chip_GPIO_SetPinToggle(LPC_GPIO_T * gpio, uint8_t port, uint8_t pin);
+
+uint32_t Chip_Clock_GetRate(CHIP_CCU_CLK_T clk);
+void Chip_SetupCoreClock(CHIP_CGU_CLKIN_T clkin, uint32_t core_freq, bool setbase);
+
+void Chip_SCTPWM_Init(LPC_SCT_T * sct);
+void Chip_SCTPWM_SetRate(LPC_SCT_T * sct, uint32_t freq);
+void Chip_SCTPWM_SetOutPin(LPC_SCT_T * sct, uint8_t index, uint8_t pin);
+void Chip_SCTPWM_SetDutyCycle(LPC_SCT_T * sct, uint8_t index, uint32_t ticks);
+uint32_t Chip_SCTPWM_GetTicksPerCycle(LPC_SCT_T * sct);
+void Chip_SCTPWM_Start(LPC_SCT_T * sct);
+void Chip_SCTPWM_Stop(LPC_SCT_T * sct);
+
+void Chip_TIMER_Init(LPC_TIMER_T * timer);
+void Chip_TIMER_PrescaleSet(LPC_TIMER_T * timer, uint32_t prescale);
+void Chip_TIMER_SetMatch(LPC_TIMER_T * timer, int8_t match, uint32_t count);
+void Chip_TIMER_MatchEnableInt(LPC_TIMER_T * timer, int8_t match);
+void Chip_TIMER_ResetOnMatchEnable(LPC_TIMER_T * timer, int8_t match);
+void Chip_TIMER_StopOnMatchEnable(LPC_TIMER_T * timer, int8_t match);
+void Chip_TIMER_Reset(LPC_TIMER_T * timer);
+void Chip_TIMER_Enable(LPC_TIMER_T * timer);
+void Chip_TIMER_Disable(LPC_TIMER_T * timer);
+bool Chip_TIMER_MatchPending(LPC_TIMER_T * timer, int8_t match);
+void Chip_TIMER_ClearMatch(LPC_TIMER_T * timer, int8_t match);
+
+void Chip_RIT_Init(LPC_RITIMER_T * rit);
+void Chip_RIT_SetTimerInterval(LPC_RITIMER_T * rit, uint32_t time_interval);
+void Chip_RIT_ClearInt(LPC_RITIMER_T * rit);
+
+void Chip_UART_Init(LPC_USART_T * uart);
+uint32_t Chip_UART_SetBaud(LPC_USART_T * uart, uint32_t baudrate);
+void Chip_UART_ConfigData(LPC_USART_T * uart, uint32_t config);
+void Chip_UART_SetupFIFOS(LPC_USART_T * uart, uint32_t fcr);
+void Chip_UART_TXEnable(LPC_USART_T * uart);
+
+void Chip_GPDMA_Init(LPC_GPDMA_T * gpdma);
+uint8_t Chip_GPDMA_GetFreeChannel(LPC_GPDMA_T * gpdma, uint32_t connection);
+Status Chip_GPDMA_InitDescriptor(LPC_GPDMA_T * gpdma, DMA_TransferDescriptor_t * descriptor,
+                                 uintptr_t src, uintptr_t dst, uint32_t size,
+                                 GPDMA_FLOW_CONTROL_T type, const DMA_TransferDescriptor_t * next);
+Status Chip_GPDMA_SGTransfer(LPC_GPDMA_T * gpdma, uint8_t channel,
+                             const DMA_TransferDescriptor_t * descriptor, GPDMA_FLOW_CONTROL_T type);
+Status Chip_GPDMA_Transfer(LPC_GPDMA_T * gpdma, uint8_t channel, uintptr_t src, uintptr_t dst,
+                           GPDMA_FLOW_CONTROL_T type, uint32_t size);
+IntStatus Chip_GPDMA_IntGetStatus(LPC_GPDMA_T * gpdma, IntStatusType type, uint8_t channel);
+void Chip_GPDMA_ClearIntPending(LPC_GPDMA_T * gpdma, IntClearStatusType type, uint8_t channel);
+
+void Chip_WWDT_Init(LPC_WWDT_T * wwdt);
+void Chip_WWDT_SetTimeOut(LPC_WWDT_T * wwdt, uint32_t timeout);
+void Chip_WWDT_SetOption(LPC_WWDT_T * wwdt, uint32_t options);
+uint32_t Chip_WWDT_GetStatus(LPC_WWDT_T * wwdt);
+void Chip_WWDT_ClearStatusFlag(LPC_WWDT_T * wwdt, uint32_t flag);
+void Chip_WWDT_Start(LPC_WWDT_T * wwdt);
+void Chip_WWDT_Feed(LPC_WWDT_T * wwdt);
+
+void Chip_RGU_ClearReset(CHIP_RGU_RST_T reset);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* CHIP_H */
@@ -0,0 +1,325 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Grabacion y reproduccion de las entradas
+ **
+ ** Con la variable de entorno HOST_GRABAR se guarda en un archivo cada cambio de nivel de los pines
+ ** de entrada junto con el numero del SysTick en el que el firmware lo ve por primera vez. Con
+ ** HOST_REPRODUCIR el mismo archivo se aplica a las entradas en esos ticks, que se ejecutan sin
+ ** esperar su periodo y sincronizados con el lazo principal, de modo que dos reproducciones pasan
+ ** por los mismos estados. La reproduccion escribe en la salida estandar cada cuadro nuevo de la
+ ** pantalla y al terminar una suma de la memoria retenida, que incluye la hora, la alarma, el modo
+ ** de la interfaz y la traza. Tambien escribe cada registro nuevo de la traza y al final la
+ ** cantidad de registros de cada tipo y de eventos de teclas descartados, que son los mismos en
+ ** todas las reproducciones. El formato del archivo esta en grabacion.h.
+ **
+ ** Solo se graban las entradas digitales: lo recibido por la consola no se reproduce, y la grabacion
+ ** se cierra en un reinicio porque la reproduccion siempre arranca en frio.
+ **
+ ** \addtogroup host Host
+ ** \brief Ejecucion del firmware en Linux
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "chip.h"
+#include "host.h"
+#include "grabacion.h"
+#include "digital.h"
+#include "reloj.h"
+#include "traza.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/personality.h>
+#include <time.h>
+#include <unistd.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define ENTORNO_GRABAR     "HOST_GRABAR"
+#define ENTORNO_REPRODUCIR "HOST_REPRODUCIR"
+#define CUADRO_DIGITOS     4
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+static FILE * grabacion = NULL;
+static uint32_t niveles[HOST_GPIO_PORTS]; // ultimos niveles grabados de cada puerto
+static uint64_t ultimo = 0;               // tick del ultimo registro grabado o leido
+
+// Archivo a reproducir, leido completo en memoria
+static uint8_t * datos = NULL;
+static size_t tamano = 0;
+static size_t posicion = 0;
+static uint64_t proximo = 0; // tick del registro pendiente
+static uint8_t destino = 0;  // puerto y pin del registro pendiente
+static bool nivel = false;
+
+static uint8_t cuadro[CUADRO_DIGITOS];
+static uint64_t cuadros = 0;
+static uint64_t cambios = 0;
+static struct timespec comienzo;
+static uint32_t leidos = 0; // registros de la traza ya escritos en la salida
+static uint64_t tipos[TRAZA_TIPOS];
+
+static const char * const nombres[TRAZA_TIPOS] = {
+    [TRAZA_NINGUNO] = "NINGUNO",
+#define TRAZA_EVENTO(id, texto) [TRAZA_##id] = #id,
+#include "traza_eventos.h"
+#undef TRAZA_EVENTO
+};
+
+// Limites de la seccion retenida, que define el enlazador si algun modulo la usa
+extern char __start_noinit[] __attribute__((weak));
+extern char __stop_noinit[] __attribute__((weak));
+
+/* === Private function declarations =========================================================== */
+
+void GrabacionEscribir(uint64_t tick, bool valor, uint8_t byte);
+void GrabacionTick(uint64_t tick);
+void GrabacionCerrar(void);
+bool GrabacionLeer(void);
+void GrabacionCuadro(uint64_t tick);
+void GrabacionTraza(void);
+void GrabacionResumen(uint64_t tick);
+void ReproduccionTick(uint64_t tick);
+bool ReproduccionAbrir(const char * archivo);
+void GrabacionInit(int argc, char * argv[]) __attribute__((constructor));
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+void GrabacionEscribir(uint64_t tick, bool valor, uint8_t byte) {
+
+    GrabacionRegistro(grabacion, tick - ultimo, valor, byte);
+    ultimo = tick;
+}
+
+// Compara los niveles impuestos con los grabados: lo que cambio es lo que el tick va a leer
+void GrabacionTick(uint64_t tick) {
+
+    for (uint8_t puerto = 0; puerto < HOST_GPIO_PORTS; puerto++) {
+        uint32_t actuales = HostGpioInputs(puerto);
+        uint32_t diferentes = actuales ^ niveles[puerto];
+
+        while (diferentes) {
+            uint8_t pin = (uint8_t)__builtin_ctz(diferentes);
+            diferentes &= diferentes - 1;
+            GrabacionEscribir(tick, (actuales >> pin) & 1, GRABACION_PIN(puerto, pin));
+            cambios++;
+        }
+        niveles[puerto] = actuales;
+    }
+}
+
+void GrabacionCerrar(void) {
+
+    if (!grabacion) {
+        return;
+    }
+    GrabacionEscribir(HostSysTickCount(), false, GRABACION_FIN);
+    fclose(grabacion);
+    grabacion = NULL;
+    fprintf(stderr, "\ngrabados %llu cambios en %llu ticks\n", (unsigned long long)cambios,
+            (unsigned long long)HostSysTickCount());
+    // El proceso que sigue a un reinicio no debe pisar la grabacion
+    unsetenv(ENTORNO_GRABAR);
+}
+
+// Lee el registro siguiente; devuelve false si el archivo termina antes del registro final
+bool GrabacionLeer(void) {
+
+    uint64_t numero = 0;
+    unsigned desplazamiento = 0;
+
+    while (posicion < tamano && desplazamiento < 64) {
+        uint8_t byte = datos[posicion++];
+        numero |= (uint64_t)(byte & 0x7F) << desplazamiento;
+        desplazamiento += 7;
+        if (!(byte & 0x80)) {
+            if (posicion >= tamano) {
+                return false;
+            }
+            proximo = ultimo + (numero >> 1);
+            nivel = numero & 1;
+            destino = datos[posicion++];
+            ultimo = proximo;
+            return true;
+        }
+    }
+    return false;
+}
+
+// El multiplexado solo escribe los puertos en el SysTick: al comenzar un tick la pantalla muestra
+// lo que dejo el anterior
+void GrabacionCuadro(uint64_t tick) {
+
+    uint8_t actual[CUADRO_DIGITOS];
+
+    HostPanelFrame(actual, sizeof(actual));
+    if (memcmp(actual, cuadro, sizeof(cuadro)) == 0) {
+        return;
+    }
+    memcpy(cuadro, actual, sizeof(cuadro));
+    cuadros++;
+    printf("%10llu", (unsigned long long)tick);
+    for (int digito = 0; digito < CUADRO_DIGITOS; digito++) {
+        printf(" %02x", cuadro[digito]);
+    }
+    printf("\n");
+}
+
+// El lazo principal esta dormido mientras se ejecuta la funcion de tick, asi que los registros
+// hasta TrazaSiguiente ya estan completos
+void GrabacionTraza(void) {
+
+    uint32_t siguiente = TrazaSiguiente();
+
+    if (siguiente - leidos > TRAZA_REGISTROS) {
+        leidos = siguiente - TRAZA_REGISTROS;
+    }
+    while (leidos != siguiente) {
+        uint64_t registro = TrazaLeer(leidos++);
+        uint8_t tipo = TRAZA_TIPO(registro);
+        if (tipo >= TRAZA_TIPOS) {
+            continue;
+        }
+        tipos[tipo]++;
+        printf("%10" PRIu32 " %-16s %3u %5u\n", TRAZA_TICK(registro), nombres[tipo],
+               TRAZA_A(registro), TRAZA_B(registro));
+    }
+}
+
+void GrabacionResumen(uint64_t tick) {
+
+    uint32_t suma = 2166136261u;
+    size_t retenida = (size_t)(__stop_noinit - __start_noinit);
+    struct timespec fin;
+
+    for (size_t indice = 0; indice < retenida; indice++) {
+        suma = (suma ^ (uint8_t)__start_noinit[indice]) * 16777619u;
+    }
+    for (int tipo = TRAZA_NINGUNO + 1; tipo < TRAZA_TIPOS; tipo++) {
+        printf("total %s %llu\n", nombres[tipo], (unsigned long long)tipos[tipo]);
+    }
+    printf("fin en el tick %llu, %llu cambios, %u descartados, %llu cuadros, memoria retenida %zu "
+           "bytes suma %08x\n",
+           (unsigned long long)tick, (unsigned long long)cambios, DigitalEventsDropped(),
+           (unsigned long long)cuadros, retenida, suma);
+    fflush(stdout);
+
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    double real = (double)(fin.tv_sec - comienzo.tv_sec) + (fin.tv_nsec - comienzo.tv_nsec) / 1e9;
+    double simulado = (double)tick / TICKS_PER_SECOND;
+    fprintf(stderr, "reproducidos %.1f s en %.3f s, %.0f veces mas rapido que el tiempo real\n",
+            simulado, real, real > 0 ? simulado / real : 0);
+}
+
+void ReproduccionTick(uint64_t tick) {
+
+    GrabacionCuadro(tick - 1);
+    GrabacionTraza();
+    while (proximo == tick && destino != GRABACION_FIN) {
+        HostGpioSetInput(GRABACION_PUERTO(destino), GRABACION_BIT(destino), nivel);
+        cambios++;
+        if (!GrabacionLeer()) {
+            fprintf(stderr, "grabacion incompleta despues del tick %llu\n",
+                    (unsigned long long)tick);
+            destino = GRABACION_FIN;
+            proximo = tick;
+        }
+    }
+    if (destino == GRABACION_FIN && tick > proximo) {
+        GrabacionResumen(tick - 1);
+        HostRequestExit(0);
+    }
+}
+
+bool ReproduccionAbrir(const char * archivo) {
+
+    FILE * entrada = fopen(archivo, "rb");
+    size_t firma = strlen(GRABACION_FIRMA);
+
+    if (!entrada) {
+        perror(archivo);
+        return false;
+    }
+    fseek(entrada, 0, SEEK_END);
+    tamano = (size_t)ftell(entrada);
+    rewind(entrada);
+    datos = malloc(tamano ? tamano : 1);
+    if (!datos || fread(datos, 1, tamano, entrada) != tamano || tamano <= firma ||
+        memcmp(datos, GRABACION_FIRMA, firma) != 0 || datos[firma] != GRABACION_VERSION) {
+        fprintf(stderr, "%s: no es una grabacion de la version %d\n", archivo, GRABACION_VERSION);
+        fclose(entrada);
+        return false;
+    }
+    fclose(entrada);
+    posicion = firma + 1;
+    if (!GrabacionLeer()) {
+        fprintf(stderr, "%s: grabacion vacia\n", archivo);
+        return false;
+    }
+    return true;
+}
+
+void GrabacionInit(int argc, char * argv[]) {
+
+    const char * archivo;
+    int personalidad = personality(0xFFFFFFFF);
+
+    (void)argc;
+    if ((archivo = getenv(ENTORNO_REPRODUCIR))) {
+        // La memoria retenida guarda punteros: para que quede igual en cada reproduccion el proceso
+        // se vuelve a ejecutar con las direcciones sin aleatorizar, como hace un depurador
+        if (personalidad != -1 && !(personalidad & ADDR_NO_RANDOMIZE) &&
+            personality((unsigned long)personalidad | ADDR_NO_RANDOMIZE) != -1) {
+            execv("/proc/self/exe", argv);
+        }
+        if (!ReproduccionAbrir(archivo)) {
+            exit(EXIT_FAILURE);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &comienzo);
+        HostSetLockstep(true);
+        HostSetTickHook(ReproduccionTick);
+    } else if ((archivo = getenv(ENTORNO_GRABAR))) {
+        if (!(grabacion = fopen(archivo, "wb"))) {
+            perror(archivo);
+            exit(EXIT_FAILURE);
+        }
+        GrabacionCabecera(grabacion);
+        HostSetTickHook(GrabacionTick);
+        HostSetResetHook(GrabacionCerrar);
+        atexit(GrabacionCerrar);
+    }
+}
+
+/* === Public function implementation ========================================================== */
+
+bool HostReplaying(void) {
+
+    return getenv(ENTORNO_REPRODUCIR) != NULL;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,88 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef GRABACION_H
+#define GRABACION_H
+
+/** \brief Formato de las grabaciones de entradas
+ **
+ ** El archivo empieza con la firma GRABACION_FIRMA y la version. Cada cambio de nivel ocupa un
+ ** numero de longitud variable (7 bits por byte, el bit 7 indica que sigue otro) con los ticks desde
+ ** el cambio anterior desplazados un bit y el nivel nuevo en el bit 0, y un byte con el puerto en
+ ** los bits 7 a 5 y el pin en los bits 4 a 0. El ultimo registro tiene el byte GRABACION_FIN y sus
+ ** ticks llevan al ultimo SysTick ejecutado.
+ **
+ ** Lo usan la grabacion del firmware en Linux y las herramientas que generan grabaciones.
+ **
+ ** \addtogroup host Host
+ ** \brief Ejecucion del firmware en Linux
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+#define GRABACION_FIRMA   "GRAB"
+#define GRABACION_VERSION 1
+#define GRABACION_FIN     0xFF
+
+//! Byte que identifica un pin en un registro
+#define GRABACION_PIN(puerto, pin) ((uint8_t)((puerto) << 5 | (pin)))
+#define GRABACION_PUERTO(byte)     ((uint8_t)((byte) >> 5))
+#define GRABACION_BIT(byte)        ((uint8_t)((byte) & 0x1F))
+
+/* === Public data type declarations =========================================================== */
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+//! Escribe la firma y la version al comienzo de una grabacion
+static inline void GrabacionCabecera(FILE * archivo) {
+    fputs(GRABACION_FIRMA, archivo);
+    fputc(GRABACION_VERSION, archivo);
+}
+
+//! Escribe un registro: el pin (o GRABACION_FIN) cambia al nivel indicado ticks despues del anterior
+static inline void GrabacionRegistro(FILE * archivo, uint64_t ticks, bool nivel, uint8_t pin) {
+
+    uint64_t numero = (ticks << 1) | nivel;
+
+    do {
+        fputc((int)((numero & 0x7F) | (numero > 0x7F ? 0x80 : 0)), archivo);
+        numero >>= 7;
+    } while (numero);
+    fputc(pin, archivo);
+}
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* GRABACION_H */
@@ -0,0 +1,559 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Generador de tormentas de teclas
+ **
+ ** Arma grabaciones de entradas (grabacion.h) con escenarios patologicos y las reproduce con el
+ ** firmware para Linux. Cada escenario se genera dos veces con la misma semilla: una con rebotes de
+ ** contacto en cada flanco y otra limpia, que sirve de referencia. La diferencia en la cantidad de
+ ** registros de cada tipo de la traza entre las dos reproducciones son los eventos, cambios de modo
+ ** y acciones espurias que provocaron los rebotes. Ademas se informan los eventos descartados por
+ ** la cola de teclas, la latencia entre la interrupcion que detecta una tecla y la tarea que la
+ ** atiende, la demora maxima de esa tarea y la duracion del SysTick.
+ **
+ **     estres [-x app] [-d directorio] [-s semilla] [-n pulsaciones] [-r rebotes] [-a ancho]
+ **            [-p periodo] [-f] [escenario ...]
+ **
+ ** Los escenarios son incrementos (pulsaciones rapidas de F4 y F3 ajustando la hora), aporreo
+ ** (teclas al azar superpuestas), simultaneo (dos o tres teclas en el mismo tick, a veces F1 y F2
+ ** sostenidas) y alarma (aceptar y cancelar con rebotes mientras suena la alarma). Con -f el
+ ** programa termina con error si hubo registros espurios o eventos descartados.
+ **
+ ** \addtogroup host Host
+ ** \brief Ejecucion del firmware en Linux
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "bsp.h"
+#include "poncho.h"
+#include "grabacion.h"
+#include "traza.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define APLICACION   "build/host/app"
+#define DIRECTORIO   "build/host/tormentas"
+#define SEMILLA      1
+#define PULSACIONES  40
+#define REBOTES      3  // rebotes maximos en cada flanco
+#define ANCHO        8  // ticks en los que se producen los rebotes
+#define PERIODO      60 // ticks entre pulsaciones de los escenarios rapidos
+#define INICIO       500   // ticks desde el arranque hasta la primera pulsacion
+#define SOSTENER     3200  // F1 y F2 sostenidas, algo mas que DELAY_SET_TIME_ALARM
+#define PAUSA        300   // ticks entre pasos de los ajustes
+#define ASENTAR      2000  // ticks que se siguen ejecutando despues del ultimo flanco
+#define POSPONER     300000 // duracion de la alarma pospuesta, 5 minutos
+#define LINEA        256
+
+/* === Private data type declarations ========================================================== */
+
+typedef struct flanco_s {
+    uint64_t tick;
+    uint32_t orden; // desempata flancos del mismo tick en el orden en que se generaron
+    uint8_t pin;
+    bool nivel;
+} flanco_s;
+
+typedef struct escenario_s {
+    const char * nombre;
+    uint64_t (*generar)(uint64_t tick); // agrega las pulsaciones y devuelve el tick del final
+} escenario_s;
+
+typedef struct resultado_s {
+    uint64_t tipos[TRAZA_TIPOS];
+    unsigned descartados;
+    double latencia[3]; // percentiles 50, 90 y 99 en microsegundos
+    unsigned systick[2]; // percentiles 50 y 99 en ciclos
+    unsigned demora;     // demora maxima de la tarea interfaz, en ticks
+    bool valido;
+} resultado_s;
+
+/* === Private variable declarations =========================================================== */
+
+static const uint8_t pines[BOARD_KEYS] = {
+    [BOARD_KEY_ACCEPT] = GRABACION_PIN(KEY_ACCEPT_GPIO, KEY_ACCEPT_BIT),
+    [BOARD_KEY_CANCEL] = GRABACION_PIN(KEY_CANCEL_GPIO, KEY_CANCEL_BIT),
+    [BOARD_KEY_SET_TIME] = GRABACION_PIN(KEY_F1_GPIO, KEY_F1_BIT),
+    [BOARD_KEY_SET_ALARM] = GRABACION_PIN(KEY_F2_GPIO, KEY_F2_BIT),
+    [BOARD_KEY_DECREMENT] = GRABACION_PIN(KEY_F3_GPIO, KEY_F3_BIT),
+    [BOARD_KEY_INCREMENT] = GRABACION_PIN(KEY_F4_GPIO, KEY_F4_BIT),
+};
+
+static const char * const nombres[TRAZA_TIPOS] = {
+    [TRAZA_NINGUNO] = "NINGUNO",
+#define TRAZA_EVENTO(id, texto) [TRAZA_##id] = #id,
+#include "traza_eventos.h"
+#undef TRAZA_EVENTO
+};
+
+static flanco_s * flancos = NULL;
+static size_t cantidad = 0;
+static size_t capacidad = 0;
+static uint64_t libre[BOARD_KEYS]; // primer tick en el que cada tecla se puede volver a pulsar
+static unsigned pulsaciones = 0;
+
+// Dos secuencias al azar: la de los rebotes no debe cambiar las pulsaciones del escenario
+static uint64_t azar_escenario;
+static uint64_t azar_rebote;
+
+static unsigned opcion_pulsaciones = PULSACIONES;
+static unsigned opcion_rebotes = REBOTES;
+static unsigned opcion_ancho = ANCHO;
+static unsigned opcion_periodo = PERIODO;
+static unsigned rebotes = 0; // los del escenario que se esta generando, 0 en la referencia
+
+/* === Private function declarations =========================================================== */
+
+static uint32_t Azar(uint64_t * estado, uint32_t limite);
+static void Agregar(uint64_t tick, int tecla, bool nivel);
+static void Flanco(uint64_t tick, int tecla, bool nivel);
+static void Pulsar(uint64_t tick, int tecla, uint64_t duracion);
+static uint64_t AjustarHora(uint64_t tick);
+
+static uint64_t Incrementos(uint64_t tick);
+static uint64_t Aporreo(uint64_t tick);
+static uint64_t Simultaneo(uint64_t tick);
+static uint64_t Alarma(uint64_t tick);
+
+static int Comparar(const void * a, const void * b);
+static uint64_t Generar(const escenario_s * escenario, uint64_t semilla, bool con_rebotes);
+static bool Escribir(const char * archivo, uint64_t fin);
+static resultado_s Reproducir(const char * aplicacion, const char * archivo);
+static uint64_t Acciones(const resultado_s * resultado);
+static bool Elegido(const char * nombre, int argc, char * argv[], int primero);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static const escenario_s escenarios[] = {
+    {"incrementos", Incrementos},
+    {"aporreo", Aporreo},
+    {"simultaneo", Simultaneo},
+    {"alarma", Alarma},
+};
+
+/* === Private function implementation ========================================================= */
+
+// xorshift64: la misma semilla da la misma grabacion en cualquier maquina
+static uint32_t Azar(uint64_t * estado, uint32_t limite) {
+
+    *estado ^= *estado << 13;
+    *estado ^= *estado >> 7;
+    *estado ^= *estado << 17;
+    return limite ? (uint32_t)(*estado % limite) : 0;
+}
+
+static void Agregar(uint64_t tick, int tecla, bool nivel) {
+
+    if (cantidad == capacidad) {
+        capacidad = capacidad ? 2 * capacidad : 1024;
+        flancos = realloc(flancos, capacidad * sizeof(flanco_s));
+        if (!flancos) {
+            perror("estres");
+            exit(EXIT_FAILURE);
+        }
+    }
+    flancos[cantidad] = (flanco_s){.tick = tick, .orden = (uint32_t)cantidad, .pin = pines[tecla],
+                                   .nivel = nivel};
+    cantidad++;
+}
+
+// El contacto cambia al nivel nuevo y despues rebota: vuelve al anterior y al nuevo en ticks
+// distintos dentro del ancho, para que el barrido pueda ver cada rebote
+static void Flanco(uint64_t tick, int tecla, bool nivel) {
+
+    unsigned veces = rebotes ? Azar(&azar_rebote, rebotes + 1) : 0;
+    uint64_t hasta = tick + opcion_ancho;
+
+    Agregar(tick, tecla, nivel);
+    for (unsigned rebote = 0; rebote < veces && tick + 2 <= hasta; rebote++) {
+        uint64_t suelta = tick + 1 + Azar(&azar_rebote, (uint32_t)(hasta - tick - 1));
+        if (suelta + 1 > hasta) {
+            break;
+        }
+        uint64_t vuelve = suelta + 1 + Azar(&azar_rebote, (uint32_t)(hasta - suelta));
+        Agregar(suelta, tecla, !nivel);
+        Agregar(vuelve, tecla, nivel);
+        tick = vuelve;
+    }
+}
+
+// Una pulsacion ocupa la tecla hasta que terminan los rebotes de la liberacion
+static void Pulsar(uint64_t tick, int tecla, uint64_t duracion) {
+
+    if (tick < libre[tecla]) {
+        tick = libre[tecla];
+    }
+    if (duracion <= opcion_ancho) {
+        duracion = opcion_ancho + 1;
+    }
+    Flanco(tick, tecla, true);
+    Flanco(tick + duracion, tecla, false);
+    libre[tecla] = tick + duracion + opcion_ancho + 1;
+    pulsaciones++;
+}
+
+// Pone el reloj en 00:00 con F1 sostenida y dos veces aceptar
+static uint64_t AjustarHora(uint64_t tick) {
+
+    Pulsar(tick, BOARD_KEY_SET_TIME, SOSTENER);
+    tick += SOSTENER + PAUSA;
+    Pulsar(tick, BOARD_KEY_ACCEPT, PAUSA / 3);
+    tick += PAUSA;
+    Pulsar(tick, BOARD_KEY_ACCEPT, PAUSA / 3);
+    return tick + PAUSA;
+}
+
+static uint64_t Incrementos(uint64_t tick) {
+
+    Pulsar(tick, BOARD_KEY_SET_TIME, SOSTENER);
+    tick += SOSTENER + PAUSA;
+    for (unsigned indice = 0; indice < opcion_pulsaciones; indice++) {
+        Pulsar(tick, BOARD_KEY_INCREMENT, opcion_periodo / 2);
+        tick += opcion_periodo;
+    }
+    Pulsar(tick, BOARD_KEY_ACCEPT, PAUSA / 3);
+    tick += PAUSA;
+    for (unsigned indice = 0; indice < opcion_pulsaciones; indice++) {
+        Pulsar(tick, BOARD_KEY_DECREMENT, opcion_periodo / 2);
+        tick += opcion_periodo;
+    }
+    Pulsar(tick, BOARD_KEY_ACCEPT, PAUSA / 3);
+    return tick + PAUSA;
+}
+
+// Teclas al azar, cada una con su duracion: las pulsaciones de teclas distintas se superponen
+static uint64_t Aporreo(uint64_t tick) {
+
+    tick = AjustarHora(tick);
+    for (unsigned indice = 0; indice < opcion_pulsaciones; indice++) {
+        int tecla = (int)Azar(&azar_escenario, BOARD_KEYS);
+        Pulsar(tick, tecla, 1 + Azar(&azar_escenario, opcion_periodo));
+        tick += 1 + Azar(&azar_escenario, opcion_periodo / 2);
+    }
+    return tick;
+}
+
+// Dos o tres teclas distintas en el mismo tick; una de cada cuatro veces F1 y F2 sostenidas
+static uint64_t Simultaneo(uint64_t tick) {
+
+    tick = AjustarHora(tick);
+    for (unsigned indice = 0; indice < opcion_pulsaciones; indice++) {
+        if (indice % 4 == 3) {
+            Pulsar(tick, BOARD_KEY_SET_TIME, SOSTENER);
+            Pulsar(tick, BOARD_KEY_SET_ALARM, SOSTENER);
+            tick += SOSTENER + PAUSA;
+            continue;
+        }
+        unsigned teclas = 2 + Azar(&azar_escenario, 2);
+        int elegidas = 0;
+        uint64_t duracion = 1 + Azar(&azar_escenario, opcion_periodo);
+        while (teclas) {
+            int tecla = (int)Azar(&azar_escenario, BOARD_KEYS);
+            if (!(elegidas & (1 << tecla))) {
+                elegidas |= 1 << tecla;
+                teclas--;
+            }
+        }
+        // Se espera a que todas esten libres para que lleguen juntas
+        for (int tecla = 0; tecla < BOARD_KEYS; tecla++) {
+            if ((elegidas & (1 << tecla)) && libre[tecla] > tick) {
+                tick = libre[tecla];
+            }
+        }
+        for (int tecla = 0; tecla < BOARD_KEYS; tecla++) {
+            if (elegidas & (1 << tecla)) {
+                Pulsar(tick, tecla, duracion);
+            }
+        }
+        tick += duracion + PAUSA;
+    }
+    return tick;
+}
+
+// Hora 00:00 y alarma 00:01: suena un minuto despues, se pospone con aceptar y al volver a sonar se
+// cancela. La cantidad de pulsaciones no cambia este escenario.
+static uint64_t Alarma(uint64_t tick) {
+
+    tick = AjustarHora(tick);
+    uint64_t suena = tick - PAUSA + 60 * 1000;
+
+    Pulsar(tick, BOARD_KEY_SET_ALARM, SOSTENER);
+    tick += SOSTENER + PAUSA;
+    Pulsar(tick, BOARD_KEY_INCREMENT, PAUSA / 3);
+    tick += PAUSA;
+    Pulsar(tick, BOARD_KEY_ACCEPT, PAUSA / 3);
+    tick += PAUSA;
+    Pulsar(tick, BOARD_KEY_ACCEPT, PAUSA / 3);
+
+    tick = suena + 2000;
+    Pulsar(tick, BOARD_KEY_ACCEPT, PAUSA / 3);
+    tick += POSPONER + 2000;
+    Pulsar(tick, BOARD_KEY_CANCEL, PAUSA / 3);
+    return tick + PAUSA;
+}
+
+static int Comparar(const void * a, const void * b) {
+
+    const flanco_s * x = a;
+    const flanco_s * y = b;
+
+    if (x->tick != y->tick) {
+        return x->tick < y->tick ? -1 : 1;
+    }
+    return (x->orden > y->orden) - (x->orden < y->orden);
+}
+
+// Deja en flancos el escenario ordenado por tick, con rebotes o sin ellos, y devuelve el tick en el
+// que termina la grabacion
+static uint64_t Generar(const escenario_s * escenario, uint64_t semilla, bool con_rebotes) {
+
+    uint64_t fin;
+
+    cantidad = 0;
+    pulsaciones = 0;
+    memset(libre, 0, sizeof(libre));
+    azar_escenario = semilla * 2654435761u + 1;
+    azar_rebote = semilla * 40503u + 7;
+    rebotes = con_rebotes ? opcion_rebotes : 0;
+    fin = escenario->generar(INICIO) + ASENTAR;
+    qsort(flancos, cantidad, sizeof(flanco_s), Comparar);
+    return fin;
+}
+
+static bool Escribir(const char * archivo, uint64_t fin) {
+
+    FILE * salida = fopen(archivo, "wb");
+    uint64_t anterior = 0;
+
+    if (!salida) {
+        perror(archivo);
+        return false;
+    }
+    GrabacionCabecera(salida);
+    for (size_t indice = 0; indice < cantidad; indice++) {
+        GrabacionRegistro(salida, flancos[indice].tick - anterior, flancos[indice].nivel,
+                          flancos[indice].pin);
+        anterior = flancos[indice].tick;
+    }
+    GrabacionRegistro(salida, fin > anterior ? fin - anterior : 0, false, GRABACION_FIN);
+    return fclose(salida) == 0;
+}
+
+// Toma de la reproduccion los totales de la traza y el resumen, y del informe de salida las
+// latencias de teclas, la fila de la tarea interfaz y la sonda del SysTick
+static resultado_s Reproducir(const char * aplicacion, const char * archivo) {
+
+    char comando[2 * LINEA];
+    char linea[LINEA];
+    char nombre[32];
+    unsigned long long valor;
+    resultado_s resultado = {0};
+
+    snprintf(comando, sizeof(comando), "HOST_REPRODUCIR='%s' '%s' 2>&1 </dev/null", archivo,
+             aplicacion);
+    FILE * entrada = popen(comando, "r");
+    if (!entrada) {
+        perror(aplicacion);
+        return resultado;
+    }
+    while (fgets(linea, sizeof(linea), entrada)) {
+        unsigned campos[8];
+        if (sscanf(linea, "total %31s %llu", nombre, &valor) == 2) {
+            for (int tipo = 0; tipo < TRAZA_TIPOS; tipo++) {
+                if (strcmp(nombre, nombres[tipo]) == 0) {
+                    resultado.tipos[tipo] = valor;
+                }
+            }
+        } else if (sscanf(linea, "fin en el tick %llu, %*u cambios, %u descartados", &valor,
+                          &resultado.descartados) == 2) {
+            resultado.valido = true;
+        } else if (sscanf(linea, "p50 / p90 / p99 : %lf / %lf / %lf", &resultado.latencia[0],
+                          &resultado.latencia[1], &resultado.latencia[2]) == 3) {
+        } else if (sscanf(linea, "interfaz %u %u %u %u %u %u", &campos[0], &campos[1], &campos[2],
+                          &campos[3], &campos[4], &campos[5]) == 6) {
+            resultado.demora = campos[5];
+        } else if (sscanf(linea, "systick %u %u %u %u %u %u", &campos[0], &campos[1], &campos[2],
+                          &campos[3], &campos[4], &campos[5]) == 6) {
+            resultado.systick[0] = campos[4];
+            resultado.systick[1] = campos[5];
+        }
+    }
+    if (pclose(entrada) != 0) {
+        resultado.valido = false;
+    }
+    return resultado;
+}
+
+// Registros de la traza que corresponden a acciones sobre el reloj o la alarma
+static uint64_t Acciones(const resultado_s * resultado) {
+
+    return resultado->tipos[TRAZA_HORA] + resultado->tipos[TRAZA_AJUSTE_ALARMA] +
+           resultado->tipos[TRAZA_HABILITAR_ALARMA] + resultado->tipos[TRAZA_POSPONER] +
+           resultado->tipos[TRAZA_ALARMA];
+}
+
+static bool Elegido(const char * nombre, int argc, char * argv[], int primero) {
+
+    if (primero >= argc) {
+        return true;
+    }
+    for (int indice = primero; indice < argc; indice++) {
+        if (strcmp(nombre, argv[indice]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(int argc, char * argv[]) {
+
+    const char * aplicacion = APLICACION;
+    const char * directorio = DIRECTORIO;
+    uint64_t semilla = SEMILLA;
+    bool fallar = false;
+    int problemas = 0;
+    int opcion;
+
+    while ((opcion = getopt(argc, argv, "x:d:s:n:r:a:p:f")) != -1) {
+        switch (opcion) {
+        case 'x':
+            aplicacion = optarg;
+            break;
+        case 'd':
+            directorio = optarg;
+            break;
+        case 's':
+            semilla = strtoull(optarg, NULL, 10);
+            break;
+        case 'n':
+            opcion_pulsaciones = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        case 'r':
+            opcion_rebotes = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        case 'a':
+            opcion_ancho = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        case 'p':
+            opcion_periodo = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        case 'f':
+            fallar = true;
+            break;
+        default:
+            fprintf(stderr,
+                    "uso: %s [-x app] [-d directorio] [-s semilla] [-n pulsaciones] [-r rebotes] "
+                    "[-a ancho] [-p periodo] [-f] [escenario ...]\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (opcion_periodo < 2) {
+        opcion_periodo = 2;
+    }
+    mkdir(directorio, 0777);
+
+    printf("%-12s %6s %7s %7s %6s %11s %11s %5s %22s %13s %7s\n", "escenario", "puls", "flancos",
+           "teclas", "desc", "modos", "acciones", "otros", "latencia p50/p90/p99", "systick",
+           "demora");
+    printf("%-12s %6s %7s %7s %6s %11s %11s %5s %22s %13s %7s\n", "", "", "", "ref+esp", "",
+           "ref+esp", "ref+esp", "", "us", "p50/p99 cic", "ticks");
+
+    for (size_t indice = 0; indice < sizeof(escenarios) / sizeof(escenarios[0]); indice++) {
+        const escenario_s * escenario = &escenarios[indice];
+        char archivos[2][LINEA];
+        resultado_s resultados[2];
+        size_t flancos_tormenta = 0;
+
+        if (!Elegido(escenario->nombre, argc, argv, optind)) {
+            continue;
+        }
+        // La referencia sin rebotes primero, despues la tormenta con la misma semilla
+        for (int variante = 0; variante < 2; variante++) {
+            uint64_t fin = Generar(escenario, semilla, variante);
+
+            snprintf(archivos[variante], sizeof(archivos[variante]), "%s/%s%s.grab", directorio,
+                     escenario->nombre, variante ? "" : "_limpio");
+            if (!Escribir(archivos[variante], fin)) {
+                return EXIT_FAILURE;
+            }
+            flancos_tormenta = cantidad;
+            resultados[variante] = Reproducir(aplicacion, archivos[variante]);
+            if (!resultados[variante].valido) {
+                fprintf(stderr, "%s: la reproduccion de %s fallo\n", escenario->nombre,
+                        archivos[variante]);
+                return EXIT_FAILURE;
+            }
+        }
+
+        const resultado_s * ref = &resultados[0];
+        const resultado_s * tormenta = &resultados[1];
+        long long teclas =
+            (long long)tormenta->tipos[TRAZA_TECLA] - (long long)ref->tipos[TRAZA_TECLA];
+        long long modos =
+            (long long)tormenta->tipos[TRAZA_MODO] - (long long)ref->tipos[TRAZA_MODO];
+        long long acciones = (long long)Acciones(tormenta) - (long long)Acciones(ref);
+        long long otros = 0;
+        char columnas[3][16];
+        char latencia[32];
+        char systick[16];
+
+        for (int tipo = TRAZA_NINGUNO + 1; tipo < TRAZA_TIPOS; tipo++) {
+            if (tipo != TRAZA_TECLA && tipo != TRAZA_MODO && tipo != TRAZA_HORA &&
+                tipo != TRAZA_AJUSTE_ALARMA && tipo != TRAZA_HABILITAR_ALARMA &&
+                tipo != TRAZA_POSPONER && tipo != TRAZA_ALARMA) {
+                otros += llabs((long long)tormenta->tipos[tipo] - (long long)ref->tipos[tipo]);
+            }
+        }
+        snprintf(columnas[0], sizeof(columnas[0]), "%llu%+lld",
+                 (unsigned long long)ref->tipos[TRAZA_TECLA], teclas);
+        snprintf(columnas[1], sizeof(columnas[1]), "%llu%+lld",
+                 (unsigned long long)ref->tipos[TRAZA_MODO], modos);
+        snprintf(columnas[2], sizeof(columnas[2]), "%llu%+lld",
+                 (unsigned long long)Acciones(ref), acciones);
+        snprintf(latencia, sizeof(latencia), "%.1f/%.1f/%.1f", tormenta->latencia[0],
+                 tormenta->latencia[1], tormenta->latencia[2]);
+        snprintf(systick, sizeof(systick), "%u/%u", tormenta->systick[0], tormenta->systick[1]);
+        printf("%-12s %6u %7zu %7s %6u %11s %11s %5lld %22s %13s %7u\n", escenario->nombre,
+               pulsaciones, flancos_tormenta, columnas[0], tormenta->descartados, columnas[1],
+               columnas[2], otros, latencia, systick, tormenta->demora);
+
+        // Detalle de cada tipo de registro que cambio con los rebotes
+        for (int tipo = TRAZA_NINGUNO + 1; tipo < TRAZA_TIPOS; tipo++) {
+            if (tormenta->tipos[tipo] != ref->tipos[tipo] && tipo != TRAZA_TECLA) {
+                printf("    %-16s %llu con rebotes, %llu sin rebotes\n", nombres[tipo],
+                       (unsigned long long)tormenta->tipos[tipo],
+                       (unsigned long long)ref->tipos[tipo]);
+            }
+        }
+        problemas += (modos != 0 || acciones != 0 || tormenta->descartados != 0);
+    }
+    return (fallar && problemas) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,63 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef PRUEBA_H
+#define PRUEBA_H
+
+/** \brief Verificaciones de las pruebas de comportamiento en Linux
+ **
+ ** Cada prueba de host/herramientas incluye este archivo una sola vez, desde el archivo con su main.
+ ** VERIFICAR cuenta la verificacion y, si falla, muestra el archivo, la linea y un mensaje con el
+ ** formato de printf. PruebaFin informa el total y devuelve el codigo de salida del programa.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* === Public macros definitions =============================================================== */
+
+#define VERIFICAR(condicion, ...)                                                                  \
+    do {                                                                                           \
+        prueba_verificaciones++;                                                                   \
+        if (!(condicion)) {                                                                        \
+            prueba_fallas++;                                                                       \
+            fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);                                        \
+            fprintf(stderr, __VA_ARGS__);                                                          \
+            fputc('\n', stderr);                                                                   \
+        }                                                                                          \
+    } while (0)
+
+/* === Private variable definitions ============================================================ */
+
+static unsigned long prueba_verificaciones = 0;
+static unsigned long prueba_fallas = 0;
+
+/* === Public function implementation ========================================================== */
+
+static inline int PruebaFin(const char * nombre) {
+
+    printf("%s: %lu verificaciones, %lu fallas\n", nombre, prueba_verificaciones, prueba_fallas);
+    return prueba_fallas ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/** @} End of module definition for doxygen */
+
+#endif /* PRUEBA_H */
@@ -0,0 +1,154 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba de la aritmetica BCD empaquetada
+ **
+ ** Compara BcdIncrementar y BcdDecrementar con una referencia que pasa cada campo a entero, en
+ ** cada hora valida del dia, con cada combinacion de campos usada por la interfaz y dos juegos de
+ ** limites. Tambien recorre el dia con BcdSegundo y separa y vuelve a empaquetar cada hora.
+ **
+ **     prueba_bcd
+ **     prueba_bcd_swar
+ **
+ ** La segunda es la misma prueba enlazada con bcd.c compilado con BCD_SWAR, de modo que las dos
+ ** formas de la suma y la resta por campo se comparan con la misma referencia. Termina con error si
+ ** alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "bcd.h"
+#include "prueba.h"
+#include <stdint.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define SEGUNDOS_DIA (24 * 60 * 60)
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static bcd_t Empaquetar(unsigned segundos);
+static bcd_t Referencia(bcd_t valor, bcd_t campos, bcd_t limites, int paso);
+static void VerificarCampos(bcd_t limites);
+static void VerificarDia(void);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+// Los campos que cambian los comandos de ajuste, y todos juntos
+static const bcd_t CAMPOS[] = {
+    BCD_SEGUNDOS, BCD_MINUTOS, BCD_HORAS, BCD_MINUTOS | BCD_HORAS,
+    BCD_SEGUNDOS | BCD_MINUTOS | BCD_HORAS,
+};
+
+/* === Private function implementation ========================================================= */
+
+static bcd_t Empaquetar(unsigned segundos) {
+
+    unsigned campos[] = {segundos % 60, segundos / 60 % 60, segundos / 3600};
+    bcd_t valor = 0;
+
+    for (unsigned indice = 0; indice < 3; indice++) {
+        valor |= (bcd_t)(campos[indice] / 10 * 16 + campos[indice] % 10) << (8 * indice);
+    }
+    return valor;
+}
+
+// Cada campo elegido pasa a entero, se le suma o resta 1 con su limite y vuelve a BCD
+static bcd_t Referencia(bcd_t valor, bcd_t campos, bcd_t limites, int paso) {
+
+    for (unsigned desplazamiento = 0; desplazamiento < 24; desplazamiento += 8) {
+        if ((campos >> desplazamiento) & 1) {
+            unsigned campo = (valor >> desplazamiento) & 0xFF;
+            unsigned limite = (limites >> desplazamiento) & 0xFF;
+            unsigned numero = campo / 16 * 10 + campo % 16;
+            unsigned maximo = limite / 16 * 10 + limite % 16;
+
+            if (paso > 0) {
+                numero = numero >= maximo ? 0 : numero + 1;
+            } else {
+                numero = numero == 0 ? maximo : numero - 1;
+            }
+            valor &= ~((bcd_t)0xFF << desplazamiento);
+            valor |= (bcd_t)(numero / 10 * 16 + numero % 10) << desplazamiento;
+        }
+    }
+    return valor;
+}
+
+// Cada valor que no supera los limites, con cada combinacion de campos
+static void VerificarCampos(bcd_t limites) {
+
+    for (unsigned segundos = 0; segundos < SEGUNDOS_DIA; segundos++) {
+        bcd_t valor = Empaquetar(segundos);
+
+        if ((valor >> 16) > (limites >> 16)) {
+            break;
+        }
+        for (unsigned indice = 0; indice < sizeof(CAMPOS) / sizeof(CAMPOS[0]); indice++) {
+            bcd_t campos = CAMPOS[indice];
+            bcd_t esperado = Referencia(valor, campos, limites, 1);
+            bcd_t obtenido = BcdIncrementar(valor, campos, limites);
+
+            VERIFICAR(obtenido == esperado,
+                      "incrementar %06X campos %06X limites %06X: %06X, no %06X", (unsigned)valor,
+                      (unsigned)campos, (unsigned)limites, (unsigned)obtenido, (unsigned)esperado);
+            esperado = Referencia(valor, campos, limites, -1);
+            obtenido = BcdDecrementar(valor, campos, limites);
+            VERIFICAR(obtenido == esperado,
+                      "decrementar %06X campos %06X limites %06X: %06X, no %06X", (unsigned)valor,
+                      (unsigned)campos, (unsigned)limites, (unsigned)obtenido, (unsigned)esperado);
+        }
+    }
+}
+
+// Cada segundo del dia sigue al anterior, y separar y volver a empaquetar no cambia la hora
+static void VerificarDia(void) {
+
+    for (unsigned segundos = 0; segundos < SEGUNDOS_DIA; segundos++) {
+        bcd_t hora = Empaquetar(segundos);
+        bcd_t siguiente = Empaquetar((segundos + 1) % SEGUNDOS_DIA);
+        uint8_t digitos[6];
+
+        VERIFICAR(BcdSegundo(hora) == siguiente, "segundo %06X: %06X, no %06X", (unsigned)hora,
+                  (unsigned)BcdSegundo(hora), (unsigned)siguiente);
+        BcdDesempaquetar(hora, digitos, sizeof(digitos));
+        VERIFICAR(BcdEmpaquetar(digitos, sizeof(digitos)) == hora, "desempaquetar %06X",
+                  (unsigned)hora);
+    }
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(void) {
+
+    VerificarCampos(BCD_LIMITES);
+    VerificarCampos(0x115959); // reloj de 12 horas
+    VerificarDia();
+    return PruebaFin(BCD_SWAR ? "prueba_bcd_swar" : "prueba_bcd");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
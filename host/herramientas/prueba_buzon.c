@@ -0,0 +1,336 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba del buzon entre nucleos
+ **
+ ** Un hilo hace de M4 y otro de M0, como en el firmware de doble nucleo pero con el buzon en una
+ ** variable comun. Se verifica que:
+ **
+ ** - ningun cuadro leido mezcle dos publicaciones, aunque el M4 publique sin pausa. Las lecturas
+ **   solo se superponen con las escrituras si la maquina tiene mas de un procesador;
+ ** - los eventos lleguen todos y en orden mientras el M0 no supere la capacidad de la cola;
+ ** - con la cola llena los eventos descartados se cuenten en BuzonEventosPerdidos, y los que llegan
+ **   conserven el orden.
+ **
+ **     prueba_buzon [-n cuadros]
+ **
+ ** Termina con error si alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "buzon.h"
+#include "prueba.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define CUADROS 200000 // cuadros que publica el M4
+#define EVENTOS 200000 // eventos que envia el M0 en cada prueba concurrente
+#define DESBORDE 100   // eventos que se envian sin retirar ninguno
+#define CEDER    64    // operaciones entre cesiones del procesador, por si hay un solo nucleo
+
+/* === Private data type declarations ========================================================== */
+
+//! Resultado de la lectura de cuadros del M0
+typedef struct lecturas_s {
+    unsigned long cuadros;   // cuadros nuevos leidos
+    unsigned long mezclados; // cuadros con bytes de dos publicaciones
+    unsigned long atras;     // cuadros anteriores al ultimo leido
+    uint32_t ultimo;         // numero del ultimo cuadro leido
+} lecturas_s;
+
+//! Resultado del envio de eventos del M0
+typedef struct envios_s {
+    unsigned long aceptados;
+    unsigned long rechazados;
+} envios_s;
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static void Llenar(display_frame_s * cuadro, uint32_t numero);
+static uint32_t Numero(const display_frame_s * cuadro);
+static void * PublicarCuadros(void * argumento);
+static void * EnviarConEspera(void * argumento);
+static void * EnviarSinEspera(void * argumento);
+static void PruebaCuadros(void);
+static void PruebaEventos(void);
+static void PruebaDesborde(void);
+static void PruebaDesbordeConcurrente(void);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static unsigned long cuadros = CUADROS;
+static bool terminado;
+static unsigned long recibidos; // eventos retirados por el M4, para que el M0 no llene la cola
+
+/* === Private function implementation ========================================================= */
+
+// Todos los campos del cuadro se derivan del numero, asi una copia mezclada no es coherente
+static void Llenar(display_frame_s * cuadro, uint32_t numero) {
+
+    for (unsigned indice = 0; indice < sizeof(cuadro->memory); indice++) {
+        cuadro->memory[indice] = (uint8_t)(numero + indice);
+    }
+    cuadro->flashing_from = (uint8_t)(numero >> 8);
+    cuadro->flashing_to = (uint8_t)(numero >> 16);
+    cuadro->flashing_factor = (uint16_t)numero;
+    cuadro->brightness = (uint8_t)(numero >> 24);
+}
+
+static uint32_t Numero(const display_frame_s * cuadro) {
+
+    return cuadro->flashing_factor | (uint32_t)cuadro->flashing_from << 8 |
+           (uint32_t)cuadro->flashing_to << 16 | (uint32_t)cuadro->brightness << 24;
+}
+
+static void * PublicarCuadros(void * argumento) {
+
+    display_frame_s cuadro;
+
+    (void)argumento;
+    for (uint32_t numero = 1; numero <= cuadros; numero++) {
+        Llenar(&cuadro, numero);
+        BuzonPublicarCuadro(&cuadro);
+        if (numero % CEDER == 0) {
+            sched_yield();
+        }
+    }
+    __atomic_store_n(&terminado, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void * EnviarConEspera(void * argumento) {
+
+    envios_s * envios = argumento;
+    buzon_evento_s evento;
+
+    for (uint32_t numero = 0; numero < EVENTOS; numero++) {
+        // La cola de N lugares guarda N - 1 eventos; 8 en vuelo quedan debajo de cualquier tamano
+        while (numero - __atomic_load_n(&recibidos, __ATOMIC_ACQUIRE) >= 8) {
+            sched_yield();
+        }
+        evento = (buzon_evento_s){.marca = numero, .tecla = (uint8_t)numero, .flanco = numero & 1};
+        if (BuzonEnviarEvento(&evento)) {
+            envios->aceptados++;
+        } else {
+            envios->rechazados++;
+        }
+    }
+    return NULL;
+}
+
+static void * EnviarSinEspera(void * argumento) {
+
+    envios_s * envios = argumento;
+    buzon_evento_s evento;
+
+    for (uint32_t numero = 0; numero < EVENTOS; numero++) {
+        evento = (buzon_evento_s){.marca = numero, .tecla = (uint8_t)numero, .flanco = numero & 1};
+        if (BuzonEnviarEvento(&evento)) {
+            envios->aceptados++;
+        } else {
+            envios->rechazados++;
+        }
+        if (numero % CEDER == 0) {
+            sched_yield();
+        }
+    }
+    __atomic_store_n(&terminado, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// El hilo principal hace de M0 y lee cuadros mientras el otro hilo los publica
+static void PruebaCuadros(void) {
+
+    lecturas_s lecturas = {0};
+    display_frame_s cuadro, esperado;
+    uint32_t generacion = 0;
+    pthread_t m4;
+    bool fin;
+
+    BuzonInit();
+    terminado = false;
+    pthread_create(&m4, NULL, PublicarCuadros, NULL);
+    do {
+        fin = __atomic_load_n(&terminado, __ATOMIC_ACQUIRE);
+        if (BuzonLeerCuadro(&cuadro, &generacion)) {
+            uint32_t numero = Numero(&cuadro);
+            Llenar(&esperado, numero);
+            lecturas.cuadros++;
+            if (memcmp(&cuadro, &esperado, sizeof(cuadro)) != 0) {
+                lecturas.mezclados++;
+            } else if (numero <= lecturas.ultimo) {
+                lecturas.atras++;
+            } else {
+                lecturas.ultimo = numero;
+            }
+        } else {
+            sched_yield();
+        }
+    } while (!fin);
+    pthread_join(m4, NULL);
+
+    printf("cuadros: %lu publicados, %lu leidos, %u reintentos\n", cuadros, lecturas.cuadros,
+           BuzonReintentos());
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2) {
+        printf("cuadros: con un solo procesador casi ninguna lectura coincide con una "
+               "escritura\n");
+    }
+    VERIFICAR(lecturas.cuadros > 0, "no se leyo ningun cuadro");
+    VERIFICAR(lecturas.mezclados == 0, "%lu cuadros mezclados", lecturas.mezclados);
+    VERIFICAR(lecturas.atras == 0, "%lu cuadros fuera de orden", lecturas.atras);
+    VERIFICAR(lecturas.ultimo == cuadros, "el ultimo cuadro leido es %u", lecturas.ultimo);
+    VERIFICAR(!BuzonLeerCuadro(&cuadro, &generacion), "cuadro nuevo sin publicacion");
+}
+
+// El hilo principal hace de M4 y retira los eventos que envia el otro hilo sin llenar la cola
+static void PruebaEventos(void) {
+
+    envios_s envios = {0};
+    buzon_evento_s evento;
+    unsigned long desordenados = 0;
+    pthread_t m0;
+
+    BuzonInit();
+    recibidos = 0;
+    pthread_create(&m0, NULL, EnviarConEspera, &envios);
+    while (recibidos < EVENTOS) {
+        if (BuzonRecibirEvento(&evento)) {
+            if (evento.marca != recibidos || evento.tecla != (uint8_t)recibidos ||
+                evento.flanco != (recibidos & 1)) {
+                desordenados++;
+            }
+            __atomic_store_n(&recibidos, recibidos + 1, __ATOMIC_RELEASE);
+        } else {
+            sched_yield();
+        }
+    }
+    pthread_join(m0, NULL);
+
+    VERIFICAR(envios.aceptados == EVENTOS, "%lu eventos aceptados", envios.aceptados);
+    VERIFICAR(envios.rechazados == 0, "%lu eventos rechazados", envios.rechazados);
+    VERIFICAR(desordenados == 0, "%lu eventos fuera de orden o alterados", desordenados);
+    VERIFICAR(BuzonEventosPerdidos() == 0, "%u eventos perdidos", BuzonEventosPerdidos());
+    VERIFICAR(!BuzonRecibirEvento(&evento), "evento de mas en la cola");
+}
+
+// Sin retirar eventos la cola acepta su capacidad y descarta el resto contandolos como perdidos
+static void PruebaDesborde(void) {
+
+    buzon_evento_s evento;
+    unsigned capacidad = 0;
+
+    BuzonInit();
+    for (uint32_t numero = 0; numero < DESBORDE; numero++) {
+        evento = (buzon_evento_s){.marca = numero};
+        if (BuzonEnviarEvento(&evento)) {
+            VERIFICAR(numero == capacidad, "se acepto el evento %u despues de uno rechazado",
+                      numero);
+            capacidad++;
+        }
+    }
+    VERIFICAR(capacidad > 0 && capacidad < DESBORDE, "capacidad %u", capacidad);
+    VERIFICAR(BuzonEventosPerdidos() == DESBORDE - capacidad, "%u perdidos con capacidad %u",
+              BuzonEventosPerdidos(), capacidad);
+    for (uint32_t numero = 0; numero < capacidad; numero++) {
+        VERIFICAR(BuzonRecibirEvento(&evento) && evento.marca == numero,
+                  "se esperaba el evento %u", numero);
+    }
+    VERIFICAR(!BuzonRecibirEvento(&evento), "evento de mas en la cola");
+
+    // Al liberar lugar la cola vuelve a aceptar eventos sin tocar el contador
+    evento.marca = DESBORDE;
+    VERIFICAR(BuzonEnviarEvento(&evento), "la cola vacia rechazo un evento");
+    VERIFICAR(BuzonRecibirEvento(&evento) && evento.marca == DESBORDE, "evento alterado");
+    VERIFICAR(BuzonEventosPerdidos() == DESBORDE - capacidad, "el contador de perdidos cambio");
+}
+
+// El M0 envia sin esperar: los eventos que llegan estan en orden y los demas se cuentan perdidos
+static void PruebaDesbordeConcurrente(void) {
+
+    envios_s envios = {0};
+    buzon_evento_s evento;
+    unsigned long llegados = 0, desordenados = 0;
+    uint32_t siguiente = 0;
+    pthread_t m0;
+    bool fin;
+
+    BuzonInit();
+    terminado = false;
+    pthread_create(&m0, NULL, EnviarSinEspera, &envios);
+    do {
+        fin = __atomic_load_n(&terminado, __ATOMIC_ACQUIRE);
+        while (BuzonRecibirEvento(&evento)) {
+            if (evento.marca < siguiente || evento.tecla != (uint8_t)evento.marca) {
+                desordenados++;
+            }
+            siguiente = evento.marca + 1;
+            llegados++;
+        }
+        sched_yield();
+    } while (!fin);
+    pthread_join(m0, NULL);
+
+    printf("desborde: %lu eventos enviados, %lu recibidos, %u perdidos\n", (unsigned long)EVENTOS,
+           llegados, BuzonEventosPerdidos());
+    VERIFICAR(desordenados == 0, "%lu eventos fuera de orden o alterados", desordenados);
+    VERIFICAR(llegados == envios.aceptados, "%lu recibidos de %lu aceptados", llegados,
+              envios.aceptados);
+    VERIFICAR(BuzonEventosPerdidos() == envios.rechazados, "%u perdidos de %lu rechazados",
+              BuzonEventosPerdidos(), envios.rechazados);
+    VERIFICAR(llegados + BuzonEventosPerdidos() == EVENTOS, "faltan eventos sin contar");
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(int argc, char * argv[]) {
+
+    int opcion;
+
+    while ((opcion = getopt(argc, argv, "n:")) != -1) {
+        switch (opcion) {
+        case 'n':
+            cuadros = strtoul(optarg, NULL, 10);
+            break;
+        default:
+            fprintf(stderr, "uso: %s [-n cuadros]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    PruebaCuadros();
+    PruebaEventos();
+    PruebaDesborde();
+    PruebaDesbordeConcurrente();
+    return PruebaFin("prueba_buzon");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
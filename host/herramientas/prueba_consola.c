@@ -0,0 +1,300 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba de la consola de comandos
+ **
+ ** Atiende lineas escritas en un anillo propio, que un controlador falso avanza como lo haria el
+ ** DMA, y compara lo que la consola entrega para transmitir. Verifica una linea que cruza el final
+ ** del anillo, las lineas y las cantidades de palabras en el limite, las lineas de estado que no
+ ** entran en la cola de transmision llena y los desbordes del anillo de recepcion, incluida una
+ ** vuelta que ocurre entre las dos consultas al controlador.
+ **
+ **     prueba_consola
+ **
+ ** Termina con error si alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "consola.h"
+#include "prueba.h"
+#include <stdio.h>
+#include <string.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define ANILLO 128                       // bytes del anillo de recepcion falso
+#define SALIDA (2 * CONSOLA_TRANSMISION) // bytes transmitidos que se guardan entre dos revisiones
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static void Recibir(const char * texto);
+static void Repetir(char caracter, unsigned cantidad);
+static uint16_t Recibidos(void);
+static bool Vuelta(void);
+static bool Transmitir(const char * datos, uint16_t cantidad);
+static bool Transmitiendo(void);
+static const char * ComandoEco(consola_t consola, uint8_t argc, char * argv[]);
+static const char * ComandoFalla(consola_t consola, uint8_t argc, char * argv[]);
+static const char * ComandoLlenar(consola_t consola, uint8_t argc, char * argv[]);
+static void Procesar(void);
+static void Esperar(const char * caso, const char * esperado);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static char anillo[ANILLO];
+static uint16_t escritura = 0;       // posicion en la que el DMA falso escribe el proximo caracter
+static bool vuelta = false;          // marca de fin de bloque del canal falso
+static const char * demorado = NULL; // llega entre la consulta de la marca y la de la posicion
+static char salida[SALIDA + 1];
+static unsigned transmitidos = 0;
+static bool ocupado = false; // el DMA falso no termina el bloque en curso
+static consola_t consola;
+
+static const consola_comando_s comandos[] = {
+    {"eco", "palabras: las repite separadas por '|'", ComandoEco},
+    {"falla", "termina con error", ComandoFalla},
+    {"llenar", "ocupa toda la cola de transmision", ComandoLlenar},
+};
+
+/* === Private function implementation ========================================================= */
+
+static void Recibir(const char * texto) {
+
+    for (; *texto; texto++) {
+        anillo[escritura] = *texto;
+        escritura = (escritura + 1) % ANILLO;
+        if (escritura == 0) {
+            vuelta = true;
+        }
+    }
+}
+
+static void Repetir(char caracter, unsigned cantidad) {
+
+    char texto[2] = {caracter, '\0'};
+    while (cantidad--) {
+        Recibir(texto);
+    }
+}
+
+static uint16_t Recibidos(void) {
+    return escritura;
+}
+
+static bool Vuelta(void) {
+
+    bool resultado = vuelta;
+    vuelta = false;
+    if (demorado) {
+        Recibir(demorado);
+        demorado = NULL;
+    }
+    return resultado;
+}
+
+static bool Transmitir(const char * datos, uint16_t cantidad) {
+
+    if (transmitidos + cantidad <= SALIDA) {
+        memcpy(&salida[transmitidos], datos, cantidad);
+    }
+    transmitidos += cantidad;
+    return true;
+}
+
+static bool Transmitiendo(void) {
+    return ocupado;
+}
+
+static const char * ComandoEco(consola_t consola, uint8_t argc, char * argv[]) {
+
+    char texto[CONSOLA_LINEA_MAXIMA + 1] = "";
+    size_t largo = 0;
+
+    for (uint8_t indice = 1; indice < argc; indice++) {
+        largo += (size_t)snprintf(&texto[largo], sizeof(texto) - largo, "%s%s",
+                                  indice > 1 ? "|" : "", argv[indice]);
+    }
+    ConsolaImprimir(consola, "%s", texto);
+    return NULL;
+}
+
+static const char * ComandoFalla(consola_t consola, uint8_t argc, char * argv[]) {
+
+    (void)consola;
+    (void)argc;
+    (void)argv;
+    return "motivo";
+}
+
+// Con la cola vacia, lineas completas y una ultima que deja la cola justo llena
+static const char * ComandoLlenar(consola_t consola, uint8_t argc, char * argv[]) {
+
+    (void)argc;
+    (void)argv;
+    for (unsigned libres = CONSOLA_TRANSMISION; libres;) {
+        unsigned largo = libres >= CONSOLA_LINEA_MAXIMA + 2 ? CONSOLA_LINEA_MAXIMA : libres - 2;
+        ConsolaImprimir(consola, "%.*s", (int)largo,
+                        "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"
+                        "xxxxxxxx");
+        libres -= largo + 2;
+    }
+    return NULL;
+}
+
+// Con el DMA libre, cada llamada termina un bloque y entrega el siguiente
+static void Procesar(void) {
+
+    for (unsigned llamada = 0; llamada < 4; llamada++) {
+        ConsolaProcesar(consola);
+    }
+}
+
+static void Esperar(const char * caso, const char * esperado) {
+
+    Procesar();
+    salida[transmitidos < SALIDA ? transmitidos : SALIDA] = '\0';
+    VERIFICAR(strcmp(salida, esperado) == 0, "%s: se transmitio \"%s\" y se esperaba \"%s\"", caso,
+              salida, esperado);
+    transmitidos = 0;
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(void) {
+
+    static const struct consola_driver_s controlador = {
+        .Recibidos = Recibidos,
+        .Vuelta = Vuelta,
+        .Transmitir = Transmitir,
+        .Transmitiendo = Transmitiendo,
+    };
+
+    // Una marca vieja del canal no cuenta como vuelta de la consola recien creada
+    escritura = ANILLO - 5;
+    vuelta = true;
+    consola = ConsolaCreate(anillo, ANILLO, &controlador);
+    ConsolaComandos(consola, comandos, sizeof(comandos) / sizeof(comandos[0]));
+    const consola_informe_s * informe = ConsolaInforme(consola);
+
+    // Cruza el final del anillo: se atiende desde la copia contigua
+    Recibir("eco abc def\r\n");
+    Esperar("linea partida", "abc|def\r\nok\r\n");
+    VERIFICAR(informe->lineas == 1 && informe->errores == 0 && informe->desbordes == 0,
+              "linea partida: %u lineas, %u errores, %u desbordes", informe->lineas,
+              informe->errores, informe->desbordes);
+
+    Recibir("falla\n");
+    Esperar("error del comando", "error: motivo\r\n");
+    Recibir("nada\n");
+    Esperar("comando desconocido", "error: comando desconocido\r\n");
+    VERIFICAR(informe->lineas == 3 && informe->errores == 2, "errores: %u lineas, %u errores",
+              informe->lineas, informe->errores);
+
+    // Una linea de CONSOLA_LINEA_MAXIMA caracteres se atiende y una mas larga se descarta entera
+    Recibir("eco ");
+    Repetir('a', CONSOLA_LINEA_MAXIMA - 4);
+    Recibir("\n");
+    Esperar("linea maxima", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+                            "aaaaaa\r\nok\r\n");
+    Recibir("eco ");
+    Repetir('a', CONSOLA_LINEA_MAXIMA - 3);
+    Recibir("\n");
+    Esperar("linea larga", "error: linea demasiado larga\r\n");
+    VERIFICAR(informe->lineas == 5 && informe->errores == 3, "linea larga: %u lineas, %u errores",
+              informe->lineas, informe->errores);
+
+    Recibir("eco 1 2  3\t4 5 \n");
+    Esperar("argumentos maximos", "1|2|3|4|5\r\nok\r\n");
+    Recibir("eco 1 2 3 4 5 6\n");
+    Esperar("demasiados argumentos", "error: demasiados argumentos\r\n");
+    VERIFICAR(informe->lineas == 7 && informe->errores == 4,
+              "demasiados argumentos: %u lineas, %u errores", informe->lineas, informe->errores);
+
+    // Con la cola llena las lineas de estado se descartan enteras, y el error se cuenta igual
+    ocupado = true;
+    Recibir("llenar\n");
+    ConsolaProcesar(consola);
+    VERIFICAR(informe->descartados == 4, "cola llena: %u bytes descartados, se esperaban los de ok",
+              informe->descartados);
+    Recibir("falla\n");
+    ConsolaProcesar(consola);
+    VERIFICAR(informe->descartados == 4 + 15 && informe->errores == 5,
+              "cola llena: %u bytes descartados, %u errores", informe->descartados,
+              informe->errores);
+    ocupado = false;
+    Procesar();
+    VERIFICAR(transmitidos == CONSOLA_TRANSMISION, "cola llena: se transmitieron %u bytes",
+              transmitidos);
+    VERIFICAR(strstr(salida, "ok") == NULL && strstr(salida, "error") == NULL,
+              "cola llena: se transmitio una linea de estado que no entraba");
+    transmitidos = 0;
+    Recibir("eco sigue\n");
+    Esperar("cola vaciada", "sigue\r\nok\r\n");
+
+    // Casi una vuelta entre dos llamadas no pierde nada
+    Repetir('\n', ANILLO - 1 - 10);
+    Recibir("eco justo\n");
+    Esperar("casi una vuelta", "justo\r\nok\r\n");
+    VERIFICAR(informe->desbordes == 0, "casi una vuelta: %u desbordes", informe->desbordes);
+
+    // Una vuelta exacta pisa la linea en curso y deja al DMA donde estaba: se descarta hasta el fin
+    // de la linea y cuenta como error
+    Recibir("eco parcial");
+    ConsolaProcesar(consola);
+    Repetir('z', ANILLO);
+    ConsolaProcesar(consola);
+    Recibir(" resto\n");
+    Esperar("vuelta completa", "error: desborde de recepcion\r\n");
+    Recibir("eco bien\n");
+    Esperar("despues del desborde", "bien\r\nok\r\n");
+    VERIFICAR(informe->desbordes == 1 && informe->errores == 6,
+              "vuelta completa: %u desbordes, %u errores", informe->desbordes, informe->errores);
+
+    // Mas de una vuelta, terminando delante de lo leido: la linea empieza al principio del anillo
+    Repetir('\n', (ANILLO - escritura) % ANILLO);
+    Procesar();
+    Recibir("eco ");
+    ConsolaProcesar(consola);
+    Repetir('z', ANILLO + 10);
+    Recibir("\neco otra\n");
+    Esperar("mas de una vuelta", "error: desborde de recepcion\r\notra\r\nok\r\n");
+    VERIFICAR(informe->desbordes == 2, "mas de una vuelta: %u desbordes", informe->desbordes);
+
+    // El final se cruza entre la consulta de la marca y la de la posicion
+    Repetir('\n', (unsigned)(ANILLO - 2 - escritura + ANILLO) % ANILLO);
+    Procesar();
+    demorado = "eco x\n";
+    Esperar("vuelta entre consultas", "x\r\nok\r\n");
+    Recibir("eco y\n");
+    Esperar("despues de la vuelta entre consultas", "y\r\nok\r\n");
+    VERIFICAR(informe->desbordes == 2, "vuelta entre consultas: %u desbordes", informe->desbordes);
+
+    return PruebaFin("prueba_consola");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,220 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba del generador de tormentas de teclas
+ **
+ ** Genera cada escenario de host/herramientas/estres.c, que se incluye con su main renombrado, sin
+ ** rebotes y con rebotes, y compara los flancos sin reproducirlos. Verifica:
+ **
+ ** - que los flancos queden ordenados por tick, desde INICIO y antes del final de la grabacion;
+ ** - que los flancos de cada tecla alternen de nivel en ticks crecientes y la dejen suelta;
+ ** - que los rebotes no cambien las pulsaciones: cada flanco limpio esta en la tormenta en su tick,
+ **   y los agregados son pares dentro del ancho, a lo sumo los rebotes pedidos;
+ ** - que la misma semilla genere la misma tormenta.
+ **
+ **     prueba_estres
+ **
+ ** Termina con error si alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+// El main del generador queda con otro nombre y no se llama: se usan sus escenarios
+#define main EstresMain
+#include "estres.c"
+#undef main
+
+#include "prueba.h"
+#include <inttypes.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define SEMILLAS 3 // semillas con las que se genera cada escenario, desde 1
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static size_t Filtrar(const flanco_s * desde, size_t largo, uint8_t pin, flanco_s * hacia);
+static unsigned Alternados(const flanco_s * tecla, size_t largo);
+static void VerificarTecla(const char * caso, int tecla, const flanco_s * limpios, size_t largo);
+static void VerificarEscenario(const escenario_s * escenario, uint64_t semilla);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+// Copia en hacia los flancos de un pin, en el mismo orden
+static size_t Filtrar(const flanco_s * desde, size_t largo, uint8_t pin, flanco_s * hacia) {
+
+    size_t copiados = 0;
+
+    for (size_t indice = 0; indice < largo; indice++) {
+        if (desde[indice].pin == pin) {
+            hacia[copiados++] = desde[indice];
+        }
+    }
+    return copiados;
+}
+
+// Cuenta los flancos que no cambian el nivel de la tecla o no avanzan el tick; la tecla empieza y
+// termina suelta
+static unsigned Alternados(const flanco_s * tecla, size_t largo) {
+
+    unsigned malos = 0;
+    bool nivel = false;
+    uint64_t tick = 0;
+
+    for (size_t indice = 0; indice < largo; indice++) {
+        if (tecla[indice].nivel == nivel || (indice && tecla[indice].tick <= tick)) {
+            malos++;
+        }
+        nivel = tecla[indice].nivel;
+        tick = tecla[indice].tick;
+    }
+    return malos + nivel;
+}
+
+// Cada flanco limpio esta en la tormenta y lo siguen los rebotes agregados por Flanco, en pares
+// antes del flanco limpio siguiente y dentro del ancho
+static void VerificarTecla(const char * caso, int tecla, const flanco_s * limpios, size_t largo) {
+
+    flanco_s * limpia = malloc((largo + 1) * sizeof(flanco_s));
+    flanco_s * tormenta = malloc((cantidad + 1) * sizeof(flanco_s));
+    size_t limpia_largo, tormenta_largo, siguiente = 0;
+    unsigned faltan = 0, fuera = 0;
+
+    if (!limpia || !tormenta) {
+        perror("prueba_estres");
+        exit(EXIT_FAILURE);
+    }
+    limpia_largo = Filtrar(limpios, largo, pines[tecla], limpia);
+    tormenta_largo = Filtrar(flancos, cantidad, pines[tecla], tormenta);
+    VERIFICAR(Alternados(limpia, limpia_largo) == 0, "%s: tecla %d sin rebotes no alterna", caso,
+              tecla);
+    VERIFICAR(Alternados(tormenta, tormenta_largo) == 0, "%s: tecla %d con rebotes no alterna",
+              caso, tecla);
+
+    for (size_t indice = 0; indice < limpia_largo; indice++) {
+        const flanco_s * flanco = &limpia[indice];
+        uint64_t hasta = flanco->tick + opcion_ancho;
+        unsigned agregados = 0;
+
+        if (indice + 1 < limpia_largo && limpia[indice + 1].tick <= hasta) {
+            hasta = limpia[indice + 1].tick - 1;
+        }
+        if (siguiente >= tormenta_largo || tormenta[siguiente].tick != flanco->tick ||
+            tormenta[siguiente].nivel != flanco->nivel) {
+            faltan++;
+            continue;
+        }
+        for (siguiente++; siguiente < tormenta_largo && tormenta[siguiente].tick <= hasta;
+             siguiente++) {
+            agregados++;
+        }
+        if (agregados % 2 || agregados > 2 * opcion_rebotes) {
+            fuera++;
+        }
+    }
+    VERIFICAR(faltan == 0, "%s: tecla %d, %u flancos limpios que no estan en la tormenta", caso,
+              tecla, faltan);
+    VERIFICAR(fuera == 0 && siguiente == tormenta_largo,
+              "%s: tecla %d, %u rebotes impares o de mas, %zu flancos fuera del ancho", caso, tecla,
+              fuera, tormenta_largo - siguiente);
+    free(limpia);
+    free(tormenta);
+}
+
+static void VerificarEscenario(const escenario_s * escenario, uint64_t semilla) {
+
+    char caso[LINEA];
+    flanco_s * limpios;
+    size_t largo;
+    unsigned limpias, desordenados = 0;
+    uint64_t fin;
+
+    snprintf(caso, sizeof(caso), "%s con la semilla %" PRIu64, escenario->nombre, semilla);
+    Generar(escenario, semilla, false);
+    largo = cantidad;
+    limpias = pulsaciones;
+    limpios = malloc((largo + 1) * sizeof(flanco_s));
+    if (!limpios) {
+        perror("prueba_estres");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(limpios, flancos, largo * sizeof(flanco_s));
+    VERIFICAR(largo == 2 * limpias, "%s: %zu flancos limpios para %u pulsaciones", caso, largo,
+              limpias);
+
+    fin = Generar(escenario, semilla, true);
+    VERIFICAR(pulsaciones == limpias, "%s: %u pulsaciones con rebotes y %u sin rebotes", caso,
+              pulsaciones, limpias);
+    VERIFICAR(cantidad > largo, "%s: la tormenta no tiene rebotes", caso);
+    for (size_t indice = 1; indice < cantidad; indice++) {
+        desordenados += flancos[indice].tick < flancos[indice - 1].tick;
+    }
+    VERIFICAR(desordenados == 0, "%s: %u flancos fuera de orden", caso, desordenados);
+    VERIFICAR(cantidad && flancos[0].tick >= INICIO && flancos[cantidad - 1].tick < fin,
+              "%s: flancos fuera de la grabacion, que termina en el tick %" PRIu64, caso, fin);
+    for (int tecla = 0; tecla < BOARD_KEYS; tecla++) {
+        VerificarTecla(caso, tecla, limpios, largo);
+    }
+
+    // La misma semilla genera la misma tormenta
+    flanco_s * primera = malloc((cantidad + 1) * sizeof(flanco_s));
+    size_t primera_largo = cantidad;
+    if (!primera) {
+        perror("prueba_estres");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(primera, flancos, cantidad * sizeof(flanco_s));
+    VERIFICAR(Generar(escenario, semilla, true) == fin && cantidad == primera_largo,
+              "%s: la misma semilla genera otra cantidad de flancos", caso);
+    desordenados = 0;
+    for (size_t indice = 0; indice < cantidad && indice < primera_largo; indice++) {
+        desordenados += flancos[indice].tick != primera[indice].tick ||
+                        flancos[indice].pin != primera[indice].pin ||
+                        flancos[indice].nivel != primera[indice].nivel;
+    }
+    VERIFICAR(desordenados == 0, "%s: la misma semilla genera %u flancos distintos", caso,
+              desordenados);
+    free(primera);
+    free(limpios);
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(void) {
+
+    for (size_t indice = 0; indice < sizeof(escenarios) / sizeof(escenarios[0]); indice++) {
+        for (uint64_t semilla = 1; semilla <= SEMILLAS; semilla++) {
+            VerificarEscenario(&escenarios[indice], semilla);
+        }
+    }
+    free(flancos);
+    return PruebaFin("prueba_estres");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
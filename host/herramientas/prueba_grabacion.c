@@ -0,0 +1,287 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba del formato de las grabaciones de entradas
+ **
+ ** Escribe grabaciones con GrabacionRegistro y las lee con la reproduccion de host/grabacion.c, que
+ ** se incluye entera para llegar a sus funciones y variables privadas. Verifica:
+ **
+ ** - los bytes de los numeros de longitud variable en el limite de 7 bits;
+ ** - que cada registro se lea con su tick absoluto, su nivel y su pin, con pasos de 0 a 2^62 - 1
+ **   ticks entre registros;
+ ** - que se rechacen los archivos con otra firma u otra version, sin registros o cortados;
+ ** - que la grabacion escriba cada pin que cambia, en orden de puerto y de pin, y nada mas.
+ **
+ **     prueba_grabacion
+ **
+ ** Termina con error si alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "../grabacion.c"
+
+#include "prueba.h"
+#include <fcntl.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define CANTIDAD(vector) (sizeof(vector) / sizeof((vector)[0]))
+
+/* === Private data type declarations ========================================================== */
+
+typedef struct registro_s {
+    uint64_t tick; // absoluto, como queda en proximo
+    bool nivel;
+    uint8_t pin;
+} registro_s;
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static FILE * Crear(char * archivo);
+static bool Abrir(const char * archivo);
+static void VerificarRegistros(const char * caso, const registro_s * esperados, size_t cantidad);
+static bool Rechazada(const uint8_t * bytes, size_t largo);
+static void VerificarBytes(void);
+static void VerificarIda(void);
+static void VerificarRechazos(void);
+static void VerificarGrabador(void);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+// Crea un archivo temporal con la cabecera ya escrita y deja su nombre en archivo
+static FILE * Crear(char * archivo) {
+
+    int descriptor = mkstemp(archivo);
+    FILE * salida = descriptor >= 0 ? fdopen(descriptor, "wb") : NULL;
+
+    if (salida) {
+        GrabacionCabecera(salida);
+    }
+    return salida;
+}
+
+// Abre la grabacion como lo hace la reproduccion, sin sus mensajes de error, y la borra
+static bool Abrir(const char * archivo) {
+
+    int errores = dup(STDERR_FILENO);
+    int nulo = open("/dev/null", O_WRONLY);
+    bool abierta;
+
+    free(datos);
+    datos = NULL;
+    ultimo = 0;
+    fflush(stderr);
+    dup2(nulo, STDERR_FILENO);
+    abierta = ReproduccionAbrir(archivo);
+    fflush(stderr);
+    dup2(errores, STDERR_FILENO);
+    close(errores);
+    close(nulo);
+    unlink(archivo);
+    return abierta;
+}
+
+// Lee desde el registro que dejo pendiente Abrir hasta el final del archivo
+static void VerificarRegistros(const char * caso, const registro_s * esperados, size_t cantidad) {
+
+    for (size_t indice = 0; indice < cantidad; indice++) {
+        VERIFICAR(proximo == esperados[indice].tick && nivel == esperados[indice].nivel &&
+                      destino == esperados[indice].pin,
+                  "%s: registro %zu en el tick %" PRIu64 " nivel %d pin %02x", caso, indice,
+                  proximo, nivel, destino);
+        if (indice + 1 < cantidad) {
+            VERIFICAR(GrabacionLeer(), "%s: el archivo termina en el registro %zu", caso, indice);
+        }
+    }
+    VERIFICAR(!GrabacionLeer(), "%s: sobran registros despues del final", caso);
+}
+
+// Escribe los bytes tal cual en un archivo y devuelve si la reproduccion no lo acepta
+static bool Rechazada(const uint8_t * bytes, size_t largo) {
+
+    char archivo[] = "/tmp/prueba_grabacionXXXXXX";
+    int descriptor = mkstemp(archivo);
+    FILE * salida = descriptor >= 0 ? fdopen(descriptor, "wb") : NULL;
+
+    if (!salida) {
+        return false;
+    }
+    fwrite(bytes, 1, largo, salida);
+    fclose(salida);
+    return !Abrir(archivo);
+}
+
+// 63 ticks con nivel 1 es el mayor numero de un byte; 64 con nivel 0 ya ocupa dos
+static void VerificarBytes(void) {
+
+    static const uint8_t esperados[] = {'G', 'R', 'A', 'B', GRABACION_VERSION, 0x7F, 0x00,
+                                        0x80, 0x01, 0xFE, 0x00, GRABACION_FIN};
+    char archivo[] = "/tmp/prueba_grabacionXXXXXX";
+    FILE * salida = Crear(archivo);
+    uint8_t leidos[sizeof(esperados) + 1];
+    size_t largo;
+
+    VERIFICAR(salida, "bytes: no se pudo crear %s", archivo);
+    if (!salida) {
+        return;
+    }
+    GrabacionRegistro(salida, 63, true, GRABACION_PIN(0, 0));
+    GrabacionRegistro(salida, 64, false, GRABACION_PIN(7, 30));
+    GrabacionRegistro(salida, 0, false, GRABACION_FIN);
+    fclose(salida);
+
+    salida = fopen(archivo, "rb");
+    largo = salida ? fread(leidos, 1, sizeof(leidos), salida) : 0;
+    if (salida) {
+        fclose(salida);
+    }
+    VERIFICAR(largo == sizeof(esperados) && memcmp(leidos, esperados, largo) == 0,
+              "bytes: %zu bytes distintos de los esperados", largo);
+    VERIFICAR(Abrir(archivo), "bytes: la reproduccion no acepta el archivo");
+    VerificarRegistros("bytes", (const registro_s[]){{63, true, GRABACION_PIN(0, 0)},
+                                                     {127, false, GRABACION_PIN(7, 30)},
+                                                     {127, false, GRABACION_FIN}},
+                       3);
+}
+
+// Cada cantidad de ticks entre registros en el borde de un byte mas, alternando pines y niveles.
+// GRABACION_PIN(7, 31) coincide con GRABACION_FIN, asi que el ultimo pin es el 30
+static void VerificarIda(void) {
+
+    static const uint64_t pasos[] = {0,          1,    63,        64,
+                                     8191,       8192, 1ULL << 35, (1ULL << 62) - 1};
+    registro_s esperados[CANTIDAD(pasos) + 1];
+    char archivo[] = "/tmp/prueba_grabacionXXXXXX";
+    FILE * salida = Crear(archivo);
+    uint64_t tick = 0;
+
+    VERIFICAR(salida, "ida: no se pudo crear %s", archivo);
+    if (!salida) {
+        return;
+    }
+    for (size_t indice = 0; indice < CANTIDAD(pasos); indice++) {
+        tick += pasos[indice];
+        esperados[indice] = (registro_s){tick, indice & 1,
+                                         indice & 1 ? GRABACION_PIN(7, 30) : GRABACION_PIN(0, 0)};
+        GrabacionRegistro(salida, pasos[indice], esperados[indice].nivel, esperados[indice].pin);
+    }
+    GrabacionRegistro(salida, 5, false, GRABACION_FIN);
+    esperados[CANTIDAD(pasos)] = (registro_s){tick + 5, false, GRABACION_FIN};
+    fclose(salida);
+
+    VERIFICAR(Abrir(archivo), "ida: la reproduccion no acepta el archivo");
+    VerificarRegistros("ida", esperados, CANTIDAD(esperados));
+}
+
+static void VerificarRechazos(void) {
+
+    static const uint8_t version[] = {'G', 'R', 'A', 'B', GRABACION_VERSION + 1, 0x00, 0xFF};
+    static const uint8_t firma[] = {'G', 'R', 'A', 'V', GRABACION_VERSION, 0x00, 0xFF};
+    static const uint8_t vacia[] = {'G', 'R', 'A', 'B', GRABACION_VERSION};
+    static const uint8_t cortada[] = {'G', 'R', 'A', 'B', GRABACION_VERSION, 0x80};
+    static const uint8_t sin_pin[] = {'G', 'R', 'A', 'B', GRABACION_VERSION, 0x02};
+    static const uint8_t largo[] = {'G',  'R',  'A',  'B',  GRABACION_VERSION, 0x80, 0x80, 0x80,
+                                    0x80, 0x80, 0x80, 0x80, 0x80,              0x80, 0x80, 0x01,
+                                    0xFF};
+    static const uint8_t incompleta[] = {0x02, 0x00, 0x04}; // sin la cabecera, que pone Crear
+    char archivo[] = "/tmp/prueba_grabacionXXXXXX";
+    FILE * salida;
+
+    VERIFICAR(Rechazada(version, sizeof(version)), "rechazos: acepta otra version");
+    VERIFICAR(Rechazada(firma, sizeof(firma)), "rechazos: acepta otra firma");
+    VERIFICAR(Rechazada(vacia, sizeof(vacia)), "rechazos: acepta una grabacion sin registros");
+    VERIFICAR(Rechazada(cortada, sizeof(cortada)), "rechazos: acepta un numero cortado");
+    VERIFICAR(Rechazada(sin_pin, sizeof(sin_pin)), "rechazos: acepta un registro sin pin");
+    VERIFICAR(Rechazada(largo, sizeof(largo)), "rechazos: acepta un numero de mas de 64 bits");
+
+    // Un registro completo y el siguiente sin pin: se abre, pero el segundo no se lee
+    salida = Crear(archivo);
+    VERIFICAR(salida, "rechazos: no se pudo crear %s", archivo);
+    if (!salida) {
+        return;
+    }
+    fwrite(incompleta, 1, sizeof(incompleta), salida);
+    fclose(salida);
+    VERIFICAR(Abrir(archivo), "rechazos: no acepta un primer registro completo");
+    VERIFICAR(!GrabacionLeer(), "rechazos: lee un registro sin pin");
+}
+
+// Los cambios de un tick salen en orden de puerto y de pin, el primero con los ticks desde el
+// anterior y los demas con 0; un tick sin cambios no escribe nada
+static void VerificarGrabador(void) {
+
+    static const registro_s esperados[] = {
+        {10, true, GRABACION_PIN(1, 2)},  {10, true, GRABACION_PIN(1, 9)},
+        {10, true, GRABACION_PIN(3, 5)},  {12, false, GRABACION_PIN(1, 2)},
+        {20, false, GRABACION_FIN},
+    };
+    char archivo[] = "/tmp/prueba_grabacionXXXXXX";
+
+    grabacion = Crear(archivo);
+    VERIFICAR(grabacion, "grabador: no se pudo crear %s", archivo);
+    if (!grabacion) {
+        return;
+    }
+    memset(niveles, 0, sizeof(niveles));
+    ultimo = 0;
+    cambios = 0;
+    HostGpioSetInput(3, 5, true);
+    HostGpioSetInput(1, 9, true);
+    HostGpioSetInput(1, 2, true);
+    GrabacionTick(10);
+    HostGpioSetInput(1, 2, false);
+    GrabacionTick(12);
+    GrabacionTick(13);
+    GrabacionEscribir(20, false, GRABACION_FIN);
+    fclose(grabacion);
+    grabacion = NULL;
+
+    VERIFICAR(cambios == 4, "grabador: %llu cambios, no 4", (unsigned long long)cambios);
+    VERIFICAR(Abrir(archivo), "grabador: la reproduccion no acepta el archivo");
+    VerificarRegistros("grabador", esperados, CANTIDAD(esperados));
+}
+
+/* === Public function implementation ========================================================== */
+
+// La prueba no enlaza panel.c: la reproduccion no avanza ticks y no le pide cuadros
+void HostPanelFrame(uint8_t * frame, uint8_t size) {
+
+    memset(frame, 0, size);
+}
+
+int main(void) {
+
+    VerificarBytes();
+    VerificarIda();
+    VerificarRechazos();
+    VerificarGrabador();
+    free(datos);
+    return PruebaFin("prueba_grabacion");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,221 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba del planificador de tareas
+ **
+ ** Crea tareas que anotan su letra al ejecutarse, las activa como lo harian las interrupciones y
+ ** avanza los ticks llamando a PlanificadorTick. Verifica:
+ **
+ ** - que se ejecuten por prioridad y, con la misma prioridad, en el orden en que se crearon;
+ ** - que varias activaciones de una tarea lista se combinen en una sola ejecucion;
+ ** - que se cuenten plazos perdidos para una periodica que se vuelve a activar sin haber corrido y
+ **   para una tarea cuya demora supera su plazo, y no para una que termina justo en el plazo;
+ ** - que no se puedan crear tareas despues de la primera activacion, aunque ya no haya listas.
+ **
+ **     prueba_planificador
+ **
+ ** Termina con error si alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "planificador.h"
+#include "prueba.h"
+#include <inttypes.h>
+#include <string.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define ANOTADAS 16 // ejecuciones que se anotan entre dos revisiones
+#define PERIODO  5  // ticks entre activaciones de la tarea periodica
+#define PLAZO    3  // ticks de plazo de la tarea con plazo
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static void Anotar(void * contexto);
+static void Ejecutar(void);
+static void Revisar(const char * caso, const char * esperado);
+static const tarea_informe_s * Informe(const char * nombre);
+static void VerificarOrden(void);
+static void VerificarCombinadas(void);
+static void VerificarPlazos(void);
+static void VerificarCrear(void);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static char anotadas[ANOTADAS + 1];
+static unsigned cantidad = 0;
+
+// Se crean antes de activar ninguna, fuera de orden de prioridad
+static tarea_t a, b, c, d, periodica, con_plazo;
+
+/* === Private function implementation ========================================================= */
+
+static void Anotar(void * contexto) {
+
+    if (cantidad < ANOTADAS) {
+        anotadas[cantidad++] = *(const char *)contexto;
+        anotadas[cantidad] = '\0';
+    }
+}
+
+// Ejecuta las tareas listas como el lazo principal, hasta que no quede ninguna
+static void Ejecutar(void) {
+
+    while (PlanificadorEjecutar()) {
+    }
+}
+
+static void Revisar(const char * caso, const char * esperado) {
+
+    VERIFICAR(strcmp(anotadas, esperado) == 0, "%s: se ejecuto \"%s\" y no \"%s\"", caso, anotadas,
+              esperado);
+    cantidad = 0;
+    anotadas[0] = '\0';
+}
+
+static const tarea_informe_s * Informe(const char * nombre) {
+
+    for (uint8_t indice = 0; indice < PlanificadorTareas(); indice++) {
+        if (strcmp(PlanificadorInforme(indice)->nombre, nombre) == 0) {
+            return PlanificadorInforme(indice);
+        }
+    }
+    return NULL;
+}
+
+// Prioridades: b 0, d 1, a y c 2 (a creada antes), periodica 3, con_plazo 4
+static void VerificarOrden(void) {
+
+    static const char * const nombres[] = {"b", "d", "a", "c", "periodica", "con_plazo"};
+
+    VERIFICAR(PlanificadorTareas() == 6, "orden: %u tareas", PlanificadorTareas());
+    for (uint8_t indice = 0; indice < 6 && indice < PlanificadorTareas(); indice++) {
+        VERIFICAR(strcmp(PlanificadorInforme(indice)->nombre, nombres[indice]) == 0,
+                  "orden: el informe %u es %s y no %s", indice, PlanificadorInforme(indice)->nombre,
+                  nombres[indice]);
+    }
+
+    PlanificadorActivar(con_plazo);
+    PlanificadorActivar(c);
+    PlanificadorActivar(a);
+    PlanificadorActivar(d);
+    PlanificadorActivar(b);
+    Ejecutar();
+    Revisar("orden", "bdacl");
+}
+
+static void VerificarCombinadas(void) {
+
+    uint32_t activaciones = Informe("a")->activaciones;
+
+    PlanificadorActivar(a);
+    PlanificadorActivar(a);
+    PlanificadorActivar(a);
+    VERIFICAR(PlanificadorPendiente(), "combinadas: la tarea no quedo lista");
+    Ejecutar();
+    Revisar("combinadas", "a");
+    VERIFICAR(!PlanificadorPendiente(), "combinadas: quedaron tareas listas");
+    VERIFICAR(Informe("a")->activaciones == activaciones + 1 && Informe("a")->plazos_perdidos == 0,
+              "combinadas: %" PRIu32 " activaciones y %" PRIu32 " plazos perdidos",
+              Informe("a")->activaciones - activaciones, Informe("a")->plazos_perdidos);
+}
+
+static void VerificarPlazos(void) {
+
+    const tarea_informe_s * informe = Informe("periodica");
+
+    // Dos periodos sin ejecutar: la segunda activacion se combina y cuenta como plazo perdido
+    for (int tick = 0; tick < 2 * PERIODO; tick++) {
+        PlanificadorTick();
+    }
+    Ejecutar();
+    Revisar("periodica combinada", "p");
+    VERIFICAR(informe->plazos_perdidos == 1, "periodica combinada: %" PRIu32 " plazos perdidos",
+              informe->plazos_perdidos);
+    VERIFICAR(informe->demora_maxima == PERIODO, "periodica combinada: demora %" PRIu32,
+              informe->demora_maxima);
+
+    // Un periodo ejecutando a tiempo no pierde plazos
+    for (int tick = 0; tick < PERIODO; tick++) {
+        PlanificadorTick();
+        Ejecutar();
+    }
+    Revisar("periodica a tiempo", "p");
+    VERIFICAR(informe->plazos_perdidos == 1, "periodica a tiempo: %" PRIu32 " plazos perdidos",
+              informe->plazos_perdidos);
+
+    // La tarea con plazo termina justo en el plazo y despues un tick tarde. La periodica vuelve a
+    // estar lista en el segundo intento y corre antes, porque tiene mayor prioridad
+    informe = Informe("con_plazo");
+    for (int demora = PLAZO; demora <= PLAZO + 1; demora++) {
+        PlanificadorActivar(con_plazo);
+        for (int tick = 0; tick < demora; tick++) {
+            PlanificadorTick();
+        }
+        Ejecutar();
+        Revisar("con plazo", demora == PLAZO ? "l" : "pl");
+        VERIFICAR(informe->plazos_perdidos == (uint32_t)(demora > PLAZO),
+                  "con plazo: demora %d, %" PRIu32 " plazos perdidos", demora,
+                  informe->plazos_perdidos);
+    }
+    VERIFICAR(informe->demora_maxima == PLAZO + 1, "con plazo: demora maxima %" PRIu32,
+              informe->demora_maxima);
+}
+
+// Ya no hay tareas listas, pero alguna se activo
+static void VerificarCrear(void) {
+
+    static const char letra = 'x';
+
+    VERIFICAR(!PlanificadorPendiente(), "crear: quedaron tareas listas");
+    VERIFICAR(PlanificadorCrear("tarde", Anotar, (void *)&letra, 0, 0, 0) == NULL,
+              "crear: se creo una tarea despues de activar");
+    VERIFICAR(PlanificadorTareas() == 6, "crear: %u tareas", PlanificadorTareas());
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(void) {
+
+    static const char letras[] = "abcdpl";
+
+    a = PlanificadorCrear("a", Anotar, (void *)&letras[0], 2, 0, 0);
+    periodica = PlanificadorCrear("periodica", Anotar, (void *)&letras[4], 3, PERIODO, 0);
+    b = PlanificadorCrear("b", Anotar, (void *)&letras[1], 0, 0, 0);
+    con_plazo = PlanificadorCrear("con_plazo", Anotar, (void *)&letras[5], 4, 0, PLAZO);
+    c = PlanificadorCrear("c", Anotar, (void *)&letras[2], 2, 0, 0);
+    d = PlanificadorCrear("d", Anotar, (void *)&letras[3], 1, 0, 0);
+
+    VerificarOrden();
+    VerificarCombinadas();
+    VerificarPlazos();
+    VerificarCrear();
+    return PruebaFin("prueba_planificador");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
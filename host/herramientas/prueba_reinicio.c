@@ -0,0 +1,254 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba del arranque en caliente
+ **
+ ** Simula reinicios llamando otra vez a ReinicioInit y ClockCreate sobre la misma memoria
+ ** retenida, como quedaria despues de un reinicio que no corta la alimentacion. Verifica:
+ **
+ ** - que ReinicioSuma detecte el cambio de cualquier bit y tenga en cuenta el tamano;
+ ** - que un arranque sin firma sea en frio y el reloj quede sin configurar;
+ ** - que despues de un reinicio pedido o externo el reloj retome la hora, la alarma y el tick
+ **   dentro del segundo;
+ ** - que un bit cambiado en la memoria retenida del reloj, o un tick fuera de rango para la
+ **   frecuencia nueva, lo haga arrancar en frio;
+ ** - los ticks perdidos que se estiman en un reinicio del perro guardian, y que una racha de
+ **   REINICIO_PERRO_SEGUIDOS reinicios del perro no deje retomar el estado.
+ **
+ **     prueba_reinicio
+ **
+ ** Termina con error si alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "reinicio.h"
+#include "reloj.h"
+#include "prueba.h"
+#include <inttypes.h>
+#include <string.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define TICKS  1000 // ticks por segundo
+#define ESPERA 1000 // ticks del perro guardian sin alimentar hasta que reinicia
+#define HORA   0x123456UL
+#define ALARMA 0x073000UL
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static void Avanzar(uint32_t ticks);
+static void Configurar(bcd_t hora);
+static void Reiniciar(bool perro, const char * caso);
+static void VerificarHora(const char * caso, bcd_t esperada);
+static void VerificarSuma(void);
+static void VerificarFrio(void);
+static void VerificarPedido(void);
+static void VerificarDanado(void);
+static void VerificarFrecuencia(void);
+static void VerificarPerro(void);
+static void VerificarRacha(void);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static reloj_t reloj;
+
+/* === Private function implementation ========================================================= */
+
+// Lo que hace el SysTick del firmware en cada tick con estos dos modulos
+static void Avanzar(uint32_t ticks) {
+
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+        ReinicioTick();
+        RelojNuevoTick(reloj);
+    }
+}
+
+static void Configurar(bcd_t hora) {
+
+    uint8_t digitos[6];
+
+    BcdDesempaquetar(hora, digitos, sizeof(digitos));
+    SetClockTime(reloj, digitos, sizeof(digitos));
+    BcdDesempaquetar(ALARMA, digitos, 4);
+    SetAlarmTime(reloj, digitos);
+}
+
+// El arranque del firmware: la causa, el reloj y la compensacion de lo que duro el reinicio
+static void Reiniciar(bool perro, const char * caso) {
+
+    ReinicioInit(perro, ESPERA);
+    reloj = ClockCreate(TICKS);
+    if (RelojRecuperado(reloj)) {
+        RelojCompensar(reloj, ReinicioPerdidos());
+    }
+    VERIFICAR(!RelojRecuperado(reloj) || ReinicioEnCaliente(),
+              "%s: el reloj retomo su estado en un arranque en frio", caso);
+}
+
+static void VerificarHora(const char * caso, bcd_t esperada) {
+
+    bcd_t hora = 0;
+    uint8_t alarma[4];
+    bool valida = GetClockTimePacked(reloj, &hora);
+    bool habilitada = GetAlarmTime(reloj, alarma);
+
+    VERIFICAR(valida && hora == esperada, "%s: hora %06" PRIX32 " %s, no %06" PRIX32, caso, hora,
+              valida ? "valida" : "invalida", esperada);
+    VERIFICAR(habilitada && BcdEmpaquetar(alarma, 4) == ALARMA, "%s: alarma %06" PRIX32 " %s",
+              caso, BcdEmpaquetar(alarma, 4), habilitada ? "habilitada" : "deshabilitada");
+}
+
+// Cualquier bit cambiado cambia la suma, y los mismos bytes con otro tamano tambien
+static void VerificarSuma(void) {
+
+    uint8_t datos[16] = {0};
+    uint32_t suma = ReinicioSuma(datos, sizeof(datos));
+    unsigned iguales = 0;
+
+    for (unsigned bit = 0; bit < 8 * sizeof(datos); bit++) {
+        datos[bit / 8] ^= 1 << (bit % 8);
+        iguales += ReinicioSuma(datos, sizeof(datos)) == suma;
+        datos[bit / 8] ^= 1 << (bit % 8);
+    }
+    VERIFICAR(iguales == 0, "suma: %u bits cambiados que no cambian la suma", iguales);
+    VERIFICAR(ReinicioSuma(datos, sizeof(datos)) == suma, "suma: no es repetible");
+    VERIFICAR(ReinicioSuma(datos, sizeof(datos) - 1) != suma, "suma: no depende del tamano");
+}
+
+static void VerificarFrio(void) {
+
+    bcd_t hora;
+
+    memset(&reinicio, 0xA5, sizeof(reinicio)); // basura del encendido
+    Reiniciar(false, "frio");
+    VERIFICAR(ReinicioCausa() == REINICIO_FRIO && !ReinicioEnCaliente(), "frio: causa %d",
+              ReinicioCausa());
+    VERIFICAR(ReinicioPerdidos() == 0 && ReinicioCantidad() == 0,
+              "frio: %" PRIu32 " perdidos, %" PRIu32 " reinicios", ReinicioPerdidos(),
+              ReinicioCantidad());
+    VERIFICAR(!RelojRecuperado(reloj) && !GetClockTimePacked(reloj, &hora),
+              "frio: el reloj no quedo sin configurar");
+}
+
+// Con un reinicio pedido solo se pierden los ticks del arranque, y el tick dentro del segundo sigue
+static void VerificarPedido(void) {
+
+    Configurar(HORA);
+    Avanzar(3 * TICKS + TICKS / 2);
+    ReinicioPedir();
+    Reiniciar(false, "pedido");
+    VERIFICAR(ReinicioCausa() == REINICIO_PEDIDO && ReinicioEnCaliente(), "pedido: causa %d",
+              ReinicioCausa());
+    VERIFICAR(ReinicioPerdidos() == REINICIO_ARRANQUE, "pedido: %" PRIu32 " ticks perdidos",
+              ReinicioPerdidos());
+    VERIFICAR(RelojRecuperado(reloj), "pedido: el reloj no retomo su estado");
+    VerificarHora("pedido", 0x123459);
+    Avanzar(TICKS / 2 - REINICIO_ARRANQUE);
+    VerificarHora("pedido, medio segundo despues", 0x123500);
+}
+
+// Un bit cambiado en la hora retenida no pasa la suma
+static void VerificarDanado(void) {
+
+    bcd_t hora;
+
+    Configurar(HORA);
+    ((volatile uint8_t *)reloj)[0] ^= 0x01;
+    Reiniciar(false, "danado");
+    VERIFICAR(ReinicioCausa() == REINICIO_EXTERNO && ReinicioEnCaliente(), "danado: causa %d",
+              ReinicioCausa());
+    VERIFICAR(!RelojRecuperado(reloj) && !GetClockTimePacked(reloj, &hora),
+              "danado: el reloj retomo una hora que no pasa la suma");
+}
+
+// El tick dentro del segundo no esta en la suma: se retoma si esta en el rango de la frecuencia
+static void VerificarFrecuencia(void) {
+
+    bcd_t hora;
+
+    Configurar(HORA);
+    Avanzar(3 * TICKS / 4);
+    ReinicioInit(false, ESPERA);
+    reloj = ClockCreate(TICKS);
+    VERIFICAR(RelojRecuperado(reloj), "frecuencia: el reloj no retomo su estado");
+    ReinicioInit(false, ESPERA);
+    reloj = ClockCreate(TICKS / 2);
+    VERIFICAR(!RelojRecuperado(reloj) && !GetClockTimePacked(reloj, &hora),
+              "frecuencia: el reloj retomo un tick fuera de rango");
+    Reiniciar(false, "frecuencia");
+}
+
+// El perro guardian vence ESPERA ticks despues de la ultima alimentacion; los que no se contaron
+// hasta entonces se suman a los del arranque
+static void VerificarPerro(void) {
+
+    Configurar(0x120000);
+    Avanzar(100);
+    ReinicioAlimentado();
+    Avanzar(50);
+    Reiniciar(true, "perro");
+    VERIFICAR(ReinicioCausa() == REINICIO_PERRO && ReinicioEnCaliente(), "perro: causa %d",
+              ReinicioCausa());
+    VERIFICAR(ReinicioPerdidos() == REINICIO_ARRANQUE + ESPERA - 50,
+              "perro: %" PRIu32 " ticks perdidos, no %d", ReinicioPerdidos(),
+              REINICIO_ARRANQUE + ESPERA - 50);
+    // 100 + 50 + los perdidos pasan de un segundo
+    VerificarHora("perro", 0x120001);
+}
+
+// Despues de REINICIO_PERRO_SEGUIDOS reinicios del perro sin un periodo estable se arranca en frio,
+// y un reinicio que no es del perro corta la racha
+static void VerificarRacha(void) {
+
+    for (unsigned reinicios = 2; reinicios <= REINICIO_PERRO_SEGUIDOS; reinicios++) {
+        Reiniciar(true, "racha");
+        VERIFICAR(ReinicioEnCaliente() == (reinicios < REINICIO_PERRO_SEGUIDOS),
+                  "racha: reinicio %u del perro %s en caliente", reinicios,
+                  ReinicioEnCaliente() ? "retoma" : "no retoma");
+    }
+    VERIFICAR(!RelojRecuperado(reloj), "racha: el reloj retomo su estado al final de la racha");
+    ReinicioPedir();
+    Reiniciar(false, "racha");
+    VERIFICAR(ReinicioEnCaliente(), "racha: un reinicio pedido no corta la racha del perro");
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(void) {
+
+    VerificarSuma();
+    VerificarFrio();
+    VerificarPedido();
+    VerificarDanado();
+    VerificarFrecuencia();
+    VerificarPerro();
+    VerificarRacha();
+    return PruebaFin("prueba_reinicio");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
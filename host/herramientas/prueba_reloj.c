@@ -0,0 +1,303 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba del reloj contra un modelo de referencia
+ **
+ ** Avanza el reloj tick a tick, como lo hacen el SysTick y PendSV del firmware, y compara despues
+ ** de cada tick la hora, la alarma y la secuencia de eventos publicados con un modelo que cuenta
+ ** segundos enteros. El recorrido pasa por la hora sin configurar, el ajuste, la alarma, la alarma
+ ** pospuesta, el cambio de hora y la medianoche, y deshabilitar y cancelar la alarma.
+ **
+ **     prueba_reloj
+ **     prueba_reloj_cpp
+ **
+ ** La segunda es la misma prueba enlazada con el motor en C++ (src/reloj_plantilla.cpp compilado
+ ** con RELOJ_PLANTILLA) en lugar de src/reloj.c, de modo que las dos implementaciones reciben la
+ ** misma secuencia de ticks y se comparan con la misma referencia. Termina con error si alguna
+ ** verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "bcd.h"
+#include "reloj.h"
+#include "temporizador.h"
+#include "prueba.h"
+#include <inttypes.h>
+#include <stdio.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define TICKS        10 // ticks por segundo, pocos para recorrer minutos enteros
+#define EVENTOS      16 // eventos que se anotan en un tick
+#define SEGUNDOS_DIA (24 * 60 * 60)
+
+#ifdef RELOJ_PLANTILLA
+    #define NOMBRE "prueba_reloj_cpp"
+#else
+    #define NOMBRE "prueba_reloj"
+#endif
+
+/* === Private data type declarations ========================================================== */
+
+//! Lo que deberia tener el reloj, en segundos enteros
+typedef struct modelo_s {
+    int tick;          // tick dentro del segundo
+    bool valida;
+    uint32_t segundos; // desde la medianoche
+    uint32_t alarma;   // minutos desde la medianoche
+    bool habilitada;
+    uint32_t pospuesta; // ticks que le faltan a la alarma pospuesta, 0 si no hay
+} modelo_s;
+
+typedef struct eventos_s {
+    reloj_evento_t lista[EVENTOS];
+    unsigned cantidad;
+} eventos_s;
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static bcd_t Empaquetar(uint32_t segundos);
+static void Anotar(reloj_t reloj, reloj_evento_t evento, void * contexto);
+static void Agregar(eventos_s * eventos, reloj_evento_t evento);
+static void Describir(const eventos_s * eventos, char * texto, size_t tamano);
+static void Comparar(const char * caso);
+static void Tick(void);
+static void Correr(const char * caso, uint32_t ticks);
+static void AjustarHora(uint32_t segundos);
+static void AjustarAlarma(uint32_t minutos);
+static void Posponer(uint8_t minutos);
+static void Alternar(void);
+static void Cancelar(void);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static reloj_t reloj;
+static modelo_s modelo;
+static eventos_s obtenidos;
+static eventos_s esperados;
+
+static const char * const nombres[RELOJ_EVENTOS] = {
+    [RELOJ_SEGUNDO] = "segundo", [RELOJ_MEDIO_SEGUNDO] = "medio", [RELOJ_MINUTO] = "minuto",
+    [RELOJ_HORA] = "hora",       [RELOJ_DIA] = "dia",             [RELOJ_ALARMA] = "alarma",
+    [RELOJ_POSPONER] = "posponer", [RELOJ_CANCELAR] = "cancelar",
+};
+
+/* === Private function implementation ========================================================= */
+
+static bcd_t Empaquetar(uint32_t segundos) {
+
+    uint32_t campos[] = {segundos % 60, segundos / 60 % 60, segundos / 3600};
+    bcd_t valor = 0;
+
+    for (unsigned indice = 0; indice < 3; indice++) {
+        valor |= (campos[indice] / 10 * 16 + campos[indice] % 10) << (8 * indice);
+    }
+    return valor;
+}
+
+static void Anotar(reloj_t reloj, reloj_evento_t evento, void * contexto) {
+    (void)reloj;
+    (void)contexto;
+    Agregar(&obtenidos, evento);
+}
+
+static void Agregar(eventos_s * eventos, reloj_evento_t evento) {
+
+    if (eventos->cantidad < EVENTOS) {
+        eventos->lista[eventos->cantidad++] = evento;
+    }
+}
+
+static void Describir(const eventos_s * eventos, char * texto, size_t tamano) {
+
+    size_t largo = 0;
+
+    texto[0] = 0;
+    for (unsigned indice = 0; indice < eventos->cantidad && largo < tamano; indice++) {
+        largo += (size_t)snprintf(texto + largo, tamano - largo, " %s",
+                                  nombres[eventos->lista[indice]]);
+    }
+}
+
+// Los eventos anotados, la hora y la alarma contra el modelo; despues empieza otra anotacion
+static void Comparar(const char * caso) {
+
+    bool iguales = obtenidos.cantidad == esperados.cantidad;
+    bcd_t hora = 0, esperada = Empaquetar(modelo.segundos);
+    bool valida = GetClockTimePacked(reloj, &hora);
+    uint8_t digitos[4];
+    bool habilitada = GetAlarmTime(reloj, digitos);
+    bcd_t alarma = BcdEmpaquetar(digitos, 4);
+    char texto[2][EVENTOS * 10];
+
+    for (unsigned indice = 0; iguales && indice < obtenidos.cantidad; indice++) {
+        iguales = obtenidos.lista[indice] == esperados.lista[indice];
+    }
+    Describir(&obtenidos, texto[0], sizeof(texto[0]));
+    Describir(&esperados, texto[1], sizeof(texto[1]));
+    VERIFICAR(iguales, "%s, %06" PRIX32 ": eventos [%s ], no [%s ]", caso, esperada, texto[0],
+              texto[1]);
+    VERIFICAR(valida == modelo.valida && (!valida || hora == esperada),
+              "%s: hora %06" PRIX32 " %s, no %06" PRIX32 " %s", caso, hora,
+              valida ? "valida" : "invalida", esperada, modelo.valida ? "valida" : "invalida");
+    VERIFICAR(habilitada == modelo.habilitada && alarma == Empaquetar(modelo.alarma * 60),
+              "%s, %06" PRIX32 ": alarma %06" PRIX32 " %s", caso, esperada, alarma,
+              habilitada ? "habilitada" : "deshabilitada");
+    obtenidos.cantidad = esperados.cantidad = 0;
+}
+
+// Un tick del firmware: el SysTick avanza los temporizadores y cuenta el tick, y PendSV publica la
+// alarma pospuesta y procesa el segundo o el medio segundo. El modelo hace lo mismo en segundos
+// enteros
+static void Tick(void) {
+
+    bool segundo = false, medio = false;
+
+    TemporizadorTick();
+    bool procesar = RelojContarTick(reloj);
+    if (procesar) {
+        RelojProcesarTicks(reloj);
+    }
+
+    if (modelo.tick >= TICKS - 1) {
+        modelo.tick = 0;
+        segundo = true;
+    } else if (++modelo.tick == TICKS / 2) {
+        medio = true;
+    }
+    if (modelo.pospuesta && --modelo.pospuesta == 0 && modelo.habilitada) {
+        Agregar(&esperados, RELOJ_ALARMA);
+    }
+    if (segundo) {
+        if (modelo.valida) {
+            modelo.segundos = (modelo.segundos + 1) % SEGUNDOS_DIA;
+            if (modelo.segundos % 60 == 0) {
+                Agregar(&esperados, RELOJ_MINUTO);
+            }
+            if (modelo.segundos % 3600 == 0) {
+                Agregar(&esperados, RELOJ_HORA);
+            }
+            if (modelo.segundos == 0) {
+                Agregar(&esperados, RELOJ_DIA);
+            }
+            if (modelo.segundos % 60 == 0 && modelo.habilitada &&
+                modelo.segundos / 60 == modelo.alarma) {
+                Agregar(&esperados, RELOJ_ALARMA);
+            }
+        }
+        Agregar(&esperados, RELOJ_SEGUNDO);
+    }
+    if (medio) {
+        Agregar(&esperados, RELOJ_MEDIO_SEGUNDO);
+    }
+}
+
+static void Correr(const char * caso, uint32_t ticks) {
+
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+        Tick();
+        Comparar(caso);
+    }
+}
+
+static void AjustarHora(uint32_t segundos) {
+
+    uint8_t digitos[6];
+
+    BcdDesempaquetar(Empaquetar(segundos), digitos, sizeof(digitos));
+    SetClockTime(reloj, digitos, sizeof(digitos));
+    modelo.valida = true;
+    modelo.segundos = segundos;
+    Comparar("ajustar hora");
+}
+
+static void AjustarAlarma(uint32_t minutos) {
+
+    uint8_t digitos[4];
+
+    BcdDesempaquetar(Empaquetar(minutos * 60), digitos, sizeof(digitos));
+    SetAlarmTime(reloj, digitos);
+    modelo.alarma = minutos;
+    modelo.habilitada = true;
+    Comparar("ajustar alarma");
+}
+
+static void Posponer(uint8_t minutos) {
+
+    PosponerAlarma(reloj, minutos);
+    modelo.pospuesta = (uint32_t)minutos * 60 * TICKS;
+    Agregar(&esperados, RELOJ_POSPONER);
+    Comparar("posponer");
+}
+
+static void Alternar(void) {
+
+    ToggleHabAlarma(reloj);
+    modelo.habilitada = !modelo.habilitada;
+    modelo.pospuesta = 0;
+    Comparar("alternar");
+}
+
+static void Cancelar(void) {
+
+    CancelarAlarma(reloj);
+    modelo.pospuesta = 0;
+    Agregar(&esperados, RELOJ_CANCELAR);
+    Comparar("cancelar");
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(void) {
+
+    reloj = ClockCreate(TICKS);
+    RelojSuscribir(reloj, (1U << RELOJ_EVENTOS) - 1, Anotar, NULL);
+    Comparar("crear");
+
+    Correr("sin configurar", 2 * TICKS + 3); // el ajuste queda fuera de fase con los segundos
+
+    AjustarHora(23 * 3600 + 58 * 60 + 55);
+    AjustarAlarma(23 * 60 + 59);
+    Correr("alarma", 7 * TICKS);
+    Posponer(1);
+    Correr("pospuesta y medianoche", 70 * TICKS);
+    Posponer(1);
+    Correr("pospuesta", 10 * TICKS);
+    Alternar();
+    Correr("deshabilitada", 60 * TICKS);
+    Alternar();
+    Posponer(1);
+    Correr("pospuesta", 5 * TICKS);
+    Cancelar();
+    Correr("cancelada", 60 * TICKS);
+    AjustarAlarma(modelo.segundos / 60 + 1);
+    Correr("alarma", 65 * TICKS);
+    AjustarHora(12 * 3600 + 59 * 60 + 58);
+    Correr("cambio de hora", 3 * TICKS);
+    return PruebaFin(NOMBRE);
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,163 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba del banco de rendimiento
+ **
+ ** Incluye host/herramientas/rendimiento.c con su main renombrado y verifica lo que no depende de
+ ** los tiempos medidos:
+ **
+ ** - las estadisticas de Resumir sobre muestras conocidas;
+ ** - la lectura de un csv de base con LeerBase y la busqueda de cada caso en ella;
+ ** - la eleccion de casos por texto de la linea de comandos;
+ ** - que cada caso tenga un nombre unico que entre en la base, y que se pueda preparar y medir.
+ **
+ **     prueba_rendimiento
+ **
+ ** Termina con error si alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+// El main del banco queda con otro nombre y no se llama: se usan sus funciones y sus casos
+#define main BancoMain
+#include "rendimiento.c"
+#undef main
+
+#include "prueba.h"
+
+/* === Macros definitions ====================================================================== */
+
+#define MUESTRAS 100
+#define TOLERANCIA 1e-9
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static void VerificarResumen(void);
+static void VerificarBase(void);
+static void VerificarEleccion(void);
+static void VerificarCasos(void);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+// Las muestras 1 a 100 en orden inverso, y todas iguales
+static void VerificarResumen(void) {
+
+    double muestras[MUESTRAS];
+    resultado_s r;
+
+    for (unsigned indice = 0; indice < MUESTRAS; indice++) {
+        muestras[indice] = MUESTRAS - indice;
+    }
+    r = Resumir(muestras, MUESTRAS);
+    VERIFICAR(r.minimo == 1 && r.mediana == 51 && r.p90 == 91 && r.p99 == 100,
+              "resumen: minimo %g, mediana %g, p90 %g, p99 %g", r.minimo, r.mediana, r.p90, r.p99);
+    VERIFICAR(fabs(r.promedio - 50.5) < TOLERANCIA, "resumen: promedio %g", r.promedio);
+    VERIFICAR(fabs(r.desvio - sqrt((MUESTRAS * MUESTRAS - 1) / 12.0)) < TOLERANCIA,
+              "resumen: desvio %g", r.desvio);
+
+    for (unsigned indice = 0; indice < MUESTRAS; indice++) {
+        muestras[indice] = 2.5;
+    }
+    r = Resumir(muestras, MUESTRAS);
+    VERIFICAR(r.desvio == 0 && r.minimo == r.p99, "resumen iguales: desvio %g", r.desvio);
+}
+
+// Un csv como el de -o csv, con el encabezado y una linea que no es de un caso
+static void VerificarBase(void) {
+
+    char archivo[] = "/tmp/prueba_rendimientoXXXXXX";
+    int descriptor = mkstemp(archivo);
+    FILE * salida = descriptor >= 0 ? fdopen(descriptor, "w") : NULL;
+    base_s base[BASE_CASOS];
+    size_t cantidad = 0;
+
+    VERIFICAR(salida, "base: no se pudo crear %s", archivo);
+    if (!salida) {
+        return;
+    }
+    fprintf(salida, "caso,tandas,operaciones,minimo_ns,mediana_ns,promedio_ns,p90_ns,p99_ns,"
+                    "desvio_ns\n"
+                    "reloj_tick_comun,200,20000,1.00,2.50,2.60,3.00,4.00,0.10\n"
+                    "4 casos empeoraron\n"
+                    "vacio,200,20000,0.10,0.20,0.20,0.30,0.40,0.01\n");
+    fclose(salida);
+    cantidad = LeerBase(archivo, base, BASE_CASOS);
+    unlink(archivo);
+
+    const base_s * tick = BuscarBase(base, cantidad, "reloj_tick_comun");
+    const base_s * vacio = BuscarBase(base, cantidad, "vacio");
+    VERIFICAR(cantidad == 2, "base: %zu casos, no 2", cantidad);
+    VERIFICAR(tick && tick->mediana == 2.5, "base: reloj_tick_comun sin la mediana 2.5");
+    VERIFICAR(vacio && vacio->mediana == 0.2, "base: vacio sin la mediana 0.2");
+    VERIFICAR(!BuscarBase(base, cantidad, "reloj"), "base: encontro un nombre incompleto");
+}
+
+static void VerificarEleccion(void) {
+
+    char programa[] = "rendimiento", bcd[] = "bcd", vacio[] = "vacio";
+    char * argv[] = {programa, bcd, vacio, NULL};
+
+    VERIFICAR(Elegido("reloj_tick_comun", 1, argv, 1), "eleccion: sin textos no midio todos");
+    VERIFICAR(Elegido("bcd_segundo", 3, argv, 1) && Elegido("vacio", 3, argv, 1),
+              "eleccion: no eligio los casos pedidos");
+    VERIFICAR(!Elegido("reloj_tick_comun", 3, argv, 1), "eleccion: eligio un caso no pedido");
+}
+
+// Una medicion corta de cada caso: solo se verifica que corra y que los resultados sean coherentes
+static void VerificarCasos(void) {
+
+    size_t total = sizeof(casos) / sizeof(casos[0]);
+
+    VERIFICAR(total <= BASE_CASOS, "casos: %zu, la base lee %d", total, BASE_CASOS);
+    for (size_t indice = 0; indice < total; indice++) {
+        const char * nombre = casos[indice].nombre;
+        resultado_s r = Medir(&casos[indice], 3, 50);
+
+        VERIFICAR(strlen(nombre) < sizeof(((base_s *)0)->nombre), "casos: %s no entra en la base",
+                  nombre);
+        for (size_t otro = 0; otro < indice; otro++) {
+            VERIFICAR(strcmp(nombre, casos[otro].nombre) != 0, "casos: %s repetido", nombre);
+        }
+        VERIFICAR(r.minimo >= 0 && r.minimo <= r.mediana && r.mediana <= r.p99,
+                  "casos: %s minimo %g, mediana %g, p99 %g", nombre, r.minimo, r.mediana, r.p99);
+    }
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(void) {
+
+    VerificarResumen();
+    VerificarBase();
+    VerificarEleccion();
+    VerificarCasos();
+    return PruebaFin("prueba_rendimiento");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,269 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba de la rueda de temporizadores
+ **
+ ** Avanza la rueda llamando a TemporizadorTick como lo hace el SysTick y anota el tick en que vence
+ ** cada temporizador. Verifica:
+ **
+ ** - que un disparo venza exactamente despues de su espera a ambos lados de cada cascada (63 y 64,
+ **   4095 y 4096, 262143 y 262144 ticks) y con TEMPORIZADOR_MAXIMO, desde distintas fases de la
+ **   rueda, y que las esperas fuera de rango se recorten;
+ ** - que un periodico vuelva a vencer cada periodo sin acumular corrimiento;
+ ** - que una accion pueda detener su propio temporizador y otro que vence en el mismo tick;
+ ** - que los vencimientos de un temporizador sin accion se cuenten, se retiren con
+ **   TemporizadorVencido y se descarten al detenerlo.
+ **
+ **     prueba_temporizador
+ **
+ ** Termina con error si alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "temporizador.h"
+#include "prueba.h"
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define LOTE     6         // temporizadores que corren juntos en la prueba de las cascadas
+#define VUELTA   (1U << 18) // ticks en los que dan la vuelta los tres primeros niveles
+#define PERIODOS 50        // vencimientos que se revisan de cada periodico
+#define CANTIDAD(vector) (sizeof(vector) / sizeof((vector)[0]))
+
+/* === Private data type declarations ========================================================== */
+
+//! Vencimientos de un temporizador con accion
+typedef struct registro_s {
+    uint32_t vencimientos;
+    uint32_t ultimo;    // tick del ultimo vencimiento
+    uint32_t esperado;  // tick en que deberia vencer el proximo, para los periodicos
+    uint32_t periodo;
+    uint32_t corridos;  // vencimientos que no llegaron en el tick esperado
+    temporizador_t detener; // temporizador que la accion detiene al vencer, o NULL
+} registro_s;
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static void Avanzar(uint32_t ticks);
+static void AvanzarHastaFase(uint32_t fase);
+static void Anotar(temporizador_t temporizador, void * contexto);
+static void VerificarBordes(uint32_t fase);
+static void VerificarPeriodico(uint32_t espera, uint32_t periodo);
+static void VerificarDetenerEnAccion(void);
+static void VerificarPendientes(void);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static uint32_t tick = 0; // ticks avanzados; durante una accion, el tick que se esta procesando
+static temporizador_t lote[LOTE];
+static registro_s registros[LOTE];
+
+/* === Private function implementation ========================================================= */
+
+static void Avanzar(uint32_t ticks) {
+
+    while (ticks--) {
+        tick++;
+        TemporizadorTick();
+    }
+}
+
+// Avanza hasta que el proximo tick quede en la fase indicada de la vuelta de los tres niveles
+static void AvanzarHastaFase(uint32_t fase) {
+
+    Avanzar((fase - tick) & (VUELTA - 1));
+}
+
+static void Anotar(temporizador_t temporizador, void * contexto) {
+
+    registro_s * registro = contexto;
+
+    registro->vencimientos++;
+    registro->ultimo = tick;
+    if (registro->periodo) {
+        registro->corridos += tick != registro->esperado;
+        registro->esperado += registro->periodo;
+    }
+    if (registro->detener) {
+        TemporizadorDetener(registro->detener);
+    }
+    (void)temporizador;
+}
+
+// Cada espera vence una sola vez, en el tick que corresponde; las de 0 y de mas del maximo se
+// recortan a 1 y a TEMPORIZADOR_MAXIMO. Las esperas corren de a LOTE juntas.
+static void VerificarBordes(uint32_t fase) {
+
+    static const uint32_t esperas[] = {
+        0, 1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 262145,
+        TEMPORIZADOR_MAXIMO - 1, TEMPORIZADOR_MAXIMO, TEMPORIZADOR_MAXIMO + 1,
+    };
+
+    for (size_t primera = 0; primera < CANTIDAD(esperas); primera += LOTE) {
+        size_t cantidad = CANTIDAD(esperas) - primera < LOTE ? CANTIDAD(esperas) - primera : LOTE;
+        uint32_t inicio, mayor = 0;
+
+        AvanzarHastaFase(fase);
+        inicio = tick;
+        for (size_t indice = 0; indice < cantidad; indice++) {
+            uint32_t espera = esperas[primera + indice];
+            uint32_t efectiva = espera == 0                     ? 1
+                                : espera > TEMPORIZADOR_MAXIMO ? TEMPORIZADOR_MAXIMO
+                                                               : espera;
+
+            registros[indice] = (registro_s){.esperado = inicio + efectiva};
+            TemporizadorIniciar(lote[indice], espera, 0);
+            VERIFICAR(TemporizadorRestante(lote[indice]) == efectiva,
+                      "bordes en la fase %" PRIu32 ": espera %" PRIu32 ", faltan %" PRIu32, fase,
+                      espera, TemporizadorRestante(lote[indice]));
+            if (efectiva > mayor) {
+                mayor = efectiva;
+            }
+        }
+        Avanzar(mayor + 1);
+        for (size_t indice = 0; indice < cantidad; indice++) {
+            uint32_t espera = esperas[primera + indice];
+
+            VERIFICAR(registros[indice].vencimientos == 1 &&
+                          registros[indice].ultimo == registros[indice].esperado,
+                      "bordes en la fase %" PRIu32 ": espera %" PRIu32 " vencio %" PRIu32
+                      " veces, en el tick %" PRIu32 " y no en el %" PRIu32,
+                      fase, espera, registros[indice].vencimientos,
+                      registros[indice].ultimo - inicio, registros[indice].esperado - inicio);
+            VERIFICAR(!TemporizadorActivo(lote[indice]) && TemporizadorRestante(lote[indice]) == 0,
+                      "bordes en la fase %" PRIu32 ": espera %" PRIu32 " sigue activo", fase,
+                      espera);
+        }
+    }
+}
+
+// El periodo se suma al vencimiento anterior y no al tick en que se atendio
+static void VerificarPeriodico(uint32_t espera, uint32_t periodo) {
+
+    registro_s * registro = &registros[0];
+
+    *registro = (registro_s){.esperado = tick + espera, .periodo = periodo};
+    TemporizadorIniciar(lote[0], espera, periodo);
+    Avanzar(espera + (PERIODOS - 1) * periodo);
+    VERIFICAR(registro->vencimientos == PERIODOS && registro->corridos == 0,
+              "periodico de %" PRIu32 ": %" PRIu32 " vencimientos, %" PRIu32 " fuera de tiempo",
+              periodo, registro->vencimientos, registro->corridos);
+    VERIFICAR(TemporizadorActivo(lote[0]) && TemporizadorRestante(lote[0]) == periodo,
+              "periodico de %" PRIu32 ": faltan %" PRIu32 " para el siguiente", periodo,
+              TemporizadorRestante(lote[0]));
+    TemporizadorDetener(lote[0]);
+    Avanzar(periodo);
+    VERIFICAR(registro->vencimientos == PERIODOS, "periodico de %" PRIu32 ": vencio detenido",
+              periodo);
+}
+
+// Un periodico que se detiene a si mismo, y dos que vencen en el mismo tick donde el primero
+// detiene al segundo antes de que se atienda
+static void VerificarDetenerEnAccion(void) {
+
+    memset(registros, 0, sizeof(registros));
+    registros[0] = (registro_s){.esperado = tick + 10, .periodo = 3, .detener = lote[0]};
+    TemporizadorIniciar(lote[0], 10, 3);
+    registros[1].detener = lote[2];
+    TemporizadorIniciar(lote[1], 70, 0);
+    TemporizadorIniciar(lote[2], 70, 5);
+    Avanzar(100);
+
+    VERIFICAR(registros[0].vencimientos == 1 && !TemporizadorActivo(lote[0]),
+              "detener en la accion: el propio vencio %" PRIu32 " veces",
+              registros[0].vencimientos);
+    VERIFICAR(registros[1].vencimientos == 1, "detener en la accion: el primero vencio %" PRIu32
+              " veces", registros[1].vencimientos);
+    VERIFICAR(registros[2].vencimientos == 0 && !TemporizadorActivo(lote[2]),
+              "detener en la accion: el detenido vencio %" PRIu32 " veces",
+              registros[2].vencimientos);
+    registros[0].detener = NULL;
+    registros[1].detener = NULL;
+}
+
+// Un temporizador sin accion junta sus vencimientos hasta UINT8_MAX
+static void VerificarPendientes(void) {
+
+    temporizador_t uno = TemporizadorCreate(NULL, NULL);
+    temporizador_t otro = TemporizadorCreate(NULL, NULL);
+    unsigned retirados = 0;
+
+    VERIFICAR(uno && otro, "pendientes: no hay temporizadores libres");
+    if (!uno || !otro) {
+        return;
+    }
+    TemporizadorIniciar(uno, 1, 1);
+    TemporizadorIniciar(otro, 4, 0);
+    Avanzar(10);
+    VERIFICAR(TemporizadoresPendientes(), "pendientes: no hay vencimientos pendientes");
+    while (TemporizadorVencido(otro)) {
+        retirados++;
+    }
+    VERIFICAR(retirados == 1 && TemporizadoresPendientes(),
+              "pendientes: el de un disparo tenia %u vencimientos", retirados);
+    for (retirados = 0; TemporizadorVencido(uno); retirados++) {
+    }
+    VERIFICAR(retirados == 10 && !TemporizadoresPendientes(),
+              "pendientes: el periodico tenia %u vencimientos, no 10", retirados);
+
+    Avanzar(300);
+    for (retirados = 0; TemporizadorVencido(uno); retirados++) {
+    }
+    VERIFICAR(retirados == UINT8_MAX, "pendientes: %u vencimientos despues de 300 ticks",
+              retirados);
+
+    Avanzar(7);
+    TemporizadorDetener(uno);
+    VERIFICAR(!TemporizadoresPendientes() && !TemporizadorVencido(uno),
+              "pendientes: detener no descarto los vencimientos");
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(void) {
+
+    static const uint32_t fases[] = {0, 1, 63, 4095, VUELTA - 1};
+
+    for (int indice = 0; indice < LOTE; indice++) {
+        lote[indice] = TemporizadorCreate(Anotar, &registros[indice]);
+    }
+    for (size_t indice = 0; indice < CANTIDAD(fases); indice++) {
+        VerificarBordes(fases[indice]);
+    }
+    VerificarPeriodico(1, 1);
+    VerificarPeriodico(5, 97);
+    VerificarPeriodico(64, 4096);
+    VerificarPeriodico(3, 300000);
+    VerificarDetenerEnAccion();
+    VerificarPendientes();
+    return PruebaFin("prueba_temporizador");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
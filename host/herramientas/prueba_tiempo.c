@@ -0,0 +1,175 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba de lecturas de TiempoMicros
+ **
+ ** El SysTick simulado de chip.c cuenta los ticks con TiempoTick, como el handler del firmware,
+ ** y el hilo principal lee TiempoMicros sin pausa. Cada lectura tiene que ser mayor o igual que la
+ ** anterior, tambien las que se hacen con las interrupciones deshabilitadas justo cuando vence un
+ ** periodo: ahi el tick todavia no se conto y lo compensa el pedido pendiente del SysTick. Al final
+ ** el tiempo medido tiene que coincidir con el del reloj de la PC.
+ **
+ ** En Linux el hilo principal sigue corriendo mientras el hilo de interrupciones ejecuta el
+ ** handler, cosa que en la placa no pasa: una lectura hecha entre la recarga y TiempoTick ve el
+ ** periodo nuevo sin el tick contado. Por eso cada lectura se hace con las interrupciones
+ ** deshabilitadas, que equivale a que el SysTick llegue antes o despues de ella. Nunca quedan
+ ** deshabilitadas mas de un periodo, que es la condicion que pide tiempo.h.
+ **
+ **     prueba_tiempo [-n segundos]
+ **
+ ** Termina con error si alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "tiempo.h"
+#include "chip.h"
+#include "host.h"
+#include "prueba.h"
+#include <inttypes.h>
+#include <sched.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define SEGUNDOS     2    // duracion de la prueba
+#define TICKS        1000 // ticks por segundo, como el firmware
+#define ENMASCARADAS 64   // lecturas seguidas con las interrupciones deshabilitadas
+#define SUELTAS      4096 // lecturas sueltas entre cada grupo
+#define TOLERANCIA   20   // periodos de diferencia admitidos con el reloj de la PC
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static uint64_t MicrosPc(void);
+static void Leer(void);
+static void Habilitar(void);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static unsigned segundos = SEGUNDOS;
+static unsigned long lecturas, retrocesos, pendientes;
+static uint64_t anterior, retroceso_max;
+
+/* === Private function implementation ========================================================= */
+
+static uint64_t MicrosPc(void) {
+
+    struct timespec ahora;
+
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    return (uint64_t)ahora.tv_sec * 1000000 + (uint64_t)ahora.tv_nsec / 1000;
+}
+
+// Se llama con las interrupciones deshabilitadas
+static void Leer(void) {
+
+    uint64_t actual = TiempoMicros();
+
+    lecturas++;
+    pendientes += (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0;
+    if (actual < anterior) {
+        retrocesos++;
+        if (anterior - actual > retroceso_max) {
+            retroceso_max = anterior - actual;
+        }
+    }
+    anterior = actual;
+}
+
+// En la placa un SysTick pendiente entra apenas se habilitan las interrupciones. En Linux el hilo
+// de interrupciones tiene que ganar el mutex, asi que se lo espera
+static void Habilitar(void) {
+
+    __enable_irq();
+    while (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        sched_yield();
+    }
+}
+
+/* === Public function implementation ========================================================== */
+
+// Reemplaza al handler debil de chip.c
+void SysTick_Handler(void) {
+
+    TiempoTick();
+}
+
+int main(int argc, char * argv[]) {
+
+    uint64_t inicio, fin, medido, pc;
+    int opcion;
+
+    while ((opcion = getopt(argc, argv, "n:")) != -1) {
+        switch (opcion) {
+        case 'n':
+            segundos = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        default:
+            fprintf(stderr, "uso: %s [-n segundos]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    TiempoInit(TICKS);
+    inicio = MicrosPc();
+    SysTick_Config(SystemCoreClock / TICKS);
+    // El hilo del SysTick cuenta los periodos desde que arranca, no desde SysTick_Config
+    while (HostSysTickCount() == 0) {
+        sched_yield();
+    }
+    fin = inicio + (uint64_t)segundos * 1000000;
+
+    while (MicrosPc() < fin) {
+        // Mientras estan deshabilitadas el SysTick no entra; las lecturas siguen avanzando con el
+        // contador y, si vence el periodo, con el pedido pendiente
+        __disable_irq();
+        for (int lectura = 0; lectura < ENMASCARADAS; lectura++) {
+            Leer();
+        }
+        Habilitar();
+        for (int lectura = 0; lectura < SUELTAS; lectura++) {
+            __disable_irq();
+            Leer();
+            Habilitar();
+        }
+    }
+    medido = TiempoMicros();
+    pc = MicrosPc() - inicio;
+
+    printf("%lu lecturas, %lu con el tick pendiente; medido %" PRIu64 " us, PC %" PRIu64 " us\n",
+           lecturas, pendientes, medido, pc);
+    VERIFICAR(retrocesos == 0, "%lu lecturas hacia atras, hasta %" PRIu64 " us", retrocesos,
+              retroceso_max);
+    VERIFICAR(medido + TOLERANCIA * 1000000 / TICKS >= pc &&
+                  medido <= pc + TOLERANCIA * 1000000 / TICKS,
+              "el tiempo medido difiere del de la PC");
+    return PruebaFin("prueba_tiempo");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,343 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba de la tabla de transiciones de la interfaz
+ **
+ ** Incluye src/main.c para llegar a la tabla y al estado de la interfaz, que son privados, y
+ ** llama a Despachar con cada evento en cada modo, con la hora valida o sin configurar y con la
+ ** alarma deshabilitada, habilitada o sonando; asi se recorren las dos alternativas de las celdas
+ ** con guarda. Lo esperado se calcula en Esperado a partir de la descripcion de la interfaz, no de
+ ** la tabla, y se verifica:
+ **
+ ** - el modo de destino y el parpadeo que le corresponde;
+ ** - las acciones de entrada y salida, por el temporizador de inactividad: los modos de ajuste lo
+ **   reinician al entrar y lo detienen al salir, y un evento ignorado no lo toca;
+ ** - el efecto de la accion sobre la hora, la alarma y el valor que se esta editando.
+ **
+ **     prueba_transiciones
+ **
+ ** Termina con error si alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+// El main del firmware queda con otro nombre y no se llama: la prueba arma solo lo que usa la
+// interfaz, sin SysTick ni planificador
+#define main FirmwareMain
+#include "../../src/main.c"
+#undef main
+
+#include "prueba.h"
+
+/* === Macros definitions ====================================================================== */
+
+#define TICKS_PREVIOS 10 // ticks del temporizador de inactividad antes de despachar el evento
+#define EDICION       0x084500UL // empaquetados como HHMMSS
+#define HORA          0x123400UL
+#define ALARMA        0x073000UL
+
+/* === Private data type declarations ========================================================== */
+
+typedef enum {
+    DESHABILITADA,
+    HABILITADA,
+    SONANDO,
+} alarma_t;
+
+typedef enum {
+    INACTIVA,   // el temporizador de inactividad esta detenido
+    SIGUE,      // sigue contando desde antes del evento
+    REINICIADA, // vuelve a contar MAX_IDLE_TIME segundos
+} inactividad_t;
+
+typedef struct esperado_s {
+    modo_t destino;
+    inactividad_t inactividad;
+    bool hora_valida;
+    alarma_t alarma;
+    bool edicion;  // se verifica el valor editado
+    bcd_t valor;   // HH:MM que deberia quedar en temp_input
+} esperado_s;
+
+typedef struct parpadeo_s {
+    uint8_t desde;
+    uint8_t hasta;
+    uint16_t factor;
+} parpadeo_s;
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static bool Ajuste(modo_t modo);
+static esperado_s Esperado(modo_t origen, evento_t evento, bool hora_valida, alarma_t alarma);
+static void Preparar(modo_t origen, bool hora_valida, alarma_t alarma);
+static void Comprobar(modo_t origen, evento_t evento, bool hora_valida, alarma_t alarma);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static const parpadeo_s parpadeos[MODOS] = {
+    [SIN_CONFIGURAR] = {0, 3, 250},
+    [MOSTRANDO_HORA] = {0, 3, 0},
+    [AJUSTANDO_MINUTOS_ACTUAL] = {2, 3, 250},
+    [AJUSTANDO_HORAS_ACTUAL] = {0, 1, 250},
+    [AJUSTANDO_MINUTOS_ALARMA] = {2, 3, 250},
+    [AJUSTANDO_HORAS_ALARMA] = {0, 1, 250},
+};
+
+static const char * const nombres_modo[MODOS] = {
+    [SIN_CONFIGURAR] = "SIN_CONFIGURAR",
+    [MOSTRANDO_HORA] = "MOSTRANDO_HORA",
+    [AJUSTANDO_MINUTOS_ACTUAL] = "AJUSTANDO_MINUTOS_ACTUAL",
+    [AJUSTANDO_HORAS_ACTUAL] = "AJUSTANDO_HORAS_ACTUAL",
+    [AJUSTANDO_MINUTOS_ALARMA] = "AJUSTANDO_MINUTOS_ALARMA",
+    [AJUSTANDO_HORAS_ALARMA] = "AJUSTANDO_HORAS_ALARMA",
+};
+
+static const char * const nombres_evento[EVENTOS] = {
+    [EVENTO_ACEPTAR] = "ACEPTAR",
+    [EVENTO_CANCELAR] = "CANCELAR",
+    [EVENTO_AJUSTAR_HORA] = "AJUSTAR_HORA",
+    [EVENTO_AJUSTAR_ALARMA] = "AJUSTAR_ALARMA",
+    [EVENTO_DECREMENTAR] = "DECREMENTAR",
+    [EVENTO_INCREMENTAR] = "INCREMENTAR",
+    [EVENTO_INACTIVIDAD] = "INACTIVIDAD",
+};
+
+static const char * const nombres_alarma[] = {"deshabilitada", "habilitada", "sonando"};
+
+/* === Private function implementation ========================================================= */
+
+static bool Ajuste(modo_t modo) {
+
+    return modo >= AJUSTANDO_MINUTOS_ACTUAL && modo <= AJUSTANDO_HORAS_ALARMA;
+}
+
+// Lo que deberia pasar segun el comportamiento de la interfaz. Un evento que no se atiende deja
+// todo como estaba; uno que lleva a un modo, aunque sea el mismo, pasa por la salida y la entrada
+static esperado_s Esperado(modo_t origen, evento_t evento, bool hora_valida, alarma_t alarma) {
+
+    esperado_s esperado = {
+        .destino = origen,
+        .inactividad = Ajuste(origen) ? SIGUE : INACTIVA,
+        .hora_valida = hora_valida,
+        .alarma = alarma,
+    };
+    bool cambia = false;
+    bool minutos = origen == AJUSTANDO_MINUTOS_ACTUAL || origen == AJUSTANDO_MINUTOS_ALARMA;
+
+    switch (evento) {
+    case EVENTO_AJUSTAR_HORA:
+        // F1 sostenido empieza a ajustar la hora desde cualquier modo
+        cambia = true;
+        esperado.destino = AJUSTANDO_MINUTOS_ACTUAL;
+        esperado.edicion = true;
+        esperado.valor = hora_valida ? HORA : 0;
+        break;
+    case EVENTO_AJUSTAR_ALARMA:
+        // Sin la hora configurada no se puede ajustar la alarma
+        if (origen != SIN_CONFIGURAR) {
+            cambia = true;
+            esperado.destino = AJUSTANDO_MINUTOS_ALARMA;
+            esperado.edicion = true;
+            esperado.valor = alarma == DESHABILITADA ? 0 : ALARMA;
+        }
+        break;
+    case EVENTO_ACEPTAR:
+        if (origen == MOSTRANDO_HORA) {
+            // Habilita la alarma, o pospone la que suena
+            if (alarma != HABILITADA) {
+                esperado.alarma = HABILITADA;
+            }
+        } else if (Ajuste(origen)) {
+            // De los minutos se pasa a las horas, y de las horas se confirma el valor editado
+            cambia = true;
+            if (origen == AJUSTANDO_MINUTOS_ACTUAL) {
+                esperado.destino = AJUSTANDO_HORAS_ACTUAL;
+            } else if (origen == AJUSTANDO_MINUTOS_ALARMA) {
+                esperado.destino = AJUSTANDO_HORAS_ALARMA;
+            } else if (origen == AJUSTANDO_HORAS_ACTUAL) {
+                esperado.destino = MOSTRANDO_HORA;
+                esperado.hora_valida = true;
+            } else {
+                esperado.destino = MOSTRANDO_HORA;
+                esperado.alarma = alarma == SONANDO ? SONANDO : HABILITADA;
+            }
+        }
+        break;
+    case EVENTO_CANCELAR:
+        if (origen == MOSTRANDO_HORA) {
+            // Deshabilita la alarma silenciosa, o apaga la que suena y la deja habilitada
+            if (alarma != DESHABILITADA) {
+                esperado.alarma = alarma == SONANDO ? HABILITADA : DESHABILITADA;
+            }
+        } else if (Ajuste(origen)) {
+            // De las horas se vuelve a los minutos; de los minutos se abandona el ajuste
+            cambia = true;
+            if (origen == AJUSTANDO_HORAS_ACTUAL) {
+                esperado.destino = AJUSTANDO_MINUTOS_ACTUAL;
+            } else if (origen == AJUSTANDO_HORAS_ALARMA) {
+                esperado.destino = AJUSTANDO_MINUTOS_ALARMA;
+            } else {
+                esperado.destino = hora_valida ? MOSTRANDO_HORA : SIN_CONFIGURAR;
+            }
+        }
+        break;
+    case EVENTO_INCREMENTAR:
+    case EVENTO_DECREMENTAR:
+        // Cambian el campo que se edita sin salir del modo, y reinician la espera
+        if (Ajuste(origen)) {
+            int paso = evento == EVENTO_INCREMENTAR ? 1 : -1;
+            esperado.inactividad = REINICIADA;
+            esperado.edicion = true;
+            esperado.valor = minutos ? (paso > 0 ? 0x084600 : 0x084400)
+                                   : (paso > 0 ? 0x094500 : 0x074500);
+        }
+        break;
+    case EVENTO_INACTIVIDAD:
+        if (Ajuste(origen)) {
+            cambia = true;
+            esperado.destino = hora_valida ? MOSTRANDO_HORA : SIN_CONFIGURAR;
+        }
+        break;
+    default:
+        break;
+    }
+    if (cambia) {
+        esperado.inactividad = Ajuste(esperado.destino) ? REINICIADA : INACTIVA;
+    }
+    return esperado;
+}
+
+// Arranca cada caso con un reloj nuevo y el temporizador de inactividad contando desde la entrada
+static void Preparar(modo_t origen, bool hora_valida, alarma_t alarma) {
+
+    static const uint8_t hora[6] = {1, 2, 3, 4, 0, 0};
+    static const uint8_t alarma_digitos[4] = {0, 7, 3, 0};
+
+    reloj = ClockCreate(TICKS_PER_SECOND);
+    if (hora_valida) {
+        SetClockTime(reloj, hora, sizeof(hora));
+    }
+    alarma_sonando = false;
+    BuzzerStop(board->buzzer);
+    if (alarma != DESHABILITADA) {
+        SetAlarmTime(reloj, alarma_digitos);
+    }
+    if (alarma == SONANDO) {
+        RelojPublicar(reloj, RELOJ_ALARMA);
+    }
+    BcdDesempaquetar(EDICION, temp_input, sizeof(temp_input));
+
+    TemporizadorDetener(inactividad);
+    CambiarModo(origen);
+    for (int tick = 0; tick < TICKS_PREVIOS; tick++) {
+        TemporizadorTick();
+    }
+}
+
+static void Comprobar(modo_t origen, evento_t evento, bool hora_valida, alarma_t alarma) {
+
+    esperado_s esperado = Esperado(origen, evento, hora_valida, alarma);
+    uint8_t digitos[6];
+    display_frame_s cuadro;
+    alarma_t resultado;
+    uint32_t restante;
+    char caso[96];
+
+    snprintf(caso, sizeof(caso), "%s + %s, hora %s, alarma %s", nombres_modo[origen],
+             nombres_evento[evento], hora_valida ? "valida" : "invalida", nombres_alarma[alarma]);
+    Preparar(origen, hora_valida, alarma);
+    Despachar(evento);
+
+    VERIFICAR(modo == esperado.destino, "%s: modo %s en lugar de %s", caso, nombres_modo[modo],
+              nombres_modo[esperado.destino]);
+
+    DisplayGetFrame(board->display, &cuadro);
+    VERIFICAR(cuadro.flashing_from == parpadeos[modo].desde &&
+                  cuadro.flashing_to == parpadeos[modo].hasta &&
+                  cuadro.flashing_factor == parpadeos[modo].factor,
+              "%s: parpadeo %u-%u %u", caso, cuadro.flashing_from, cuadro.flashing_to,
+              cuadro.flashing_factor);
+
+    restante = TemporizadorRestante(inactividad);
+    switch (esperado.inactividad) {
+    case INACTIVA:
+        VERIFICAR(!TemporizadorActivo(inactividad), "%s: la inactividad sigue contando", caso);
+        break;
+    case SIGUE:
+        VERIFICAR(TemporizadorActivo(inactividad) &&
+                      restante == MAX_IDLE_TIME * INT_PER_SECOND - TICKS_PREVIOS,
+                  "%s: la inactividad no sigue, quedan %u ticks", caso, restante);
+        break;
+    case REINICIADA:
+        VERIFICAR(TemporizadorActivo(inactividad) && restante == MAX_IDLE_TIME * INT_PER_SECOND,
+                  "%s: la inactividad no se reinicio, quedan %u ticks", caso, restante);
+        break;
+    }
+
+    VERIFICAR(GetClockTime(reloj, digitos, sizeof(digitos)) == esperado.hora_valida,
+              "%s: la hora %s", caso,
+              esperado.hora_valida ? "quedo sin configurar" : "quedo configurada");
+    if (!GetAlarmTime(reloj, digitos)) {
+        resultado = alarma_sonando ? -1 : DESHABILITADA;
+    } else {
+        resultado = alarma_sonando ? SONANDO : HABILITADA;
+    }
+    VERIFICAR(resultado == esperado.alarma, "%s: alarma %s en lugar de %s", caso,
+              resultado <= SONANDO ? nombres_alarma[resultado] : "deshabilitada y sonando",
+              nombres_alarma[esperado.alarma]);
+    if (esperado.edicion) {
+        bcd_t valor = BcdEmpaquetar(temp_input, sizeof(temp_input));
+        VERIFICAR(valor == esperado.valor, "%s: edicion %06X en lugar de %06X", caso,
+                  (unsigned)valor, (unsigned)esperado.valor);
+    }
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(void) {
+
+    TrazaInit();
+    board = BoardCreate();
+    reloj = ClockCreate(TICKS_PER_SECOND);
+    RelojSuscribir(reloj,
+                   RELOJ_FILTRO(RELOJ_ALARMA) | RELOJ_FILTRO(RELOJ_POSPONER) |
+                       RELOJ_FILTRO(RELOJ_CANCELAR),
+                   ActivarAlarma, NULL);
+    inactividad = TemporizadorCreate(NULL, NULL);
+    pulsacion = TemporizadorCreate(PulsacionCumplida, NULL);
+
+    for (modo_t origen = SIN_CONFIGURAR; origen < MODOS; origen++) {
+        for (evento_t evento = 0; evento < EVENTOS; evento++) {
+            for (int hora_valida = 0; hora_valida <= 1; hora_valida++) {
+                for (alarma_t alarma = DESHABILITADA; alarma <= SONANDO; alarma++) {
+                    Comprobar(origen, evento, hora_valida, alarma);
+                }
+            }
+        }
+    }
+    return PruebaFin("prueba_transiciones");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,235 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba de la traza de eventos
+ **
+ ** Registra eventos en la traza del firmware y los lee con TrazaLeer y con el decodificador de
+ ** host/herramientas/traza.c, que se incluye con su main renombrado. Verifica:
+ **
+ ** - que un inicio sin firma vacie la memoria y uno con firma conserve los registros;
+ ** - que al dar la vuelta al anillo queden los ultimos TRAZA_REGISTROS, en orden y sin mezclas;
+ ** - que el numero de registro pase de 2^32 a 0 sin saltar posiciones del anillo;
+ ** - que los campos de un registro no se pisen con valores extremos;
+ ** - que el decodificador lea lo mismo de un volcado binario y de la salida de la consola.
+ **
+ **     prueba_traza
+ **
+ ** Termina con error si alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+// El main del decodificador queda con otro nombre y no se llama: se usan sus funciones de lectura
+#define main DecodificadorMain
+#include "traza.c"
+#undef main
+
+#include "prueba.h"
+#include <inttypes.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define VUELTAS 2 // vueltas completas al anillo antes de revisarlo
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static uint64_t Esperado(uint32_t numero);
+static uint32_t Registrar(uint32_t cantidad);
+static void VerificarAnillo(const char * caso, uint32_t desde, uint32_t hasta);
+static void VerificarInicio(void);
+static void VerificarCampos(void);
+static void VerificarVuelta(void);
+static void VerificarIndice(void);
+static void VerificarBinario(void);
+static void VerificarTexto(void);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+// El registro numero n (n > 0) se escribe despues del tick n, con datos que dependen de n
+static uint64_t Esperado(uint32_t numero) {
+
+    traza_tipo_t tipo = (traza_tipo_t)(1 + numero % (TRAZA_TIPOS - 1));
+    return TRAZA_CODIFICAR(numero, tipo, numero * 7, numero ^ 0xA5A5);
+}
+
+// Registra cantidad eventos a partir de traza.siguiente, cada uno en su tick
+static uint32_t Registrar(uint32_t cantidad) {
+
+    for (uint32_t indice = 0; indice < cantidad; indice++) {
+        uint32_t numero = traza.siguiente;
+        uint64_t registro = Esperado(numero);
+
+        traza.ahora = numero - 1;
+        TrazaTick();
+        TrazaRegistrar(TRAZA_TIPO(registro), TRAZA_A(registro), TRAZA_B(registro));
+    }
+    return traza.siguiente;
+}
+
+// Cada registro desde hasta hasta es el que se escribio con ese numero
+static void VerificarAnillo(const char * caso, uint32_t desde, uint32_t hasta) {
+
+    uint32_t malos = 0;
+
+    for (uint32_t numero = desde; numero != hasta; numero++) {
+        if (TrazaLeer(numero) != Esperado(numero)) {
+            malos++;
+        }
+    }
+    VERIFICAR(malos == 0, "%s: %" PRIu32 " registros distintos de los escritos", caso, malos);
+}
+
+static void VerificarInicio(void) {
+
+    memset(&traza, 0xA5, sizeof(traza)); // basura del encendido
+    TrazaInit();
+    VERIFICAR(traza.firma == TRAZA_FIRMA, "inicio en frio: firma %08" PRIx32, traza.firma);
+    VERIFICAR(traza.reinicios == 0, "inicio en frio: %" PRIu32 " reinicios", traza.reinicios);
+    VERIFICAR(TrazaPrimero() == 0 && TrazaSiguiente() == 1, "inicio en frio: registros %" PRIu32
+              " a %" PRIu32, TrazaPrimero(), TrazaSiguiente());
+    VERIFICAR(TrazaLeer(0) == TRAZA_CODIFICAR(0, TRAZA_REINICIO, 0, 0),
+              "inicio en frio: primer registro %016" PRIx64, TrazaLeer(0));
+    VERIFICAR(TrazaLeer(1) == 0, "inicio en frio: quedo basura en el anillo");
+
+    Registrar(10);
+    uint32_t ahora = traza.ahora;
+    TrazaInit();
+    VERIFICAR(traza.reinicios == 1, "inicio en caliente: %" PRIu32 " reinicios", traza.reinicios);
+    VERIFICAR(traza.ahora == ahora, "inicio en caliente: ahora %" PRIu32 ", no %" PRIu32,
+              traza.ahora, ahora);
+    VERIFICAR(TrazaSiguiente() == 12, "inicio en caliente: siguiente %" PRIu32, TrazaSiguiente());
+    VERIFICAR(TrazaLeer(11) == TRAZA_CODIFICAR(ahora, TRAZA_REINICIO, 0, 1),
+              "inicio en caliente: registro de reinicio %016" PRIx64, TrazaLeer(11));
+    VerificarAnillo("inicio en caliente", 1, 11);
+}
+
+// Los valores extremos de cada campo no se mezclan con los vecinos
+static void VerificarCampos(void) {
+
+    static const struct {
+        uint32_t tick;
+        uint8_t tipo;
+        uint8_t a;
+        uint16_t b;
+    } casos[] = {
+        {0xFFFFFFFF, 0, 0, 0},         {0, 0xFF, 0, 0},     {0, 0, 0xFF, 0},
+        {0, 0, 0, 0xFFFF},             {0xFFFFFFFF, 0xFF, 0xFF, 0xFFFF},
+        {0x12345678, 0x9A, 0xBC, 0xDEF0},
+    };
+
+    for (unsigned indice = 0; indice < sizeof(casos) / sizeof(casos[0]); indice++) {
+        uint32_t tick = casos[indice].tick;
+        uint8_t tipo = casos[indice].tipo, a = casos[indice].a;
+        uint16_t b = casos[indice].b;
+        uint64_t registro = TRAZA_CODIFICAR(tick, tipo, a, b);
+
+        VERIFICAR(TRAZA_TICK(registro) == tick && TRAZA_TIPO(registro) == tipo &&
+                      TRAZA_A(registro) == a && TRAZA_B(registro) == b,
+                  "campos %u: %016" PRIx64, indice, registro);
+    }
+}
+
+// Despues de varias vueltas quedan exactamente los ultimos TRAZA_REGISTROS
+static void VerificarVuelta(void) {
+
+    uint32_t siguiente = Registrar(VUELTAS * TRAZA_REGISTROS + 7);
+
+    VERIFICAR(TrazaPrimero() == siguiente - TRAZA_REGISTROS, "vuelta: primero %" PRIu32
+              ", siguiente %" PRIu32, TrazaPrimero(), siguiente);
+    VerificarAnillo("vuelta", TrazaPrimero(), siguiente);
+}
+
+// Los registros alrededor de 2^32 ocupan posiciones consecutivas y no se pisan
+static void VerificarIndice(void) {
+
+    uint32_t desde = UINT32_MAX - TRAZA_REGISTROS / 2;
+
+    traza.siguiente = desde;
+    VerificarAnillo("indice", desde, Registrar(TRAZA_REGISTROS));
+}
+
+// Un volcado binario es la memoria de la traza tal cual, en un Cortex-M y en la PC little endian
+static void VerificarBinario(void) {
+
+    uint64_t * registros;
+    size_t cantidad;
+
+    cantidad = DecodificarBinario((const uint8_t *)&traza, sizeof(traza), &registros);
+    VERIFICAR(registros && cantidad == TrazaSiguiente() - TrazaPrimero(),
+              "binario: %zu registros, no %" PRIu32, cantidad, TrazaSiguiente() - TrazaPrimero());
+    for (size_t indice = 0; registros && indice < cantidad; indice++) {
+        VERIFICAR(registros[indice] == TrazaLeer(TrazaPrimero() + (uint32_t)indice),
+                  "binario: registro %zu %016" PRIx64, indice, registros[indice]);
+    }
+    free(registros);
+}
+
+// La salida del comando traza, con el eco del comando, el resumen y palabras hexadecimales que no
+// son registros
+static void VerificarTexto(void) {
+
+    static const char ruido[] = "0123456789abcdef0 x0123456789abcdef deadbeef ok\n";
+    enum { MUESTRA = 16 };
+    char texto[64 + MUESTRA * 20 + 2 * sizeof(ruido)];
+    uint64_t * registros;
+    size_t largo, cantidad;
+    uint32_t desde = TrazaSiguiente() - MUESTRA;
+
+    largo = (size_t)snprintf(texto, sizeof(texto), "> traza %" PRIu32 "\n%s", desde, ruido);
+    for (uint32_t numero = desde; numero != TrazaSiguiente(); numero++) {
+        uint64_t registro = TrazaLeer(numero);
+        largo += (size_t)snprintf(texto + largo, sizeof(texto) - largo, "%08" PRIx32 "%08" PRIx32
+                                  "\n", (uint32_t)(registro >> 32), (uint32_t)registro);
+    }
+    snprintf(texto + largo, sizeof(texto) - largo, "registros %" PRIu32 " a %" PRIu32 "\n%s",
+             desde, TrazaSiguiente(), ruido);
+
+    cantidad = DecodificarTexto(texto, &registros);
+    VERIFICAR(registros && cantidad == MUESTRA, "texto: %zu registros, no %d", cantidad, MUESTRA);
+    for (size_t indice = 0; registros && indice < cantidad && indice < MUESTRA; indice++) {
+        VERIFICAR(registros[indice] == TrazaLeer(desde + (uint32_t)indice),
+                  "texto: registro %zu %016" PRIx64, indice, registros[indice]);
+    }
+    free(registros);
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(void) {
+
+    VerificarInicio();
+    VerificarCampos();
+    VerificarVuelta();
+    VerificarBinario();
+    VerificarTexto();
+    VerificarIndice();
+    return PruebaFin("prueba_traza");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
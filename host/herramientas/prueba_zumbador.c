@@ -0,0 +1,217 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba del secuenciador del zumbador
+ **
+ ** Reproduce los patrones del zumbador sobre un controlador falso que anota cada llamada, y
+ ** avanza las notas llamando a BuzzerNextStep como lo haria la interrupcion del TIMER1. Verifica el
+ ** orden de las notas, las repeticiones, el encadenamiento de patrones y la detencion, incluido un
+ ** patron encadenado sin notas.
+ **
+ **     prueba_zumbador
+ **
+ ** Termina con error si alguna verificacion falla.
+ **
+ ** \addtogroup host Host
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "buzzer.h"
+#include "prueba.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define LLAMADAS 8 // llamadas al controlador que se guardan entre dos revisiones
+
+/* === Private data type declarations ========================================================== */
+
+typedef enum {
+    TONO,
+    SILENCIO,
+    PROGRAMAR,
+} llamada_t;
+
+typedef struct llamada_s {
+    llamada_t tipo;
+    uint16_t valor; // frecuencia de TONO o milisegundos de PROGRAMAR
+} llamada_s;
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static void Anotar(llamada_t tipo, uint16_t valor);
+static void ToneOn(uint16_t frecuencia);
+static void ToneOff(void);
+static void Schedule(uint16_t milisegundos);
+static void VerificarNota(const char * caso, unsigned paso, buzzer_nota_s nota);
+static void VerificarDetenido(const char * caso);
+static void RecorrerPatron(const char * caso, const buzzer_nota_s * notas, unsigned total,
+                           unsigned repeticiones);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static llamada_s llamadas[LLAMADAS];
+static unsigned cantidad = 0;
+static buzzer_t buzzer;
+
+// Las mismas cadencias que los patrones de buzzer.c, que no las exporta
+static const buzzer_nota_s LENTA[] = {{2700, 200}, {BUZZER_SILENCIO, 800}};
+static const buzzer_nota_s MEDIA[] = {{2700, 150}, {BUZZER_SILENCIO, 350}};
+static const buzzer_nota_s RAPIDA[] = {{2700, 100}, {BUZZER_SILENCIO, 100}};
+static const buzzer_nota_s MELODIA[] = {{523, 120}, {659, 120}, {784, 240}};
+
+static const buzzer_nota_s DOS[] = {{1000, 10}, {BUZZER_SILENCIO, 20}};
+
+// Un patron sin notas al final de una cadena: la tabla nula hace fallar cualquier lectura
+static const struct buzzer_patron_s VACIO[1] = {{NULL, 0, 1, NULL}};
+static const struct buzzer_patron_s ANTES_DEL_VACIO[1] = {{DOS, 2, 2, VACIO}};
+static const struct buzzer_patron_s TRES_VECES[1] = {{DOS, 2, 3, NULL}};
+
+/* === Private function implementation ========================================================= */
+
+static void Anotar(llamada_t tipo, uint16_t valor) {
+
+    if (cantidad < LLAMADAS) {
+        llamadas[cantidad] = (llamada_s){tipo, valor};
+    }
+    cantidad++;
+}
+
+static void ToneOn(uint16_t frecuencia) {
+    Anotar(TONO, frecuencia);
+}
+
+static void ToneOff(void) {
+    Anotar(SILENCIO, 0);
+}
+
+static void Schedule(uint16_t milisegundos) {
+    Anotar(PROGRAMAR, milisegundos);
+}
+
+// Una nota son dos llamadas: el tono o el silencio y la programacion de su fin
+static void VerificarNota(const char * caso, unsigned paso, buzzer_nota_s nota) {
+
+    VERIFICAR(cantidad == 2, "%s, nota %u: %u llamadas al controlador", caso, paso, cantidad);
+    if (nota.frecuencia == BUZZER_SILENCIO) {
+        VERIFICAR(llamadas[0].tipo == SILENCIO, "%s, nota %u: se esperaba un silencio", caso,
+                  paso);
+    } else {
+        VERIFICAR(llamadas[0].tipo == TONO && llamadas[0].valor == nota.frecuencia,
+                  "%s, nota %u: se esperaba un tono de %u Hz", caso, paso, nota.frecuencia);
+    }
+    VERIFICAR(llamadas[1].tipo == PROGRAMAR && llamadas[1].valor == nota.duracion,
+              "%s, nota %u: se esperaba programar %u ms", caso, paso, nota.duracion);
+    VERIFICAR(BuzzerIsPlaying(buzzer), "%s, nota %u: el zumbador no esta sonando", caso, paso);
+    cantidad = 0;
+}
+
+// Detenido: se cancela el temporizador y se apaga el tono
+static void VerificarDetenido(const char * caso) {
+
+    VERIFICAR(cantidad == 2 && llamadas[0].tipo == PROGRAMAR && llamadas[0].valor == 0 &&
+                  llamadas[1].tipo == SILENCIO,
+              "%s: no se detuvo el temporizador y el tono", caso);
+    VERIFICAR(!BuzzerIsPlaying(buzzer), "%s: el zumbador sigue sonando", caso);
+    cantidad = 0;
+}
+
+// Recorre las repeticiones de un patron ya iniciado; al volver la primera nota del siguiente ya
+// esta cargada, o el zumbador detenido
+static void RecorrerPatron(const char * caso, const buzzer_nota_s * notas, unsigned total,
+                           unsigned repeticiones) {
+
+    for (unsigned repeticion = 0; repeticion < repeticiones; repeticion++) {
+        for (unsigned nota = 0; nota < total; nota++) {
+            VerificarNota(caso, repeticion * total + nota, notas[nota]);
+            BuzzerNextStep(buzzer);
+        }
+    }
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(void) {
+
+    static const struct buzzer_driver_s controlador = {
+        .ToneOn = ToneOn,
+        .ToneOff = ToneOff,
+        .Schedule = Schedule,
+    };
+
+    buzzer = BuzzerCreate(&controlador);
+    VERIFICAR(cantidad == 1 && llamadas[0].tipo == SILENCIO, "BuzzerCreate no apago el tono");
+    VERIFICAR(!BuzzerIsPlaying(buzzer), "BuzzerCreate deja el zumbador sonando");
+    cantidad = 0;
+
+    // Avanzar detenido no toca el hardware
+    BuzzerNextStep(buzzer);
+    VERIFICAR(cantidad == 0, "BuzzerNextStep detenido llamo al controlador");
+
+    BuzzerPlay(buzzer, BUZZER_PATRON_BEEP);
+    RecorrerPatron("beep", (const buzzer_nota_s[]){{2000, 100}}, 1, 1);
+    VerificarDetenido("beep");
+
+    BuzzerPlay(buzzer, BUZZER_PATRON_MELODIA);
+    RecorrerPatron("melodia", MELODIA, 3, 1);
+    VerificarDetenido("melodia");
+
+    BuzzerPlay(buzzer, TRES_VECES);
+    RecorrerPatron("repeticiones", DOS, 2, 3);
+    VerificarDetenido("repeticiones");
+
+    // Diez lentas, diez medias y rapidas hasta BuzzerStop
+    BuzzerPlay(buzzer, BUZZER_PATRON_ALARMA);
+    RecorrerPatron("alarma lenta", LENTA, 2, 10);
+    RecorrerPatron("alarma media", MEDIA, 2, 10);
+    RecorrerPatron("alarma rapida", RAPIDA, 2, 100);
+    VerificarNota("alarma rapida", 200, RAPIDA[0]);
+    BuzzerStop(buzzer);
+    VerificarDetenido("alarma detenida");
+    BuzzerNextStep(buzzer);
+    VERIFICAR(cantidad == 0, "BuzzerNextStep despues de BuzzerStop llamo al controlador");
+
+    // Un patron encadenado sin notas termina la reproduccion sin leer su tabla
+    BuzzerPlay(buzzer, ANTES_DEL_VACIO);
+    RecorrerPatron("cadena vacia", DOS, 2, 2);
+    VerificarDetenido("cadena vacia");
+
+    // Reiniciar en medio de un patron vuelve a la primera nota
+    BuzzerPlay(buzzer, BUZZER_PATRON_MELODIA);
+    BuzzerNextStep(buzzer);
+    cantidad = 0;
+    BuzzerPlay(buzzer, BUZZER_PATRON_MELODIA);
+    RecorrerPatron("melodia reiniciada", MELODIA, 3, 1);
+    VerificarDetenido("melodia reiniciada");
+
+    BuzzerPlay(buzzer, NULL);
+    VerificarDetenido("patron nulo");
+    BuzzerPlay(buzzer, VACIO);
+    VerificarDetenido("patron vacio");
+
+    return PruebaFin("zumbador");
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
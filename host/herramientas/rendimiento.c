@@ -0,0 +1,701 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Banco de rendimiento de los caminos criticos
+ **
+ ** Mide en la PC el costo de las funciones que corren en la interrupcion del SysTick o en cada
+ ** tecla: el tick del reloj en sus tres casos (comun, fin de segundo y medianoche), la verificacion
+ ** de la alarma, la escritura y el refresco de la pantalla, la aritmetica BCD y las entradas
+ ** digitales. La aritmetica BCD empaquetada se mide junto a las versiones de un digito por byte que
+ ** reemplazo, copiadas aqui como referencia en los casos terminados en _escalar. Cada caso se
+ ** repite en tandas y de los tiempos por operacion de cada tanda se informan el minimo, la mediana,
+ ** el promedio, los percentiles 90 y 99 y el desvio.
+ **
+ **     rendimiento [-r tandas] [-n operaciones] [-o texto|csv|json] [-c base.csv] [-u umbral]
+ **                 [caso ...]
+ **
+ ** Con -c se compara la mediana de cada caso con la de un csv anterior y el programa termina con
+ ** error si alguno empeoro mas que el umbral, en porcentaje.
+ **
+ ** \addtogroup host Host
+ ** \brief Ejecucion del firmware en Linux
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "reloj.h"
+#include "pantalla.h"
+#include "digital.h"
+#include "bcd.h"
+#include "host.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define TANDAS       200   // tandas por caso, cada una da una muestra
+#define OPERACIONES  20000 // operaciones por tanda
+#define UMBRAL       10    // empeoramiento de la mediana, en porcentaje, que se informa como regresion
+#define NS_SEGUNDO   1000000000.0
+#define BASE_CASOS   64
+#define ENTRADAS     6     // teclas de la placa
+#define PUERTO       5     // puerto simulado de las entradas
+
+/* === Private data type declarations ========================================================== */
+
+typedef struct caso_s {
+    const char * nombre;
+    void (*preparar)(void); // deja el estado del que parte cada operacion, fuera de la medicion
+    void (*medir)(void);    // una operacion
+} caso_s;
+
+typedef struct resultado_s {
+    double minimo;
+    double mediana;
+    double promedio;
+    double p90;
+    double p99;
+    double desvio;
+} resultado_s;
+
+typedef struct base_s {
+    char nombre[32];
+    double mediana;
+} base_s;
+
+/* === Private variable declarations =========================================================== */
+
+static reloj_t reloj;
+static display_t pantalla;
+static digital_input_t entradas[ENTRADAS];
+static uint8_t digitos[6];
+static uint8_t numero[2];
+static bcd_t empaquetado;
+static uint8_t alternar;
+static volatile bool sumidero; // evita que se descarten los resultados
+
+static const uint8_t medianoche[] = {2, 3, 5, 9, 5, 9};
+static const uint8_t con_segundos[] = {1, 2, 3, 4, 5, 6};
+static const uint8_t en_punto[] = {1, 2, 3, 5, 0, 0};
+static const uint8_t alarma[] = {0, 6, 3, 0};
+static const uint8_t limite_min[] = {5, 9};
+static const uint8_t alarma_escalar[] = {1, 2, 3, 5};
+static const uint8_t valores[2][4] = {{1, 2, 3, 4}, {1, 2, 3, 5}};
+
+/* === Private function declarations =========================================================== */
+
+static void Apagar(void);
+static void Encender(uint8_t valor);
+static void CrearReloj(int ticks_por_segundo, const uint8_t * hora);
+static void CrearPantalla(uint16_t parpadeo);
+static void CrearEntradas(void);
+static void Escuchar(reloj_t reloj, reloj_evento_t evento, void * contexto);
+
+static void PrepararTickComun(void);
+static void PrepararTickSegundo(void);
+static void PrepararHora(void);
+static void PrepararEnPunto(void);
+static void PrepararEventos(void);
+static void PrepararPantalla(void);
+static void PrepararParpadeo(void);
+static void PrepararBCD(void);
+static void PrepararSegundo(void);
+static void PrepararEntradas(void);
+
+static void MedirVacio(void);
+static void MedirTick(void);
+static void MedirMedianoche(void);
+static void MedirAjuste(void);
+static void MedirAlarma(void);
+static void MedirLeerHora(void);
+static void MedirLeerVista(void);
+static void MedirLeerEmpaquetada(void);
+static void MedirPublicar(void);
+static void MedirEscribirIgual(void);
+static void MedirEscribirCambia(void);
+static void MedirRefresco(void);
+static void MedirEscribirEmpaquetado(void);
+static void MedirIncrementar(void);
+static void MedirIncrementarEscalar(void);
+static void MedirDecrementar(void);
+static void MedirDecrementarEscalar(void);
+static void MedirSegundo(void);
+static void MedirSegundoEscalar(void);
+static void MedirComparar(void);
+static void MedirCompararEscalar(void);
+static void MedirDesempaquetar(void);
+static void MedirEstado(void);
+static void MedirActivada(void);
+static void MedirFlanco(void);
+static void MedirBarrido(void);
+
+static void IncrementarEscalar(uint8_t numero[2], const uint8_t limite[2]);
+static void DecrementarEscalar(uint8_t numero[2], const uint8_t limite[2]);
+static void SegundoEscalar(uint8_t hora[6]);
+static uint32_t SegundosEscalar(const uint8_t * hora);
+
+static uint64_t Ahora(void);
+static int Comparar(const void * a, const void * b);
+static resultado_s Resumir(double * muestras, unsigned tandas);
+static resultado_s Medir(const caso_s * caso, unsigned tandas, unsigned operaciones);
+static size_t LeerBase(const char * archivo, base_s * base, size_t capacidad);
+static const base_s * BuscarBase(const base_s * base, size_t cantidad, const char * nombre);
+static bool Elegido(const char * nombre, int argc, char * argv[], int primero);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static const caso_s casos[] = {
+    {"vacio", NULL, MedirVacio},
+    {"reloj_tick_comun", PrepararTickComun, MedirTick},
+    {"reloj_tick_segundo", PrepararTickSegundo, MedirTick},
+    {"reloj_tick_medianoche", PrepararTickSegundo, MedirMedianoche},
+    {"reloj_ajuste", PrepararTickSegundo, MedirAjuste},
+    {"alarma_segundo", PrepararHora, MedirAlarma},
+    {"alarma_minuto", PrepararEnPunto, MedirAlarma},
+    {"hora_leer", PrepararHora, MedirLeerHora},
+    {"hora_leer_vista", PrepararHora, MedirLeerVista},
+    {"hora_leer_empaquetada", PrepararHora, MedirLeerEmpaquetada},
+    {"reloj_publicar", PrepararEventos, MedirPublicar},
+    {"pantalla_escribir_igual", PrepararPantalla, MedirEscribirIgual},
+    {"pantalla_escribir_cambia", PrepararPantalla, MedirEscribirCambia},
+    {"pantalla_refresco", PrepararPantalla, MedirRefresco},
+    {"pantalla_refresco_parpadeo", PrepararParpadeo, MedirRefresco},
+    {"pantalla_escribir_empaquetado", PrepararPantalla, MedirEscribirEmpaquetado},
+    {"bcd_incrementar", PrepararBCD, MedirIncrementar},
+    {"bcd_incrementar_escalar", PrepararBCD, MedirIncrementarEscalar},
+    {"bcd_decrementar", PrepararBCD, MedirDecrementar},
+    {"bcd_decrementar_escalar", PrepararBCD, MedirDecrementarEscalar},
+    {"bcd_segundo", PrepararSegundo, MedirSegundo},
+    {"bcd_segundo_escalar", PrepararSegundo, MedirSegundoEscalar},
+    {"bcd_comparar", PrepararSegundo, MedirComparar},
+    {"bcd_comparar_escalar", PrepararSegundo, MedirCompararEscalar},
+    {"bcd_desempaquetar", PrepararSegundo, MedirDesempaquetar},
+    {"entrada_estado", PrepararEntradas, MedirEstado},
+    {"entrada_activada", PrepararEntradas, MedirActivada},
+    {"entrada_flanco", PrepararEntradas, MedirFlanco},
+    {"entradas_barrido", PrepararEntradas, MedirBarrido},
+};
+
+/* === Private function implementation ========================================================= */
+
+// Referencias escalares: la aritmetica de un digito por byte que reemplazo bcd.c. No se expanden en
+// linea, como no se expandian en su modulo, para medir lo mismo que las funciones de bcd.c
+
+__attribute__((noinline)) static void IncrementarEscalar(uint8_t numero[2], const uint8_t limite[2]) {
+
+    numero[1]++;
+    if ((numero[0] == limite[0]) && (numero[1] > limite[1])) {
+        numero[0] = 0;
+        numero[1] = 0;
+    }
+    if (numero[1] > 9) {
+        numero[1] = 0;
+        numero[0]++;
+    }
+}
+
+__attribute__((noinline)) static void DecrementarEscalar(uint8_t numero[2], const uint8_t limite[2]) {
+
+    numero[1]--;
+    if ((numero[0] == 0) && ((int8_t)numero[1] < 0)) {
+        numero[0] = limite[0];
+        numero[1] = limite[1];
+    }
+    if ((int8_t)numero[1] < 0) {
+        numero[1] = 9;
+        numero[0]--;
+    }
+}
+
+// El avance de un segundo de reloj.c con los acarreos anidados
+__attribute__((noinline)) static void SegundoEscalar(uint8_t hora[6]) {
+
+    hora[5]++;
+    if (hora[5] == 10) {
+        hora[5] = 0;
+        hora[4]++;
+        if (hora[4] == 6) {
+            hora[4] = 0;
+            hora[3]++;
+            if (hora[3] == 10) {
+                hora[3] = 0;
+                hora[2]++;
+                if (hora[2] == 6) {
+                    hora[2] = 0;
+                    hora[1]++;
+                    if (hora[1] == 10 && hora[0] < 2) {
+                        hora[1] = 0;
+                        hora[0]++;
+                    } else if (hora[1] == 4 && hora[0] == 2) {
+                        hora[1] = 0;
+                        hora[0] = 0;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// La conversion a segundos con la que reloj.c comparaba la hora con la alarma
+__attribute__((noinline)) static uint32_t SegundosEscalar(const uint8_t * hora) {
+    return (hora[0] * 10 * 3600) + (hora[1] * 3600) + (hora[2] * 10 * 60) + (hora[3] * 60);
+}
+
+// Controlador de pantalla sin hardware: mide solo la logica del multiplexado
+static void Apagar(void) {
+}
+
+static void Encender(uint8_t valor) {
+    (void)valor;
+}
+
+static void CrearReloj(int ticks_por_segundo, const uint8_t * hora) {
+
+    reloj = ClockCreate(ticks_por_segundo);
+    SetClockTime(reloj, hora, 6);
+    SetAlarmTime(reloj, alarma);
+}
+
+static void CrearPantalla(uint16_t parpadeo) {
+
+    static const struct display_driver_s controlador = {
+        .ScreenTurnOff = Apagar,
+        .SegmentsTurnOn = Encender,
+        .DigitTurnOn = Encender,
+    };
+
+    pantalla = DisplayCreate(4, &controlador);
+    DisplayWriteBCD(pantalla, (uint8_t *)valores[0], 4);
+    DisplayFlashDigits(pantalla, 0, 3, parpadeo);
+}
+
+// Las entradas no se liberan, asi que se crean una sola vez para todos los casos
+static void CrearEntradas(void) {
+
+    if (!entradas[0]) {
+        for (int indice = 0; indice < ENTRADAS; indice++) {
+            entradas[indice] = DigitalInputCreate(PUERTO, indice, false);
+        }
+    }
+    for (int indice = 0; indice < ENTRADAS; indice++) {
+        HostGpioSetInput(PUERTO, indice, false);
+    }
+}
+
+// Suscriptor vacio: reloj_publicar mide solo el recorrido de la lista
+static void Escuchar(reloj_t reloj, reloj_evento_t evento, void * contexto) {
+    (void)reloj;
+    (void)evento;
+    (void)contexto;
+}
+
+// Con un segundo de 2^30 ticks todos los ticks medidos son comunes
+static void PrepararTickComun(void) {
+    CrearReloj(1 << 30, con_segundos);
+}
+
+// Con un segundo de un tick cada tick avanza la hora y verifica la alarma
+static void PrepararTickSegundo(void) {
+    CrearReloj(1, con_segundos);
+}
+
+static void PrepararHora(void) {
+    CrearReloj(1000, con_segundos);
+}
+
+static void PrepararEnPunto(void) {
+    CrearReloj(1000, en_punto);
+}
+
+// Las suscripciones no se retiran, asi que se hacen una sola vez; RELOJ_CANCELAR no lo publica
+// ningun otro caso, de modo que la lista llena no cambia lo que miden los demas
+static void PrepararEventos(void) {
+    static bool suscripto = false;
+
+    CrearReloj(1000, con_segundos);
+    if (!suscripto) {
+        for (int indice = 0; indice < RELOJ_SUSCRIPTORES; indice++) {
+            RelojSuscribir(reloj, RELOJ_FILTRO(RELOJ_CANCELAR), Escuchar, NULL);
+        }
+        suscripto = true;
+    }
+}
+
+static void PrepararPantalla(void) {
+    CrearPantalla(0);
+}
+
+static void PrepararParpadeo(void) {
+    CrearPantalla(250);
+}
+
+static void PrepararBCD(void) {
+    numero[0] = 2;
+    numero[1] = 9;
+    empaquetado = 0x002900;
+}
+
+// Todas las horas de un dia pasan por cada tanda, incluida la vuelta de 23:59:59
+static void PrepararSegundo(void) {
+    memcpy(digitos, medianoche, sizeof(digitos));
+    empaquetado = BcdEmpaquetar(medianoche, sizeof(medianoche));
+}
+
+static void PrepararEntradas(void) {
+    CrearEntradas();
+}
+
+static void MedirVacio(void) {
+}
+
+static void MedirTick(void) {
+    sumidero = RelojNuevoTick(reloj);
+}
+
+// Incluye el ajuste a 23:59:59; reloj_ajuste mide ese costo por separado
+static void MedirMedianoche(void) {
+    SetClockTime(reloj, medianoche, sizeof(medianoche));
+    sumidero = RelojNuevoTick(reloj);
+}
+
+static void MedirAjuste(void) {
+    SetClockTime(reloj, medianoche, sizeof(medianoche));
+}
+
+static void MedirAlarma(void) {
+    VerificarAlarma(reloj);
+}
+
+static void MedirLeerHora(void) {
+    sumidero = GetClockTime(reloj, digitos, sizeof(digitos));
+}
+
+static void MedirLeerVista(void) {
+    reloj_vista_s vista;
+    RelojVista(reloj, &vista);
+    sumidero = vista.hora_valida;
+}
+
+static void MedirLeerEmpaquetada(void) {
+    bcd_t hora;
+    sumidero = GetClockTimePacked(reloj, &hora);
+    empaquetado = hora;
+}
+
+// Cuatro suscriptores en la lista, la capacidad por omision
+static void MedirPublicar(void) {
+    RelojPublicar(reloj, RELOJ_CANCELAR);
+}
+
+static void MedirEscribirIgual(void) {
+    DisplayWriteBCD(pantalla, (uint8_t *)valores[0], 4);
+}
+
+// Cada escritura cambia el contenido, como al ajustar la hora con las teclas
+static void MedirEscribirCambia(void) {
+    alternar ^= 1;
+    DisplayWriteBCD(pantalla, (uint8_t *)valores[alternar], 4);
+}
+
+static void MedirRefresco(void) {
+    DisplayRefresh(pantalla);
+}
+
+static void MedirEscribirEmpaquetado(void) {
+    DisplayWritePacked(pantalla, 0x123400, 4);
+}
+
+static void MedirIncrementar(void) {
+    empaquetado = BcdIncrementar(empaquetado, BCD_MINUTOS, BCD_LIMITES);
+}
+
+static void MedirIncrementarEscalar(void) {
+    IncrementarEscalar(numero, limite_min);
+}
+
+static void MedirDecrementar(void) {
+    empaquetado = BcdDecrementar(empaquetado, BCD_MINUTOS, BCD_LIMITES);
+}
+
+static void MedirDecrementarEscalar(void) {
+    DecrementarEscalar(numero, limite_min);
+}
+
+static void MedirSegundo(void) {
+    empaquetado = BcdSegundo(empaquetado);
+}
+
+static void MedirSegundoEscalar(void) {
+    SegundoEscalar(digitos);
+}
+
+// Avanza la hora y la compara con la alarma, para que la comparacion no se resuelva de antemano
+static void MedirComparar(void) {
+    empaquetado = BcdSegundo(empaquetado);
+    sumidero = BcdComparar(empaquetado, 0x123500) == 0;
+}
+
+static void MedirCompararEscalar(void) {
+    SegundoEscalar(digitos);
+    sumidero = SegundosEscalar(digitos) == SegundosEscalar(alarma_escalar);
+}
+
+static void MedirDesempaquetar(void) {
+    BcdDesempaquetar(empaquetado, digitos, sizeof(digitos));
+    sumidero = digitos[5];
+}
+
+static void MedirEstado(void) {
+    sumidero = DigitalInputGetState(entradas[0]);
+}
+
+static void MedirActivada(void) {
+    sumidero = DigitalInputHasActivated(entradas[0]);
+}
+
+// Cada operacion cambia el nivel del pin y detecta el flanco
+static void MedirFlanco(void) {
+    alternar ^= 1;
+    HostGpioSetInput(PUERTO, 0, alternar);
+    sumidero = DigitalInputHasChanged(entradas[0]);
+}
+
+static void MedirBarrido(void) {
+    DigitalInputsScan();
+}
+
+static uint64_t Ahora(void) {
+
+    struct timespec ahora;
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    return (uint64_t)ahora.tv_sec * 1000000000ULL + (uint64_t)ahora.tv_nsec;
+}
+
+static int Comparar(const void * a, const void * b) {
+
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Ordena las muestras y calcula las estadisticas que se informan de cada caso
+static resultado_s Resumir(double * muestras, unsigned tandas) {
+
+    resultado_s resultado = {0};
+    double suma = 0, cuadrados = 0;
+
+    for (unsigned tanda = 0; tanda < tandas; tanda++) {
+        suma += muestras[tanda];
+        cuadrados += muestras[tanda] * muestras[tanda];
+    }
+    qsort(muestras, tandas, sizeof(double), Comparar);
+    resultado.minimo = muestras[0];
+    resultado.mediana = muestras[tandas / 2];
+    resultado.promedio = suma / tandas;
+    resultado.p90 = muestras[(tandas * 90) / 100];
+    resultado.p99 = muestras[(tandas * 99) / 100];
+    resultado.desvio = sqrt(fmax(cuadrados / tandas - resultado.promedio * resultado.promedio, 0));
+    return resultado;
+}
+
+static resultado_s Medir(const caso_s * caso, unsigned tandas, unsigned operaciones) {
+
+    double * muestras = malloc(tandas * sizeof(double));
+    resultado_s resultado = {0};
+
+    if (!muestras) {
+        return resultado;
+    }
+    if (caso->preparar) {
+        caso->preparar();
+    }
+    // Una tanda previa para llevar a memoria cache el codigo y los datos
+    for (unsigned operacion = 0; operacion < operaciones; operacion++) {
+        caso->medir();
+    }
+    for (unsigned tanda = 0; tanda < tandas; tanda++) {
+        if (caso->preparar) {
+            caso->preparar();
+        }
+        uint64_t inicio = Ahora();
+        for (unsigned operacion = 0; operacion < operaciones; operacion++) {
+            caso->medir();
+        }
+        muestras[tanda] = (double)(Ahora() - inicio) / operaciones;
+    }
+    resultado = Resumir(muestras, tandas);
+    free(muestras);
+    return resultado;
+}
+
+// Lee el nombre y la mediana de cada linea de un csv generado con -o csv
+static size_t LeerBase(const char * archivo, base_s * base, size_t capacidad) {
+
+    FILE * entrada = fopen(archivo, "r");
+    char linea[256];
+    size_t cantidad = 0;
+
+    if (!entrada) {
+        perror(archivo);
+        exit(EXIT_FAILURE);
+    }
+    while (cantidad < capacidad && fgets(linea, sizeof(linea), entrada)) {
+        double minimo;
+        if (sscanf(linea, "%31[^,],%*u,%*u,%lf,%lf", base[cantidad].nombre, &minimo,
+                   &base[cantidad].mediana) == 3) {
+            cantidad++;
+        }
+    }
+    fclose(entrada);
+    return cantidad;
+}
+
+static const base_s * BuscarBase(const base_s * base, size_t cantidad, const char * nombre) {
+
+    for (size_t indice = 0; indice < cantidad; indice++) {
+        if (strcmp(base[indice].nombre, nombre) == 0) {
+            return &base[indice];
+        }
+    }
+    return NULL;
+}
+
+// Sin casos en la linea de comandos se miden todos; si no, los que contienen alguno de los textos
+static bool Elegido(const char * nombre, int argc, char * argv[], int primero) {
+
+    if (primero >= argc) {
+        return true;
+    }
+    for (int indice = primero; indice < argc; indice++) {
+        if (strstr(nombre, argv[indice])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(int argc, char * argv[]) {
+
+    unsigned tandas = TANDAS;
+    unsigned operaciones = OPERACIONES;
+    double umbral = UMBRAL;
+    const char * formato = "texto";
+    static base_s base[BASE_CASOS];
+    size_t en_base = 0;
+    int regresiones = 0;
+    int opcion;
+
+    while ((opcion = getopt(argc, argv, "r:n:o:c:u:")) != -1) {
+        switch (opcion) {
+        case 'r':
+            tandas = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        case 'n':
+            operaciones = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        case 'o':
+            formato = optarg;
+            break;
+        case 'c':
+            en_base = LeerBase(optarg, base, BASE_CASOS);
+            break;
+        case 'u':
+            umbral = strtod(optarg, NULL);
+            break;
+        default:
+            fprintf(stderr,
+                    "uso: %s [-r tandas] [-n operaciones] [-o texto|csv|json] [-c base.csv] "
+                    "[-u umbral] [caso ...]\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!tandas || !operaciones) {
+        fprintf(stderr, "las tandas y las operaciones deben ser mayores que cero\n");
+        return EXIT_FAILURE;
+    }
+
+    bool csv = strcmp(formato, "csv") == 0;
+    bool json = strcmp(formato, "json") == 0;
+    bool primero = true;
+
+    if (csv) {
+        printf("caso,tandas,operaciones,minimo_ns,mediana_ns,promedio_ns,p90_ns,p99_ns,desvio_ns\n");
+    } else if (json) {
+        printf("[\n");
+    } else {
+        printf("%-27s %9s %9s %9s %9s %9s %9s %9s\n", "caso (ns por operacion)", "minimo",
+               "mediana", "promedio", "p90", "p99", "desvio", en_base ? "vs base" : "");
+    }
+
+    for (size_t indice = 0; indice < sizeof(casos) / sizeof(casos[0]); indice++) {
+        const caso_s * caso = &casos[indice];
+        if (!Elegido(caso->nombre, argc, argv, optind)) {
+            continue;
+        }
+        resultado_s r = Medir(caso, tandas, operaciones);
+        const base_s * anterior = BuscarBase(base, en_base, caso->nombre);
+        double cambio = (anterior && anterior->mediana > 0)
+                            ? 100.0 * (r.mediana - anterior->mediana) / anterior->mediana
+                            : 0;
+        bool regresion = anterior && cambio > umbral;
+        regresiones += regresion;
+
+        if (csv) {
+            printf("%s,%u,%u,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n", caso->nombre, tandas, operaciones,
+                   r.minimo, r.mediana, r.promedio, r.p90, r.p99, r.desvio);
+        } else if (json) {
+            printf("%s  {\"caso\": \"%s\", \"tandas\": %u, \"operaciones\": %u, \"minimo_ns\": %.2f, "
+                   "\"mediana_ns\": %.2f, \"promedio_ns\": %.2f, \"p90_ns\": %.2f, "
+                   "\"p99_ns\": %.2f, \"desvio_ns\": %.2f",
+                   primero ? "" : ",\n", caso->nombre, tandas, operaciones, r.minimo, r.mediana,
+                   r.promedio, r.p90, r.p99, r.desvio);
+            if (anterior) {
+                printf(", \"cambio_pct\": %.1f, \"regresion\": %s", cambio,
+                       regresion ? "true" : "false");
+            }
+            printf("}");
+        } else {
+            printf("%-27s %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f", caso->nombre, r.minimo, r.mediana,
+                   r.promedio, r.p90, r.p99, r.desvio);
+            if (anterior) {
+                printf(" %+8.1f%%%s", cambio, regresion ? " REGRESION" : "");
+            }
+            printf("\n");
+        }
+        primero = false;
+    }
+    if (json) {
+        printf("\n]\n");
+    }
+    if (regresiones) {
+        fprintf(stderr, "%d casos empeoraron mas de %.0f %%\n", regresiones, umbral);
+    }
+    return regresiones ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,196 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Prueba de lecturas concurrentes del reloj
+ **
+ ** Como el lazo principal en la placa, el programa lee el reloj sin parar con RelojVista,
+ ** GetClockTime y GetClockTimePacked, y un temporizador lo interrumpe cada INTERRUPCION_US
+ ** microsegundos en cualquier instruccion. La interrupcion avanza el reloj SEGUNDOS segundos y
+ ** programa la alarma con los minutos y los segundos de la hora nueva, asi que entre interrupciones
+ ** la alarma siempre es la hora corrida dos digitos.
+ **
+ ** Cada lectura tiene que tener digitos BCD validos dentro de 23:59:59 y la hora no puede volver
+ ** atras salvo al pasar la medianoche. En cada vista la alarma tiene que corresponder a la hora:
+ ** una vista que toma la hora de antes de una interrupcion y la alarma de despues, o que mezcla dos
+ ** segundos como 09:50:00 entre 09:59:59 y 10:00:00, viola alguna de las tres.
+ **
+ **     tortura [-n vueltas]
+ **
+ ** Termina con error si alguna lectura fue inconsistente.
+ **
+ ** \addtogroup host Host
+ ** \brief Ejecucion del firmware en Linux
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "reloj.h"
+#include "bcd.h"
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define VUELTAS         5   // dias completos que avanza el reloj
+#define SEGUNDOS        53 // segundos que avanza cada interrupcion
+#define INTERRUPCION_US 25 // periodo de las interrupciones; cada una dura bastante menos
+#define DIAS()          __atomic_load_n(&dias, __ATOMIC_SEQ_CST)
+
+// La alarma guarda HHMM en la misma posicion que la hora; aqui lleva los MMSS de la hora
+#define ALARMA(hora) (((hora) << 8) & 0xFFFF00UL)
+
+/* === Private data type declarations ========================================================== */
+
+typedef struct errores_s {
+    unsigned long lecturas;
+    unsigned long digitos; // digito fuera de rango
+    unsigned long atras;   // la hora volvio atras sin pasar la medianoche
+    unsigned long alarma;  // la alarma no corresponde a la hora de la misma vista
+} errores_s;
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static void Interrupcion(int senal);
+static bool Valida(bcd_t hora);
+static void Revisar(errores_s * errores, bcd_t hora, bcd_t * anterior, unsigned * dia_anterior,
+                    unsigned antes, unsigned despues);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static reloj_t reloj;
+static unsigned vueltas = VUELTAS;
+static unsigned dias;       // medianoches que paso la interrupcion, se cuentan antes de pasarlas
+static bool terminado;
+
+/* === Private function implementation ========================================================= */
+
+static void Interrupcion(int senal) {
+
+    uint8_t digitos[6];
+    bcd_t hora;
+
+    (void)senal;
+    for (unsigned segundo = 0; segundo < SEGUNDOS && !terminado; segundo++) {
+        GetClockTimePacked(reloj, &hora);
+        if (hora == BCD_LIMITES && __atomic_add_fetch(&dias, 1, __ATOMIC_SEQ_CST) == vueltas) {
+            __atomic_store_n(&terminado, true, __ATOMIC_SEQ_CST);
+        }
+        RelojNuevoTick(reloj);
+    }
+    GetClockTimePacked(reloj, &hora);
+    BcdDesempaquetar(hora, digitos, sizeof(digitos));
+    SetAlarmTime(reloj, &digitos[2]);
+}
+
+static bool Valida(bcd_t hora) {
+
+    uint8_t digitos[6];
+
+    if (hora > BCD_LIMITES) {
+        return false;
+    }
+    BcdDesempaquetar(hora, digitos, sizeof(digitos));
+    return digitos[1] <= 9 && digitos[2] <= 5 && digitos[3] <= 9 && digitos[4] <= 5 &&
+           digitos[5] <= 9 && (digitos[0] < 2 || digitos[1] <= 3);
+}
+
+// Las medianoches se cuentan antes y despues de cada lectura. La hora puede volver atras si la
+// interrupcion conto otra entre el comienzo de la lectura anterior y el final de esta, o si la
+// anterior fue 23:59:59 y la interrupcion ya la habia contado
+static void Revisar(errores_s * errores, bcd_t hora, bcd_t * anterior, unsigned * dia_anterior,
+                    unsigned antes, unsigned despues) {
+
+    errores->lecturas++;
+    if (!Valida(hora)) {
+        errores->digitos++;
+    } else if (hora < *anterior && despues == *dia_anterior && *anterior != BCD_LIMITES) {
+        errores->atras++;
+    }
+    *anterior = hora;
+    *dia_anterior = antes;
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(int argc, char * argv[]) {
+
+    static const uint8_t inicio[] = {0, 9, 5, 9, 5, 0};
+    struct itimerval periodo = {{0, INTERRUPCION_US}, {0, INTERRUPCION_US}};
+    errores_s errores = {0};
+    reloj_vista_s vista;
+    uint8_t digitos[6];
+    bcd_t hora, anterior = 0;
+    unsigned dia, dia_anterior = 0;
+    int opcion;
+
+    while ((opcion = getopt(argc, argv, "n:")) != -1) {
+        switch (opcion) {
+        case 'n':
+            vueltas = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        default:
+            fprintf(stderr, "uso: %s [-n vueltas]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (vueltas == 0) {
+        return EXIT_SUCCESS;
+    }
+
+    reloj = ClockCreate(1);
+    SetClockTime(reloj, inicio, sizeof(inicio));
+    SetAlarmTime(reloj, &inicio[2]);
+    sigaction(SIGALRM, &(struct sigaction){.sa_handler = Interrupcion, .sa_flags = SA_RESTART},
+              NULL);
+    setitimer(ITIMER_REAL, &periodo, NULL);
+
+    while (!__atomic_load_n(&terminado, __ATOMIC_SEQ_CST)) {
+        dia = DIAS();
+        RelojVista(reloj, &vista);
+        Revisar(&errores, vista.hora, &anterior, &dia_anterior, dia, DIAS());
+        if (vista.alarma != ALARMA(vista.hora)) {
+            errores.alarma++;
+        }
+
+        dia = DIAS();
+        GetClockTime(reloj, digitos, sizeof(digitos));
+        Revisar(&errores, BcdEmpaquetar(digitos, sizeof(digitos)), &anterior, &dia_anterior, dia,
+                DIAS());
+
+        dia = DIAS();
+        GetClockTimePacked(reloj, &hora);
+        Revisar(&errores, hora, &anterior, &dia_anterior, dia, DIAS());
+    }
+    setitimer(ITIMER_REAL, &(struct itimerval){0}, NULL);
+
+    printf("%u dias, %lu lecturas: %lu con digitos invalidos, %lu hacia atras, %lu con alarma "
+           "de otra hora\n",
+           vueltas, errores.lecturas, errores.digitos, errores.atras, errores.alarma);
+    return (errores.digitos || errores.atras || errores.alarma) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,276 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Decodificador de la traza de eventos
+ **
+ ** Convierte la traza del firmware en una linea de tiempo legible. Acepta un volcado binario de la
+ ** variable traza, tomado con el depurador, o la salida en texto del comando 'traza' de la consola,
+ ** de la que se toman los registros de 16 digitos hexadecimales e ignora el resto.
+ **
+ **     traza [-t ticks_por_segundo] [archivo]
+ **
+ ** \addtogroup host Host
+ ** \brief Ejecucion del firmware en Linux
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "traza.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define TICKS_POR_SEGUNDO 1000 // frecuencia del SysTick del firmware
+#define DIGITOS_REGISTRO  16   // digitos hexadecimales de un registro en la salida de la consola
+#define ENCABEZADO        16   // bytes de firma, reinicios, siguiente y ahora en un volcado
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+static const char * const eventos[TRAZA_TIPOS] = {
+    [TRAZA_NINGUNO] = "ninguno",
+#define TRAZA_EVENTO(id, texto) [TRAZA_##id] = texto,
+#include "traza_eventos.h"
+#undef TRAZA_EVENTO
+};
+
+// Copia de modo_t de main.c
+static const char * const modos[] = {
+    "MODO_ACTUAL",
+    "SIN_CONFIGURAR",
+    "MOSTRANDO_HORA",
+    "AJUSTANDO_MINUTOS_ACTUAL",
+    "AJUSTANDO_HORAS_ACTUAL",
+    "AJUSTANDO_MINUTOS_ALARMA",
+    "AJUSTANDO_HORAS_ALARMA",
+};
+
+// Copia de board_key_t de bsp.h
+static const char * const teclas[] = {
+    "aceptar", "cancelar", "ajustar hora", "ajustar alarma", "decrementar", "incrementar",
+};
+
+// Copia de reinicio_causa_t de reinicio.h
+static const char * const causas[] = {
+    "en frio", "perro guardian", "pedido", "externo",
+};
+
+/* === Private function declarations =========================================================== */
+
+static uint8_t * LeerArchivo(FILE * archivo, size_t * tamano);
+
+static uint32_t LeerPalabra(const uint8_t * datos);
+
+static uint64_t LeerRegistro(const uint8_t * datos);
+
+static size_t DecodificarBinario(const uint8_t * datos, size_t tamano, uint64_t ** registros);
+
+static size_t DecodificarTexto(const char * texto, uint64_t ** registros);
+
+static const char * Nombre(const char * const * tabla, size_t cantidad, uint8_t valor);
+
+static void Imprimir(uint64_t registro, unsigned ticks_por_segundo);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+static uint8_t * LeerArchivo(FILE * archivo, size_t * tamano) {
+
+    size_t capacidad = 4096;
+    uint8_t * datos = malloc(capacidad + 1);
+
+    *tamano = 0;
+    while (datos) {
+        *tamano += fread(datos + *tamano, 1, capacidad - *tamano, archivo);
+        if (*tamano < capacidad) {
+            break;
+        }
+        capacidad *= 2;
+        datos = realloc(datos, capacidad + 1);
+    }
+    if (datos) {
+        datos[*tamano] = 0; // terminador para leerlo como texto
+    }
+    return datos;
+}
+
+// El firmware corre en un Cortex-M, little endian
+static uint32_t LeerPalabra(const uint8_t * datos) {
+    return (uint32_t)datos[0] | (uint32_t)datos[1] << 8 | (uint32_t)datos[2] << 16 |
+           (uint32_t)datos[3] << 24;
+}
+
+static uint64_t LeerRegistro(const uint8_t * datos) {
+    return (uint64_t)LeerPalabra(datos) | (uint64_t)LeerPalabra(datos + 4) << 32;
+}
+
+// La cantidad de registros del anillo sale del tamano del volcado, por si el firmware se compilo
+// con otro TRAZA_REGISTROS
+static size_t DecodificarBinario(const uint8_t * datos, size_t tamano, uint64_t ** registros) {
+
+    size_t capacidad = (tamano - ENCABEZADO) / sizeof(uint64_t);
+    uint32_t siguiente = LeerPalabra(datos + 8);
+    uint32_t primero = siguiente > capacidad ? siguiente - (uint32_t)capacidad : 0;
+    size_t cantidad = 0;
+
+    *registros = malloc((capacidad + 1) * sizeof(uint64_t));
+    printf("volcado binario: %zu registros, %u escritos, %u reinicios en caliente\n", capacidad,
+           siguiente, LeerPalabra(datos + 4));
+    for (uint32_t numero = primero; *registros && numero != siguiente; numero++) {
+        (*registros)[cantidad++] = LeerRegistro(datos + ENCABEZADO + (numero % capacidad) * 8);
+    }
+    return cantidad;
+}
+
+static size_t DecodificarTexto(const char * texto, uint64_t ** registros) {
+
+    const char * inicio = texto;
+    size_t capacidad = 64;
+    size_t cantidad = 0;
+
+    *registros = malloc(capacidad * sizeof(uint64_t));
+    while (*registros && *texto) {
+        size_t largo = 0;
+        while (isxdigit((unsigned char)texto[largo])) {
+            largo++;
+        }
+        if (largo == DIGITOS_REGISTRO && !isalnum((unsigned char)texto[largo]) &&
+            (texto == inicio || !isalnum((unsigned char)texto[-1]))) {
+            if (cantidad == capacidad) {
+                capacidad *= 2;
+                *registros = realloc(*registros, capacidad * sizeof(uint64_t));
+                if (!*registros) {
+                    break;
+                }
+            }
+            (*registros)[cantidad++] = strtoull(texto, NULL, 16);
+        }
+        texto += largo ? largo : 1;
+    }
+    return cantidad;
+}
+
+static const char * Nombre(const char * const * tabla, size_t cantidad, uint8_t valor) {
+    return valor < cantidad && tabla[valor] ? tabla[valor] : "?";
+}
+
+static void Imprimir(uint64_t registro, unsigned ticks_por_segundo) {
+
+    uint32_t tick = TRAZA_TICK(registro);
+    uint8_t tipo = TRAZA_TIPO(registro);
+    uint8_t a = TRAZA_A(registro);
+    uint16_t b = TRAZA_B(registro);
+
+    printf("%12.3f  %-17s", (double)tick / ticks_por_segundo,
+           Nombre(eventos, TRAZA_TIPOS, tipo));
+    switch (tipo) {
+    case TRAZA_REINICIO:
+        printf("%u reinicios en caliente", b);
+        break;
+    case TRAZA_MODO:
+        printf("%s -> %s", Nombre(modos, sizeof(modos) / sizeof(*modos), a),
+               Nombre(modos, sizeof(modos) / sizeof(*modos), (uint8_t)b));
+        break;
+    case TRAZA_TECLA:
+        printf("%s %s", Nombre(teclas, sizeof(teclas) / sizeof(*teclas), a),
+               b ? "suelta" : "presionada");
+        break;
+    case TRAZA_ALARMA:
+        printf("%s", a ? "suena" : "se silencia");
+        break;
+    case TRAZA_POSPONER:
+        printf("%u minutos", a);
+        break;
+    case TRAZA_HORA:
+    case TRAZA_AJUSTE_ALARMA:
+        printf("%x%x:%x%x", b >> 12, (b >> 8) & 0xF, (b >> 4) & 0xF, b & 0xF);
+        break;
+    case TRAZA_HABILITAR_ALARMA:
+        printf("%s", a ? "habilitada" : "deshabilitada");
+        break;
+    case TRAZA_RETOMAR:
+        printf("reinicio %s, %u ticks compensados", Nombre(causas, sizeof(causas) / sizeof(*causas), a),
+               b);
+        break;
+    case TRAZA_PANTALLA:
+        printf("%u digitos: %04x", a, b);
+        break;
+    default:
+        printf("a=%u b=%u", a, b);
+        break;
+    }
+    printf("\n");
+}
+
+/* === Public function implementation ========================================================== */
+
+int main(int argc, char * argv[]) {
+
+    unsigned ticks_por_segundo = TICKS_POR_SEGUNDO;
+    FILE * archivo = stdin;
+    uint64_t * registros;
+    uint8_t * datos;
+    size_t tamano, cantidad;
+
+    for (int indice = 1; indice < argc; indice++) {
+        if (strcmp(argv[indice], "-t") == 0 && indice + 1 < argc) {
+            ticks_por_segundo = (unsigned)strtoul(argv[++indice], NULL, 10);
+        } else if (argv[indice][0] == '-') {
+            fprintf(stderr, "uso: %s [-t ticks_por_segundo] [archivo]\n", argv[0]);
+            return EXIT_FAILURE;
+        } else if (!(archivo = fopen(argv[indice], "rb"))) {
+            perror(argv[indice]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!ticks_por_segundo) {
+        ticks_por_segundo = TICKS_POR_SEGUNDO;
+    }
+
+    datos = LeerArchivo(archivo, &tamano);
+    if (!datos) {
+        fprintf(stderr, "sin memoria\n");
+        return EXIT_FAILURE;
+    }
+    if (tamano >= ENCABEZADO + sizeof(uint64_t) && LeerPalabra(datos) == TRAZA_FIRMA) {
+        cantidad = DecodificarBinario(datos, tamano, &registros);
+    } else {
+        cantidad = DecodificarTexto((const char *)datos, &registros);
+    }
+
+    printf("    segundos  evento           datos\n");
+    for (size_t indice = 0; registros && indice < cantidad; indice++) {
+        // Un registro en cero es una posicion del anillo que nunca se escribio
+        if (registros[indice]) {
+            Imprimir(registros[indice], ticks_por_segundo);
+        }
+    }
+    free(registros);
+    free(datos);
+    return EXIT_SUCCESS;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,151 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef HOST_H
+#define HOST_H
+
+/** \brief Control y metricas del sustituto de hardware en Linux
+ **
+ ** Permite manejar las entradas simuladas, observar las salidas y leer la cantidad de accesos a
+ ** registros que hizo el firmware.
+ **
+ ** \addtogroup host Host
+ ** \brief Ejecucion del firmware en Linux
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+#define HOST_RESET_HOOKS 4 // funciones que se pueden registrar con HostSetResetHook
+
+/* === Public data type declarations =========================================================== */
+
+//! Cantidad de accesos a los registros simulados y de interrupciones atendidas
+typedef struct host_metrics_s {
+    uint64_t gpio_reads;
+    uint64_t gpio_writes;
+    uint64_t pinmux_writes;
+    uint64_t nvic_writes;
+    uint64_t systick_reads;
+    uint64_t sct_writes;
+    uint64_t timer_writes;
+    uint64_t irq_masks;
+    uint64_t wfi_sleeps;
+    uint64_t systick_interrupts;
+    uint64_t pendsv_interrupts;
+    uint64_t timer1_interrupts;
+    uint64_t clock_switches;
+    uint64_t uart_rx_bytes;
+    uint64_t uart_tx_bytes;
+    uint64_t uart_overruns; // bytes recibidos sin un canal de DMA que los tome
+} host_metrics_s;
+
+//! Funcion que se llama despues de cada escritura en un puerto GPIO
+typedef void (*host_gpio_hook_t)(uint8_t port);
+
+//! Funcion que se llama en el hilo de interrupciones antes de cada SysTick, con su numero
+typedef void (*host_tick_hook_t)(uint64_t tick);
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+const host_metrics_s * HostMetrics(void);
+
+void HostMetricsPrint(FILE * output);
+
+//! Fija el nivel que un dispositivo externo impone sobre un pin configurado como entrada
+void HostGpioSetInput(uint8_t port, uint8_t pin, bool state);
+
+bool HostGpioGetInput(uint8_t port, uint8_t pin);
+
+//! Niveles impuestos sobre todos los pines de un puerto, un bit por pin
+uint32_t HostGpioInputs(uint8_t port);
+
+void HostGpioSetHook(host_gpio_hook_t hook);
+
+//! Modo y funcion configurados con Chip_SCU_PinMuxSet para un pin del SCU
+uint16_t HostPinMux(uint8_t port, uint8_t pin);
+
+//! Cantidad de interrupciones de SysTick ocurridas desde el inicio
+uint64_t HostSysTickCount(void);
+
+//! Terminal (pty) conectada a la UART de la consola, o NULL si el firmware no la inicio
+const char * HostSerialPath(void);
+
+//! Agrega una funcion que se llama antes de reemplazar el proceso en un reinicio, en lugar de las
+//! de atexit. Se admiten hasta HOST_RESET_HOOKS.
+void HostSetResetHook(void (*hook)(void));
+
+/**
+ * @brief Instala una funcion que se llama antes de cada SysTick con las interrupciones enmascaradas.
+ *
+ * Mientras haya una instalada los niveles de HostGpioSetInput llegan al firmware recien al
+ * comenzar el SysTick siguiente, de modo que la funcion ve exactamente lo que va a leer el
+ * barrido de teclas. Si la funcion llama a HostRequestExit ese SysTick no se ejecuta.
+ */
+void HostSetTickHook(host_tick_hook_t hook);
+
+/**
+ * @brief Ejecuta los SysTick sin esperar su periodo.
+ *
+ * Cada tick se genera cuando el lazo principal se durmio con WFI despues de atender el anterior,
+ * asi el orden entre interrupciones y tareas es siempre el mismo y la simulacion avanza tan rapido
+ * como puede.
+ */
+void HostSetLockstep(bool enabled);
+
+//! Indica si las entradas vienen de una grabacion (HOST_REPRODUCIR) en lugar del teclado
+bool HostReplaying(void);
+
+//! Termina la simulacion desde un contexto seguro (el hilo de interrupciones)
+void HostRequestExit(int code);
+
+/**
+ * @brief Copia los segmentos que el multiplexado encendio por ultima vez en cada digito del poncho.
+ *
+ * @param frame destino, un byte por digito con el mismo formato que la memoria de la pantalla
+ * @param size cantidad de digitos a copiar
+ */
+void HostPanelFrame(uint8_t * frame, uint8_t size);
+
+/**
+ * @brief Cambia el estado de la tecla del poncho asociada al caracter: '1' a '4' para F1 a F4, 'a'
+ * para aceptar y 'c' para cancelar.
+ *
+ * @return true si el caracter corresponde a una tecla
+ */
+bool HostPanelToggleKey(char key);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* HOST_H */
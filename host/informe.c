@@ -0,0 +1,138 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Informe del firmware al terminar la simulacion
+ **
+ ** Al salir del ejecutable para Linux se muestran las mediciones que el firmware lleva en tiempo de
+ ** ejecucion, las mismas que en la placa se leen con el depurador.
+ **
+ ** \addtogroup host Host
+ ** \brief Ejecucion del firmware en Linux
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "host.h"
+#include "cpu.h"
+#include "digital.h"
+#include "energia.h"
+#include "planificador.h"
+#include "perfil.h"
+#include "traza.h"
+#include "chip.h"
+#include <stdlib.h>
+
+/* === Macros definitions ====================================================================== */
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+void InformeImprimir(void);
+void InformeInit(void) __attribute__((constructor));
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+void InformeImprimir(void) {
+
+    cpu_carga_s carga;
+    const estadistica_s * latencia = DigitalEventsLatency();
+    double us_por_ciclo = 1e6 / SystemCoreClock;
+
+    CpuCarga(&carga);
+    fprintf(stderr, "\n--- carga del procesador ---\n");
+    fprintf(stderr, "ciclos activo      : %llu\n", (unsigned long long)carga.ciclos_activo);
+    fprintf(stderr, "ciclos dormido     : %llu\n", (unsigned long long)carga.ciclos_dormido);
+    fprintf(stderr, "utilizacion        : %u %%\n", carga.utilizacion);
+    fprintf(stderr, "reposo             : %u %%\n", carga.reposo);
+
+    fprintf(stderr, "\n--- latencia de teclas (us) ---\n");
+    fprintf(stderr, "eventos            : %u (descartados %u)\n", latencia->cantidad,
+            DigitalEventsDropped());
+    if (latencia->cantidad) {
+        fprintf(stderr, "min / prom / max   : %.1f / %.1f / %.1f\n", latencia->minimo * us_por_ciclo,
+                EstadisticaPromedio(latencia) * us_por_ciclo, latencia->maximo * us_por_ciclo);
+        fprintf(stderr, "p50 / p90 / p99    : %.1f / %.1f / %.1f\n",
+                EstadisticaPercentil(latencia, 50) * us_por_ciclo,
+                EstadisticaPercentil(latencia, 90) * us_por_ciclo,
+                EstadisticaPercentil(latencia, 99) * us_por_ciclo);
+    }
+
+    const estadistica_s * costo = EnergiaCosto();
+    fprintf(stderr, "\n--- escalado del reloj ---\n");
+    fprintf(stderr, "cambios            : %u\n", EnergiaCambios());
+    fprintf(stderr, "ticks reducidos    : %u de %llu\n", EnergiaTicksReducidos(),
+            (unsigned long long)HostSysTickCount());
+    if (costo->cantidad) {
+        fprintf(stderr, "ciclos por cambio  : %u / %u / %u (min / prom / max)\n", costo->minimo,
+                EstadisticaPromedio(costo), costo->maximo);
+    }
+
+    fprintf(stderr, "\n--- tareas ---\n");
+    fprintf(stderr, "%-10s %4s %7s %6s %8s %6s %7s %9s %9s\n", "tarea", "prio", "periodo", "plazo",
+            "activ", "perd", "demora", "ciclos", "max");
+    for (uint8_t indice = 0; indice < PlanificadorTareas(); indice++) {
+        const tarea_informe_s * tarea = PlanificadorInforme(indice);
+        fprintf(stderr, "%-10s %4u %7u %6u %8u %6u %7u %9u %9u\n", tarea->nombre, tarea->prioridad,
+                tarea->periodo, tarea->plazo, tarea->activaciones, tarea->plazos_perdidos,
+                tarea->demora_maxima, EstadisticaPromedio(&tarea->ciclos), tarea->ciclos.maximo);
+    }
+
+    fprintf(stderr, "\n--- perfil (ciclos, sobrecarga %u descontada) ---\n", PerfilSobrecarga());
+    fprintf(stderr, "%-14s %8s %7s %7s %7s %7s %7s\n", "sonda", "cantidad", "min", "prom", "max",
+            "p50", "p99");
+    for (int sonda = 0; sonda < PERFIL_SONDAS; sonda++) {
+        const estadistica_s * ciclos = &perfil[sonda].ciclos;
+        if (ciclos->cantidad) {
+            fprintf(stderr, "%-14s %8u %7u %7u %7u %7u %7u\n", perfil[sonda].nombre,
+                    ciclos->cantidad, ciclos->minimo, EstadisticaPromedio(ciclos), ciclos->maximo,
+                    EstadisticaPercentil(ciclos, 50), EstadisticaPercentil(ciclos, 99));
+        }
+    }
+
+    // Con TRAZA_VOLCADO se guarda la memoria de la traza como la volcaria el depurador
+    const char * volcado = getenv("TRAZA_VOLCADO");
+    fprintf(stderr, "\n--- traza ---\n");
+    fprintf(stderr, "registros          : %u (en el anillo desde %u)\n", TrazaSiguiente(),
+            TrazaPrimero());
+    if (volcado) {
+        FILE * archivo = fopen(volcado, "wb");
+        if (archivo && fwrite(&traza, sizeof(traza), 1, archivo) == 1) {
+            fprintf(stderr, "volcado            : %s\n", volcado);
+        }
+        if (archivo) {
+            fclose(archivo);
+        }
+    }
+}
+
+void InformeInit(void) {
+
+    atexit(InformeImprimir);
+}
+
+/* === Public function implementation ========================================================== */
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,214 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Sustituto del poncho en Linux
+ **
+ ** Reconstruye lo que muestra la pantalla multiplexada a partir de las escrituras en los puertos
+ ** de digitos y segmentos, y permite operar las teclas desde la terminal.
+ **
+ ** \addtogroup host Host
+ ** \brief Ejecucion del firmware en Linux
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "poncho.h"
+#include "pantalla.h"
+#include "host.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define PANEL_DIGITS      4
+#define PANEL_REFRESH_US  100000 // la terminal se redibuja 10 veces por segundo
+
+/* === Private data type declarations ========================================================== */
+
+typedef struct panel_key_s {
+    char key;
+    uint8_t gpio;
+    uint8_t bit;
+} panel_key_s;
+
+/* === Private variable declarations =========================================================== */
+
+static const panel_key_s PANEL_KEYS[] = {
+    {'1', KEY_F1_GPIO, KEY_F1_BIT},         {'2', KEY_F2_GPIO, KEY_F2_BIT},
+    {'3', KEY_F3_GPIO, KEY_F3_BIT},         {'4', KEY_F4_GPIO, KEY_F4_BIT},
+    {'a', KEY_ACCEPT_GPIO, KEY_ACCEPT_BIT}, {'c', KEY_CANCEL_GPIO, KEY_CANCEL_BIT},
+};
+
+static const struct {
+    uint8_t segments;
+    char symbol;
+} PANEL_GLYPHS[] = {
+    {SEGMENT_A | SEGMENT_B | SEGMENT_C | SEGMENT_D | SEGMENT_E | SEGMENT_F, '0'},
+    {SEGMENT_B | SEGMENT_C, '1'},
+    {SEGMENT_A | SEGMENT_B | SEGMENT_D | SEGMENT_E | SEGMENT_G, '2'},
+    {SEGMENT_A | SEGMENT_B | SEGMENT_C | SEGMENT_D | SEGMENT_G, '3'},
+    {SEGMENT_B | SEGMENT_C | SEGMENT_F | SEGMENT_G, '4'},
+    {SEGMENT_A | SEGMENT_C | SEGMENT_D | SEGMENT_F | SEGMENT_G, '5'},
+    {SEGMENT_A | SEGMENT_C | SEGMENT_D | SEGMENT_E | SEGMENT_F | SEGMENT_G, '6'},
+    {SEGMENT_A | SEGMENT_B | SEGMENT_C, '7'},
+    {SEGMENT_A | SEGMENT_B | SEGMENT_C | SEGMENT_D | SEGMENT_E | SEGMENT_F | SEGMENT_G, '8'},
+    {SEGMENT_A | SEGMENT_B | SEGMENT_C | SEGMENT_F | SEGMENT_G, '9'},
+    {0, ' '},
+};
+
+static volatile uint8_t panel_frame[PANEL_DIGITS];
+static struct termios panel_terminal;
+
+/* === Private function declarations =========================================================== */
+
+void PanelGpioWritten(uint8_t port);
+char PanelGlyph(uint8_t segments);
+void * PanelKeyboardThread(void * arg);
+void * PanelRenderThread(void * arg);
+void PanelRestoreTerminal(void);
+void PanelInit(void) __attribute__((constructor));
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+// Cuando queda encendido un unico digito se guardan los segmentos que lo acompanan
+void PanelGpioWritten(uint8_t port) {
+
+    if (port != DIGITS_GPIO && port != SEGMENTS_GPIO && port != SEGMENT_P_GPIO) {
+        return;
+    }
+    uint32_t digits = LPC_GPIO_PORT->SET[DIGITS_GPIO] & DIGITS_MASK;
+    if (digits == 0 || (digits & (digits - 1))) {
+        return;
+    }
+    // DigitTurnOn enciende el bit (8 >> digito), por lo que el bit 3 es el digito 0
+    uint8_t digit = (uint8_t)(PANEL_DIGITS - 1 - __builtin_ctz(digits));
+    uint8_t segments = LPC_GPIO_PORT->SET[SEGMENTS_GPIO] & SEGMENTS_MASK;
+    if ((LPC_GPIO_PORT->SET[SEGMENT_P_GPIO] >> SEGMENT_P_BIT) & 1) {
+        segments |= SEGMENT_P;
+    }
+    panel_frame[digit] = segments;
+}
+
+char PanelGlyph(uint8_t segments) {
+
+    segments &= ~SEGMENT_P;
+    for (size_t i = 0; i < sizeof(PANEL_GLYPHS) / sizeof(PANEL_GLYPHS[0]); i++) {
+        if (PANEL_GLYPHS[i].segments == segments) {
+            return PANEL_GLYPHS[i].symbol;
+        }
+    }
+    return '?';
+}
+
+void * PanelKeyboardThread(void * arg) {
+
+    (void)arg;
+    char key;
+    while (read(STDIN_FILENO, &key, 1) == 1) {
+        if (key == 'q') {
+            HostRequestExit(0);
+        } else {
+            HostPanelToggleKey(key);
+        }
+    }
+    return NULL;
+}
+
+void * PanelRenderThread(void * arg) {
+
+    (void)arg;
+    while (1) {
+        uint8_t frame[PANEL_DIGITS];
+        char line[2 * PANEL_DIGITS + 1];
+        size_t length = 0;
+
+        HostPanelFrame(frame, sizeof(frame));
+        for (int i = 0; i < PANEL_DIGITS; i++) {
+            line[length++] = PanelGlyph(frame[i]);
+            line[length++] = (frame[i] & SEGMENT_P) ? '.' : ' ';
+        }
+        line[length] = 0;
+        fprintf(stderr, "\r[ %s]", line);
+        usleep(PANEL_REFRESH_US);
+    }
+    return NULL;
+}
+
+void PanelRestoreTerminal(void) {
+
+    tcsetattr(STDIN_FILENO, TCSANOW, &panel_terminal);
+}
+
+void PanelInit(void) {
+
+    pthread_t thread;
+
+    HostGpioSetHook(PanelGpioWritten);
+    // Al reproducir una grabacion las teclas ya estan en el archivo
+    if (HostReplaying()) {
+        return;
+    }
+    if (isatty(STDIN_FILENO)) {
+        // Cada tecla se entrega sin esperar el fin de linea y sin eco
+        struct termios raw;
+        tcgetattr(STDIN_FILENO, &panel_terminal);
+        raw = panel_terminal;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        atexit(PanelRestoreTerminal);
+        HostSetResetHook(PanelRestoreTerminal);
+
+        pthread_create(&thread, NULL, PanelKeyboardThread, NULL);
+        pthread_detach(thread);
+    }
+    if (isatty(STDERR_FILENO)) {
+        pthread_create(&thread, NULL, PanelRenderThread, NULL);
+        pthread_detach(thread);
+    }
+}
+
+/* === Public function implementation ========================================================== */
+
+void HostPanelFrame(uint8_t * frame, uint8_t size) {
+
+    for (uint8_t i = 0; i < size && i < PANEL_DIGITS; i++) {
+        frame[i] = panel_frame[i];
+    }
+}
+
+bool HostPanelToggleKey(char key) {
+
+    for (size_t i = 0; i < sizeof(PANEL_KEYS) / sizeof(PANEL_KEYS[0]); i++) {
+        if (PANEL_KEYS[i].key == key) {
+            bool state = HostGpioGetInput(PANEL_KEYS[i].gpio, PANEL_KEYS[i].bit);
+            HostGpioSetInput(PANEL_KEYS[i].gpio, PANEL_KEYS[i].bit, !state);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
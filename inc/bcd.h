@@ -0,0 +1,128 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef BCD_H
+#define BCD_H
+
+/** \brief Aritmetica BCD empaquetada
+ **
+ ** Una hora HH:MM:SS ocupa una palabra de 32 bits con un campo de dos digitos BCD por byte,
+ ** 0x00HHMMSS, de modo que se puede comparar como un entero y operar en todos los campos a la vez
+ ** con aritmetica SWAR (varios campos dentro de un registro). La suma y la resta de 1 por campo
+ ** recorren los campos elegidos uno por uno salvo que se compile con BCD_SWAR.
+ **
+ ** Los digitos sueltos, uno por byte y el mas significativo primero, como los usan la pantalla y la
+ ** consola, se alinean siempre con las horas: cuatro digitos son HH:MM y seis HH:MM:SS.
+ **
+ ** \addtogroup bcd BCD
+ ** \brief Aritmetica BCD empaquetada
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+/**
+ * Con 1, BcdIncrementar y BcdDecrementar operan en todos los campos a la vez con aritmetica SWAR.
+ * En la PC esa forma resulto mas lenta que recorrer los campos elegidos, porque la interfaz cambia
+ * uno solo y el caso comun es una comparacion y una suma; queda para medirla en el Cortex-M4.
+ */
+#ifndef BCD_SWAR
+    #define BCD_SWAR 0
+#endif
+
+//! Con BCD_SWAR, usa las instrucciones SIMD de bytes del Cortex-M4 (UADD8, USUB8, SEL) si las tiene
+#ifndef BCD_DSP
+    #if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32
+        #define BCD_DSP 1
+    #else
+        #define BCD_DSP 0
+    #endif
+#endif
+
+//! Un 1 en el campo indicado, para elegir los campos que cambian BcdIncrementar y BcdDecrementar
+#define BCD_SEGUNDOS 0x000001UL
+#define BCD_MINUTOS  0x000100UL
+#define BCD_HORAS    0x010000UL
+
+//! Mayor valor de cada campo de una hora
+#define BCD_LIMITES  0x235959UL
+
+//! Campo de una hora empaquetada, de 0x00 a 0x59
+#define BCD_CAMPO(valor, campo) (((valor) / (campo)) & 0xFF)
+
+/* === Public data type declarations =========================================================== */
+
+//! Hora empaquetada, 0x00HHMMSS. Cada campo debe ser menor que 0x80
+typedef uint32_t bcd_t;
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+//! Empaqueta cantidad digitos (2, 4 o 6) alineados con las horas; los campos que faltan quedan en 0
+bcd_t BcdEmpaquetar(const uint8_t * digitos, uint8_t cantidad);
+
+//! Separa los primeros cantidad digitos (hasta 6), uno por byte
+void BcdDesempaquetar(bcd_t valor, uint8_t * digitos, uint8_t cantidad);
+
+//! Mascara de los campos que ocupan cantidad digitos alineados con las horas
+static inline bcd_t BcdMascara(uint8_t cantidad) {
+    return (0xFFFFFFUL << (4 * (6 - cantidad))) & 0xFFFFFFUL;
+}
+
+//! Suma un segundo a una hora valida; despues de 23:59:59 sigue 00:00:00
+bcd_t BcdSegundo(bcd_t hora);
+
+/**
+ * @brief Suma 1 a los campos elegidos.
+ *
+ * @param valor numero empaquetado
+ * @param campos 1 en cada campo que se incrementa, por ejemplo BCD_MINUTOS
+ * @param limites mayor valor de cada campo; el que lo supera vuelve a 00
+ */
+bcd_t BcdIncrementar(bcd_t valor, bcd_t campos, bcd_t limites);
+
+/**
+ * @brief Resta 1 a los campos elegidos.
+ *
+ * @param valor numero empaquetado
+ * @param campos 1 en cada campo que se decrementa
+ * @param limites valor de cada campo despues de restar 1 a 00
+ */
+bcd_t BcdDecrementar(bcd_t valor, bcd_t campos, bcd_t limites);
+
+//! Compara dos valores empaquetados: negativo, cero o positivo como a - b
+static inline int BcdComparar(bcd_t a, bcd_t b) {
+    return (a > b) - (a < b);
+}
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* BCD_H */
@@ -30,6 +30,8 @@ SPDX-License-Identifier: MIT
 
 #include <digital.h>
 #include <pantalla.h>
+#include <buzzer.h>
+#include <consola.h>
 
 /* === Cabecera C++ ============================================================================ */
 
@@ -39,22 +41,39 @@ extern "C" {
 
 /* === Public macros definitions =============================================================== */
 
+//! Milisegundos sin alimentar al perro guardian hasta que reinicia el procesador
+#define BOARD_WATCHDOG_MS 250
+
 /* === Public data type declarations =========================================================== */
 
 // Se define la estructura board como publica, pero se define un puntero a una estructura constante
 // con lo cual board_s no puede ser modificada.
 typedef struct board_s {
-    digital_output_t buzzer;
+    buzzer_t buzzer;
     digital_input_t accept;
     digital_input_t cancel;
     digital_input_t set_time;
     digital_input_t set_alarm;
     digital_input_t decrement;
     digital_input_t increment;
+    digital_matrix_t keypad; // NULL si la placa no tiene teclado matricial
     display_t display;
+    consola_t consola; // NULL en la imagen del M0
+    bool watchdog_reset; // el ultimo reinicio lo provoco el perro guardian
 
 } board_s;
 
+//! Teclas de la placa, en el orden en que las identifica el buzon entre nucleos
+typedef enum {
+    BOARD_KEY_ACCEPT,
+    BOARD_KEY_CANCEL,
+    BOARD_KEY_SET_TIME,
+    BOARD_KEY_SET_ALARM,
+    BOARD_KEY_DECREMENT,
+    BOARD_KEY_INCREMENT,
+    BOARD_KEYS,
+} board_key_t;
+
 // se cambia el puntero a variable porque no me dejaba modificarlo en el main
 typedef board_s * board_t;
 
@@ -63,8 +82,36 @@ typedef board_s * board_t;
 /* === Public function declarations ============================================================ */
 
 board_t BoardCreate(void);
+//! Arranca el SysTick con una prioridad mayor que la de PendSV, que queda para su mitad diferida
 void SisTick_Init(uint16_t ticks);
 
+/**
+ * @brief Cambia la frecuencia del nucleo y reprograma el SysTick y el TIMER1 del zumbador.
+ *
+ * Lo que resta del periodo del SysTick en curso se reescala a la nueva frecuencia, por lo que los
+ * ticks no se adelantan ni se atrasan. Conviene llamarla al comienzo de un periodo (desde la
+ * interrupcion del SysTick) para que el cambio, incluida la espera del PLL, termine antes del tick
+ * siguiente.
+ */
+void BoardSetCoreClock(uint32_t frecuencia);
+
+//! Valor actual del contador de ciclos (DWT CYCCNT, o TIMER3 comun a ambos nucleos en DUAL_CORE)
+uint32_t BoardCycles(void);
+
+//! Reinicia la cuenta del perro guardian, que BoardCreate deja en marcha salvo en la imagen del M0
+void BoardWatchdogFeed(void);
+
+//! Reinicia el procesador sin cortar la alimentacion, por lo que la memoria retenida se conserva
+void BoardReset(void);
+
+//! Multiplexa un digito de la pantalla, o publica el cuadro al M0 en modo de dos nucleos
+void BoardDisplayRefresh(board_t board);
+
+digital_input_t BoardKey(board_key_t key);
+
+//! Indice de la tecla de la placa que corresponde a la entrada, o -1 si no es una de ellas
+int BoardKeyIndex(digital_input_t input);
+
 /* === End of documentation ==================================================================== */
 
 #ifdef __cplusplus
@@ -0,0 +1,92 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef BUZON_H
+#define BUZON_H
+
+/** \brief Buzon de memoria compartida entre los nucleos M4 y M0
+ **
+ ** El M4 publica cuadros de pantalla y el M0 devuelve eventos de teclas. Ambos sentidos tienen un
+ ** unico productor y un unico consumidor, por lo que alcanza con lecturas y escrituras ordenadas
+ ** con barreras de memoria: el M0 no tiene instrucciones exclusivas (LDREX/STREX).
+ **
+ ** \addtogroup buzon Buzon
+ ** \brief Comunicacion entre nucleos
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "pantalla.h"
+#include "digital.h"
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+/* === Public data type declarations =========================================================== */
+
+//! Evento de tecla detectado por el M0
+typedef struct buzon_evento_s {
+    uint32_t marca; // marca de tiempo de la deteccion, en la base de tiempo comun a ambos nucleos
+    uint8_t tecla;  // indice de la tecla en la placa
+    uint8_t flanco; // digital_edge_t
+} buzon_evento_s;
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+//! Limpia el buzon. Lo llama el M4 antes de liberar el reset del M0
+void BuzonInit(void);
+
+//! M4: publica un cuadro de pantalla sin bloquear, reemplazando al anterior
+void BuzonPublicarCuadro(const display_frame_s * cuadro);
+
+/**
+ * @brief M0: lee el ultimo cuadro publicado.
+ *
+ * @param cuadro destino de la copia
+ * @param generacion generacion del ultimo cuadro leido; se actualiza si hay uno nuevo
+ * @return true si se copio un cuadro nuevo y consistente
+ */
+bool BuzonLeerCuadro(display_frame_s * cuadro, uint32_t * generacion);
+
+//! M0: envia un evento al M4. Devuelve false si el buzon esta lleno y el evento se pierde
+bool BuzonEnviarEvento(const buzon_evento_s * evento);
+
+//! M4: retira el evento mas antiguo. Devuelve false si no hay eventos
+bool BuzonRecibirEvento(buzon_evento_s * evento);
+
+//! Eventos descartados por buzon lleno
+uint32_t BuzonEventosPerdidos(void);
+
+//! Lecturas de cuadro que se repitieron por coincidir con una escritura del M4
+uint32_t BuzonReintentos(void);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* BUZON_H */
@@ -0,0 +1,121 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef BUZZER_H
+#define BUZZER_H
+
+/** \brief Secuenciador de patrones del zumbador
+ **
+ ** Reproduce tablas de notas (frecuencia y duracion) sobre un driver que genera el tono y programa
+ ** el proximo limite de nota por hardware. La CPU solo interviene al cambiar de nota.
+ **
+ ** \addtogroup buzzer Zumbador
+ ** \brief Patrones de sonido del zumbador
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+#include <stdbool.h>
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+//! Valor de frecuencia que indica un silencio
+#define BUZZER_SILENCIO 0
+
+//! Cantidad de repeticiones que indica que el patron se repite hasta llamar a BuzzerStop
+#define BUZZER_INFINITO 0
+
+/* === Public data type declarations =========================================================== */
+
+//! puntero a la estructura buzzer_s
+typedef struct buzzer_s * buzzer_t;
+
+//! Nota de un patron: frecuencia en Hz (BUZZER_SILENCIO para pausa) y duracion en milisegundos
+typedef struct buzzer_nota_s {
+    uint16_t frecuencia;
+    uint16_t duracion;
+} buzzer_nota_s;
+
+//! Patron precompilado. Al terminar sus repeticiones continua con 'siguiente' (si no es NULL), lo
+//! que permite encadenar cadencias que se aceleran.
+typedef struct buzzer_patron_s {
+    const buzzer_nota_s * notas;
+    uint8_t cantidad;
+    uint8_t repeticiones;
+    const struct buzzer_patron_s * siguiente;
+} const * buzzer_patron_t;
+
+//! Funcion de callback para generar un tono de la frecuencia indicada
+typedef void (*buzzer_tone_on_t)(uint16_t frecuencia);
+
+//! Funcion de callback para silenciar el zumbador
+typedef void (*buzzer_tone_off_t)(void);
+
+//! Funcion de callback que programa el temporizador para avisar el fin de la nota actual. Con 0
+//! milisegundos se detiene el temporizador.
+typedef void (*buzzer_schedule_t)(uint16_t milisegundos);
+
+//! Interfaz que debe implementar la placa para manejar el zumbador
+typedef struct buzzer_driver_s {
+    buzzer_tone_on_t ToneOn;
+    buzzer_tone_off_t ToneOff;
+    buzzer_schedule_t Schedule;
+} const * const buzzer_driver_t;
+
+/* === Public variable declarations ============================================================ */
+
+//! Beep corto
+extern const struct buzzer_patron_s BUZZER_PATRON_BEEP[1];
+
+//! Cadencia de alarma: tren de beeps que se acelera hasta un tono entrecortado continuo
+extern const struct buzzer_patron_s BUZZER_PATRON_ALARMA[1];
+
+//! Melodia corta de confirmacion
+extern const struct buzzer_patron_s BUZZER_PATRON_MELODIA[1];
+
+/* === Public function declarations ============================================================ */
+
+buzzer_t BuzzerCreate(buzzer_driver_t driver);
+
+void BuzzerPlay(buzzer_t buzzer, buzzer_patron_t patron);
+
+void BuzzerStop(buzzer_t buzzer);
+
+bool BuzzerIsPlaying(buzzer_t buzzer);
+
+/**
+ * @brief Avanza a la siguiente nota del patron. La llama la placa desde la interrupcion del
+ * temporizador cuando vence la duracion programada con Schedule.
+ *
+ * @param buzzer puntero a la estructura buzzer_s
+ */
+void BuzzerNextStep(buzzer_t buzzer);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* BUZZER_H */
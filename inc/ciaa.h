@@ -99,6 +99,15 @@ extern "C" {
 #define TEC_4_GPIO 1
 #define TEC_4_BIT  9
 
+// UART2, conectada al conversor USB de la placa
+#define UART_USB_TXD_PORT 7
+#define UART_USB_TXD_PIN  1
+#define UART_USB_TXD_FUNC SCU_MODE_FUNC6
+
+#define UART_USB_RXD_PORT 7
+#define UART_USB_RXD_PIN  2
+#define UART_USB_RXD_FUNC SCU_MODE_FUNC6
+
 /* === Public data type declarations =========================================================== */
 
 /* === Public variable declarations ============================================================ */
@@ -0,0 +1,143 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef CONSOLA_H
+#define CONSOLA_H
+
+/** \brief Consola de comandos por puerto serie
+ **
+ ** Recibe lineas de texto desde un anillo que llena el DMA de la UART, las separa en palabras sin
+ ** copiarlas y llama al comando correspondiente de una tabla. Las respuestas se encolan y se envian
+ ** tambien por DMA. Todo se hace desde ConsolaProcesar, en el lazo principal: ni la recepcion ni
+ ** la transmision usan interrupciones.
+ **
+ ** \addtogroup consola Consola
+ ** \brief Consola de comandos por puerto serie
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+#include <stdbool.h>
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+//! Caracteres de una linea de comando o de respuesta, sin el fin de linea
+#define CONSOLA_LINEA_MAXIMA 80
+
+//! Palabras de una linea de comando, incluido el nombre del comando
+#define CONSOLA_ARGUMENTOS   6
+
+//! Capacidad de la cola de respuestas, en bytes
+#define CONSOLA_TRANSMISION  1024
+
+/* === Public data type declarations =========================================================== */
+
+typedef struct consola_s * consola_t;
+
+/**
+ * @brief Funcion que atiende un comando.
+ *
+ * @param argc cantidad de palabras de la linea, incluido el nombre del comando
+ * @param argv palabras de la linea; apuntan al anillo de recepcion y valen hasta que termina la
+ * llamada
+ * @return NULL si el comando se ejecuto, o el motivo del error
+ */
+typedef const char * (*consola_accion_t)(consola_t consola, uint8_t argc, char * argv[]);
+
+typedef struct consola_comando_s {
+    const char * nombre;
+    const char * ayuda; // argumentos y descripcion que muestra el comando "ayuda"
+    consola_accion_t accion;
+} consola_comando_s;
+
+//! Funcion de callback que devuelve la posicion del anillo en la que el DMA escribira el proximo
+//! caracter recibido
+typedef uint16_t (*consola_recibidos_t)(void);
+
+//! Funcion de callback que indica si el DMA paso por el final del anillo desde la consulta
+//! anterior, y borra esa marca
+typedef bool (*consola_vuelta_t)(void);
+
+//! Funcion de callback que comienza a enviar un bloque. Los datos no cambian hasta que termina.
+typedef bool (*consola_transmitir_t)(const char * datos, uint16_t cantidad);
+
+//! Funcion de callback que indica si todavia se esta enviando el ultimo bloque
+typedef bool (*consola_transmitiendo_t)(void);
+
+typedef struct consola_driver_s {
+    consola_recibidos_t Recibidos;
+    consola_vuelta_t Vuelta;
+    consola_transmitir_t Transmitir;
+    consola_transmitiendo_t Transmitiendo;
+} const * const consola_driver_t;
+
+//! Contadores de la consola
+typedef struct consola_informe_s {
+    uint32_t lineas;      // lineas atendidas, incluidas las que terminaron en error
+    uint32_t errores;     // comandos desconocidos, rechazados, lineas demasiado largas o perdidas
+    uint32_t descartados; // bytes de respuestas que no entraron en la cola de transmision
+    uint32_t desbordes;   // vueltas del DMA que pisaron caracteres sin revisar
+} consola_informe_s;
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+/**
+ * @brief Crea la consola.
+ *
+ * El anillo lo llena el DMA en forma circular. ConsolaProcesar debe llamarse antes de que el DMA
+ * de una vuelta completa: a 115200 baudios un anillo de 512 bytes alcanza para 44 ms. Si llega
+ * tarde, lo pisado no se puede recuperar: se descarta lo recibido hasta el proximo fin de linea y
+ * esa linea se cuenta como un error.
+ *
+ * @param anillo memoria de recepcion; la consola escribe en ella el fin de cada palabra
+ * @param tamano bytes del anillo
+ * @param driver funciones de la placa para recibir y transmitir
+ */
+consola_t ConsolaCreate(char * anillo, uint16_t tamano, consola_driver_t driver);
+
+//! Fija la tabla de comandos. Ademas de los de la tabla, la consola atiende "ayuda"
+void ConsolaComandos(consola_t consola, const consola_comando_s * comandos, uint8_t cantidad);
+
+//! Atiende las lineas recibidas y continua el envio de las respuestas. Nunca espera.
+void ConsolaProcesar(consola_t consola);
+
+//! Encola una linea de respuesta con formato de printf, de hasta CONSOLA_LINEA_MAXIMA caracteres
+//! mas el fin de linea. Si no entra en la cola se descarta completa. No es para interrupciones.
+void ConsolaImprimir(consola_t consola, const char * formato, ...)
+    __attribute__((format(printf, 2, 3)));
+
+//! Indica si quedan respuestas sin terminar de enviar
+bool ConsolaPendiente(consola_t consola);
+
+const consola_informe_s * ConsolaInforme(consola_t consola);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* CONSOLA_H */
@@ -0,0 +1,76 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef CPU_H
+#define CPU_H
+
+/** \brief Reposo del procesador y medicion de carga
+ **
+ ** Duerme el nucleo con WFI cuando no hay trabajo pendiente y lleva la cuenta de los ciclos que
+ ** paso despierto y dormido para conocer la utilizacion del procesador.
+ **
+ ** \addtogroup cpu CPU
+ ** \brief Reposo y utilizacion del procesador
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+/* === Public data type declarations =========================================================== */
+
+typedef struct cpu_carga_s {
+    uint64_t ciclos_activo;  // ciclos con el nucleo despierto, incluyendo interrupciones
+    uint64_t ciclos_dormido; // ciclos transcurridos dentro de WFI
+    uint8_t utilizacion;     // porcentaje de tiempo despierto
+    uint8_t reposo;          // porcentaje de tiempo dormido
+} cpu_carga_s;
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+//! Comienza la medicion. Requiere el contador de ciclos habilitado (BoardCreate)
+void CpuInit(void);
+
+//! Acumula el periodo del SysTick. Se llama en cada interrupcion del SysTick
+void CpuTick(void);
+
+/**
+ * @brief Duerme el nucleo hasta la proxima interrupcion. Se debe llamar con las interrupciones
+ * deshabilitadas, despues de verificar que no hay eventos pendientes; la interrupcion que lo
+ * despierte se atiende al volver a habilitarlas.
+ */
+void CpuDormir(void);
+
+void CpuCarga(cpu_carga_s * carga);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* CPU_H */
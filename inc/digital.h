@@ -29,6 +29,7 @@ SPDX-License-Identifier: MIT
 /* === Headers files inclusions ================================================================ */
 #include <stdint.h>
 #include <stdbool.h>
+#include "estadistica.h"
 /* === Cabecera C++ ============================================================================ */
 
 #ifdef __cplusplus
@@ -39,9 +40,32 @@ extern "C" {
 
 typedef struct digital_output_s * digital_output_t;
 typedef struct digital_input_s * digital_input_t;
+typedef struct digital_matrix_s * digital_matrix_t;
 
 /* === Public data type declarations =========================================================== */
 
+//! Flanco detectado en una entrada
+typedef enum {
+    DIGITAL_EVENT_ACTIVATED,
+    DIGITAL_EVENT_DEACTIVATED,
+} digital_edge_t;
+
+//! Evento de entrada con la marca de tiempo del momento en que se detecto el cambio
+typedef struct digital_event_s {
+    digital_input_t input;
+    digital_edge_t edge;
+    uint32_t stamp;
+} digital_event_s;
+
+//! Linea de retorno (fila) de un teclado matricial
+typedef struct digital_matrix_row_s {
+    uint8_t port;
+    uint8_t pin;
+} digital_matrix_row_s;
+
+//! Funcion que devuelve la marca de tiempo actual (ciclos, ticks, etc.)
+typedef uint32_t (*digital_timestamp_t)(void);
+
 /* === Public variable declarations ============================================================ */
 
 /* === Public function declarations ============================================================ */
@@ -55,6 +79,12 @@ void DigitalOutputToggle(digital_output_t output);
 
 digital_input_t DigitalInputCreate(uint8_t port, uint8_t pin, bool inverted);
 
+/**
+ * @brief Crea una entrada sin pin propio, cuyo estado se fija con DigitalInputPostEdge (por ejemplo
+ * una tecla leida por el otro nucleo).
+ */
+digital_input_t DigitalInputCreateRemote(void);
+
 bool DigitalInputGetState(digital_input_t input);
 
 bool DigitalInputHasChanged(digital_input_t input);
@@ -62,6 +92,73 @@ bool DigitalInputHasChanged(digital_input_t input);
 bool DigitalInputHasActivated(digital_input_t input);
 
 bool DigitalInputHasDeactivated(digital_input_t input);
+
+/**
+ * @brief Define la fuente de marcas de tiempo de los eventos y reinicia las estadisticas de latencia.
+ *
+ * @param timestamp funcion que devuelve el tiempo actual, en la unidad que se quiera medir
+ */
+void DigitalEventsInit(digital_timestamp_t timestamp);
+
+/**
+ * @brief Muestrea todas las entradas creadas y encola un evento por cada flanco. Se llama
+ * periodicamente desde una interrupcion.
+ */
+void DigitalInputsScan(void);
+
+/**
+ * @brief Fija el estado de una entrada remota y encola el evento con la marca de tiempo de su
+ * deteccion. Se llama desde una interrupcion de la misma prioridad que DigitalInputsScan.
+ */
+void DigitalInputPostEdge(digital_input_t input, digital_edge_t edge, uint32_t stamp);
+
+/**
+ * @brief Retira el evento mas antiguo de la cola.
+ *
+ * @return true si habia un evento pendiente
+ */
+bool DigitalEventGet(digital_event_s * event);
+
+//! Indica si hay eventos en la cola sin retirar
+bool DigitalEventsPending(void);
+
+/**
+ * @brief Registra la latencia entre la deteccion del evento y el momento en que se lo atiende.
+ */
+void DigitalEventHandled(const digital_event_s * event);
+
+//! Estadisticas de latencia desde la deteccion hasta la atencion de los eventos
+const estadistica_s * DigitalEventsLatency(void);
+
+//! Cantidad de eventos descartados por cola llena
+uint32_t DigitalEventsDropped(void);
+
+/**
+ * @brief Crea un teclado matricial cuyas columnas son lineas que ya se activan de a una (por ejemplo
+ * los digitos de la pantalla) y cuyas filas son entradas que se leen durante cada columna.
+ *
+ * @param rows lineas de retorno del teclado
+ * @param row_count cantidad de filas
+ * @param columns cantidad de columnas
+ * @return teclado creado o NULL si no hay instancias disponibles
+ */
+digital_matrix_t DigitalMatrixCreate(const digital_matrix_row_s * rows, uint8_t row_count,
+                                     uint8_t columns);
+
+/**
+ * @brief Devuelve la entrada correspondiente a una tecla. Se usa igual que una entrada de un solo
+ * pin (DigitalInputGetState, DigitalInputHas* y eventos).
+ */
+digital_input_t DigitalMatrixKey(digital_matrix_t matrix, uint8_t row, uint8_t column);
+
+/**
+ * @brief Lee las filas mientras la columna indicada esta activa. Al completar la ultima columna se
+ * actualiza el estado de las teclas, salvo que haya riesgo de tecla fantasma.
+ */
+void DigitalMatrixScan(digital_matrix_t matrix, uint8_t column);
+
+//! Cantidad de barridos descartados por deteccion de tecla fantasma
+uint32_t DigitalMatrixGhosts(digital_matrix_t matrix);
 /* === End of documentation ==================================================================== */
 
 #ifdef __cplusplus
@@ -0,0 +1,96 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef ENERGIA_H
+#define ENERGIA_H
+
+/** \brief Escalado del reloj del nucleo segun la actividad
+ **
+ ** Baja la frecuencia del nucleo cuando la interfaz queda inactiva y la restablece en cuanto hay
+ ** actividad (un evento de tecla o la alarma). Mide los ciclos que cuesta cada cambio.
+ **
+ ** \addtogroup energia Energia
+ ** \brief Administracion de la frecuencia del nucleo
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "estadistica.h"
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+/* === Public data type declarations =========================================================== */
+
+//! Funcion que cambia la frecuencia del nucleo manteniendo la fase del SysTick (BoardSetCoreClock)
+typedef void (*energia_reloj_t)(uint32_t frecuencia);
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+/**
+ * @brief Configura el administrador. El nucleo debe estar funcionando a la frecuencia plena.
+ *
+ * @param cambiar funcion que cambia la frecuencia del nucleo
+ * @param plena frecuencia con actividad, en Hz
+ * @param reducida frecuencia en reposo, en Hz
+ * @param espera ticks seguidos sin actividad antes de bajar la frecuencia
+ */
+void EnergiaInit(energia_reloj_t cambiar, uint32_t plena, uint32_t reducida, uint16_t espera);
+
+/**
+ * @brief Se llama al final de cada interrupcion del SysTick. Solo cuenta los ticks sin actividad y
+ * decide la frecuencia: el cambio, que espera al PLL con las interrupciones deshabilitadas, lo hace
+ * EnergiaAplicar fuera del SysTick.
+ *
+ * @param ocupado true si hay eventos pendientes, la alarma suena o la interfaz no esta en reposo
+ * @return true si hay que llamar a EnergiaAplicar
+ */
+bool EnergiaTick(bool ocupado);
+
+/**
+ * @brief Cambia la frecuencia si EnergiaTick lo pidio. Se llama desde PendSV, que corre a
+ * continuacion del SysTick, para que el periodo en curso sea el que se reescala.
+ */
+void EnergiaAplicar(void);
+
+bool EnergiaReducida(void);
+
+//! Cantidad de cambios de frecuencia realizados
+uint32_t EnergiaCambios(void);
+
+//! Ticks transcurridos con la frecuencia reducida
+uint32_t EnergiaTicksReducidos(void);
+
+//! Ciclos del nucleo que demora cada cambio de frecuencia, incluida la espera del PLL
+const estadistica_s * EnergiaCosto(void);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* ENERGIA_H */
@@ -0,0 +1,80 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef ESTADISTICA_H
+#define ESTADISTICA_H
+
+/** \brief Estadisticas acumuladas de mediciones
+ **
+ ** Mantiene minimo, maximo, promedio e histograma logaritmico (potencias de dos) de una serie de
+ ** mediciones enteras, con costo constante por muestra y sin memoria dinamica.
+ **
+ ** \addtogroup estadistica Estadistica
+ ** \brief Minimo, maximo, promedio y percentiles de mediciones
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+//! Cantidad de cubetas del histograma: la cubeta i cuenta valores en [2^(i-1), 2^i)
+#define ESTADISTICA_CUBETAS 33
+
+/* === Public data type declarations =========================================================== */
+
+typedef struct estadistica_s {
+    uint32_t minimo;
+    uint32_t maximo;
+    uint32_t cantidad;
+    uint64_t suma;
+    uint32_t histograma[ESTADISTICA_CUBETAS];
+} estadistica_s;
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+void EstadisticaReiniciar(estadistica_s * estadistica);
+
+void EstadisticaRegistrar(estadistica_s * estadistica, uint32_t valor);
+
+uint32_t EstadisticaPromedio(const estadistica_s * estadistica);
+
+/**
+ * @brief Estima un percentil a partir del histograma.
+ *
+ * @param estadistica estadistica a consultar
+ * @param percentil valor entre 0 y 100
+ * @return cota superior de la cubeta que contiene el percentil (acotada por el maximo medido)
+ */
+uint32_t EstadisticaPercentil(const estadistica_s * estadistica, uint8_t percentil);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* ESTADISTICA_H */
@@ -28,6 +28,7 @@ SPDX-License-Identifier: MIT
 
 /* === Headers files inclusions ================================================================ */
 #include <stdint.h>
+#include "bcd.h"
 /* === Cabecera C++ ============================================================================ */
 
 #ifdef __cplusplus
@@ -51,6 +52,13 @@ extern "C" {
 #define DOT_3     (1 << 3)
 #define DOT_MASK  (DOT_0 | DOT_1 | DOT_2 | DOT_3)
 
+//! Cantidad de digitos que transporta un cuadro de pantalla
+#define DISPLAY_FRAME_DIGITS 8
+
+//! Brillo maximo: la pantalla se enciende en DISPLAY_BRIGHTNESS_MAX de cada DISPLAY_BRIGHTNESS_MAX
+//! barridos. Con mas niveles el brillo minimo se veria parpadear.
+#define DISPLAY_BRIGHTNESS_MAX 4
+
 /* === Public data type declarations =========================================================== */
 
 //! puntero a la estructura display_s
@@ -76,6 +84,15 @@ typedef struct display_driver_s {
                                   // de los miembros de la estructura con ese puntero ni puedo
                                   // apuntar a otra direccion de memoria.
 
+//! Contenido completo de una pantalla: lo que otro modulo necesita para multiplexarla
+typedef struct display_frame_s {
+    uint8_t memory[DISPLAY_FRAME_DIGITS];
+    uint8_t flashing_from;
+    uint8_t flashing_to;
+    uint16_t flashing_factor;
+    uint8_t brightness;
+} display_frame_s;
+
 /* === Public variable declarations ============================================================ */
 
 /* === Public function declarations ============================================================ */
@@ -84,6 +101,9 @@ display_t DisplayCreate(uint8_t digits, display_driver_t driver);
 
 void DisplayWriteBCD(display_t display, uint8_t * numbers, uint8_t size);
 
+//! Escribe los primeros size digitos (hasta 6) de un valor empaquetado, alineados con las horas
+void DisplayWritePacked(display_t display, bcd_t numbers, uint8_t size);
+
 void DisplayRefresh(display_t display);
 
 void DisplayToggleDot(display_t display, uint8_t digit_dot);
@@ -102,6 +122,25 @@ void DisplayClearDot(display_t display, uint8_t digit_dot);
  */
 void DisplayFlashDigits(display_t display, uint8_t from, uint8_t to, uint16_t factor);
 
+/**
+ * @brief Fija el brillo de la pantalla.
+ *
+ * Los barridos encendidos se reparten de forma pareja entre los apagados, por lo que el brillo
+ * minimo sigue sin parpadear a la frecuencia de multiplexado de la placa.
+ *
+ * @param display puntero a la estructura display_s
+ * @param brightness de 0 (apagada) a DISPLAY_BRIGHTNESS_MAX; los valores mayores se limitan
+ */
+void DisplaySetBrightness(display_t display, uint8_t brightness);
+
+uint8_t DisplayGetBrightness(display_t display);
+
+//! Copia la memoria y el parpadeo de la pantalla en un cuadro
+void DisplayGetFrame(display_t display, display_frame_s * frame);
+
+//! Carga un cuadro en la pantalla. El ciclo de parpadeo solo se reinicia si cambiaron sus parametros
+void DisplaySetFrame(display_t display, const display_frame_s * frame);
+
 /* === End of documentation ==================================================================== */
 
 #ifdef __cplusplus
@@ -0,0 +1,104 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef PERFIL_H
+#define PERFIL_H
+
+/** \brief Perfilador de secciones de codigo
+ **
+ ** Mide en ciclos del nucleo (DWT CYCCNT) el tiempo de las secciones marcadas con PERFIL_INICIO y
+ ** PERFIL_FIN, y acumula minimo, maximo, promedio e histograma de cada una. Las mediciones quedan
+ ** en la tabla global perfil, que se puede leer con el depurador. Con PERFIL_HABILITADO en 0 las
+ ** macros no generan codigo.
+ **
+ ** \addtogroup perfil Perfil
+ ** \brief Perfilador de secciones de codigo
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+#include "estadistica.h"
+#include "chip.h"
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+// El M0 no tiene DWT
+#ifndef PERFIL_HABILITADO
+    #if defined(CORE_M0)
+        #define PERFIL_HABILITADO 0
+    #else
+        #define PERFIL_HABILITADO 1
+    #endif
+#endif
+
+#if PERFIL_HABILITADO
+    //! Marca el comienzo de la seccion medida por la sonda PERFIL_<sonda>
+    #define PERFIL_INICIO(sonda) uint32_t perfil_inicio_##sonda = DWT->CYCCNT
+    //! Marca el final de la seccion; debe estar en el mismo bloque que PERFIL_INICIO
+    #define PERFIL_FIN(sonda)    PerfilRegistrar(PERFIL_##sonda, DWT->CYCCNT - perfil_inicio_##sonda)
+    //! Como PERFIL_FIN, pero registra en la sonda que esta indice lugares despues de PERFIL_<sonda>
+    #define PERFIL_FIN_INDICE(sonda, indice)                                                       \
+        PerfilRegistrar(PERFIL_##sonda + (indice), DWT->CYCCNT - perfil_inicio_##sonda)
+#else
+    #define PERFIL_INICIO(sonda)
+    #define PERFIL_FIN(sonda)
+    #define PERFIL_FIN_INDICE(sonda, indice)
+#endif
+
+/* === Public data type declarations =========================================================== */
+
+typedef enum {
+#define PERFIL_SONDA(id, texto) PERFIL_##id,
+#include "perfil_sondas.h"
+#undef PERFIL_SONDA
+    PERFIL_SONDAS,
+} perfil_sonda_t;
+
+typedef struct perfil_s {
+    const char * nombre;
+    estadistica_s ciclos; // ya descontado el costo de la propia medicion
+} perfil_s;
+
+/* === Public variable declarations ============================================================ */
+
+//! Mediciones de cada sonda, indexadas por perfil_sonda_t
+extern perfil_s perfil[PERFIL_SONDAS];
+
+/* === Public function declarations ============================================================ */
+
+//! Reinicia las mediciones y calibra el costo de la medicion. Requiere el contador de ciclos
+void PerfilInit(void);
+
+void PerfilRegistrar(perfil_sonda_t sonda, uint32_t ciclos);
+
+//! Ciclos que agrega un par PERFIL_INICIO / PERFIL_FIN vacio, descontados de cada medicion
+uint32_t PerfilSobrecarga(void);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* PERFIL_H */
@@ -0,0 +1,46 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Sondas del perfilador
+ **
+ ** Lista de las secciones medidas por el perfilador. Cada entrada es PERFIL_SONDA(identificador,
+ ** nombre); perfil.h arma con ella la enumeracion PERFIL_<identificador> y perfil.c la tabla de
+ ** nombres. Este archivo se incluye varias veces a proposito y no tiene guarda.
+ **
+ ** \addtogroup perfil Perfil
+ ** @{ */
+
+PERFIL_SONDA(SYSTICK, "systick")               // SysTick_Handler completo, la mitad superior
+PERFIL_SONDA(TECLAS, "teclas")                 // DigitalInputsScan
+PERFIL_SONDA(RELOJ, "reloj")                   // RelojContarTick
+PERFIL_SONDA(DIFERIDO, "diferido")             // PendSV_Handler: RelojProcesarTicks
+PERFIL_SONDA(SEGUNDO, "segundo")               // NuevoSegundo
+PERFIL_SONDA(ALARMA, "alarma")                 // VerificarAlarma
+// RelojPublicar, una sonda por reloj_evento_t y en el mismo orden
+PERFIL_SONDA(EVENTO_SEGUNDO, "ev segundo")
+PERFIL_SONDA(EVENTO_MEDIO_SEGUNDO, "ev medio")
+PERFIL_SONDA(EVENTO_MINUTO, "ev minuto")
+PERFIL_SONDA(EVENTO_HORA, "ev hora")
+PERFIL_SONDA(EVENTO_DIA, "ev dia")
+PERFIL_SONDA(EVENTO_ALARMA, "ev alarma")
+PERFIL_SONDA(EVENTO_POSPONER, "ev posponer")
+PERFIL_SONDA(EVENTO_CANCELAR, "ev cancelar")
+PERFIL_SONDA(TEMPORIZADORES, "temporizadores") // TemporizadorTick
+PERFIL_SONDA(PANTALLA, "pantalla")             // BoardDisplayRefresh
+PERFIL_SONDA(HORA, "hora")                     // GetClockTime y DisplayWriteBCD en TareaHora
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,138 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef PLANIFICADOR_H
+#define PLANIFICADOR_H
+
+/** \brief Planificador cooperativo de tareas
+ **
+ ** Cada tarea es una funcion que se ejecuta hasta terminar cada vez que se la activa, ya sea en
+ ** forma periodica o desde una interrupcion. Entre tareas listas se elige la de mayor prioridad.
+ ** Las tareas que necesitan esperar entre activaciones pueden escribirse como protohilos con las
+ ** macros PT_*. Para cada tarea se mide el tiempo de ejecucion y se cuentan los plazos perdidos.
+ **
+ ** \addtogroup planificador Planificador
+ ** \brief Planificador cooperativo de tareas
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "estadistica.h"
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+//! Comienzo del cuerpo de un protohilo. Las variables locales no se conservan entre activaciones
+#define PT_BEGIN(pt)                                                                               \
+    switch ((pt)->linea) {                                                                         \
+    case 0:
+
+//! Termina la activacion; la siguiente continua despues de esta linea
+#define PT_YIELD(pt)                                                                               \
+    do {                                                                                           \
+        (pt)->linea = __LINE__;                                                                    \
+        return;                                                                                    \
+    case __LINE__:;                                                                                \
+    } while (0)
+
+//! Termina la activacion mientras la condicion sea falsa y se la vuelve a evaluar en la siguiente
+#define PT_WAIT_UNTIL(pt, condicion)                                                               \
+    do {                                                                                           \
+        (pt)->linea = __LINE__;                                                                    \
+    case __LINE__:                                                                                 \
+        if (!(condicion)) {                                                                        \
+            return;                                                                                \
+        }                                                                                          \
+    } while (0)
+
+//! Fin del cuerpo: la proxima activacion empieza de nuevo desde PT_BEGIN
+#define PT_END(pt)                                                                                 \
+    }                                                                                              \
+    (pt)->linea = 0
+
+/* === Public data type declarations =========================================================== */
+
+//! Estado de un protohilo: linea en la que continua
+typedef struct protohilo_s {
+    uint16_t linea;
+} protohilo_s;
+
+typedef struct tarea_s * tarea_t;
+
+typedef void (*tarea_funcion_t)(void * contexto);
+
+//! Mediciones de una tarea
+typedef struct tarea_informe_s {
+    const char * nombre;
+    uint8_t prioridad;
+    uint16_t periodo;
+    uint16_t plazo;
+    uint32_t activaciones;
+    uint32_t plazos_perdidos; // terminaron tarde o se volvieron a activar sin haber corrido
+    uint32_t demora_maxima;   // ticks entre la activacion y el final de la ejecucion
+    estadistica_s ciclos;     // ciclos del nucleo por ejecucion
+} tarea_informe_s;
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+/**
+ * @brief Crea una tarea.
+ *
+ * @param nombre nombre para los informes
+ * @param funcion cuerpo de la tarea
+ * @param contexto parametro de la funcion
+ * @param prioridad 0 es la mas alta
+ * @param periodo ticks entre activaciones, 0 si solo se activa con PlanificadorActivar
+ * @param plazo ticks desde la activacion en que la tarea debe haber terminado, 0 sin plazo
+ * @return la tarea, o NULL si no hay lugar o si ya se activo alguna: las tareas se crean al inicio
+ */
+tarea_t PlanificadorCrear(const char * nombre, tarea_funcion_t funcion, void * contexto,
+                          uint8_t prioridad, uint16_t periodo, uint16_t plazo);
+
+//! Deja la tarea lista para ejecutar. Se puede llamar desde una interrupcion
+void PlanificadorActivar(tarea_t tarea);
+
+//! Avanza un tick y libera las tareas periodicas. Se llama en cada interrupcion del SysTick
+void PlanificadorTick(void);
+
+//! Ejecuta la tarea lista de mayor prioridad. Devuelve false si no habia ninguna
+bool PlanificadorEjecutar(void);
+
+//! Indica si hay tareas listas. Se consulta con las interrupciones deshabilitadas antes de dormir
+bool PlanificadorPendiente(void);
+
+uint8_t PlanificadorTareas(void);
+
+//! Mediciones de la tarea indicada, en orden de prioridad
+const tarea_informe_s * PlanificadorInforme(uint8_t indice);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* PLANIFICADOR_H */
@@ -184,6 +184,26 @@ extern "C" {
 #define KEY_CANCEL_GPIO 5
 #define KEY_CANCEL_BIT  8
 
+// Definiciones de las lineas de retorno del teclado matricial. Las columnas son las lineas de
+// seleccion de digito de la pantalla, por lo que cada tecla une un digito con una de estas filas.
+#define KEY_ROW_1_PORT 6
+#define KEY_ROW_1_PIN  1
+#define KEY_ROW_1_FUNC SCU_MODE_FUNC0
+#define KEY_ROW_1_GPIO 3
+#define KEY_ROW_1_BIT  0
+
+#define KEY_ROW_2_PORT 6
+#define KEY_ROW_2_PIN  4
+#define KEY_ROW_2_FUNC SCU_MODE_FUNC0
+#define KEY_ROW_2_GPIO 3
+#define KEY_ROW_2_BIT  3
+
+#define KEY_ROW_3_PORT 6
+#define KEY_ROW_3_PIN  5
+#define KEY_ROW_3_FUNC SCU_MODE_FUNC0
+#define KEY_ROW_3_GPIO 3
+#define KEY_ROW_3_BIT  4
+
 // Definiciones de los recursos asociados al zumbador
 #define BUZZER_PORT 2
 #define BUZZER_PIN  2
@@ -191,6 +211,10 @@ extern "C" {
 #define BUZZER_GPIO 5
 #define BUZZER_BIT  2
 
+// El mismo pin en su funcion CTOUT_6 permite generar el tono por PWM con el SCT
+#define BUZZER_SCT_FUNC SCU_MODE_FUNC1
+#define BUZZER_SCT_OUT  6
+
 /* === Public data type declarations =========================================================== */
 
 /* === Public variable declarations ============================================================ */
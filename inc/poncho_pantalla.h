@@ -0,0 +1,97 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef PONCHO_PANTALLA_H
+#define PONCHO_PANTALLA_H
+
+/** \brief Controlador de la pantalla del poncho
+ **
+ ** Las escrituras en los GPIO de los digitos y segmentos, como funciones en linea. bsp.c las usa
+ ** para el controlador que se pasa a DisplayCreate, y pantalla.c las llama directamente cuando se
+ ** compila con -DDISPLAY_DRIVER='"poncho_pantalla.h"', de modo que el barrido no pasa por los
+ ** punteros de display_driver_s y el compilador puede expandir las escrituras en DisplayRefresh.
+ **
+ ** \addtogroup hal HAL
+ ** \brief Hardware abstraction layer
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+
+#include "chip.h"
+#include "poncho.h"
+#include <stdint.h>
+
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+// Enlace de la pantalla al compilar. ScreenOff recibe el digito que estaba encendido, que con los
+// punteros lleva el propio controlador
+#if defined(DUAL_CORE)
+    // En el M4 la pantalla solo guarda el cuadro que se publica al M0: el barrido desaparece
+    #define DISPLAY_DRIVER_SCREEN_OFF(lit)       ((void)(lit))
+    #define DISPLAY_DRIVER_SEGMENTS_ON(segments) ((void)(segments))
+    #define DISPLAY_DRIVER_DIGIT_ON(digit)       ((void)(digit))
+#else
+    #define DISPLAY_DRIVER_SCREEN_OFF(lit)       PonchoScreenTurnOff(lit)
+    #define DISPLAY_DRIVER_SEGMENTS_ON(segments) PonchoSegmentsTurnOn(segments)
+    #define DISPLAY_DRIVER_DIGIT_ON(digit)       PonchoDigitTurnOn(digit)
+#endif
+
+/* === Public data type declarations =========================================================== */
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+//! Lee el teclado matricial, si la placa lo tiene, con el digito que estuvo encendido
+void BoardKeypadScan(uint8_t digit);
+
+//! Apaga digitos y segmentos. Antes lee el teclado, con las filas estables por el digito encendido
+static inline void PonchoScreenTurnOff(uint8_t lit) {
+
+    BoardKeypadScan(lit);
+    Chip_GPIO_ClearValue(LPC_GPIO_PORT, DIGITS_GPIO, DIGITS_MASK);
+    Chip_GPIO_ClearValue(LPC_GPIO_PORT, SEGMENTS_GPIO, SEGMENTS_MASK);
+    Chip_GPIO_SetPinState(LPC_GPIO_PORT, SEGMENT_P_GPIO, SEGMENT_P_BIT, false);
+}
+
+static inline void PonchoSegmentsTurnOn(uint8_t segments) {
+
+    Chip_GPIO_SetValue(LPC_GPIO_PORT, SEGMENTS_GPIO, segments);
+    Chip_GPIO_SetPinState(LPC_GPIO_PORT, SEGMENT_P_GPIO, SEGMENT_P_BIT, (segments >> 7 && 1));
+}
+
+static inline void PonchoDigitTurnOn(uint8_t digit) {
+
+    // 8 >> digit invierte el orden en que se prenden los digitos
+    Chip_GPIO_SetValue(LPC_GPIO_PORT, DIGITS_GPIO, (8 >> digit) & DIGITS_MASK);
+}
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* PONCHO_PANTALLA_H */
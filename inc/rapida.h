@@ -0,0 +1,86 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef RAPIDA_H
+#define RAPIDA_H
+
+/** \brief Codigo y tablas en la SRAM local
+ **
+ ** Marca las funciones que corren en cada tick y las tablas que consultan para que se ejecuten y
+ ** lean desde la SRAM local en lugar de la flash, sin pasar por el acelerador de la flash ni sus
+ ** estados de espera. El arranque las copia desde la flash junto con .data, porque sus secciones
+ ** coinciden con el *(.data*) del script del enlazador. Con RAPIDA_HABILITADA en 0 las macros no
+ ** ubican nada y todo queda en la flash, para comparar con el perfilador lo que se gana en cada
+ ** funcion.
+ **
+ ** \addtogroup rapida Rapida
+ ** \brief Codigo y tablas en la SRAM local
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+#ifndef RAPIDA_HABILITADA
+    #define RAPIDA_HABILITADA 1
+#endif
+
+//! Seccion de las funciones. El nombre empieza con .data para que el arranque la copie a la SRAM
+//! sin cambiar el script del enlazador, que junta *(.data*); no lleva el punto despues de .data
+//! porque el ensamblador advierte si una seccion .data.* tiene codigo
+#ifndef RAPIDA_SECCION
+    #define RAPIDA_SECCION ".data_ramfunc"
+#endif
+
+//! Seccion de las tablas; cualquier .data* se copia a la SRAM sin cambiar el script
+#ifndef RAPIDA_SECCION_DATOS
+    #define RAPIDA_SECCION_DATOS ".data.rapida"
+#endif
+
+#if RAPIDA_HABILITADA
+    //! Ubica una funcion en la SRAM. Va antes del tipo en la definicion; no se expande en linea
+    //! para que nadie la ejecute desde la flash. Las llamadas desde la flash superan el alcance de
+    //! BL y el enlazador les agrega un salto largo
+    #define RAPIDA       __attribute__((section(RAPIDA_SECCION), noinline))
+    //! Ubica una tabla constante en la SRAM. Va despues del nombre, como RETENIDA
+    #define RAPIDA_DATOS __attribute__((section(RAPIDA_SECCION_DATOS)))
+#else
+    #define RAPIDA
+    #define RAPIDA_DATOS
+#endif
+
+/* === Public data type declarations =========================================================== */
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* RAPIDA_H */
@@ -0,0 +1,135 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef REINICIO_H
+#define REINICIO_H
+
+/** \brief Arranque en caliente
+ **
+ ** Distingue un encendido de un reinicio del perro guardian o pedido por el programa, en los que
+ ** la memoria conserva su contenido. Los modulos que deben sobrevivir a esos reinicios ubican su
+ ** estado con RETENIDA y lo protegen con ReinicioSuma; al crearse lo retoman solo si
+ ** ReinicioEnCaliente lo permite y la suma coincide. Tambien estima cuantos ticks se perdieron
+ ** entre el ultimo tick contado y el primero del nuevo arranque, para que el reloj los compense.
+ **
+ ** \addtogroup reinicio Reinicio
+ ** \brief Arranque en caliente
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+//! Seccion sin inicializar del enlazador (NOLOAD en el script), la misma que usa la traza
+#ifndef REINICIO_SECCION
+    #define REINICIO_SECCION ".noinit"
+#endif
+
+//! Ubica una variable en la memoria que el arranque no inicializa
+#define RETENIDA __attribute__((section(REINICIO_SECCION)))
+
+//! Ticks estimados entre el reinicio y el primer tick del nuevo arranque (arranque y main)
+#ifndef REINICIO_ARRANQUE
+    #define REINICIO_ARRANQUE 2
+#endif
+
+//! Reinicios seguidos del perro guardian a partir de los que se arranca en frio
+#ifndef REINICIO_PERRO_SEGUIDOS
+    #define REINICIO_PERRO_SEGUIDOS 3
+#endif
+
+//! Ticks alimentando al perro guardian para dar por superada una racha de reinicios
+#ifndef REINICIO_ESTABLE
+    #define REINICIO_ESTABLE 10000
+#endif
+
+/* === Public data type declarations =========================================================== */
+
+typedef enum {
+    REINICIO_FRIO,      // encendido, o memoria retenida invalida
+    REINICIO_PERRO,     // vencio el perro guardian
+    REINICIO_PEDIDO,    // ReinicioPedir antes de reiniciar
+    REINICIO_EXTERNO,   // pulsador de reset o depurador, con la memoria intacta
+} reinicio_causa_t;
+
+//! Memoria retenida del modulo. Los contadores cambian en cada tick y se validan con la firma
+typedef struct reinicio_s {
+    uint32_t firma;
+    uint32_t ticks;      // ticks contados desde el ultimo arranque en frio
+    uint32_t alimentado; // tick de la ultima vez que se alimento al perro guardian
+    uint32_t reinicios;  // reinicios en caliente desde el ultimo arranque en frio
+    uint8_t seguidos;    // reinicios del perro sin un periodo estable entre ellos
+    bool pedido;         // el programa pidio el reinicio
+} reinicio_s;
+
+/* === Public variable declarations ============================================================ */
+
+extern reinicio_s reinicio;
+
+/* === Public function declarations ============================================================ */
+
+/**
+ * @brief Determina la causa del arranque y estima los ticks perdidos.
+ *
+ * @param perro true si el periferico del perro guardian indica que vencio
+ * @param espera ticks sin alimentar al perro guardian hasta que reinicia el procesador
+ */
+void ReinicioInit(bool perro, uint32_t espera);
+
+reinicio_causa_t ReinicioCausa(void);
+
+//! Indica si los modulos pueden retomar su memoria retenida. Es false en frio y tambien despues de
+//! REINICIO_PERRO_SEGUIDOS reinicios del perro, por si el estado retomado es lo que los provoca
+bool ReinicioEnCaliente(void);
+
+//! Ticks estimados entre el ultimo tick contado antes del reinicio y el primero despues
+uint32_t ReinicioPerdidos(void);
+
+uint32_t ReinicioCantidad(void);
+
+//! Suma de verificacion de una memoria retenida. Incluye el tamano, para que no valide la memoria
+//! que dejo un programa anterior con otro formato
+uint32_t ReinicioSuma(const void * datos, size_t tamano);
+
+//! Avanza la cuenta de ticks. Se llama en cada interrupcion del SysTick
+static inline void ReinicioTick(void) {
+    reinicio.ticks++;
+}
+
+//! Registra que se alimento al perro guardian
+void ReinicioAlimentado(void);
+
+//! Marca el proximo reinicio como pedido por el programa. Se llama justo antes de reiniciar
+void ReinicioPedir(void);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* REINICIO_H */
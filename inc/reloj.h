@@ -21,6 +21,7 @@ SPDX-License-Identifier: MIT
 /* === Headers files inclusions ================================================================ */
 #include <stdbool.h>
 #include "stdint.h"
+#include "bcd.h"
 /* === Cabecera C++ ============================================================================ */
 
 #ifdef __cplusplus
@@ -31,22 +32,106 @@ extern "C" {
 
 #define TICKS_PER_SECOND 1000 // Cuantos ticks debe contar el reloj para sumar un segundo
 
+//! Suscriptores que puede tener cada evento
+#ifndef RELOJ_SUSCRIPTORES
+    #define RELOJ_SUSCRIPTORES 4
+#endif
+
+//! Bit del evento en el filtro de RelojSuscribir
+#define RELOJ_FILTRO(evento) (1U << (evento))
+
 /* === Public data type declarations =========================================================== */
 
 typedef struct reloj_s * reloj_t;
-typedef void (*callback_disparar)(reloj_t reloj,
-                                  bool act_desact); // funcion de callback que facilita el testing
+
+//! Eventos del reloj. Salvo RELOJ_POSPONER y RELOJ_CANCELAR se publican desde RelojProcesarTicks,
+//! en la interrupcion diferida, tambien la alarma pospuesta. Esos dos los publican PosponerAlarma y
+//! CancelarAlarma en el lazo principal, con las interrupciones enmascaradas: los suscriptores nunca
+//! corren en el SysTick ni interrumpen a otro suscriptor
+typedef enum {
+    RELOJ_SEGUNDO,       // se completo un segundo de ticks, aunque la hora no sea valida
+    RELOJ_MEDIO_SEGUNDO, // mitad de cada segundo de ticks
+    RELOJ_MINUTO,        // la hora paso a un minuto nuevo
+    RELOJ_HORA,          // la hora paso a una hora nueva
+    RELOJ_DIA,           // medianoche
+    RELOJ_ALARMA,        // empieza a sonar la alarma, tambien al vencer la pospuesta
+    RELOJ_POSPONER,      // PosponerAlarma silencio la alarma
+    RELOJ_CANCELAR,      // CancelarAlarma apago la alarma
+    RELOJ_EVENTOS,
+} reloj_evento_t;
+
+typedef void (*reloj_suscriptor_t)(reloj_t reloj, reloj_evento_t evento, void * contexto);
+
+//! Hora y alarma tomadas juntas, sin un segundo del SysTick en medio
+typedef struct reloj_vista_s {
+    bcd_t hora;   // 0x00HHMMSS
+    bcd_t alarma; // 0x00HHMM00
+    bool hora_valida;
+    bool alarma_habilitada;
+} reloj_vista_s;
 
 /* === Public variable declarations ============================================================ */
 
 /* === Public function declarations ============================================================ */
 
-reloj_t ClockCreate(int ticks_por_segundo, callback_disparar funcion_de_disparo);
+/**
+ * @brief Crea el reloj. El estado vive en memoria retenida: despues de un reinicio en caliente
+ * (ReinicioEnCaliente) se retoma la hora, la alarma y la alarma pospuesta si su suma de
+ * verificacion es correcta, y si no el reloj arranca sin configurar.
+ */
+reloj_t ClockCreate(int ticks_por_segundo);
+
+/**
+ * @brief Llama a la funcion con cada evento del filtro, armado con RELOJ_FILTRO. Cada evento tiene
+ * su lista de suscriptores, que se recorre sin buscar ni reservar memoria al publicarlo. Las
+ * suscripciones no se pueden retirar y siguen aunque se vuelva a crear el reloj.
+ *
+ * @return false si alguno de los eventos ya tiene RELOJ_SUSCRIPTORES; en ese caso no se suscribe
+ * a ninguno
+ */
+bool RelojSuscribir(reloj_t reloj, uint16_t filtro, reloj_suscriptor_t funcion, void * contexto);
+
+//! Llama a los suscriptores del evento en el orden en que se suscribieron
+void RelojPublicar(reloj_t reloj, reloj_evento_t evento);
+
+//! Indica si ClockCreate retomo el estado de antes del reinicio
+bool RelojRecuperado(reloj_t reloj);
+
+//! Avanza el reloj los ticks que se perdieron durante un reinicio, incluida la alarma pospuesta.
+//! Puede disparar la alarma si en ese lapso empezaba un minuto que coincide con ella
+void RelojCompensar(reloj_t reloj, uint32_t ticks);
+
+/**
+ * @brief Copia la hora y la alarma sin deshabilitar interrupciones.
+ *
+ * Si una interrupcion las cambia durante la copia, la repite. GetClockTime y GetAlarmTime la usan,
+ * asi que tampoco mezclan dos segundos. Solo se llama desde el lazo principal: desde una
+ * interrupcion que corte una escritura del lazo esperaria para siempre.
+ */
+void RelojVista(reloj_t reloj, reloj_vista_s * vista);
 
 bool GetClockTime(reloj_t reloj, uint8_t * hora, int size);
 
+//! Hora empaquetada 0x00HHMMSS, sin separar los digitos ni copiar la vista: es una sola lectura
+bool GetClockTimePacked(reloj_t reloj, bcd_t * hora);
+
 bool SetClockTime(reloj_t reloj, const uint8_t * hora, int size);
 
+/**
+ * @brief Mitad rapida del tick, para la interrupcion del SysTick: solo cuenta el tick, sin tocar
+ * la hora ni publicar eventos.
+ *
+ * @return true si se completo un segundo o medio segundo, o vencio la alarma pospuesta, y hay que
+ * llamar a RelojProcesarTicks
+ */
+bool RelojContarTick(reloj_t reloj);
+
+//! Avanza la hora, verifica la alarma y publica los eventos de lo que conto RelojContarTick. Se
+//! llama desde una interrupcion de menor prioridad que el SysTick; si esta se atrasa varios ticks,
+//! procesa todos los segundos pendientes
+void RelojProcesarTicks(reloj_t reloj);
+
+//! RelojContarTick y, si hace falta, RelojProcesarTicks. Devuelve el tick dentro del segundo
 int RelojNuevoTick(reloj_t reloj);
 
 bool SetAlarmTime(reloj_t reloj, const uint8_t * alarma);
@@ -57,6 +142,9 @@ void VerificarAlarma(reloj_t reloj);
 
 void ToggleHabAlarma(reloj_t reloj);
 
+//! Silencia la alarma y la vuelve a disparar a los minutos indicados. Usa un temporizador, por lo que
+//! TemporizadorTick se debe llamar con la misma frecuencia que RelojNuevoTick, y antes de
+//! RelojContarTick para que la alarma se publique en el mismo tick en que vence
 void PosponerAlarma(reloj_t reloj, uint8_t tiempo);
 
 void CancelarAlarma(reloj_t reloj);
@@ -0,0 +1,297 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef RELOJ_HPP
+#define RELOJ_HPP
+
+/** \brief Motor del reloj resuelto al compilar
+ **
+ ** Alternativa en C++, solo de encabezado, al conteo de reloj.c. La frecuencia de ticks, el formato
+ ** (12 o 24 horas, con o sin segundos) y la forma de guardar la hora son parametros de la
+ ** plantilla, de modo que los divisores y los limites de cada campo son constantes que el
+ ** compilador pliega en el codigo. src/reloj_plantilla.cpp lo usa para implementar la interfaz C
+ ** de reloj.h cuando se compila con RELOJ_PLANTILLA.
+ **
+ ** Hay tres formas de guardar la hora, todas con la misma interfaz:
+ **  - CamposBCD: una palabra 0x00HHMMSS, como reloj.c (ver bcd.h).
+ **  - CamposDigitos: un digito por byte, como el reloj.c original.
+ **  - CamposSegundos: la cantidad de pasos desde el comienzo del dia, en binario.
+ **
+ ** \addtogroup reloj Reloj
+ ** \brief Hora y alarma
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+
+#include "bcd.h"
+#include <stdint.h>
+
+/* === Public macros definitions =============================================================== */
+
+/* === Public data type declarations =========================================================== */
+
+enum class Formato : uint8_t { H24, H12 };
+
+//! Constantes de un formato. Un paso es un segundo, o un minuto si la hora no tiene segundos
+template <Formato FORMATO, bool SEGUNDOS> struct Limites {
+
+    static constexpr bool CON_SEGUNDOS = SEGUNDOS;
+    static constexpr uint8_t HORA_MIN = FORMATO == Formato::H12 ? 1 : 0;
+    static constexpr uint8_t HORA_MAX = FORMATO == Formato::H12 ? 12 : 23;
+    static constexpr uint32_t SEGUNDOS_POR_PASO = SEGUNDOS ? 1 : 60;
+    static constexpr uint32_t PASOS_POR_HORA = 3600 / SEGUNDOS_POR_PASO;
+    static constexpr uint32_t PASOS_POR_VUELTA = (HORA_MAX - HORA_MIN + 1) * PASOS_POR_HORA;
+
+    //! Dos digitos BCD de un numero menor que 100
+    static constexpr uint32_t Bcd(uint32_t numero) {
+        return ((numero / 10) << 4) | (numero % 10);
+    }
+
+    static constexpr uint32_t Binario(uint32_t campo) {
+        return (campo >> 4) * 10 + (campo & 0x0F);
+    }
+};
+
+/**
+ * Formas de guardar la hora. Cada una tiene:
+ *  - bool Avanzar(): suma un paso y devuelve true si cambio la hora.
+ *  - bcd_t Empaquetada() y void Cargar(bcd_t): conversion a 0x00HHMMSS, con SS en 00 si la hora
+ *    no tiene segundos.
+ *  - uint8_t Horas(): las horas en binario.
+ *  - bool EnPunto(): los segundos estan en 00.
+ */
+template <class LIMITES> struct CamposBCD {
+
+    bcd_t valor;
+
+    bool Avanzar() {
+
+        constexpr uint32_t UNO = LIMITES::CON_SEGUNDOS ? BCD_SEGUNDOS : BCD_MINUTOS;
+        constexpr uint32_t SESGO = LIMITES::CON_SEGUNDOS ? 0x66A6A6 : 0x66A600;
+        constexpr uint32_t DIGITOS = LIMITES::CON_SEGUNDOS ? 0x111111 : 0x111100;
+        constexpr uint32_t DESBORDE = LIMITES::Bcd(LIMITES::HORA_MAX + 1);
+
+        if ((valor & (UNO * 0x0F)) != UNO * 9) {
+            valor += UNO;
+            return false;
+        }
+        // Suma con sesgo como BcdSegundo, con las constantes del formato
+        uint32_t sesgada = valor + SESGO;
+        uint32_t suma = sesgada + UNO;
+        uint32_t acarreos = suma ^ sesgada ^ UNO;
+        valor = suma - (SESGO & (((~acarreos >> 4) & DIGITOS) * 0xF));
+        if (valor & 0xFFFF) {
+            return false;
+        }
+        if ((valor >> 16) == DESBORDE) {
+            valor = LIMITES::Bcd(LIMITES::HORA_MIN) << 16;
+        }
+        return true;
+    }
+
+    bcd_t Empaquetada() const {
+        return valor;
+    }
+
+    void Cargar(bcd_t hora) {
+        valor = hora;
+    }
+
+    uint8_t Horas() const {
+        return LIMITES::Binario(valor >> 16);
+    }
+
+    bool EnPunto() const {
+        return (valor & 0xFF) == 0;
+    }
+};
+
+template <class LIMITES> struct CamposDigitos {
+
+    uint8_t digitos[6];
+
+    bool Avanzar() {
+
+        if constexpr (LIMITES::CON_SEGUNDOS) {
+            if (++digitos[5] < 10) {
+                return false;
+            }
+            digitos[5] = 0;
+            if (++digitos[4] < 6) {
+                return false;
+            }
+            digitos[4] = 0;
+        }
+        if (++digitos[3] < 10) {
+            return false;
+        }
+        digitos[3] = 0;
+        if (++digitos[2] < 6) {
+            return false;
+        }
+        digitos[2] = 0;
+        if (digitos[0] == LIMITES::HORA_MAX / 10 && digitos[1] == LIMITES::HORA_MAX % 10) {
+            digitos[0] = LIMITES::HORA_MIN / 10;
+            digitos[1] = LIMITES::HORA_MIN % 10;
+        } else if (++digitos[1] == 10) {
+            digitos[1] = 0;
+            digitos[0]++;
+        }
+        return true;
+    }
+
+    bcd_t Empaquetada() const {
+        return BcdEmpaquetar(digitos, sizeof(digitos));
+    }
+
+    void Cargar(bcd_t hora) {
+        BcdDesempaquetar(hora, digitos, sizeof(digitos));
+    }
+
+    uint8_t Horas() const {
+        return digitos[0] * 10 + digitos[1];
+    }
+
+    bool EnPunto() const {
+        return digitos[4] == 0 && digitos[5] == 0;
+    }
+};
+
+template <class LIMITES> struct CamposSegundos {
+
+    uint32_t pasos; // desde HORA_MIN:00:00
+
+    bool Avanzar() {
+
+        if (++pasos == LIMITES::PASOS_POR_VUELTA) {
+            pasos = 0;
+        }
+        return pasos % LIMITES::PASOS_POR_HORA == 0;
+    }
+
+    bcd_t Empaquetada() const {
+
+        uint32_t segundos = pasos * LIMITES::SEGUNDOS_POR_PASO;
+        return (LIMITES::Bcd(segundos / 3600 + LIMITES::HORA_MIN) << 16) |
+               (LIMITES::Bcd(segundos / 60 % 60) << 8) | LIMITES::Bcd(segundos % 60);
+    }
+
+    void Cargar(bcd_t hora) {
+
+        uint32_t segundos = (LIMITES::Binario(hora >> 16) - LIMITES::HORA_MIN) * 3600 +
+                            LIMITES::Binario((hora >> 8) & 0xFF) * 60 +
+                            LIMITES::Binario(hora & 0xFF);
+        pasos = segundos / LIMITES::SEGUNDOS_POR_PASO;
+    }
+
+    uint8_t Horas() const {
+        return pasos / LIMITES::PASOS_POR_HORA + LIMITES::HORA_MIN;
+    }
+
+    bool EnPunto() const {
+        return pasos % (60 / LIMITES::SEGUNDOS_POR_PASO) == 0;
+    }
+};
+
+//! Indicador de la tarde, que solo existe con 12 horas para no agrandar la hora de 24
+template <Formato FORMATO> struct Meridiano {};
+
+template <> struct Meridiano<Formato::H12> {
+    bool tarde; // despues del mediodia
+};
+
+/**
+ * @brief Motor del reloj.
+ *
+ * @tparam TICKS ticks por segundo; con 0 la frecuencia se pasa al contar, como en reloj.c
+ * @tparam FORMATO 24 o 12 horas
+ * @tparam SEGUNDOS si la hora cuenta segundos o solo minutos
+ * @tparam CAMPOS forma de guardar la hora
+ *
+ * La hora y el contador de ticks son tipos separados para poder guardarlos en lugares distintos,
+ * como hace reloj.c con la parte cubierta por la suma de la memoria retenida.
+ */
+template <uint32_t TICKS, Formato FORMATO = Formato::H24, bool SEGUNDOS = true,
+          template <class> class CAMPOS = CamposBCD>
+struct RelojMotor {
+
+    using limites = Limites<FORMATO, SEGUNDOS>;
+
+    //! Frecuencia que se usa: la de la plantilla, o la variable si la plantilla tiene 0
+    static constexpr uint32_t Frecuencia(uint32_t variable) {
+        return TICKS ? TICKS : variable;
+    }
+
+    struct Contador {
+
+        uint32_t actual;
+
+        //! Cuenta un tick y devuelve true al completar un paso, volviendo a 0
+        bool Tick(uint32_t frecuencia = TICKS) {
+
+            if (actual >= Frecuencia(frecuencia) * limites::SEGUNDOS_POR_PASO - 1) {
+                actual = 0;
+                return true;
+            }
+            actual++;
+            return false;
+        }
+
+        bool Valido(uint32_t frecuencia = TICKS) const {
+            return actual < Frecuencia(frecuencia) * limites::SEGUNDOS_POR_PASO;
+        }
+    };
+
+    struct Hora : Meridiano<FORMATO> {
+
+        CAMPOS<limites> campos;
+
+        //! Suma un paso y devuelve true si cambio la hora
+        bool Avanzar() {
+
+            bool cambio = campos.Avanzar();
+            if constexpr (FORMATO == Formato::H12) {
+                if (cambio && campos.Horas() == 12) {
+                    this->tarde = !this->tarde;
+                }
+            }
+            return cambio;
+        }
+
+        bcd_t Empaquetada() const {
+            return campos.Empaquetada();
+        }
+
+        void Cargar(bcd_t hora) {
+            campos.Cargar(hora);
+        }
+
+        bool EnPunto() const {
+            return campos.EnPunto();
+        }
+    };
+};
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
+
+#endif /* RELOJ_HPP */
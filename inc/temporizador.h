@@ -0,0 +1,99 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef TEMPORIZADOR_H
+#define TEMPORIZADOR_H
+
+/** \brief Temporizadores por software
+ **
+ ** Temporizadores de un disparo y periodicos contados en ticks del SysTick, ordenados en una rueda
+ ** jerarquica. Iniciar, detener y vencer un temporizador cuesta O(1), y lo que hace cada tick no
+ ** depende de cuantos temporizadores haya activos.
+ **
+ ** \addtogroup temporizador Temporizador
+ ** \brief Temporizadores por software
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+#include <stdbool.h>
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+//! Mayor espera que se puede programar, en ticks (4 niveles de 64 ranuras)
+#define TEMPORIZADOR_MAXIMO ((1UL << 24) - 1)
+
+/* === Public data type declarations =========================================================== */
+
+typedef struct temporizador_s * temporizador_t;
+
+//! Funcion que se llama al vencer el temporizador, dentro de la interrupcion del SysTick
+typedef void (*temporizador_accion_t)(temporizador_t temporizador, void * contexto);
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+/**
+ * @brief Crea un temporizador detenido.
+ *
+ * @param accion funcion que se llama al vencer. Con NULL el vencimiento queda como evento
+ * pendiente hasta que se lo retire con TemporizadorVencido desde el lazo principal.
+ * @param contexto parametro que recibe la accion
+ */
+temporizador_t TemporizadorCreate(temporizador_accion_t accion, void * contexto);
+
+/**
+ * @brief Inicia el temporizador, o lo reinicia si ya estaba activo.
+ *
+ * @param espera ticks hasta el primer vencimiento, entre 1 y TEMPORIZADOR_MAXIMO
+ * @param periodo ticks entre vencimientos siguientes, 0 para un solo disparo
+ */
+void TemporizadorIniciar(temporizador_t temporizador, uint32_t espera, uint32_t periodo);
+
+//! Detiene el temporizador y descarta su evento pendiente
+void TemporizadorDetener(temporizador_t temporizador);
+
+bool TemporizadorActivo(temporizador_t temporizador);
+
+//! Ticks que faltan para el proximo vencimiento, contados como la espera de TemporizadorIniciar, o
+//! 0 si el temporizador esta detenido
+uint32_t TemporizadorRestante(temporizador_t temporizador);
+
+//! Retira un vencimiento pendiente de un temporizador sin accion. Devuelve false si no habia
+bool TemporizadorVencido(temporizador_t temporizador);
+
+//! Indica si algun temporizador sin accion tiene vencimientos sin retirar
+bool TemporizadoresPendientes(void);
+
+//! Avanza un tick. Se llama en cada interrupcion del SysTick
+void TemporizadorTick(void);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* TEMPORIZADOR_H */
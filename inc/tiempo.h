@@ -0,0 +1,75 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef TIEMPO_H
+#define TIEMPO_H
+
+/** \brief Tiempo desde el arranque
+ **
+ ** Cuenta los ticks del SysTick en 64 bits y les suma lo que ya corrio del periodo en curso, leido
+ ** del contador del SysTick, para dar el tiempo desde el arranque en microsegundos. A diferencia de
+ ** la hora del reloj no cambia al ajustarla, y a diferencia del contador de ciclos no depende de la
+ ** frecuencia del nucleo. La lectura no deshabilita interrupciones y se puede hacer desde cualquier
+ ** prioridad.
+ **
+ ** \addtogroup tiempo Tiempo
+ ** \brief Base de tiempo comun en microsegundos
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+/* === Public data type declarations =========================================================== */
+
+/* === Public variable declarations ============================================================ */
+
+/* === Public function declarations ============================================================ */
+
+//! Empieza a contar desde cero. Se llama antes de arrancar el SysTick (SisTick_Init)
+void TiempoInit(uint16_t ticks_por_segundo);
+
+//! Cuenta un periodo. Se llama en cada interrupcion del SysTick, antes que cualquier lectura
+void TiempoTick(void);
+
+/**
+ * @brief Microsegundos desde TiempoInit. Dos lecturas sucesivas nunca retroceden, con una
+ * condicion: las interrupciones no pueden quedar deshabilitadas, ni el SysTick demorado por otras
+ * de mas prioridad, durante un periodo completo. El pedido pendiente del SysTick registra un solo
+ * vencimiento, asi que con dos periodos sin atender la lectura queda atrasada un periodo y puede
+ * ser menor que la anterior.
+ */
+uint64_t TiempoMicros(void);
+
+//! 32 bits bajos de TiempoMicros, para medir intervalos de hasta 71 minutos (digital_timestamp_t)
+uint32_t TiempoMicros32(void);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* TIEMPO_H */
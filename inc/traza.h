@@ -0,0 +1,145 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+#ifndef TRAZA_H
+#define TRAZA_H
+
+/** \brief Traza binaria de eventos
+ **
+ ** Anillo de registros de 64 bits con la marca de tick, el tipo de evento y dos datos. Agregar un
+ ** registro es un incremento atomico del indice y un unico store, por lo que se puede hacer desde
+ ** interrupciones y desde el lazo principal sin secciones criticas. El anillo esta en memoria que
+ ** el arranque no inicializa, de modo que despues de un reinicio en caliente conserva lo ocurrido
+ ** antes y se puede leer con el depurador o con el comando "traza" de la consola.
+ **
+ ** \addtogroup traza Traza
+ ** \brief Traza binaria de eventos
+ ** @{ */
+
+/* === Headers files inclusions ================================================================ */
+#include <stdint.h>
+#include <stdbool.h>
+/* === Cabecera C++ ============================================================================ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Public macros definitions =============================================================== */
+
+// El M0 no registra eventos: solo multiplexa la pantalla
+#ifndef TRAZA_HABILITADA
+    #if defined(CORE_M0)
+        #define TRAZA_HABILITADA 0
+    #else
+        #define TRAZA_HABILITADA 1
+    #endif
+#endif
+
+//! Registros del anillo, potencia de 2
+#ifndef TRAZA_REGISTROS
+    #define TRAZA_REGISTROS 512
+#endif
+
+//! Seccion sin inicializar del enlazador en la que vive la traza (NOLOAD en el script)
+#ifndef TRAZA_SECCION
+    #define TRAZA_SECCION ".noinit"
+#endif
+
+//! Marca de una traza valida en memoria, tambien la primera palabra de un volcado binario
+#define TRAZA_FIRMA 0x5452415AUL
+
+// Campos de un registro: tick en los 32 bits bajos, luego tipo, a y b
+#define TRAZA_CODIFICAR(tick, tipo, a, b)                                                          \
+    ((uint64_t)(uint32_t)(tick) | ((uint64_t)(uint8_t)(tipo) << 32) |                              \
+     ((uint64_t)(uint8_t)(a) << 40) | ((uint64_t)(uint16_t)(b) << 48))
+#define TRAZA_TICK(registro) ((uint32_t)(registro))
+#define TRAZA_TIPO(registro) ((uint8_t)((registro) >> 32))
+#define TRAZA_A(registro)    ((uint8_t)((registro) >> 40))
+#define TRAZA_B(registro)    ((uint16_t)((registro) >> 48))
+
+#if TRAZA_HABILITADA
+    //! Registra el evento TRAZA_<tipo>
+    #define TRAZA(tipo, a, b) TrazaRegistrar(TRAZA_##tipo, (a), (b))
+#else
+    #define TRAZA(tipo, a, b)
+#endif
+
+/* === Public data type declarations =========================================================== */
+
+// El tipo 0 queda reservado: un registro en cero es una posicion que nunca se escribio
+typedef enum {
+    TRAZA_NINGUNO,
+#define TRAZA_EVENTO(id, texto) TRAZA_##id,
+#include "traza_eventos.h"
+#undef TRAZA_EVENTO
+    TRAZA_TIPOS,
+} traza_tipo_t;
+
+//! Contenido de la memoria de la traza, en el mismo formato que un volcado binario
+typedef struct traza_s {
+    uint32_t firma;
+    uint32_t reinicios; // reinicios en caliente desde que se inicio la traza
+    uint32_t siguiente; // registros escritos; el proximo va en siguiente % TRAZA_REGISTROS
+    uint32_t ahora;     // ticks desde el inicio, continua despues de un reinicio en caliente
+    uint64_t registros[TRAZA_REGISTROS];
+} traza_s;
+
+/* === Public variable declarations ============================================================ */
+
+//! Memoria de la traza, para leerla con el depurador
+extern traza_s traza;
+
+/* === Public function declarations ============================================================ */
+
+//! Conserva la traza si sobrevivio a un reinicio en caliente, y si no la vacia
+void TrazaInit(void);
+
+//! Avanza la marca de tiempo. Se llama en cada interrupcion del SysTick
+static inline void TrazaTick(void) {
+    traza.ahora++;
+}
+
+static inline void TrazaRegistrar(traza_tipo_t tipo, uint8_t a, uint16_t b) {
+
+    uint32_t indice = __atomic_fetch_add(&traza.siguiente, 1, __ATOMIC_RELAXED);
+    traza.registros[indice % TRAZA_REGISTROS] = TRAZA_CODIFICAR(traza.ahora, tipo, a, b);
+}
+
+//! Empaqueta cuatro digitos, uno por nibble, para los datos de un registro
+static inline uint16_t TrazaBCD(const uint8_t * digitos) {
+    return (uint16_t)((digitos[0] << 12) | (digitos[1] << 8) | (digitos[2] << 4) | digitos[3]);
+}
+
+//! Numero del registro mas antiguo que todavia esta en el anillo
+uint32_t TrazaPrimero(void);
+
+//! Numero que tendra el proximo registro
+uint32_t TrazaSiguiente(void);
+
+//! Registro con el numero indicado. Solo es valido entre TrazaPrimero y TrazaSiguiente
+uint64_t TrazaLeer(uint32_t numero);
+
+/* === End of documentation ==================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} End of module definition for doxygen */
+
+#endif /* TRAZA_H */
@@ -0,0 +1,38 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Eventos de la traza
+ **
+ ** Lista de los eventos que se registran en la traza. Cada entrada es TRAZA_EVENTO(identificador,
+ ** nombre); traza.h arma con ella la enumeracion TRAZA_<identificador> y el decodificador la tabla
+ ** de nombres. Este archivo se incluye varias veces a proposito y no tiene guarda.
+ **
+ ** \addtogroup traza Traza
+ ** @{ */
+
+TRAZA_EVENTO(REINICIO, "reinicio")                 // b: reinicios en caliente conservando la traza
+TRAZA_EVENTO(MODO, "modo")                         // a: modo anterior, b: modo nuevo (modo_t)
+TRAZA_EVENTO(TECLA, "tecla")                       // a: tecla (board_key_t), b: flanco
+TRAZA_EVENTO(ALARMA, "alarma")                     // a: 1 empieza a sonar, 0 se silencia
+TRAZA_EVENTO(POSPONER, "posponer")                 // a: minutos
+TRAZA_EVENTO(HORA, "hora")                         // b: hora ajustada, hhmm en BCD
+TRAZA_EVENTO(AJUSTE_ALARMA, "ajuste alarma")       // b: alarma ajustada, hhmm en BCD
+TRAZA_EVENTO(HABILITAR_ALARMA, "habilitar alarma") // a: 1 si quedo habilitada
+TRAZA_EVENTO(PANTALLA, "pantalla")                 // a: digitos escritos, b: los primeros 4 en BCD
+TRAZA_EVENTO(RETOMAR, "retomar")                   // a: causa (reinicio_causa_t), b: ticks compensados
+
+/** @} End of module definition for doxygen */
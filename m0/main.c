@@ -0,0 +1,102 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Programa del nucleo M0 en modo de dos nucleos
+ **
+ ** Se compila con CORE_M0 junto con bsp.c, digital.c, pantalla.c, buzon.c y estadistica.c. Cada
+ ** milisegundo toma el ultimo cuadro publicado por el M4, multiplexa un digito, lee las teclas y le
+ ** envia al M4 los cambios detectados, avisandole con SEV.
+ **
+ ** \addtogroup m0 Nucleo M0
+ ** \brief Multiplexado de la pantalla y lectura de teclas
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "bsp.h"
+#include "buzon.h"
+#include "chip.h"
+
+/* === Macros definitions ====================================================================== */
+
+#define INT_PER_SECOND 1000 // interrupciones por segundo del RIT, igual que el SysTick del M4
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static board_t board;
+static uint32_t generacion = 0; // generacion del ultimo cuadro copiado del buzon
+
+/* === Private function implementation ========================================================= */
+
+/* === Public function implementation ========================================================== */
+
+int main(void) {
+
+    board = BoardCreate();
+    DigitalEventsInit(BoardCycles);
+
+    // El M0 no tiene SysTick en el LPC4337: la base de tiempo del refresco es el RIT
+    Chip_RIT_Init(LPC_RITIMER);
+    Chip_RIT_SetTimerInterval(LPC_RITIMER, 1000 / INT_PER_SECOND);
+    NVIC_EnableIRQ(RITIMER_IRQn);
+
+    while (true) {
+        __WFI();
+    }
+}
+
+void RIT_IRQHandler(void) {
+
+    display_frame_s cuadro;
+    digital_event_s evento;
+    bool avisar = false;
+
+    Chip_RIT_ClearInt(LPC_RITIMER);
+
+    if (BuzonLeerCuadro(&cuadro, &generacion)) {
+        DisplaySetFrame(board->display, &cuadro);
+    }
+    DisplayRefresh(board->display);
+    DigitalInputsScan();
+
+    while (DigitalEventGet(&evento)) {
+        int tecla = BoardKeyIndex(evento.input);
+        if (tecla >= 0) {
+            buzon_evento_s mensaje = {
+                .marca = evento.stamp,
+                .tecla = (uint8_t)tecla,
+                .flanco = (uint8_t)evento.edge,
+            };
+            avisar |= BuzonEnviarEvento(&mensaje);
+        }
+    }
+    if (avisar) {
+        __SEV(); // dispara M0APP_IRQn en el M4
+    }
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,180 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Aritmetica BCD empaquetada
+ **
+ ** Los campos de una hora son numeros de dos digitos BCD menores que 0x80, asi que un byte nunca
+ ** desborda en el siguiente al sumar o restar 1 y el bit 7 de cada byte queda libre para las
+ ** comparaciones SWAR de BCD_SWAR.
+ **
+ ** \addtogroup bcd BCD
+ ** \brief Aritmetica BCD empaquetada
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "bcd.h"
+#include <string.h>
+#if BCD_SWAR && BCD_DSP
+    #include <arm_acle.h>
+#endif
+
+/* === Macros definitions ====================================================================== */
+
+#define BYTES_UNO    0x01010101UL
+#define BYTES_SEIS   0x06060606UL
+#define BYTES_ALTO   0x80808080UL
+#define BYTES_BAJO   0x0F0F0F0FUL
+#define BYTES_NIBBLE 0x10101010UL // acarreo de cada digito bajo al alto
+
+// Lo que le falta a cada digito para 16: 6 a los de base 10 y 10 a las decenas de segundos y minutos
+#define SESGO_HORA   0x66A6A6UL
+#define DIGITOS_BAJO 0x111111UL
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static uint32_t Separar(uint32_t cuatro);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+// 0xABCD a los bytes A, B, C y D en memoria. El cambio de orden final es una instruccion (REV)
+static uint32_t Separar(uint32_t cuatro) {
+
+    uint32_t digitos = ((cuatro & 0xFF00) << 8) | (cuatro & 0x00FF);  // 0x00AB00CD
+    digitos = ((digitos & 0x00F000F0) << 4) | (digitos & 0x000F000F); // 0x0A0B0C0D
+    return __builtin_bswap32(digitos);
+}
+
+/* === Public function implementation ========================================================== */
+
+bcd_t BcdEmpaquetar(const uint8_t * digitos, uint8_t cantidad) {
+
+    bcd_t valor = 0;
+
+    for (uint8_t indice = 0; indice < cantidad && indice < 6; indice++) {
+        valor |= (bcd_t)(digitos[indice] & 0x0F) << (4 * (5 - indice));
+    }
+    return valor;
+}
+
+void BcdDesempaquetar(bcd_t valor, uint8_t * digitos, uint8_t cantidad) {
+
+    uint32_t altos = Separar(valor >> 8);     // HH:MM
+    uint32_t bajos = Separar(valor & 0xFFFF); // MM:SS, de la que se toman los segundos
+
+    memcpy(digitos, &altos, cantidad < 4 ? cantidad : 4);
+    if (cantidad > 4) {
+        memcpy(digitos + 4, (uint8_t *)&bajos + 2, cantidad - 4 < 2 ? cantidad - 4 : 2);
+    }
+}
+
+// Con el sesgo cada digito desborda justo al pasar su base y el acarreo sigue al digito siguiente
+// como en una suma binaria. A los digitos que no desbordaron se les quita el sesgo.
+bcd_t BcdSegundo(bcd_t hora) {
+
+    // Nueve de cada diez segundos no hay acarreo
+    if ((hora & 0x0F) != 9) {
+        return hora + 1;
+    }
+
+    uint32_t sesgada = hora + SESGO_HORA;
+    uint32_t suma = sesgada + 1;
+    uint32_t acarreos = suma ^ sesgada ^ 1;                      // acarreo que entro en cada bit
+    uint32_t sin_desborde = (~acarreos >> 4) & DIGITOS_BAJO;     // digitos que no desbordaron
+    uint32_t resultado = suma - (SESGO_HORA & (sin_desborde * 0xF));
+
+    // Las horas no son de base fija: 24 vuelve a 00
+    return (resultado >> 16) == 0x24 ? resultado & 0xFFFF : resultado;
+}
+
+// Campo por campo: casi siempre cambia solo el digito bajo, con una comparacion y una suma
+bcd_t BcdIncrementar(bcd_t valor, bcd_t campos, bcd_t limites) {
+
+#if !BCD_SWAR
+    for (; campos; campos &= campos - 1) { // un paso por campo elegido, del menos significativo
+        unsigned desplazamiento = __builtin_ctz(campos);
+        uint32_t campo = (valor >> desplazamiento) & 0xFF;
+        if (campo >= ((limites >> desplazamiento) & 0xFF)) {
+            campo = 0;
+        } else if ((campo & 0x0F) == 9) {
+            campo += 7; // 0x09 pasa a 0x10
+        } else {
+            campo++;
+        }
+        valor = (valor & ~(0xFFUL << desplazamiento)) | (campo << desplazamiento);
+    }
+    return valor;
+#elif BCD_DSP
+    uint32_t suma = __uadd8(valor, campos);
+    // Un digito bajo que llego a 10 pasa a las decenas
+    suma += ((((suma & BYTES_BAJO) + BYTES_SEIS) & BYTES_NIBBLE) >> 4) * 6;
+    (void)__usub8(limites, suma); // GE en los campos que no superan el limite
+    return __sel(suma, 0);
+#else
+    uint32_t suma = valor + campos;
+    suma += ((((suma & BYTES_BAJO) + BYTES_SEIS) & BYTES_NIBBLE) >> 4) * 6;
+    // Bit 7 en cero en los campos mayores que su limite
+    uint32_t dentro = ((limites | BYTES_ALTO) - suma) & BYTES_ALTO;
+    uint32_t fuera = ((dentro ^ BYTES_ALTO) >> 7) * 0xFF;
+    return suma & ~fuera;
+#endif
+}
+
+bcd_t BcdDecrementar(bcd_t valor, bcd_t campos, bcd_t limites) {
+
+#if !BCD_SWAR
+    for (; campos; campos &= campos - 1) { // un paso por campo elegido, del menos significativo
+        unsigned desplazamiento = __builtin_ctz(campos);
+        uint32_t campo = (valor >> desplazamiento) & 0xFF;
+        if (campo == 0) {
+            campo = (limites >> desplazamiento) & 0xFF;
+        } else if ((campo & 0x0F) == 0) {
+            campo -= 7; // 0x10 pasa a 0x09
+        } else {
+            campo--;
+        }
+        valor = (valor & ~(0xFFUL << desplazamiento)) | (campo << desplazamiento);
+    }
+    return valor;
+#elif BCD_DSP
+    uint32_t resta = __usub8(valor, campos);
+    // Un digito bajo que bajo de 0 queda en 15 y debe quedar en 9
+    resta -= ((((resta & BYTES_BAJO) + BYTES_UNO) & BYTES_NIBBLE) >> 4) * 6;
+    (void)__usub8(valor, campos); // GE en los campos que no estaban en 00
+    return __sel(resta, limites);
+#else
+    // Los campos elegidos que estan en 00 se pasan a 01 para que la resta no pida prestado al
+    // siguiente, y al final se reemplazan por su limite
+    uint32_t no_cero = ((valor | BYTES_ALTO) - BYTES_UNO) & BYTES_ALTO;
+    uint32_t ceros = (((no_cero ^ BYTES_ALTO) & (campos << 7)) >> 7) * 0xFF;
+    uint32_t resta = (valor | (campos & ceros)) - campos;
+    resta -= ((((resta & BYTES_BAJO) + BYTES_UNO) & BYTES_NIBBLE) >> 4) * 6;
+    return (resta & ~ceros) | (limites & ceros);
+#endif
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -29,6 +29,10 @@ SPDX-License-Identifier: MIT
 #include "ciaa.h"
 #include "bsp.h"
 #include "poncho.h"
+#include "poncho_pantalla.h"
+#include "buzon.h"
+#include "rapida.h"
+#include <string.h>
 
 /* === Macros definitions ====================================================================== */
 //! Cantidad de digitos que se crearan
@@ -36,21 +40,86 @@ SPDX-License-Identifier: MIT
     #define DIGITOS 4
 #endif // DIGITOS
 
+//! Filas del teclado matricial que comparte las lineas de digito (0 = sin teclado, hasta 3)
+#if !defined(KEY_MATRIX_ROWS)
+    #define KEY_MATRIX_ROWS 0
+#endif // KEY_MATRIX_ROWS
+
+//! Direccion de la imagen del M0 en modo de dos nucleos (DUAL_CORE). La imagen del M0 se compila con
+//! CORE_M0 y se encarga de multiplexar la pantalla y leer las teclas.
+#if defined(DUAL_CORE) && !defined(M0_IMAGE_ADDR)
+    #define M0_IMAGE_ADDR 0x1B000000
+#endif
+
+//! Periodo minimo, en ciclos, del tick de transicion que se programa al cambiar la frecuencia
+#define SYSTICK_MIN_RELOAD 64
+
+//! Indice de la salida PWM del SCT usada por el zumbador
+#define BUZZER_PWM_INDEX 1
+
+//! Frecuencia de cuenta del temporizador que marca el fin de cada nota
+#define BUZZER_TIMER_HZ 1000
+
+//! Velocidad de la consola en la UART del conversor USB
+#define CONSOLE_BAUDRATE 115200
+
+//! Bytes del anillo en el que el DMA deja lo recibido por la consola
+#define CONSOLE_RX_SIZE 512
+
 /* === Private data type declarations ========================================================== */
 
 /* === Private variable declarations =========================================================== */
 
 static board_s board = {0};
 display_driver_t driver;
+static uint8_t active_digit = 0; // digito encendido por el ultimo DigitTurnOn
+static uint16_t systick_ticks = 0; // interrupciones por segundo pedidas a SisTick_Init
+
+// Orden de las teclas en board_key_t, compartido por las imagenes de ambos nucleos
+static digital_input_t * const board_keys[BOARD_KEYS] = {
+    [BOARD_KEY_ACCEPT] = &board.accept,       [BOARD_KEY_CANCEL] = &board.cancel,
+    [BOARD_KEY_SET_TIME] = &board.set_time,   [BOARD_KEY_SET_ALARM] = &board.set_alarm,
+    [BOARD_KEY_DECREMENT] = &board.decrement, [BOARD_KEY_INCREMENT] = &board.increment,
+};
+
+#if defined(DUAL_CORE)
+static display_frame_s published_frame; // ultimo cuadro enviado al M0
+#endif
+
+#if !defined(CORE_M0)
+static char console_rx[CONSOLE_RX_SIZE];
+static DMA_TransferDescriptor_t console_rx_descriptor; // enlazado consigo mismo: recepcion circular
+static uint8_t console_rx_channel;
+static uint8_t console_tx_channel;
+#endif
 
 /* === Private function declarations =========================================================== */
 void digits_init(void);
 void segments_init(void);
 void buzzer_init(void);
 void keys_init(void);
+void keypad_init(void);
 void ScreenTurnOff(void);
 void SegmentsTurnOn(uint8_t segments);
 void DigitTurnOn(uint8_t digits);
+void BuzzerToneOn(uint16_t frecuencia);
+void BuzzerToneOff(void);
+void BuzzerSchedule(uint16_t milisegundos);
+void cycle_counter_init(void);
+void console_init(void);
+void watchdog_init(void);
+uint16_t ConsoleReceived(void);
+bool ConsoleWrapped(void);
+bool ConsoleTransmit(const char * data, uint16_t size);
+bool ConsoleTransmitting(void);
+#if defined(DUAL_CORE)
+void shared_timer_init(void);
+void remote_keys_init(void);
+void m0_boot(void);
+void RemoteScreenTurnOff(void);
+void RemoteSegmentsTurnOn(uint8_t segments);
+void RemoteDigitTurnOn(uint8_t digits);
+#endif
 /* === Public variable definitions ============================================================= */
 
 /* === Private variable definitions ============================================================ */
@@ -121,10 +190,31 @@ void segments_init(void) {
     Chip_GPIO_SetPinDIR(LPC_GPIO_PORT, SEGMENT_P_GPIO, SEGMENT_P_BIT, true);
 }
 
+#if !defined(CORE_M0)
+// El zumbador queda siempre en el M4
 void buzzer_init(void) {
-    Chip_SCU_PinMuxSet(BUZZER_PORT, BUZZER_PIN, SCU_MODE_INBUFF_EN | SCU_MODE_INACT | BUZZER_FUNC);
-    board.buzzer = DigitalOutputCreate(BUZZER_GPIO, BUZZER_BIT);
+    Chip_SCU_PinMuxSet(BUZZER_PORT, BUZZER_PIN,
+                       SCU_MODE_INBUFF_EN | SCU_MODE_INACT | BUZZER_SCT_FUNC);
+
+    // El SCT genera el tono y el TIMER1 interrumpe solo al final de cada nota
+    Chip_SCTPWM_Init(LPC_SCT);
+    Chip_SCTPWM_SetOutPin(LPC_SCT, BUZZER_PWM_INDEX, BUZZER_SCT_OUT);
+
+    Chip_TIMER_Init(LPC_TIMER1);
+    Chip_TIMER_PrescaleSet(LPC_TIMER1, Chip_Clock_GetRate(CLK_MX_TIMER1) / BUZZER_TIMER_HZ - 1);
+    Chip_TIMER_MatchEnableInt(LPC_TIMER1, 0);
+    Chip_TIMER_ResetOnMatchEnable(LPC_TIMER1, 0);
+    Chip_TIMER_StopOnMatchEnable(LPC_TIMER1, 0);
+    NVIC_SetPriority(TIMER1_IRQn, (1 << __NVIC_PRIO_BITS) - 3);
+    NVIC_EnableIRQ(TIMER1_IRQn);
+
+    board.buzzer = BuzzerCreate(&(struct buzzer_driver_s){
+        .ToneOn = BuzzerToneOn,
+        .ToneOff = BuzzerToneOff,
+        .Schedule = BuzzerSchedule,
+    });
 }
+#endif
 
 void keys_init(void) {
 
@@ -149,32 +239,240 @@ void keys_init(void) {
     board.increment = DigitalInputCreate(KEY_F4_GPIO, KEY_F4_BIT, false);
 }
 
-void ScreenTurnOff(void) {
+#if defined(DUAL_CORE)
+// El M4 lee las teclas a traves del M0: las entradas no tienen pin propio
+void remote_keys_init(void) {
 
-    Chip_GPIO_ClearValue(LPC_GPIO_PORT, DIGITS_GPIO, DIGITS_MASK);
-    Chip_GPIO_ClearValue(LPC_GPIO_PORT, SEGMENTS_GPIO, SEGMENTS_MASK);
-    Chip_GPIO_SetPinState(LPC_GPIO_PORT, SEGMENT_P_GPIO, SEGMENT_P_BIT, false);
+    for (int key = 0; key < BOARD_KEYS; key++) {
+        *board_keys[key] = DigitalInputCreateRemote();
+    }
+}
+
+// TIMER3 cuenta ciclos sin detenerse y es la base de tiempo comun a los dos nucleos (el M0 no tiene
+// DWT). Solo lo configura el M4.
+void shared_timer_init(void) {
+
+    Chip_TIMER_Init(LPC_TIMER3);
+    Chip_TIMER_PrescaleSet(LPC_TIMER3, 0);
+    Chip_TIMER_Reset(LPC_TIMER3);
+    Chip_TIMER_Enable(LPC_TIMER3);
+}
+
+void m0_boot(void) {
+
+    BuzonInit();
+    // Misma prioridad que el SysTick: ambos encolan eventos de entrada y no deben interrumpirse
+    NVIC_SetPriority(M0APP_IRQn, (1 << __NVIC_PRIO_BITS) - 2);
+    NVIC_EnableIRQ(M0APP_IRQn);
+
+    LPC_CREG->M0APPMEMMAP = M0_IMAGE_ADDR;
+    Chip_RGU_ClearReset(RGU_M0APP_RST);
+}
+#endif
+
+#if !defined(CORE_M0)
+// La recepcion y la transmision las hace el GPDMA, sin interrupciones: la consola consulta la
+// posicion del canal de recepcion, si dio la vuelta al anillo y si el de transmision termino
+void console_init(void) {
+
+    Chip_SCU_PinMuxSet(UART_USB_TXD_PORT, UART_USB_TXD_PIN, SCU_MODE_PULLDOWN | UART_USB_TXD_FUNC);
+    Chip_SCU_PinMuxSet(UART_USB_RXD_PORT, UART_USB_RXD_PIN,
+                       SCU_MODE_INACT | SCU_MODE_INBUFF_EN | SCU_MODE_ZIF_DIS | UART_USB_RXD_FUNC);
+
+    Chip_UART_Init(LPC_USART2);
+    Chip_UART_SetBaud(LPC_USART2, CONSOLE_BAUDRATE);
+    Chip_UART_ConfigData(LPC_USART2, UART_LCR_WLEN8 | UART_LCR_SBS_1BIT | UART_LCR_PARITY_DIS);
+    // En modo DMA la UART pide una transferencia por cada caracter recibido
+    Chip_UART_SetupFIFOS(LPC_USART2, UART_FCR_FIFO_EN | UART_FCR_RX_RS | UART_FCR_TX_RS |
+                                         UART_FCR_DMAMODE_SEL | UART_FCR_TRG_LEV0);
+    Chip_UART_TXEnable(LPC_USART2);
+
+    Chip_GPDMA_Init(LPC_GPDMA);
+    console_rx_channel = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, GPDMA_CONN_UART2_Rx);
+    console_tx_channel = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, GPDMA_CONN_UART2_Tx);
+    Chip_GPDMA_InitDescriptor(LPC_GPDMA, &console_rx_descriptor, GPDMA_CONN_UART2_Rx,
+                              (uintptr_t)console_rx, sizeof(console_rx),
+                              GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA, &console_rx_descriptor);
+    // Sin habilitar la interrupcion del GPDMA, el fin de cada vuelta queda como marca del canal
+    console_rx_descriptor.ctrl |= GPDMA_DMACCxControl_I;
+    Chip_GPDMA_SGTransfer(LPC_GPDMA, console_rx_channel, &console_rx_descriptor,
+                          GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA);
+
+    board.consola = ConsolaCreate(console_rx, sizeof(console_rx),
+                                  &(struct consola_driver_s){
+                                      .Recibidos = ConsoleReceived,
+                                      .Vuelta = ConsoleWrapped,
+                                      .Transmitir = ConsoleTransmit,
+                                      .Transmitiendo = ConsoleTransmitting,
+                                  });
+}
+
+uint16_t ConsoleReceived(void) {
+
+    // Al terminar la vuelta el canal puede quedar un instante apuntando al final del anillo
+    return (LPC_GPDMA->CH[console_rx_channel].DESTADDR - (uintptr_t)console_rx) % CONSOLE_RX_SIZE;
+}
+
+bool ConsoleWrapped(void) {
+
+    if (Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_RAWINTTC, console_rx_channel) == RESET) {
+        return false;
+    }
+    Chip_GPDMA_ClearIntPending(LPC_GPDMA, GPDMA_STATCLR_INTTC, console_rx_channel);
+    return true;
 }
 
-void SegmentsTurnOn(uint8_t segments) {
+bool ConsoleTransmit(const char * data, uint16_t size) {
+
+    return Chip_GPDMA_Transfer(LPC_GPDMA, console_tx_channel, (uintptr_t)data, GPDMA_CONN_UART2_Tx,
+                               GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, size) == SUCCESS;
+}
+
+bool ConsoleTransmitting(void) {
+
+    return (LPC_GPDMA->ENBLDCHNS >> console_tx_channel) & 1;
+}
+#endif
+
+#if !defined(CORE_M0)
+// El indicador de vencimiento sobrevive al reinicio que provoca el perro y Chip_WWDT_Init lo borra,
+// asi que se lee antes
+void watchdog_init(void) {
+
+    board.watchdog_reset = (Chip_WWDT_GetStatus(LPC_WWDT) & WWDT_WDMOD_WDTOF) != 0;
+    Chip_WWDT_Init(LPC_WWDT);
+    Chip_WWDT_SetTimeOut(LPC_WWDT, WDT_OSC / 4 / 1000 * BOARD_WATCHDOG_MS); // prescaler fijo de 4
+    Chip_WWDT_SetOption(LPC_WWDT, WWDT_WDMOD_WDRESET);
+    Chip_WWDT_ClearStatusFlag(LPC_WWDT, WWDT_WDMOD_WDTOF);
+    Chip_WWDT_Start(LPC_WWDT);
+}
+#endif
+
+void cycle_counter_init(void) {
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void keypad_init(void) {
+#if KEY_MATRIX_ROWS > 0
+    static const digital_matrix_row_s rows[] = {
+        {.port = KEY_ROW_1_GPIO, .pin = KEY_ROW_1_BIT},
+        {.port = KEY_ROW_2_GPIO, .pin = KEY_ROW_2_BIT},
+        {.port = KEY_ROW_3_GPIO, .pin = KEY_ROW_3_BIT},
+    };
+
+    Chip_SCU_PinMuxSet(KEY_ROW_1_PORT, KEY_ROW_1_PIN,
+                       SCU_MODE_INBUFF_EN | SCU_MODE_PULLDOWN | KEY_ROW_1_FUNC);
+    Chip_SCU_PinMuxSet(KEY_ROW_2_PORT, KEY_ROW_2_PIN,
+                       SCU_MODE_INBUFF_EN | SCU_MODE_PULLDOWN | KEY_ROW_2_FUNC);
+    Chip_SCU_PinMuxSet(KEY_ROW_3_PORT, KEY_ROW_3_PIN,
+                       SCU_MODE_INBUFF_EN | SCU_MODE_PULLDOWN | KEY_ROW_3_FUNC);
+    board.keypad = DigitalMatrixCreate(rows, KEY_MATRIX_ROWS, DIGITOS);
+#else
+    board.keypad = NULL;
+#endif
+}
+
+RAPIDA void BoardKeypadScan(uint8_t digit) {
+
+    // El digito anterior estuvo encendido durante todo su intervalo, por lo que las filas ya estan
+    // estables: se leen antes de apagarlo, sin costo adicional de interrupciones.
+    if (board.keypad) {
+        DigitalMatrixScan(board.keypad, digit);
+    }
+}
+
+RAPIDA void ScreenTurnOff(void) {
+    PonchoScreenTurnOff(active_digit);
+}
+
+RAPIDA void SegmentsTurnOn(uint8_t segments) {
+    PonchoSegmentsTurnOn(segments);
+}
+
+RAPIDA void DigitTurnOn(uint8_t digits) {
+
+    active_digit = digits;
+    PonchoDigitTurnOn(digits);
+}
+
+#if defined(DUAL_CORE)
+// En modo de dos nucleos la pantalla del M4 solo guarda el contenido que se publica al M0
+void RemoteScreenTurnOff(void) {
+}
+
+void RemoteSegmentsTurnOn(uint8_t segments) {
+    (void)segments;
+}
 
-    Chip_GPIO_SetValue(LPC_GPIO_PORT, SEGMENTS_GPIO, segments);
-    Chip_GPIO_SetPinState(LPC_GPIO_PORT, SEGMENT_P_GPIO, SEGMENT_P_BIT, (segments >> 7 && 1));
+void RemoteDigitTurnOn(uint8_t digits) {
+    (void)digits;
 }
+#endif
 
-void DigitTurnOn(uint8_t digits) {
+#if !defined(CORE_M0)
+void BuzzerToneOn(uint16_t frecuencia) {
 
-    // En bitValue se utiliza 8 >> digits para invertir el orden en que se prenden los digitos
-    Chip_GPIO_SetValue(LPC_GPIO_PORT, DIGITS_GPIO, (8 >> digits) & DIGITS_MASK);
+    Chip_SCTPWM_SetRate(LPC_SCT, frecuencia);
+    Chip_SCTPWM_SetDutyCycle(LPC_SCT, BUZZER_PWM_INDEX, Chip_SCTPWM_GetTicksPerCycle(LPC_SCT) / 2);
+    Chip_SCTPWM_Start(LPC_SCT);
 }
+
+void BuzzerToneOff(void) {
+
+    Chip_SCTPWM_Stop(LPC_SCT);
+    LPC_SCT->OUTPUT &= ~(1 << BUZZER_SCT_OUT); // deja la salida en bajo al detener el contador
+}
+
+void BuzzerSchedule(uint16_t milisegundos) {
+
+    Chip_TIMER_Disable(LPC_TIMER1);
+    Chip_TIMER_Reset(LPC_TIMER1);
+    if (milisegundos) {
+        Chip_TIMER_SetMatch(LPC_TIMER1, 0, milisegundos);
+        Chip_TIMER_Enable(LPC_TIMER1);
+    }
+}
+#endif
+
 /* === Public function implementation ========================================================== */
 
 board_t BoardCreate(void) {
 
+#if defined(CORE_M0)
+    // Imagen del M0: solo pantalla y teclas
+    digits_init();
+    segments_init();
+    keys_init();
+    board.keypad = NULL;
+#elif defined(DUAL_CORE)
+    // Imagen del M4 con el M0 a cargo de la pantalla y las teclas
+    watchdog_init();
+    cycle_counter_init();
+    shared_timer_init();
+    buzzer_init();
+    remote_keys_init();
+    console_init();
+    board.keypad = NULL;
+    board.display = DisplayCreate(DIGITOS, &(struct display_driver_s){
+                                               .ScreenTurnOff = RemoteScreenTurnOff,
+                                               .DigitTurnOn = RemoteDigitTurnOn,
+                                               .SegmentsTurnOn = RemoteSegmentsTurnOn,
+                                           });
+    m0_boot();
+    return &board;
+#else
+    watchdog_init();
+    cycle_counter_init();
     digits_init();
     segments_init();
     buzzer_init();
     keys_init();
+    keypad_init();
+    console_init();
+#endif
 
     // Se hace asi para no tener que crear la estructura , ya que no se
     // volvera a usar esa variable. Solo se puede hacer por que display_driver_s es una
@@ -188,16 +486,129 @@ board_t BoardCreate(void) {
     return &board;
 }
 
+RAPIDA void BoardDisplayRefresh(board_t board) {
+
+#if defined(DUAL_CORE)
+    display_frame_s frame;
+
+    // Solo se publica cuando cambia el contenido, para no competir con las lecturas del M0
+    DisplayGetFrame(board->display, &frame);
+    if (memcmp(&frame, &published_frame, sizeof(frame)) != 0) {
+        published_frame = frame;
+        BuzonPublicarCuadro(&frame);
+    }
+#else
+    DisplayRefresh(board->display);
+#endif
+}
+
+digital_input_t BoardKey(board_key_t key) {
+
+    return (key < BOARD_KEYS) ? *board_keys[key] : NULL;
+}
+
+int BoardKeyIndex(digital_input_t input) {
+
+    for (int key = 0; key < BOARD_KEYS; key++) {
+        if (input && *board_keys[key] == input) {
+            return key;
+        }
+    }
+    return -1;
+}
+
 void SisTick_Init(uint16_t ticks) {
 
-    __asm volatile("cpsid i"); // desactiva las interrupciones
+    __disable_irq(); // desactiva las interrupciones
 
+    systick_ticks = ticks;
     SystemCoreClockUpdate();
     SysTick_Config(SystemCoreClock / ticks);
-    NVIC_SetPriority(SysTick_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+    // El SysTick deja en PendSV, la de menor prioridad, el trabajo que no hace falta en cada tick
+    NVIC_SetPriority(SysTick_IRQn, (1 << __NVIC_PRIO_BITS) - 2);
+    NVIC_SetPriority(PendSV_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+
+    __enable_irq();
+}
+
+void BoardSetCoreClock(uint32_t frecuencia) {
+
+    uint32_t anterior = SystemCoreClock;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    Chip_SetupCoreClock(CLKIN_CRYSTAL, frecuencia, true);
+    SystemCoreClockUpdate();
+
+    // El resto del periodo en curso se carga como un periodo unico y, en cuanto el contador lo
+    // toma, se deja el periodo completo para la nueva frecuencia. Mientras el PLL engancha el
+    // SysTick cuenta con el IRC, asi que el error de fase queda acotado por la duracion del cambio.
+    uint32_t restante = (uint64_t)SysTick->VAL * SystemCoreClock / anterior;
+    if (restante < SYSTICK_MIN_RELOAD) {
+        restante = SYSTICK_MIN_RELOAD;
+    }
+    SysTick->LOAD = restante - 1;
+    SysTick->VAL = 0;
+    for (int intento = 0; intento < SYSTICK_MIN_RELOAD && SysTick->VAL == 0; intento++) {
+    }
+    SysTick->LOAD = SystemCoreClock / systick_ticks - 1;
+
+#if !defined(CORE_M0)
+    // Las notas del zumbador se miden en milisegundos con el TIMER1, que depende del reloj base
+    Chip_TIMER_PrescaleSet(LPC_TIMER1, Chip_Clock_GetRate(CLK_MX_TIMER1) / BUZZER_TIMER_HZ - 1);
+    // Lo mismo el divisor de la UART de la consola
+    Chip_UART_SetBaud(LPC_USART2, CONSOLE_BAUDRATE);
+#endif
+
+    __set_PRIMASK(primask);
+}
+
+void BoardWatchdogFeed(void) {
+
+#if !defined(CORE_M0)
+    Chip_WWDT_Feed(LPC_WWDT);
+#endif
+}
+
+void BoardReset(void) {
+
+    NVIC_SystemReset();
+}
+
+uint32_t BoardCycles(void) {
+
+#if defined(DUAL_CORE) || defined(CORE_M0)
+    return LPC_TIMER3->TC;
+#else
+    return DWT->CYCCNT;
+#endif
+}
+
+#if !defined(CORE_M0)
+void TIMER1_IRQHandler(void) {
+
+    if (Chip_TIMER_MatchPending(LPC_TIMER1, 0)) {
+        Chip_TIMER_ClearMatch(LPC_TIMER1, 0);
+        BuzzerNextStep(board.buzzer);
+    }
+}
+#endif
+
+#if defined(DUAL_CORE)
+// El M0 avisa con SEV que dejo eventos de teclas en el buzon
+void M0APP_IRQHandler(void) {
+
+    buzon_evento_s evento;
 
-    __asm volatile("cpsie i");
+    LPC_CREG->M0APPTXEVENT = 0;
+    while (BuzonRecibirEvento(&evento)) {
+        digital_input_t key = BoardKey(evento.tecla);
+        if (key) {
+            DigitalInputPostEdge(key, (digital_edge_t)evento.flanco, evento.marca);
+        }
+    }
 }
+#endif
 
 /* === End of documentation ==================================================================== */
 
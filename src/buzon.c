@@ -0,0 +1,156 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Buzon de memoria compartida entre los nucleos M4 y M0
+ **
+ ** Los cuadros se transfieren con un contador de secuencia: el M4 lo deja impar mientras escribe y
+ ** el M0 descarta la copia si el contador cambio durante la lectura. Los eventos usan una cola
+ ** circular donde cada indice lo escribe un solo nucleo.
+ **
+ ** \addtogroup buzon Buzon
+ ** \brief Comunicacion entre nucleos
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "buzon.h"
+#include "chip.h"
+#include <string.h>
+
+/* === Macros definitions ====================================================================== */
+
+// Debe ser potencia de dos para que los indices se calculen con una mascara
+#ifndef BUZON_EVENTOS
+    #define BUZON_EVENTOS 16
+#endif
+
+// Lecturas de cuadro que intenta el M0 antes de conservar el cuadro anterior
+#ifndef BUZON_REINTENTOS
+    #define BUZON_REINTENTOS 4
+#endif
+
+/* === Private data type declarations ========================================================== */
+
+typedef struct buzon_s {
+    volatile uint32_t secuencia; // impar mientras el M4 escribe el cuadro
+    display_frame_s cuadro;
+    volatile uint8_t entrada; // solo lo escribe el M0
+    volatile uint8_t salida;  // solo lo escribe el M4
+    buzon_evento_s eventos[BUZON_EVENTOS];
+    volatile uint32_t perdidos;
+    volatile uint32_t reintentos;
+} buzon_s;
+
+/* === Private variable declarations =========================================================== */
+
+// Las dos imagenes deben ubicar el buzon en la misma direccion de RAM compartida. Sin una direccion
+// fija (por ejemplo en Linux, con un hilo por nucleo) se usa una variable comun.
+#if defined(BUZON_DIRECCION)
+    #define BUZON ((buzon_s *)BUZON_DIRECCION)
+#else
+static buzon_s buzon_compartido;
+    #define BUZON (&buzon_compartido)
+#endif
+
+/* === Private function declarations =========================================================== */
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+/* === Public function implementation ========================================================== */
+
+void BuzonInit(void) {
+
+    memset((void *)BUZON, 0, sizeof(buzon_s));
+    __DMB();
+}
+
+void BuzonPublicarCuadro(const display_frame_s * cuadro) {
+
+    BUZON->secuencia++;
+    __DMB();
+    memcpy(&BUZON->cuadro, cuadro, sizeof(BUZON->cuadro));
+    __DMB();
+    BUZON->secuencia++;
+}
+
+bool BuzonLeerCuadro(display_frame_s * cuadro, uint32_t * generacion) {
+
+    for (int intento = 0; intento < BUZON_REINTENTOS; intento++) {
+        uint32_t inicio = BUZON->secuencia;
+        if (inicio == *generacion) {
+            return false;
+        }
+        if ((inicio & 1) == 0) {
+            __DMB();
+            memcpy(cuadro, &BUZON->cuadro, sizeof(*cuadro));
+            __DMB();
+            if (BUZON->secuencia == inicio) {
+                *generacion = inicio;
+                return true;
+            }
+        }
+        BUZON->reintentos++;
+    }
+    return false;
+}
+
+bool BuzonEnviarEvento(const buzon_evento_s * evento) {
+
+    uint8_t entrada = BUZON->entrada;
+    uint8_t siguiente = (entrada + 1) & (BUZON_EVENTOS - 1);
+
+    if (siguiente == BUZON->salida) {
+        BUZON->perdidos++;
+        return false;
+    }
+    BUZON->eventos[entrada] = *evento;
+    __DMB(); // el evento debe estar completo antes de publicar el indice
+    BUZON->entrada = siguiente;
+    return true;
+}
+
+bool BuzonRecibirEvento(buzon_evento_s * evento) {
+
+    uint8_t salida = BUZON->salida;
+
+    if (salida == BUZON->entrada) {
+        return false;
+    }
+    __DMB();
+    *evento = BUZON->eventos[salida];
+    __DMB(); // la copia debe terminar antes de liberar el lugar
+    BUZON->salida = (salida + 1) & (BUZON_EVENTOS - 1);
+    return true;
+}
+
+uint32_t BuzonEventosPerdidos(void) {
+
+    return BUZON->perdidos;
+}
+
+uint32_t BuzonReintentos(void) {
+
+    return BUZON->reintentos;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,204 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Secuenciador de patrones del zumbador
+ **
+ ** El modulo recorre las tablas de notas y delega en el driver la generacion del tono (PWM) y la
+ ** temporizacion de cada nota, de manera que solo se ejecuta codigo en los limites entre notas.
+ **
+ ** \addtogroup buzzer Zumbador
+ ** \brief Patrones de sonido del zumbador
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "buzzer.h"
+#include "rapida.h"
+#include <string.h>
+#include <stddef.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define TONO_ALARMA 2700 // frecuencia de resonancia tipica de un zumbador piezoelectrico
+
+/* === Private data type declarations ========================================================== */
+
+struct buzzer_s {
+    struct buzzer_driver_s driver[1];
+    buzzer_patron_t patron; // patron en reproduccion, NULL si esta detenido
+    uint8_t nota;           // indice de la nota actual dentro del patron
+    uint8_t repeticion;     // repeticiones completas del patron actual
+};
+
+/* === Private variable declarations =========================================================== */
+
+static const buzzer_nota_s NOTAS_BEEP[] = {
+    {2000, 100},
+};
+
+static const buzzer_nota_s NOTAS_ALARMA_LENTA[] = {
+    {TONO_ALARMA, 200},
+    {BUZZER_SILENCIO, 800},
+};
+
+static const buzzer_nota_s NOTAS_ALARMA_MEDIA[] = {
+    {TONO_ALARMA, 150},
+    {BUZZER_SILENCIO, 350},
+};
+
+static const buzzer_nota_s NOTAS_ALARMA_RAPIDA[] = {
+    {TONO_ALARMA, 100},
+    {BUZZER_SILENCIO, 100},
+};
+
+static const buzzer_nota_s NOTAS_MELODIA[] = {
+    {523, 120}, // do
+    {659, 120}, // mi
+    {784, 240}, // sol
+};
+
+static const struct buzzer_patron_s ALARMA_RAPIDA[1] = {{
+    .notas = NOTAS_ALARMA_RAPIDA,
+    .cantidad = sizeof(NOTAS_ALARMA_RAPIDA) / sizeof(NOTAS_ALARMA_RAPIDA[0]),
+    .repeticiones = BUZZER_INFINITO,
+    .siguiente = NULL,
+}};
+
+static const struct buzzer_patron_s ALARMA_MEDIA[1] = {{
+    .notas = NOTAS_ALARMA_MEDIA,
+    .cantidad = sizeof(NOTAS_ALARMA_MEDIA) / sizeof(NOTAS_ALARMA_MEDIA[0]),
+    .repeticiones = 10,
+    .siguiente = ALARMA_RAPIDA,
+}};
+
+/* === Private function declarations =========================================================== */
+
+buzzer_t BuzzerAllocate(void);
+
+void BuzzerStartNote(buzzer_t buzzer);
+
+/* === Public variable definitions ============================================================= */
+
+const struct buzzer_patron_s BUZZER_PATRON_BEEP[1] = {{
+    .notas = NOTAS_BEEP,
+    .cantidad = sizeof(NOTAS_BEEP) / sizeof(NOTAS_BEEP[0]),
+    .repeticiones = 1,
+    .siguiente = NULL,
+}};
+
+const struct buzzer_patron_s BUZZER_PATRON_ALARMA[1] = {{
+    .notas = NOTAS_ALARMA_LENTA,
+    .cantidad = sizeof(NOTAS_ALARMA_LENTA) / sizeof(NOTAS_ALARMA_LENTA[0]),
+    .repeticiones = 10,
+    .siguiente = ALARMA_MEDIA,
+}};
+
+const struct buzzer_patron_s BUZZER_PATRON_MELODIA[1] = {{
+    .notas = NOTAS_MELODIA,
+    .cantidad = sizeof(NOTAS_MELODIA) / sizeof(NOTAS_MELODIA[0]),
+    .repeticiones = 1,
+    .siguiente = NULL,
+}};
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+buzzer_t BuzzerAllocate(void) {
+
+    static struct buzzer_s instances[1] = {0};
+    return &instances[0];
+}
+
+// Carga la nota actual en el hardware: el tono queda sonando y el temporizador avisara su fin
+void BuzzerStartNote(buzzer_t buzzer) {
+
+    const buzzer_nota_s * nota = &buzzer->patron->notas[buzzer->nota];
+
+    if (nota->frecuencia == BUZZER_SILENCIO) {
+        buzzer->driver->ToneOff();
+    } else {
+        buzzer->driver->ToneOn(nota->frecuencia);
+    }
+    buzzer->driver->Schedule(nota->duracion);
+}
+
+/* === Public function implementation ========================================================== */
+
+buzzer_t BuzzerCreate(buzzer_driver_t driver) {
+
+    buzzer_t buzzer = BuzzerAllocate();
+    memcpy(buzzer->driver, driver, sizeof(buzzer->driver));
+    buzzer->patron = NULL;
+    buzzer->nota = 0;
+    buzzer->repeticion = 0;
+    buzzer->driver->ToneOff();
+
+    return buzzer;
+}
+
+void BuzzerPlay(buzzer_t buzzer, buzzer_patron_t patron) {
+
+    if (patron == NULL || patron->cantidad == 0) {
+        BuzzerStop(buzzer);
+        return;
+    }
+    buzzer->patron = patron;
+    buzzer->nota = 0;
+    buzzer->repeticion = 0;
+    BuzzerStartNote(buzzer);
+}
+
+void BuzzerStop(buzzer_t buzzer) {
+
+    buzzer->patron = NULL;
+    buzzer->driver->Schedule(0);
+    buzzer->driver->ToneOff();
+}
+
+RAPIDA bool BuzzerIsPlaying(buzzer_t buzzer) {
+
+    return buzzer->patron != NULL;
+}
+
+void BuzzerNextStep(buzzer_t buzzer) {
+
+    if (buzzer->patron == NULL) {
+        return;
+    }
+
+    buzzer->nota++;
+    if (buzzer->nota >= buzzer->patron->cantidad) {
+        buzzer->nota = 0;
+        // Con BUZZER_INFINITO el patron se repite hasta que se llame a BuzzerStop
+        if (buzzer->patron->repeticiones != BUZZER_INFINITO &&
+            ++buzzer->repeticion >= buzzer->patron->repeticiones) {
+            buzzer->repeticion = 0;
+            buzzer->patron = buzzer->patron->siguiente;
+            // Un patron encadenado sin notas termina la reproduccion, como en BuzzerPlay
+            if (buzzer->patron == NULL || buzzer->patron->cantidad == 0) {
+                BuzzerStop(buzzer);
+                return;
+            }
+        }
+    }
+    BuzzerStartNote(buzzer);
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
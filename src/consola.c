@@ -0,0 +1,298 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Consola de comandos por puerto serie
+ **
+ ** El DMA escribe lo recibido en un anillo y la consola sigue su posicion de escritura. Cada linea
+ ** se procesa en el mismo anillo: el fin de linea y los espacios se reemplazan por '\0' y las
+ ** palabras apuntan directamente a la memoria de recepcion. Solo una linea que cruza el final del
+ ** anillo se copia a un buffer propio para que quede contigua.
+ **
+ ** El DMA no se detiene si la consola se atrasa: la marca de fin de bloque del canal indica que
+ ** paso por el final del anillo. Como cada llamada revisa todo lo recibido, quedar en o delante de
+ ** lo leido despues de pasar por el final es una vuelta completa que piso caracteres sin revisar.
+ **
+ ** Las respuestas se encolan en un buffer circular; en cada llamada a ConsolaProcesar, si el DMA
+ ** termino el bloque anterior, se le entrega el siguiente tramo contiguo.
+ **
+ ** \addtogroup consola Consola
+ ** \brief Consola de comandos por puerto serie
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "consola.h"
+#include "rapida.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define FIN_DE_LINEA "\r\n"
+
+/* === Private data type declarations ========================================================== */
+
+struct consola_s {
+    char * anillo;
+    uint16_t tamano;
+    uint16_t leido;   // proximo caracter del anillo sin revisar
+    uint16_t inicio;  // comienzo de la linea en curso
+    uint16_t largo;   // caracteres de la linea en curso
+    const char * descarte; // motivo por el que la linea en curso se ignora hasta su fin, o NULL
+    char partida[CONSOLA_LINEA_MAXIMA + 1]; // copia de una linea que cruza el final del anillo
+    const consola_comando_s * comandos;
+    uint8_t cantidad;
+    char transmision[CONSOLA_TRANSMISION];
+    uint16_t cola;       // primer byte sin enviar
+    uint16_t pendientes; // bytes encolados, incluidos los que esta enviando el DMA
+    uint16_t enviando;   // bytes entregados al driver en el ultimo bloque
+    consola_informe_s informe;
+    struct consola_driver_s driver[1];
+};
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+consola_t ConsolaAllocate(void);
+void ConsolaLinea(consola_t consola, uint16_t fin);
+void ConsolaEjecutar(consola_t consola, uint8_t argc, char * argv[]);
+void ConsolaAyuda(consola_t consola);
+void ConsolaTransmitir(consola_t consola);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+consola_t ConsolaAllocate(void) {
+
+    static struct consola_s instances[1] = {0};
+    return &instances[0];
+}
+
+// Termina la linea que empieza en inicio y cuyo fin de linea esta en la posicion fin
+void ConsolaLinea(consola_t consola, uint16_t fin) {
+
+    char * linea;
+    char * argv[CONSOLA_ARGUMENTOS];
+    uint8_t argc = 0;
+
+    if (consola->inicio < fin) {
+        linea = &consola->anillo[consola->inicio];
+        consola->anillo[fin] = '\0';
+    } else {
+        uint16_t primera = consola->tamano - consola->inicio;
+        memcpy(consola->partida, &consola->anillo[consola->inicio], primera);
+        memcpy(&consola->partida[primera], consola->anillo, consola->largo - primera);
+        consola->partida[consola->largo] = '\0';
+        linea = consola->partida;
+    }
+
+    for (char * cursor = linea; *cursor;) {
+        if (*cursor == ' ' || *cursor == '\t') {
+            *cursor++ = '\0';
+            continue;
+        }
+        if (argc == CONSOLA_ARGUMENTOS) {
+            consola->informe.lineas++;
+            consola->informe.errores++;
+            ConsolaImprimir(consola, "error: demasiados argumentos");
+            return;
+        }
+        argv[argc++] = cursor;
+        while (*cursor && *cursor != ' ' && *cursor != '\t') {
+            cursor++;
+        }
+    }
+    if (argc) {
+        ConsolaEjecutar(consola, argc, argv);
+    }
+}
+
+void ConsolaEjecutar(consola_t consola, uint8_t argc, char * argv[]) {
+
+    const char * error = "comando desconocido";
+
+    consola->informe.lineas++;
+    if (strcmp(argv[0], "ayuda") == 0) {
+        ConsolaAyuda(consola);
+        error = NULL;
+    } else {
+        for (uint8_t indice = 0; indice < consola->cantidad; indice++) {
+            if (strcmp(argv[0], consola->comandos[indice].nombre) == 0) {
+                error = consola->comandos[indice].accion(consola, argc, argv);
+                break;
+            }
+        }
+    }
+
+    // Cada respuesta termina con una linea de estado, para que el otro extremo sepa cuando termino
+    if (error) {
+        consola->informe.errores++;
+        ConsolaImprimir(consola, "error: %s", error);
+    } else {
+        ConsolaImprimir(consola, "ok");
+    }
+}
+
+void ConsolaAyuda(consola_t consola) {
+
+    for (uint8_t indice = 0; indice < consola->cantidad; indice++) {
+        ConsolaImprimir(consola, "%-12s %s", consola->comandos[indice].nombre,
+                        consola->comandos[indice].ayuda);
+    }
+    ConsolaImprimir(consola, "%-12s %s", "ayuda", "lista los comandos");
+}
+
+void ConsolaTransmitir(consola_t consola) {
+
+    if (consola->enviando) {
+        if (consola->driver->Transmitiendo()) {
+            return;
+        }
+        consola->cola = (consola->cola + consola->enviando) % CONSOLA_TRANSMISION;
+        consola->pendientes -= consola->enviando;
+        consola->enviando = 0;
+    }
+
+    // El DMA necesita un bloque contiguo: si la cola da la vuelta, el resto va en el siguiente
+    if (consola->pendientes) {
+        uint16_t bloque = CONSOLA_TRANSMISION - consola->cola;
+        if (bloque > consola->pendientes) {
+            bloque = consola->pendientes;
+        }
+        if (consola->driver->Transmitir(&consola->transmision[consola->cola], bloque)) {
+            consola->enviando = bloque;
+        }
+    }
+}
+
+/* === Public function implementation ========================================================== */
+
+consola_t ConsolaCreate(char * anillo, uint16_t tamano, consola_driver_t driver) {
+
+    consola_t consola = ConsolaAllocate();
+
+    memset(consola, 0, sizeof(*consola));
+    consola->anillo = anillo;
+    consola->tamano = tamano;
+    driver->Vuelta();
+    consola->leido = driver->Recibidos();
+    consola->inicio = consola->leido;
+    memcpy(consola->driver, driver, sizeof(consola->driver));
+
+    return consola;
+}
+
+void ConsolaComandos(consola_t consola, const consola_comando_s * comandos, uint8_t cantidad) {
+
+    consola->comandos = comandos;
+    consola->cantidad = cantidad;
+}
+
+void ConsolaProcesar(consola_t consola) {
+
+    bool vuelta = consola->driver->Vuelta();
+    uint16_t recibidos = consola->driver->Recibidos();
+
+    // El final se cruzo entre las dos consultas: la marca que dejo corresponde a esta llamada
+    if (!vuelta && recibidos < consola->leido) {
+        consola->driver->Vuelta();
+    }
+    // Lo que queda en el anillo empieza delante de la posicion del DMA, cuyo primer caracter esta
+    // por pisarse: se revisa lo demas y se descarta hasta el primer fin de linea
+    if (vuelta && recibidos >= consola->leido) {
+        consola->informe.desbordes++;
+        consola->descarte = "desborde de recepcion";
+        consola->leido = (recibidos + 1) % consola->tamano;
+        consola->inicio = consola->leido;
+        consola->largo = 0;
+    }
+
+    while (consola->leido != recibidos) {
+        uint16_t posicion = consola->leido;
+        char caracter = consola->anillo[posicion];
+
+        consola->leido = (posicion + 1) % consola->tamano;
+        if (caracter == '\r' || caracter == '\n') {
+            if (consola->descarte) {
+                consola->informe.lineas++;
+                consola->informe.errores++;
+                ConsolaImprimir(consola, "error: %s", consola->descarte);
+            } else if (consola->largo) {
+                ConsolaLinea(consola, posicion);
+            }
+            consola->descarte = NULL;
+            consola->largo = 0;
+            consola->inicio = consola->leido;
+        } else if (consola->largo < CONSOLA_LINEA_MAXIMA) {
+            consola->largo++;
+        } else if (!consola->descarte) {
+            consola->descarte = "linea demasiado larga";
+        }
+    }
+
+    ConsolaTransmitir(consola);
+}
+
+void ConsolaImprimir(consola_t consola, const char * formato, ...) {
+
+    char texto[CONSOLA_LINEA_MAXIMA + sizeof(FIN_DE_LINEA)];
+    va_list argumentos;
+
+    va_start(argumentos, formato);
+    int largo = vsnprintf(texto, CONSOLA_LINEA_MAXIMA + 1, formato, argumentos);
+    va_end(argumentos);
+    if (largo < 0) {
+        return;
+    }
+    if (largo > CONSOLA_LINEA_MAXIMA) {
+        largo = CONSOLA_LINEA_MAXIMA;
+    }
+    memcpy(&texto[largo], FIN_DE_LINEA, sizeof(FIN_DE_LINEA) - 1);
+    largo += sizeof(FIN_DE_LINEA) - 1;
+
+    if (largo > CONSOLA_TRANSMISION - consola->pendientes) {
+        consola->informe.descartados += largo;
+        return;
+    }
+    uint16_t cabeza = (consola->cola + consola->pendientes) % CONSOLA_TRANSMISION;
+    uint16_t primera = CONSOLA_TRANSMISION - cabeza;
+    if (primera > largo) {
+        primera = largo;
+    }
+    memcpy(&consola->transmision[cabeza], texto, primera);
+    memcpy(consola->transmision, &texto[primera], largo - primera);
+    consola->pendientes += largo;
+}
+
+RAPIDA bool ConsolaPendiente(consola_t consola) {
+
+    return consola->pendientes != 0;
+}
+
+const consola_informe_s * ConsolaInforme(consola_t consola) {
+
+    return &consola->informe;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
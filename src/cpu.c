@@ -0,0 +1,93 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Reposo del procesador y medicion de carga
+ **
+ ** Los ciclos activos se miden con el DWT CYCCNT en cada intervalo despierto (entre dos WFI), por
+ ** lo que el resultado no depende de que el contador avance o no durante el reposo. El tiempo total
+ ** se toma del SysTick, que sigue contando con el nucleo dormido.
+ **
+ ** \addtogroup cpu CPU
+ ** \brief Reposo y utilizacion del procesador
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "cpu.h"
+#include "chip.h"
+#include "rapida.h"
+
+/* === Macros definitions ====================================================================== */
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+static uint64_t ciclos_totales = 0;
+static uint64_t ciclos_activo = 0;
+static uint32_t despertar = 0; // CYCCNT al salir del ultimo WFI
+
+/* === Private function declarations =========================================================== */
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+/* === Public function implementation ========================================================== */
+
+void CpuInit(void) {
+
+    ciclos_totales = 0;
+    ciclos_activo = 0;
+    despertar = DWT->CYCCNT;
+}
+
+RAPIDA void CpuTick(void) {
+
+    ciclos_totales += SysTick->LOAD + 1;
+}
+
+void CpuDormir(void) {
+
+    ciclos_activo += DWT->CYCCNT - despertar;
+    __DSB();
+    __WFI();
+    despertar = DWT->CYCCNT;
+}
+
+void CpuCarga(cpu_carga_s * carga) {
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint64_t totales = ciclos_totales;
+    uint64_t activo = ciclos_activo;
+    __set_PRIMASK(primask);
+
+    if (activo > totales) {
+        activo = totales; // el periodo del SysTick en curso todavia no se acumulo
+    }
+    carga->ciclos_activo = activo;
+    carga->ciclos_dormido = totales - activo;
+    carga->utilizacion = totales ? (uint8_t)(activo * 100 / totales) : 0;
+    carga->reposo = 100 - carga->utilizacion;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
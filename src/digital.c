@@ -27,14 +27,27 @@ SPDX-License-Identifier: MIT
 
 #include "digital.h"
 #include "chip.h"
+#include "rapida.h"
+#include <string.h>
 
 /* === Macros definitions ====================================================================== */
 // Si no esta definido OUTPUT_INSTANCES en algun otro archivo h, se lo define aqui.
 #ifndef OUTPUT_INSTANCES
     #define OUTPUT_INSTANCES 4
 #endif
+// Las entradas de un solo pin mas las teclas de un teclado matricial de 3 x 4
 #ifndef INPUT_INSTANCES
-    #define INPUT_INSTANCES 6
+    #define INPUT_INSTANCES 18
+#endif
+#ifndef MATRIX_MAX_ROWS
+    #define MATRIX_MAX_ROWS 4
+#endif
+#ifndef MATRIX_MAX_COLUMNS
+    #define MATRIX_MAX_COLUMNS 8
+#endif
+// Debe ser potencia de dos para que los indices de la cola se calculen con una mascara
+#ifndef EVENT_QUEUE_SIZE
+    #define EVENT_QUEUE_SIZE 16
 #endif
 
 /* === Private data type declarations ========================================================== */
@@ -50,12 +63,37 @@ struct digital_input_s {
     bool allocated : 1;
     bool inverted : 1;
     bool last_change : 1;
+    bool last_scan : 1; // estado visto por DigitalInputsScan, independiente de last_change
+    bool remote : 1; // sin pin propio: el estado lo fija un teclado matricial o el otro nucleo
+    bool remote_state : 1;
+};
+
+struct digital_matrix_s {
+    digital_matrix_row_s rows[MATRIX_MAX_ROWS];
+    uint8_t row_count;
+    uint8_t columns;
+    digital_input_t keys[MATRIX_MAX_ROWS][MATRIX_MAX_COLUMNS];
+    uint8_t frame[MATRIX_MAX_COLUMNS]; // filas activas leidas en cada columna del barrido actual
+    uint32_t ghosts;
 };
 /* === Private variable declarations =========================================================== */
 
+static struct digital_input_s input_instances[INPUT_INSTANCES] = {0};
+
+// Cola de eventos: DigitalInputsScan (interrupcion) escribe en head y el lazo principal lee en tail
+static digital_event_s event_queue[EVENT_QUEUE_SIZE];
+static volatile uint8_t event_head = 0;
+static volatile uint8_t event_tail = 0;
+static uint32_t events_dropped = 0;
+static digital_timestamp_t event_timestamp = NULL;
+static estadistica_s event_latency;
+
 /* === Private function declarations =========================================================== */
 digital_output_t DigitalOutputAllocate(void);
 digital_input_t DigitalInputAllocate(void);
+digital_matrix_t DigitalMatrixAllocate(void);
+bool DigitalMatrixHasGhost(digital_matrix_t matrix);
+void DigitalEventPush(digital_input_t input, bool state, uint32_t stamp);
 /* === Public variable definitions ============================================================= */
 
 /* === Private variable definitions ============================================================ */
@@ -77,18 +115,58 @@ digital_output_t DigitalOutputAllocate() {
 }
 
 digital_input_t DigitalInputAllocate() {
-    static struct digital_input_s instances[INPUT_INSTANCES] = {0};
     digital_input_t input = NULL;
     for (int i = 0; i < INPUT_INSTANCES; i++) {
-        if (instances[i].allocated == false) {
-            input = &instances[i];
-            instances[i].allocated = true;
+        if (input_instances[i].allocated == false) {
+            input = &input_instances[i];
+            input_instances[i].allocated = true;
             break;
         }
     }
     return input;
 }
 
+digital_matrix_t DigitalMatrixAllocate(void) {
+    static struct digital_matrix_s instances[1] = {0};
+    static bool allocated = false;
+    digital_matrix_t matrix = NULL;
+
+    if (!allocated) {
+        allocated = true;
+        matrix = &instances[0];
+    }
+    return matrix;
+}
+
+// Sin diodos, tres teclas en las esquinas de un rectangulo hacen ver presionada la cuarta. Cuando
+// dos columnas comparten dos o mas filas activas no se puede saber cuales teclas son reales.
+bool DigitalMatrixHasGhost(digital_matrix_t matrix) {
+
+    for (uint8_t i = 0; i < matrix->columns; i++) {
+        for (uint8_t j = i + 1; j < matrix->columns; j++) {
+            uint8_t common = matrix->frame[i] & matrix->frame[j];
+            if (common & (common - 1)) { // mas de un bit en comun
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Encola un evento; solo debe llamarse desde interrupciones de igual prioridad
+void DigitalEventPush(digital_input_t input, bool state, uint32_t stamp) {
+
+    uint8_t next = (event_head + 1) & (EVENT_QUEUE_SIZE - 1);
+    if (next == event_tail) {
+        events_dropped++;
+        return;
+    }
+    event_queue[event_head].input = input;
+    event_queue[event_head].edge = state ? DIGITAL_EVENT_ACTIVATED : DIGITAL_EVENT_DEACTIVATED;
+    event_queue[event_head].stamp = stamp;
+    event_head = next; // se publica el evento recien cuando esta completo
+}
+
 /* === Public function implementation ========================================================== */
 /* --------------------------SALIDAS-------------------------- */
 digital_output_t DigitalOutputCreate(uint8_t port, uint8_t pin) {
@@ -127,13 +205,30 @@ digital_input_t DigitalInputCreate(uint8_t port, uint8_t pin, bool inverted) {
         input->port = port;
         input->inverted = inverted;
         Chip_GPIO_SetPinDIR(LPC_GPIO_PORT, input->port, input->pin, false);
+        input->last_scan = DigitalInputGetState(input);
     }
 
     return input;
 }
 
+digital_input_t DigitalInputCreateRemote(void) {
+
+    digital_input_t input = DigitalInputAllocate();
+    if (input) {
+        input->remote = true;
+        input->remote_state = false;
+        input->inverted = false;
+        input->last_scan = false;
+        input->last_change = false;
+    }
+    return input;
+}
+
 bool DigitalInputGetState(digital_input_t input) {
 
+    if (input->remote) {
+        return input->inverted ^ input->remote_state;
+    }
     return input->inverted ^ Chip_GPIO_GetPinState(LPC_GPIO_PORT, input->port, input->pin);
 }
 
@@ -162,6 +257,144 @@ bool DigitalInputHasDeactivated(digital_input_t input) {
     return result;
 }
 
+/* --------------------------TECLADO MATRICIAL-------------------------- */
+
+digital_matrix_t DigitalMatrixCreate(const digital_matrix_row_s * rows, uint8_t row_count,
+                                     uint8_t columns) {
+
+    if (row_count > MATRIX_MAX_ROWS || columns > MATRIX_MAX_COLUMNS) {
+        return NULL;
+    }
+    digital_matrix_t matrix = DigitalMatrixAllocate();
+    if (matrix) {
+        matrix->row_count = row_count;
+        matrix->columns = columns;
+        matrix->ghosts = 0;
+        memset(matrix->frame, 0, sizeof(matrix->frame));
+        for (uint8_t row = 0; row < row_count; row++) {
+            matrix->rows[row] = rows[row];
+            Chip_GPIO_SetPinDIR(LPC_GPIO_PORT, rows[row].port, rows[row].pin, false);
+            for (uint8_t column = 0; column < columns; column++) {
+                matrix->keys[row][column] = DigitalInputCreateRemote();
+            }
+        }
+    }
+    return matrix;
+}
+
+digital_input_t DigitalMatrixKey(digital_matrix_t matrix, uint8_t row, uint8_t column) {
+
+    if (row >= matrix->row_count || column >= matrix->columns) {
+        return NULL;
+    }
+    return matrix->keys[row][column];
+}
+
+RAPIDA void DigitalMatrixScan(digital_matrix_t matrix, uint8_t column) {
+
+    uint8_t active = 0;
+
+    if (column >= matrix->columns) {
+        return;
+    }
+    for (uint8_t row = 0; row < matrix->row_count; row++) {
+        if (Chip_GPIO_GetPinState(LPC_GPIO_PORT, matrix->rows[row].port, matrix->rows[row].pin)) {
+            active |= 1 << row;
+        }
+    }
+    matrix->frame[column] = active;
+
+    if (column != matrix->columns - 1) {
+        return;
+    }
+    // Barrido completo: se conserva el estado anterior si el cuadro es ambiguo
+    if (DigitalMatrixHasGhost(matrix)) {
+        matrix->ghosts++;
+        return;
+    }
+    for (uint8_t c = 0; c < matrix->columns; c++) {
+        for (uint8_t row = 0; row < matrix->row_count; row++) {
+            if (matrix->keys[row][c]) {
+                matrix->keys[row][c]->remote_state = (matrix->frame[c] >> row) & 1;
+            }
+        }
+    }
+}
+
+uint32_t DigitalMatrixGhosts(digital_matrix_t matrix) {
+
+    return matrix->ghosts;
+}
+
+/* --------------------------EVENTOS-------------------------- */
+
+void DigitalEventsInit(digital_timestamp_t timestamp) {
+
+    event_timestamp = timestamp;
+    events_dropped = 0;
+    EstadisticaReiniciar(&event_latency);
+}
+
+RAPIDA void DigitalInputsScan(void) {
+
+    uint32_t stamp = event_timestamp ? event_timestamp() : 0;
+
+    for (int i = 0; i < INPUT_INSTANCES; i++) {
+        digital_input_t input = &input_instances[i];
+        if (!input->allocated) {
+            continue;
+        }
+        bool current_state = DigitalInputGetState(input);
+        if (current_state == input->last_scan) {
+            continue;
+        }
+        input->last_scan = current_state;
+        DigitalEventPush(input, current_state, stamp);
+    }
+}
+
+void DigitalInputPostEdge(digital_input_t input, digital_edge_t edge, uint32_t stamp) {
+
+    bool state = (edge == DIGITAL_EVENT_ACTIVATED);
+
+    input->remote_state = state ^ input->inverted;
+    input->last_scan = state; // DigitalInputsScan no debe volver a informar este flanco
+    DigitalEventPush(input, state, stamp);
+}
+
+bool DigitalEventGet(digital_event_s * event) {
+
+    if (event_tail == event_head) {
+        return false;
+    }
+    *event = event_queue[event_tail];
+    event_tail = (event_tail + 1) & (EVENT_QUEUE_SIZE - 1);
+    return true;
+}
+
+RAPIDA bool DigitalEventsPending(void) {
+
+    return event_tail != event_head;
+}
+
+void DigitalEventHandled(const digital_event_s * event) {
+
+    if (event_timestamp) {
+        // La resta sin signo sigue siendo valida cuando el contador desborda
+        EstadisticaRegistrar(&event_latency, event_timestamp() - event->stamp);
+    }
+}
+
+const estadistica_s * DigitalEventsLatency(void) {
+
+    return &event_latency;
+}
+
+uint32_t DigitalEventsDropped(void) {
+
+    return events_dropped;
+}
+
 /* === End of documentation ==================================================================== */
 
 /** @} End of module definition for doxygen */
\ No newline at end of file
@@ -0,0 +1,139 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Escalado del reloj del nucleo segun la actividad
+ **
+ ** La frecuencia se restablece en el mismo tick en que aparece la actividad, antes de que el lazo
+ ** principal procese el evento: el SysTick la pide y PendSV la cambia a continuacion. El costo de
+ ** cada cambio se mide con el DWT CYCCNT, que cuenta ciclos del nucleo a la frecuencia que tenga en
+ ** cada momento.
+ **
+ ** \addtogroup energia Energia
+ ** \brief Administracion de la frecuencia del nucleo
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "energia.h"
+#include "chip.h"
+#include "rapida.h"
+
+/* === Macros definitions ====================================================================== */
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+static struct {
+    energia_reloj_t cambiar;
+    uint32_t plena;
+    uint32_t reducida;
+    uint16_t espera;
+    uint16_t inactivo;           // ticks seguidos sin actividad
+    volatile bool reposo_pedido; // el SysTick pide la frecuencia reducida
+    volatile bool en_reposo;     // el nucleo funciona a la frecuencia reducida
+    uint32_t cambios;
+    uint32_t ticks_reducidos;
+    estadistica_s costo;
+} energia;
+
+/* === Private function declarations =========================================================== */
+
+void EnergiaCambiar(uint32_t frecuencia);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+void EnergiaCambiar(uint32_t frecuencia) {
+
+    uint32_t inicio = DWT->CYCCNT;
+    energia.cambiar(frecuencia);
+    EstadisticaRegistrar(&energia.costo, DWT->CYCCNT - inicio);
+    energia.cambios++;
+}
+
+/* === Public function implementation ========================================================== */
+
+void EnergiaInit(energia_reloj_t cambiar, uint32_t plena, uint32_t reducida, uint16_t espera) {
+
+    energia.cambiar = cambiar;
+    energia.plena = plena;
+    energia.reducida = reducida;
+    energia.espera = espera;
+    energia.inactivo = 0;
+    energia.reposo_pedido = false;
+    energia.en_reposo = false;
+    energia.cambios = 0;
+    energia.ticks_reducidos = 0;
+    EstadisticaReiniciar(&energia.costo);
+}
+
+RAPIDA bool EnergiaTick(bool ocupado) {
+
+    if (!energia.cambiar) {
+        return false;
+    }
+
+    if (ocupado) {
+        energia.inactivo = 0;
+        energia.reposo_pedido = false;
+    } else if (energia.en_reposo) {
+        energia.ticks_reducidos++;
+    } else if (!energia.reposo_pedido && ++energia.inactivo >= energia.espera) {
+        energia.reposo_pedido = true;
+    }
+    return energia.reposo_pedido != energia.en_reposo;
+}
+
+// Si el SysTick interrumpe entre el cambio y la actualizacion de en_reposo vuelve a pedir PendSV,
+// que entonces no encuentra nada que cambiar
+void EnergiaAplicar(void) {
+
+    bool reposo = energia.reposo_pedido;
+
+    if (energia.cambiar && reposo != energia.en_reposo) {
+        EnergiaCambiar(reposo ? energia.reducida : energia.plena);
+        energia.en_reposo = reposo;
+    }
+}
+
+bool EnergiaReducida(void) {
+
+    return energia.en_reposo;
+}
+
+uint32_t EnergiaCambios(void) {
+
+    return energia.cambios;
+}
+
+uint32_t EnergiaTicksReducidos(void) {
+
+    return energia.ticks_reducidos;
+}
+
+const estadistica_s * EnergiaCosto(void) {
+
+    return &energia.costo;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
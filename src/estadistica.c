@@ -0,0 +1,102 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Estadisticas acumuladas de mediciones
+ **
+ ** \addtogroup estadistica Estadistica
+ ** \brief Minimo, maximo, promedio y percentiles de mediciones
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "estadistica.h"
+#include "rapida.h"
+#include <string.h>
+
+/* === Macros definitions ====================================================================== */
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+uint8_t EstadisticaCubeta(uint32_t valor);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+// Cantidad de bits significativos del valor: 0 para 0, 1 para 1, 2 para 2 y 3, etc.
+RAPIDA uint8_t EstadisticaCubeta(uint32_t valor) {
+
+    return valor ? (uint8_t)(32 - __builtin_clz(valor)) : 0;
+}
+
+/* === Public function implementation ========================================================== */
+
+void EstadisticaReiniciar(estadistica_s * estadistica) {
+
+    memset(estadistica, 0, sizeof(*estadistica));
+    estadistica->minimo = UINT32_MAX;
+}
+
+RAPIDA void EstadisticaRegistrar(estadistica_s * estadistica, uint32_t valor) {
+
+    if (valor < estadistica->minimo) {
+        estadistica->minimo = valor;
+    }
+    if (valor > estadistica->maximo) {
+        estadistica->maximo = valor;
+    }
+    estadistica->cantidad++;
+    estadistica->suma += valor;
+    estadistica->histograma[EstadisticaCubeta(valor)]++;
+}
+
+uint32_t EstadisticaPromedio(const estadistica_s * estadistica) {
+
+    if (estadistica->cantidad == 0) {
+        return 0;
+    }
+    return (uint32_t)(estadistica->suma / estadistica->cantidad);
+}
+
+uint32_t EstadisticaPercentil(const estadistica_s * estadistica, uint8_t percentil) {
+
+    // Cantidad de muestras que deben quedar por debajo del percentil, redondeando hacia arriba
+    uint32_t objetivo = (uint32_t)(((uint64_t)estadistica->cantidad * percentil + 99) / 100);
+    uint32_t acumulado = 0;
+
+    if (estadistica->cantidad == 0) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < ESTADISTICA_CUBETAS; i++) {
+        acumulado += estadistica->histograma[i];
+        if (acumulado >= objetivo && acumulado) {
+            uint32_t cota = (i == 0) ? 0 : (uint32_t)((1ULL << i) - 1);
+            return (cota < estadistica->maximo) ? cota : estadistica->maximo;
+        }
+    }
+    return estadistica->maximo;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -44,6 +44,20 @@
 #include "chip.h"
 #include <stdbool.h>
 #include "digital.h"
+#include "cpu.h"
+#include "energia.h"
+#include "temporizador.h"
+#include "planificador.h"
+#include "perfil.h"
+#include "consola.h"
+#include "traza.h"
+#include "reinicio.h"
+#include "bcd.h"
+#include "tiempo.h"
+#include "rapida.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
 
 /* === Macros definitions ====================================================================== */
 //#define RES_RELOJ         6    // Cuantos digitos tiene el reloj
@@ -51,293 +65,838 @@
 #define INT_PER_SECOND       1000 // interrupciones por segundo del systick
 #define DELAY_SET_TIME_ALARM 3 // segundos de delay para que se active el boton set_time o set_alarm
 #define MAX_IDLE_TIME        5 // cantidad de segundos antes de cancelar por inactividad
+#define FRECUENCIA_REPOSO    48000000 // frecuencia del nucleo con la interfaz inactiva
+#define ESPERA_REPOSO        500 // ticks sin actividad antes de bajar la frecuencia
+#define PLAZO_INTERFAZ       20 // ticks para atender una tecla
+#define PLAZO_HORA           100 // ticks para actualizar la hora en pantalla
+#define PERIODO_CONSOLA      10 // ticks entre revisiones de la consola
+#define PAGINA_TRAZA         40 // registros de la traza por respuesta de la consola
+#define ESPERA_PERRO         (BOARD_WATCHDOG_MS * INT_PER_SECOND / 1000) // ticks hasta que reinicia
+
+// En modo de dos nucleos las marcas de las teclas las pone el M0 con el TIMER3 que comparten
+#if defined(DUAL_CORE)
+    #define MARCA_TECLAS  BoardCycles
+    #define UNIDAD_TECLAS "ciclos"
+#else
+    #define MARCA_TECLAS  TiempoMicros32
+    #define UNIDAD_TECLAS "us"
+#endif
 /* === Private data type declarations ========================================================== */
 
+// MODO_ACTUAL no es un modo: como destino de una transicion indica que el modo no cambia
 typedef enum {
+    MODO_ACTUAL,
     SIN_CONFIGURAR,
     MOSTRANDO_HORA,
     AJUSTANDO_MINUTOS_ACTUAL,
     AJUSTANDO_HORAS_ACTUAL,
     AJUSTANDO_MINUTOS_ALARMA,
     AJUSTANDO_HORAS_ALARMA,
+    MODOS,
 } modo_t;
 
+typedef enum {
+    EVENTO_ACEPTAR,
+    EVENTO_CANCELAR,
+    EVENTO_AJUSTAR_HORA,   // F1 sostenido DELAY_SET_TIME_ALARM segundos
+    EVENTO_AJUSTAR_ALARMA, // F2 sostenido DELAY_SET_TIME_ALARM segundos
+    EVENTO_DECREMENTAR,
+    EVENTO_INCREMENTAR,
+    EVENTO_INACTIVIDAD, // MAX_IDLE_TIME segundos sin teclas durante un ajuste
+    EVENTOS,
+} evento_t;
+
+typedef bool (*guarda_t)(void);
+typedef void (*accion_t)(void);
+
+typedef struct modo_s {
+    accion_t entrada;
+    accion_t salida;
+    uint8_t parpadeo_desde; // digitos que parpadean mientras dura el modo
+    uint8_t parpadeo_hasta;
+    uint16_t parpadeo;      // factor de parpadeo, 0 si no parpadea
+    bool muestra_hora;      // el SysTick muestra la hora cada segundo
+} modo_s;
+
+// Una transicion sin guarda siempre se toma. Las que quedan en cero no cambian nada, por lo que
+// una celda vacia de la tabla ignora el evento.
+typedef struct transicion_s {
+    guarda_t guarda;
+    accion_t accion;
+    modo_t destino;
+} transicion_s;
+
+// Transiciones alternativas por celda; se toma la primera cuya guarda se cumpla
+#define ALTERNATIVAS 2
+
+// Estado de la interfaz que se retoma despues de un reinicio en caliente, junto con el reloj
+typedef struct interfaz_retenida_s {
+    modo_t modo;
+    uint8_t edicion[4]; // copia de temp_input, la hora o alarma que se estaba ajustando
+    uint8_t brillo;
+    uint32_t suma;
+} interfaz_retenida_s;
+
 /* === Private variable declarations =========================================================== */
 static board_t board;
 static reloj_t reloj;
 static uint8_t temp_input[4] = {0, 0, 0, 0}; // 4 porque nunca se configura la hora por minutos
-static const uint8_t limite_min[] = {5, 9};
-static const uint8_t limite_hs[] = {2, 3};
 static bool alarma_sonando = false;
-static bool flag_set_time_alarm = false; // para que el systick sepa cuando se presiono el boton
-static uint8_t cnt_set_time_alarm = DELAY_SET_TIME_ALARM; // contador para el delay del boton
-static bool flag_idle = false; // bandera para el "cancel" por inactividad
-static uint8_t cnt_idle = MAX_IDLE_TIME;
+static temporizador_t inactividad; // "cancel" por inactividad, se retira desde el lazo principal
+static temporizador_t pulsacion;   // pulsacion larga de F1 o F2
+static volatile bool pulsacion_larga = false; // la tecla se mantuvo DELAY_SET_TIME_ALARM segundos
+static tarea_t tarea_interfaz;
+static tarea_t tarea_hora;
+static volatile bool nuevo_segundo = false; // los fijan los eventos del reloj en PendSV
+static volatile bool medio_segundo = false;
+static interfaz_retenida_s interfaz RETENIDA;
+static reinicio_causa_t reinicio_pedido = REINICIO_FRIO; // REINICIO_PEDIDO o REINICIO_PERRO
+static estadistica_s latencia_systick; // ciclos desde la recarga del SysTick hasta su handler
 
 /* === Private function declarations ===========================================================
  */
 
-void ActivarAlarma(reloj_t reloj, bool act_desact);
+void ActivarAlarma(reloj_t reloj, reloj_evento_t evento, void * contexto);
+void MarcarSegundo(reloj_t reloj, reloj_evento_t evento, void * contexto);
 void CambiarModo(modo_t modo);
-void IncrementarBCD(uint8_t numero[2], const uint8_t limite[2]);
-// limite indica donde se pasa despues de restar 1 a 00
-void DecrementarBCD(uint8_t numero[2], const uint8_t limite[2]);
+void Despachar(evento_t evento);
+void GuardarInterfaz(void);
+void RetomarInterfaz(void);
+void Reiniciar(reinicio_causa_t causa);
+void PulsacionCumplida(temporizador_t temporizador, void * contexto);
+void TareaInterfaz(void * contexto);
+void TareaHora(void * contexto);
+void TareaConsola(void * contexto);
+uint8_t LeerHora(const char * texto, uint8_t digitos[6]);
+
+// Guardas
+bool HoraValida(void);
+bool AlarmaDeshabilitada(void);
+bool AlarmaHabilitadaSilenciosa(void);
+bool AlarmaSonando(void);
+
+// Acciones
+void IniciarInactividad(void);
+void DetenerInactividad(void);
+void ConfirmarHora(void);
+void ConfirmarAlarma(void);
+void HabilitarAlarma(void);
+void DeshabilitarAlarma(void);
+void Posponer(void);
+void Cancelar(void);
+void LimpiarPuntos(void);
+void EditarHora(void);
+void EditarAlarma(void);
+void AjustarEdicion(bcd_t valor);
+void IncrementarMinutos(void);
+void IncrementarHoras(void);
+void DecrementarMinutos(void);
+void DecrementarHoras(void);
+
+// Comandos de la consola
+const char * ComandoHora(consola_t consola, uint8_t argc, char * argv[]);
+const char * ComandoAlarma(consola_t consola, uint8_t argc, char * argv[]);
+const char * ComandoBrillo(consola_t consola, uint8_t argc, char * argv[]);
+const char * ComandoEstado(consola_t consola, uint8_t argc, char * argv[]);
+const char * ComandoPerfil(consola_t consola, uint8_t argc, char * argv[]);
+const char * ComandoTraza(consola_t consola, uint8_t argc, char * argv[]);
+const char * ComandoReiniciar(consola_t consola, uint8_t argc, char * argv[]);
 
 /* === Public variable definitions ============================================================= */
 modo_t modo;
 /* === Private variable definitions ============================================================ */
 
+static const modo_s modos[MODOS] = {
+    [SIN_CONFIGURAR] = {.parpadeo_hasta = 3, .parpadeo = 250, .muestra_hora = true},
+    [MOSTRANDO_HORA] = {.parpadeo_hasta = 3, .muestra_hora = true},
+    [AJUSTANDO_MINUTOS_ACTUAL] = {IniciarInactividad, DetenerInactividad, 2, 3, 250},
+    [AJUSTANDO_HORAS_ACTUAL] = {IniciarInactividad, DetenerInactividad, 0, 1, 250},
+    [AJUSTANDO_MINUTOS_ALARMA] = {IniciarInactividad, DetenerInactividad, 2, 3, 250},
+    [AJUSTANDO_HORAS_ALARMA] = {IniciarInactividad, DetenerInactividad, 0, 1, 250},
+};
+
+// clang-format off
+static const transicion_s transiciones[MODOS][EVENTOS][ALTERNATIVAS] = {
+    [SIN_CONFIGURAR] = {
+        [EVENTO_AJUSTAR_HORA]   = {{NULL, EditarHora, AJUSTANDO_MINUTOS_ACTUAL}},
+    },
+    [MOSTRANDO_HORA] = {
+        [EVENTO_ACEPTAR]        = {{AlarmaDeshabilitada, HabilitarAlarma, MODO_ACTUAL},
+                                   {AlarmaSonando, Posponer, MODO_ACTUAL}},
+        [EVENTO_CANCELAR]       = {{AlarmaHabilitadaSilenciosa, DeshabilitarAlarma, MODO_ACTUAL},
+                                   {AlarmaSonando, Cancelar, MODO_ACTUAL}},
+        [EVENTO_AJUSTAR_HORA]   = {{NULL, EditarHora, AJUSTANDO_MINUTOS_ACTUAL}},
+        [EVENTO_AJUSTAR_ALARMA] = {{NULL, EditarAlarma, AJUSTANDO_MINUTOS_ALARMA}},
+    },
+    [AJUSTANDO_MINUTOS_ACTUAL] = {
+        [EVENTO_ACEPTAR]        = {{NULL, NULL, AJUSTANDO_HORAS_ACTUAL}},
+        [EVENTO_CANCELAR]       = {{HoraValida, LimpiarPuntos, MOSTRANDO_HORA},
+                                   {NULL, NULL, SIN_CONFIGURAR}},
+        [EVENTO_AJUSTAR_HORA]   = {{NULL, EditarHora, AJUSTANDO_MINUTOS_ACTUAL}},
+        [EVENTO_AJUSTAR_ALARMA] = {{NULL, EditarAlarma, AJUSTANDO_MINUTOS_ALARMA}},
+        [EVENTO_DECREMENTAR]    = {{NULL, DecrementarMinutos, MODO_ACTUAL}},
+        [EVENTO_INCREMENTAR]    = {{NULL, IncrementarMinutos, MODO_ACTUAL}},
+        [EVENTO_INACTIVIDAD]    = {{HoraValida, LimpiarPuntos, MOSTRANDO_HORA},
+                                   {NULL, LimpiarPuntos, SIN_CONFIGURAR}},
+    },
+    [AJUSTANDO_HORAS_ACTUAL] = {
+        [EVENTO_ACEPTAR]        = {{NULL, ConfirmarHora, MOSTRANDO_HORA}},
+        [EVENTO_CANCELAR]       = {{NULL, NULL, AJUSTANDO_MINUTOS_ACTUAL}},
+        [EVENTO_AJUSTAR_HORA]   = {{NULL, EditarHora, AJUSTANDO_MINUTOS_ACTUAL}},
+        [EVENTO_AJUSTAR_ALARMA] = {{NULL, EditarAlarma, AJUSTANDO_MINUTOS_ALARMA}},
+        [EVENTO_DECREMENTAR]    = {{NULL, DecrementarHoras, MODO_ACTUAL}},
+        [EVENTO_INCREMENTAR]    = {{NULL, IncrementarHoras, MODO_ACTUAL}},
+        [EVENTO_INACTIVIDAD]    = {{HoraValida, LimpiarPuntos, MOSTRANDO_HORA},
+                                   {NULL, LimpiarPuntos, SIN_CONFIGURAR}},
+    },
+    [AJUSTANDO_MINUTOS_ALARMA] = {
+        [EVENTO_ACEPTAR]        = {{NULL, NULL, AJUSTANDO_HORAS_ALARMA}},
+        [EVENTO_CANCELAR]       = {{HoraValida, LimpiarPuntos, MOSTRANDO_HORA},
+                                   {NULL, NULL, SIN_CONFIGURAR}},
+        [EVENTO_AJUSTAR_HORA]   = {{NULL, EditarHora, AJUSTANDO_MINUTOS_ACTUAL}},
+        [EVENTO_AJUSTAR_ALARMA] = {{NULL, EditarAlarma, AJUSTANDO_MINUTOS_ALARMA}},
+        [EVENTO_DECREMENTAR]    = {{NULL, DecrementarMinutos, MODO_ACTUAL}},
+        [EVENTO_INCREMENTAR]    = {{NULL, IncrementarMinutos, MODO_ACTUAL}},
+        [EVENTO_INACTIVIDAD]    = {{HoraValida, LimpiarPuntos, MOSTRANDO_HORA},
+                                   {NULL, LimpiarPuntos, SIN_CONFIGURAR}},
+    },
+    [AJUSTANDO_HORAS_ALARMA] = {
+        [EVENTO_ACEPTAR]        = {{NULL, ConfirmarAlarma, MOSTRANDO_HORA}},
+        [EVENTO_CANCELAR]       = {{NULL, NULL, AJUSTANDO_MINUTOS_ALARMA}},
+        [EVENTO_AJUSTAR_HORA]   = {{NULL, EditarHora, AJUSTANDO_MINUTOS_ACTUAL}},
+        [EVENTO_AJUSTAR_ALARMA] = {{NULL, EditarAlarma, AJUSTANDO_MINUTOS_ALARMA}},
+        [EVENTO_DECREMENTAR]    = {{NULL, DecrementarHoras, MODO_ACTUAL}},
+        [EVENTO_INCREMENTAR]    = {{NULL, IncrementarHoras, MODO_ACTUAL}},
+        [EVENTO_INACTIVIDAD]    = {{HoraValida, LimpiarPuntos, MOSTRANDO_HORA},
+                                   {NULL, LimpiarPuntos, SIN_CONFIGURAR}},
+    },
+};
+// clang-format on
+
+// Evento que genera cada tecla al activarse. F1 y F2 se tratan aparte por la pulsacion larga.
+static const evento_t eventos_tecla[BOARD_KEYS] = {
+    [BOARD_KEY_ACCEPT] = EVENTO_ACEPTAR,
+    [BOARD_KEY_CANCEL] = EVENTO_CANCELAR,
+    [BOARD_KEY_DECREMENT] = EVENTO_DECREMENTAR,
+    [BOARD_KEY_INCREMENT] = EVENTO_INCREMENTAR,
+};
+
+static const char * const causas[] = {
+    [REINICIO_FRIO] = "en frio",
+    [REINICIO_PERRO] = "por el perro guardian",
+    [REINICIO_PEDIDO] = "pedido",
+    [REINICIO_EXTERNO] = "externo",
+};
+
+static const consola_comando_s comandos[] = {
+    {"hora", "[hh:mm[:ss]] consulta o ajusta la hora", ComandoHora},
+    {"alarma", "[hh:mm | activar | desactivar] consulta o ajusta la alarma", ComandoAlarma},
+    {"brillo", "[nivel] consulta o ajusta el brillo, 0 apaga la pantalla", ComandoBrillo},
+    {"estado", "tiempo encendido, carga, teclas, latencia, tareas y consola", ComandoEstado},
+    {"perfil", "ciclos medidos por cada sonda del perfil", ComandoPerfil},
+    {"traza", "[desde] registros de la traza en hexadecimal", ComandoTraza},
+    {"reiniciar", "[perro] reinicia en caliente, o deja vencer al perro guardian", ComandoReiniciar},
+};
+
 /* === Private function implementation ========================================================= */
 
-void ActivarAlarma(reloj_t reloj, bool act_desact) {
+// RELOJ_ALARMA enciende el zumbador, desde PendSV; RELOJ_POSPONER y RELOJ_CANCELAR lo apagan, desde
+// el lazo principal con las interrupciones enmascaradas
+void ActivarAlarma(reloj_t reloj, reloj_evento_t evento, void * contexto) {
+    bool act_desact = evento == RELOJ_ALARMA;
+    TRAZA(ALARMA, act_desact, 0);
     if (act_desact) {
-        DigitalOutputActivate(board->buzzer);
+        BuzzerPlay(board->buzzer, BUZZER_PATRON_ALARMA);
         alarma_sonando = true;
     } else {
-        DigitalOutputDeactivate(board->buzzer);
+        BuzzerStop(board->buzzer);
         alarma_sonando = false;
     }
 }
 
+// Despierta a TareaHora al comenzar y a la mitad de cada segundo
+void MarcarSegundo(reloj_t reloj, reloj_evento_t evento, void * contexto) {
+    if (evento == RELOJ_SEGUNDO) {
+        nuevo_segundo = true;
+    } else {
+        medio_segundo = true;
+    }
+    PlanificadorActivar(tarea_hora);
+}
+
 void CambiarModo(modo_t valor) {
+    TRAZA(MODO, modo, valor);
     modo = valor;
 
-    switch (modo) {
-    case SIN_CONFIGURAR:
-        DisplayFlashDigits(board->display, 0, 3, 250);
-        break;
-    case MOSTRANDO_HORA:
-        DisplayFlashDigits(board->display, 0, 3, 0); // digitos sin parpadear
-        // SetClockTime(reloj, (uint8_t[]){1, 2, 3, 4}, RES_DISPLAY_RELOJ);
-        break;
-    case AJUSTANDO_MINUTOS_ACTUAL:
-        DisplayFlashDigits(board->display, 2, 3, 250);
-        break;
-    case AJUSTANDO_HORAS_ACTUAL:
-        DisplayFlashDigits(board->display, 0, 1, 250);
-        break;
-    case AJUSTANDO_MINUTOS_ALARMA:
-        DisplayFlashDigits(board->display, 2, 3, 250);
-        break;
-    case AJUSTANDO_HORAS_ALARMA:
-        DisplayFlashDigits(board->display, 0, 1, 250);
-        break;
-    default:
-        break;
+    DisplayFlashDigits(board->display, modos[modo].parpadeo_desde, modos[modo].parpadeo_hasta,
+                       modos[modo].parpadeo);
+    if (modos[modo].entrada) {
+        modos[modo].entrada();
     }
+    GuardarInterfaz();
 }
 
-void IncrementarBCD(uint8_t numero[2], const uint8_t limite[2]) {
-
-    // uint8_t temp_limite_1 = limite[1];
+void Despachar(evento_t evento) {
 
-    numero[1]++;
+    const transicion_s * transicion = transiciones[modo][evento];
 
-    // Corroboro antes si se llego al limite para que el ahora segundo if no me rompa la condicion
-    // de limite
-    if ((numero[0] == limite[0]) && (numero[1] > limite[1])) {
-        numero[0] = 0;
-        numero[1] = 0;
+    for (int alternativa = 0; alternativa < ALTERNATIVAS; alternativa++, transicion++) {
+        if (transicion->guarda && !transicion->guarda()) {
+            continue;
+        }
+        if (transicion->destino != MODO_ACTUAL && modos[modo].salida) {
+            modos[modo].salida();
+        }
+        if (transicion->accion) {
+            transicion->accion();
+        }
+        // CambiarModo ya guarda la interfaz; sin cambio de modo la accion pudo cambiar la edicion
+        if (transicion->destino != MODO_ACTUAL) {
+            CambiarModo(transicion->destino);
+        } else {
+            GuardarInterfaz();
+        }
+        return;
     }
+}
 
-    if (numero[1] > 9) {
+void GuardarInterfaz(void) {
 
-        numero[1] = 0;
-        numero[0]++;
-    }
+    interfaz.modo = modo;
+    memcpy(interfaz.edicion, temp_input, sizeof(interfaz.edicion));
+    interfaz.brillo = DisplayGetBrightness(board->display);
+    interfaz.suma = ReinicioSuma(&interfaz, offsetof(interfaz_retenida_s, suma));
 }
 
-void DecrementarBCD(uint8_t numero[2], const uint8_t limite[2]) {
-    numero[1]--;
+// Vuelve al modo y a la edicion en curso antes del reinicio, con los puntos y el contenido de la
+// pantalla que dejan las acciones que llevan a ese modo
+void RetomarInterfaz(void) {
 
-    if ((numero[0] == 0) && ((int8_t)numero[1] < 0)) {
-        numero[0] = limite[0];
-        numero[1] = limite[1];
+    bool valida = interfaz.suma == ReinicioSuma(&interfaz, offsetof(interfaz_retenida_s, suma)) &&
+                  interfaz.modo > MODO_ACTUAL && interfaz.modo < MODOS;
+    modo_t destino = HoraValida() ? MOSTRANDO_HORA : SIN_CONFIGURAR;
+    uint8_t alarma[4];
+
+    if (valida) {
+        destino = interfaz.modo;
+        DisplaySetBrightness(board->display, interfaz.brillo);
+    }
+    if (GetAlarmTime(reloj, alarma)) {
+        DisplaySetDot(board->display, DOT_3);
+    }
+    if (destino == AJUSTANDO_MINUTOS_ACTUAL || destino == AJUSTANDO_HORAS_ACTUAL) {
+        EditarHora();
+    } else if (destino == AJUSTANDO_MINUTOS_ALARMA || destino == AJUSTANDO_HORAS_ALARMA) {
+        EditarAlarma();
     }
-    if ((int8_t)numero[1] < 0) {
+    if (modos[destino].muestra_hora) {
+        (void)GetClockTime(reloj, temp_input, sizeof(temp_input));
+        DisplayToggleDot(board->display, 1);
+    } else if (valida) {
+        memcpy(temp_input, interfaz.edicion, sizeof(temp_input));
+    }
+    DisplayWriteBCD(board->display, temp_input, sizeof(temp_input));
+    CambiarModo(destino);
+}
+
+void Reiniciar(reinicio_causa_t causa) {
 
-        numero[1] = 9;
-        numero[0]--;
+    if (causa == REINICIO_PERRO) {
+        // Un programa colgado con las interrupciones deshabilitadas: nadie alimenta al perro
+        __disable_irq();
+        while (true) {
+        }
     }
+    ReinicioPedir();
+    BoardReset();
 }
 
-/* === Public function implementation ========================================================= */
+bool HoraValida(void) {
+    return GetClockTime(reloj, temp_input, sizeof(temp_input));
+}
 
-int main(void) {
+bool AlarmaDeshabilitada(void) {
+    return !GetAlarmTime(reloj, temp_input);
+}
 
-    reloj = ClockCreate(TICKS_PER_SECOND, ActivarAlarma);
-    board = BoardCreate();
-    modo = SIN_CONFIGURAR;
-    SisTick_Init(INT_PER_SECOND);
-    DisplayToggleDot(board->display, 1);
-    DisplayFlashDigits(board->display, 0, 3, 250); // cuando inicia el reloj los digitos parpadean
+bool AlarmaHabilitadaSilenciosa(void) {
+    return GetAlarmTime(reloj, temp_input) && !alarma_sonando;
+}
 
-    while (1) {
-        /*
+bool AlarmaSonando(void) {
+    return alarma_sonando;
+}
 
-        Problemas: las funciones memset y todas las que modifican reloj->memory, ponen en 0 el bit
-        del punto. La que mas lo hace es DisplayWriteBCD que se la llama cada segundo. Tampoco puedo
-        llamarla cada minuto porque sino nunca podría mostrar los segundos. La solucion mas viable,
-        es cambiar el memset y resetear los 7 LSB de cada elemento de memory manualmente.
+void PulsacionCumplida(temporizador_t temporizador, void * contexto) {
+    pulsacion_larga = true;
+}
 
+// Atiende los eventos de teclas y de temporizadores. La activa el SysTick cuando hay alguno pendiente
+void TareaInterfaz(void * contexto) {
 
-        */
-        // ACEPTAR
-        if (DigitalInputHasActivated(board->accept)) {
-
-            if (modo == AJUSTANDO_MINUTOS_ACTUAL) {
-                cnt_idle = MAX_IDLE_TIME;
-                CambiarModo(AJUSTANDO_HORAS_ACTUAL);
-            } else if (modo == AJUSTANDO_MINUTOS_ALARMA) {
-                cnt_idle = MAX_IDLE_TIME;
-                CambiarModo(AJUSTANDO_HORAS_ALARMA);
-            } else if (modo == AJUSTANDO_HORAS_ACTUAL) {
-                CambiarModo(MOSTRANDO_HORA);
-                SetClockTime(reloj, temp_input, sizeof(temp_input));
-            } else if (modo == AJUSTANDO_HORAS_ALARMA) {
-                DisplayClearDot(board->display, DOT_0 | DOT_1 | DOT_2);
-                SetAlarmTime(reloj, temp_input);
-                CambiarModo(MOSTRANDO_HORA);
-            } else if (modo == MOSTRANDO_HORA) {
-                if (!GetAlarmTime(reloj, temp_input)) {
-                    ToggleHabAlarma(reloj);
-                    DisplaySetDot(board->display, DOT_3);
-                } else if (alarma_sonando) {
-                    PosponerAlarma(reloj, 5);
+    digital_event_s evento;
+
+    // Cada evento trae la marca de tiempo de la interrupcion que lo detecto
+    while (DigitalEventGet(&evento)) {
+        DigitalEventHandled(&evento);
+        int tecla = BoardKeyIndex(evento.input);
+        TRAZA(TECLA, tecla, evento.edge);
+
+        if (tecla == BOARD_KEY_SET_TIME || tecla == BOARD_KEY_SET_ALARM) {
+            // Al presionar se arranca la espera; el evento se genera al soltar si se cumplio
+            if (evento.edge == DIGITAL_EVENT_ACTIVATED) {
+                pulsacion_larga = false;
+                TemporizadorIniciar(pulsacion, DELAY_SET_TIME_ALARM * INT_PER_SECOND, 0);
+            } else {
+                TemporizadorDetener(pulsacion);
+                if (pulsacion_larga) {
+                    pulsacion_larga = false;
+                    Despachar(tecla == BOARD_KEY_SET_TIME ? EVENTO_AJUSTAR_HORA
+                                                          : EVENTO_AJUSTAR_ALARMA);
                 }
             }
+        } else if (tecla >= 0 && evento.edge == DIGITAL_EVENT_ACTIVATED) {
+            Despachar(eventos_tecla[tecla]);
         }
-        // CANCELAR
-        if (DigitalInputHasActivated(board->cancel)) {
-
-            if (modo == AJUSTANDO_MINUTOS_ACTUAL || modo == AJUSTANDO_MINUTOS_ALARMA) {
-                if (GetClockTime(reloj, temp_input, sizeof(temp_input))) {
-                    CambiarModo(MOSTRANDO_HORA);
-                    DisplayClearDot(board->display, DOT_MASK);
-                } else {
-                    // DisplayClearDot(board->display, 1);
-                    // DisplayWriteBCD(board->display, temp_input, sizeof(temp_input));
-                    CambiarModo(SIN_CONFIGURAR);
-                }
-            } else if (modo == AJUSTANDO_HORAS_ACTUAL) {
-                cnt_idle = MAX_IDLE_TIME;
-                CambiarModo(AJUSTANDO_MINUTOS_ACTUAL);
-            } else if (modo == AJUSTANDO_HORAS_ALARMA) {
-                cnt_idle = MAX_IDLE_TIME;
-                CambiarModo(AJUSTANDO_MINUTOS_ALARMA);
-            } else if (modo == MOSTRANDO_HORA) {
-                if (GetAlarmTime(reloj, temp_input) && !alarma_sonando) {
-                    ToggleHabAlarma(reloj);
-                    DisplayClearDot(board->display, DOT_3);
-                } else if (alarma_sonando) {
-                    CancelarAlarma(reloj);
-                }
-            }
+    }
+
+    if (TemporizadorVencido(inactividad)) {
+        Despachar(EVENTO_INACTIVIDAD);
+    }
+}
+
+// Muestra la hora al comenzar cada segundo y hace parpadear el punto cada medio segundo
+void TareaHora(void * contexto) {
+
+    static protohilo_s pt;
+    bcd_t hora;
+
+    PT_BEGIN(&pt);
+    while (true) {
+        PT_WAIT_UNTIL(&pt, nuevo_segundo);
+        nuevo_segundo = false;
+        medio_segundo = false;
+        if (modos[modo].muestra_hora) {
+            PERFIL_INICIO(HORA);
+            (void)GetClockTimePacked(reloj, &hora);
+            DisplayWritePacked(board->display, hora, RES_DISPLAY_RELOJ);
+            PERFIL_FIN(HORA);
+            DisplayToggleDot(board->display, 1);
         }
-        // F1
-        if (DigitalInputHasChanged(board->set_time)) {
-            flag_set_time_alarm ^= 1;
-            if (cnt_set_time_alarm == 0) {
-                flag_idle = true;
-                cnt_idle = MAX_IDLE_TIME;
-                CambiarModo(AJUSTANDO_MINUTOS_ACTUAL);
-                GetClockTime(reloj, temp_input, sizeof(temp_input));
-                DisplayClearDot(board->display, DOT_1);
-                DisplayWriteBCD(board->display, temp_input, sizeof(temp_input));
-            }
+
+        PT_WAIT_UNTIL(&pt, medio_segundo);
+        medio_segundo = false;
+        if (modos[modo].muestra_hora) {
+            DisplayToggleDot(board->display, 1);
         }
+    }
+    PT_END(&pt);
+}
 
-        // F2
-        if (DigitalInputHasChanged(board->set_alarm)) {
-            flag_set_time_alarm ^= 1;
-            if (cnt_set_time_alarm == 0 && modo != SIN_CONFIGURAR) {
-                flag_idle = true;
-                cnt_idle = MAX_IDLE_TIME;
-                CambiarModo(AJUSTANDO_MINUTOS_ALARMA);
-                GetAlarmTime(reloj, temp_input);
-                DisplaySetDot(board->display, DOT_MASK);
-                DisplayWriteBCD(board->display, temp_input, sizeof(temp_input));
-            }
+// Atiende las lineas recibidas por la consola. Es periodica porque el DMA no avisa lo que recibe
+void TareaConsola(void * contexto) {
+    ConsolaProcesar(board->consola);
+    // El reinicio espera a que salga la respuesta del comando que lo pidio
+    if (reinicio_pedido != REINICIO_FRIO && !ConsolaPendiente(board->consola)) {
+        Reiniciar(reinicio_pedido);
+    }
+}
+
+// Convierte "hh:mm" o "hh:mm:ss" en un digito por posicion, como los guarda el reloj. Devuelve la
+// cantidad de digitos, o 0 si el texto no es una hora valida.
+uint8_t LeerHora(const char * texto, uint8_t digitos[6]) {
+
+    static const uint8_t limites[] = {2, 9, 5, 9, 5, 9};
+    uint8_t cantidad = 0;
+
+    while (true) {
+        if (texto[0] < '0' || texto[0] > '9' || texto[1] < '0' || texto[1] > '9') {
+            return 0;
         }
+        digitos[cantidad] = texto[0] - '0';
+        digitos[cantidad + 1] = texto[1] - '0';
+        if (digitos[cantidad] > limites[cantidad]) {
+            return 0;
+        }
+        cantidad += 2;
+        texto += 2;
+        if (cantidad == 6 || *texto != ':') {
+            break;
+        }
+        texto++;
+    }
+    if (*texto || cantidad < 4 || (digitos[0] == 2 && digitos[1] > 3)) {
+        return 0;
+    }
+    return cantidad;
+}
 
-        // F3
-        if (DigitalInputHasActivated(board->decrement)) {
-            cnt_idle = MAX_IDLE_TIME;
-            if (modo == AJUSTANDO_MINUTOS_ACTUAL || modo == AJUSTANDO_MINUTOS_ALARMA) {
-                DecrementarBCD(&temp_input[2], limite_min);
-            } else if (modo == AJUSTANDO_HORAS_ACTUAL || modo == AJUSTANDO_HORAS_ALARMA) {
-                DecrementarBCD(temp_input, limite_hs);
-            }
-            DisplayWriteBCD(board->display, temp_input, sizeof(temp_input));
+const char * ComandoHora(consola_t consola, uint8_t argc, char * argv[]) {
+
+    uint8_t hora[6] = {0};
+
+    if (argc == 1) {
+        if (!GetClockTime(reloj, hora, sizeof(hora))) {
+            return "hora sin configurar";
         }
+        ConsolaImprimir(consola, "%u%u:%u%u:%u%u", hora[0], hora[1], hora[2], hora[3], hora[4],
+                        hora[5]);
+        return NULL;
+    }
+    if (argc > 2 || !LeerHora(argv[1], hora)) {
+        return "se espera hh:mm o hh:mm:ss";
+    }
+    SetClockTime(reloj, hora, sizeof(hora));
+    if (modo == SIN_CONFIGURAR) {
+        CambiarModo(MOSTRANDO_HORA);
+    }
+    return NULL;
+}
 
-        // F4
-        if (DigitalInputHasActivated(board->increment)) {
-            cnt_idle = MAX_IDLE_TIME;
-            if (modo == AJUSTANDO_MINUTOS_ACTUAL || modo == AJUSTANDO_MINUTOS_ALARMA) {
-                // le paso el puntero a los dos digitos menos significativos
-                IncrementarBCD(&temp_input[2], limite_min);
-            } else if (modo == AJUSTANDO_HORAS_ACTUAL || modo == AJUSTANDO_HORAS_ALARMA) {
-                IncrementarBCD(temp_input, limite_hs);
-            }
-            DisplayWriteBCD(board->display, temp_input, sizeof(temp_input));
+// No usa las guardas de la interfaz porque estas pisan la hora que se esta editando con las teclas
+const char * ComandoAlarma(consola_t consola, uint8_t argc, char * argv[]) {
+
+    uint8_t alarma[6] = {0};
+    bool habilitada = GetAlarmTime(reloj, alarma);
+
+    if (argc == 1) {
+        ConsolaImprimir(consola, "%u%u:%u%u %s", alarma[0], alarma[1], alarma[2], alarma[3],
+                        habilitada ? "activada" : "desactivada");
+        return NULL;
+    }
+    if (argc > 2) {
+        return "demasiados argumentos";
+    }
+    if (strcmp(argv[1], "activar") == 0) {
+        if (!habilitada) {
+            HabilitarAlarma();
+        }
+    } else if (strcmp(argv[1], "desactivar") == 0) {
+        if (alarma_sonando) {
+            Cancelar();
+        }
+        if (habilitada) {
+            DeshabilitarAlarma();
         }
+    } else if (LeerHora(argv[1], alarma) == 4) {
+        SetAlarmTime(reloj, alarma);
+        DisplaySetDot(board->display, DOT_3);
+    } else {
+        return "se espera hh:mm, activar o desactivar";
+    }
+    return NULL;
+}
 
-        if (cnt_idle == 0) {
-            flag_idle = false;
-            cnt_idle = MAX_IDLE_TIME;
-            DisplayClearDot(board->display, DOT_MASK);
-            if (GetClockTime(reloj, temp_input, sizeof(temp_input))) {
-                CambiarModo(MOSTRANDO_HORA);
-            } else {
-                CambiarModo(SIN_CONFIGURAR);
-            }
+const char * ComandoBrillo(consola_t consola, uint8_t argc, char * argv[]) {
+
+    if (argc == 1) {
+        ConsolaImprimir(consola, "%u de %u", DisplayGetBrightness(board->display),
+                        DISPLAY_BRIGHTNESS_MAX);
+        return NULL;
+    }
+
+    char * fin;
+    unsigned long nivel = strtoul(argv[1], &fin, 10);
+    if (argc > 2 || fin == argv[1] || *fin || nivel > DISPLAY_BRIGHTNESS_MAX) {
+        return "nivel fuera de rango";
+    }
+    DisplaySetBrightness(board->display, (uint8_t)nivel);
+    GuardarInterfaz();
+    return NULL;
+}
+
+const char * ComandoEstado(consola_t consola, uint8_t argc, char * argv[]) {
+
+    cpu_carga_s carga;
+    const estadistica_s * latencia = DigitalEventsLatency();
+    const consola_informe_s * informe = ConsolaInforme(consola);
+    uint64_t encendido = TiempoMicros();
+
+    CpuCarga(&carga);
+    ConsolaImprimir(consola, "encendido %" PRIu32 ".%06" PRIu32 " s",
+                    (uint32_t)(encendido / 1000000), (uint32_t)(encendido % 1000000));
+    ConsolaImprimir(consola, "carga %u %%, reposo %u %%", carga.utilizacion, carga.reposo);
+    ConsolaImprimir(consola, "teclas %u eventos, %u descartados, latencia max %u " UNIDAD_TECLAS,
+                    latencia->cantidad, DigitalEventsDropped(), latencia->maximo);
+    // La duracion maxima de la mitad superior es el peor caso que agrega a las interrupciones de
+    // menor prioridad; sin el perfil queda en 0
+    ConsolaImprimir(consola, "systick latencia prom %u max %u, duracion max %u ciclos",
+                    EstadisticaPromedio(&latencia_systick), latencia_systick.maximo,
+                    perfil[PERFIL_SYSTICK].ciclos.maximo);
+    for (uint8_t indice = 0; indice < PlanificadorTareas(); indice++) {
+        const tarea_informe_s * tarea = PlanificadorInforme(indice);
+        ConsolaImprimir(consola, "tarea %-9s activ %u perdidos %u demora %u ciclos %u/%u",
+                        tarea->nombre, tarea->activaciones, tarea->plazos_perdidos,
+                        tarea->demora_maxima, EstadisticaPromedio(&tarea->ciclos),
+                        tarea->ciclos.maximo);
+    }
+    ConsolaImprimir(consola, "consola %u lineas, %u errores, %u bytes descartados, %u desbordes",
+                    informe->lineas, informe->errores, informe->descartados, informe->desbordes);
+    ConsolaImprimir(consola, "reinicio %s, %" PRIu32 " en caliente, %" PRIu32 " ticks compensados",
+                    causas[ReinicioCausa()], ReinicioCantidad(),
+                    RelojRecuperado(reloj) ? ReinicioPerdidos() : 0);
+    return NULL;
+}
+
+const char * ComandoPerfil(consola_t consola, uint8_t argc, char * argv[]) {
+
+    ConsolaImprimir(consola, "sobrecarga %u ciclos descontada", PerfilSobrecarga());
+    for (int sonda = 0; sonda < PERFIL_SONDAS; sonda++) {
+        const estadistica_s * ciclos = &perfil[sonda].ciclos;
+        if (ciclos->cantidad) {
+            ConsolaImprimir(consola, "%-14s n %u min %u prom %u max %u p99 %u",
+                            perfil[sonda].nombre, ciclos->cantidad, ciclos->minimo,
+                            EstadisticaPromedio(ciclos), ciclos->maximo,
+                            EstadisticaPercentil(ciclos, 99));
         }
+    }
+    return NULL;
+}
 
-        for (int index = 0; index < 100; index++) {
-            for (int delay = 0; delay < 2500; delay++) { //= 0; delay < 25000; d
-                __asm("NOP");
-            }
+// Se envian PAGINA_TRAZA registros por vez para no desbordar la cola de la consola. Los registros
+// se numeran desde el inicio de la traza, asi que las paginas no cambian aunque lleguen nuevos.
+const char * ComandoTraza(consola_t consola, uint8_t argc, char * argv[]) {
+
+    uint32_t desde = TrazaPrimero();
+    uint32_t siguiente = TrazaSiguiente();
+
+    if (argc > 1) {
+        char * fin;
+        uint32_t pedido = strtoul(argv[1], &fin, 10);
+        if (argc > 2 || fin == argv[1] || *fin) {
+            return "se espera el numero del primer registro";
+        }
+        if ((int32_t)(pedido - desde) > 0) {
+            desde = pedido;
         }
     }
+    uint32_t hasta = desde;
+    while (hasta != siguiente && hasta - desde < PAGINA_TRAZA) {
+        uint64_t registro = TrazaLeer(hasta++);
+        ConsolaImprimir(consola, "%08" PRIx32 "%08" PRIx32, (uint32_t)(registro >> 32),
+                        (uint32_t)registro);
+    }
+    ConsolaImprimir(consola, "registros %" PRIu32 " a %" PRIu32 ", siguiente %" PRIu32, desde,
+                    hasta, siguiente);
+    return NULL;
 }
 
-void SysTick_Handler(void) {
+const char * ComandoReiniciar(consola_t consola, uint8_t argc, char * argv[]) {
 
-    uint8_t hora[RES_DISPLAY_RELOJ];
+    if (argc == 1) {
+        reinicio_pedido = REINICIO_PEDIDO;
+    } else if (argc == 2 && strcmp(argv[1], "perro") == 0) {
+        reinicio_pedido = REINICIO_PERRO;
+    } else {
+        return "se espera perro o nada";
+    }
+    return NULL;
+}
 
-    int tick = RelojNuevoTick(reloj);
-    if (modo <= MOSTRANDO_HORA) {
-        if (tick == 0) {
-            if (flag_set_time_alarm) {
-                if (cnt_set_time_alarm) {
-                    cnt_set_time_alarm--;
-                }
-            } else {
-                // Si la bandera esta en false se reinicia la cuenta así no se acumulan los tiempos
-                // de falsas pulsaciones
-                cnt_set_time_alarm = DELAY_SET_TIME_ALARM;
-            }
+void IniciarInactividad(void) {
+    TemporizadorIniciar(inactividad, MAX_IDLE_TIME * INT_PER_SECOND, 0);
+}
 
-            (void)GetClockTime(reloj, hora, RES_DISPLAY_RELOJ);
-            DisplayWriteBCD(board->display, hora, sizeof(hora));
-            DisplayToggleDot(board->display, 1);
-            VerificarAlarma(reloj);
+void DetenerInactividad(void) {
+    TemporizadorDetener(inactividad);
+}
+
+void ConfirmarHora(void) {
+    SetClockTime(reloj, temp_input, sizeof(temp_input));
+}
+
+void ConfirmarAlarma(void) {
+    DisplayClearDot(board->display, DOT_0 | DOT_1 | DOT_2);
+    SetAlarmTime(reloj, temp_input);
+}
+
+void HabilitarAlarma(void) {
+    ToggleHabAlarma(reloj);
+    DisplaySetDot(board->display, DOT_3);
+}
+
+void DeshabilitarAlarma(void) {
+    ToggleHabAlarma(reloj);
+    DisplayClearDot(board->display, DOT_3);
+}
+
+void Posponer(void) {
+    PosponerAlarma(reloj, 5);
+}
+
+void Cancelar(void) {
+    CancelarAlarma(reloj);
+}
+
+void LimpiarPuntos(void) {
+    DisplayClearDot(board->display, DOT_MASK);
+}
+
+void EditarHora(void) {
+    GetClockTime(reloj, temp_input, sizeof(temp_input));
+    DisplayClearDot(board->display, DOT_1);
+    DisplayWriteBCD(board->display, temp_input, sizeof(temp_input));
+}
+
+void EditarAlarma(void) {
+    GetAlarmTime(reloj, temp_input);
+    DisplaySetDot(board->display, DOT_MASK);
+    DisplayWriteBCD(board->display, temp_input, sizeof(temp_input));
+}
+
+// Guarda HH:MM empaquetada en temp_input y la muestra
+void AjustarEdicion(bcd_t valor) {
+    BcdDesempaquetar(valor, temp_input, sizeof(temp_input));
+    DisplayWritePacked(board->display, valor, sizeof(temp_input));
+}
+
+void IncrementarMinutos(void) {
+    IniciarInactividad();
+    AjustarEdicion(BcdIncrementar(BcdEmpaquetar(temp_input, 4), BCD_MINUTOS, BCD_LIMITES));
+}
+
+void IncrementarHoras(void) {
+    IniciarInactividad();
+    AjustarEdicion(BcdIncrementar(BcdEmpaquetar(temp_input, 4), BCD_HORAS, BCD_LIMITES));
+}
+
+void DecrementarMinutos(void) {
+    IniciarInactividad();
+    AjustarEdicion(BcdDecrementar(BcdEmpaquetar(temp_input, 4), BCD_MINUTOS, BCD_LIMITES));
+}
+
+void DecrementarHoras(void) {
+    IniciarInactividad();
+    AjustarEdicion(BcdDecrementar(BcdEmpaquetar(temp_input, 4), BCD_HORAS, BCD_LIMITES));
+}
+
+/* === Public function implementation ========================================================= */
+
+int main(void) {
+
+    TrazaInit();
+    board = BoardCreate();
+    ReinicioInit(board->watchdog_reset, ESPERA_PERRO);
+    reloj = ClockCreate(TICKS_PER_SECOND);
+    RelojSuscribir(reloj,
+                   RELOJ_FILTRO(RELOJ_ALARMA) | RELOJ_FILTRO(RELOJ_POSPONER) |
+                       RELOJ_FILTRO(RELOJ_CANCELAR),
+                   ActivarAlarma, NULL);
+    inactividad = TemporizadorCreate(NULL, NULL);
+    pulsacion = TemporizadorCreate(PulsacionCumplida, NULL);
+    modo = SIN_CONFIGURAR;
+    // La tarea de la interfaz tiene prioridad sobre la de la hora
+    tarea_interfaz = PlanificadorCrear("interfaz", TareaInterfaz, NULL, 0, 0, PLAZO_INTERFAZ);
+    tarea_hora = PlanificadorCrear("hora", TareaHora, NULL, 1, 0, PLAZO_HORA);
+    PlanificadorCrear("consola", TareaConsola, NULL, 2, PERIODO_CONSOLA, PERIODO_CONSOLA);
+    ConsolaComandos(board->consola, comandos, sizeof(comandos) / sizeof(comandos[0]));
+    DigitalEventsInit(MARCA_TECLAS);
+    CpuInit();
+    PerfilInit();
+    EstadisticaReiniciar(&latencia_systick);
+    // Despues de un reinicio en caliente se recuperan los ticks que no se contaron y se sigue en el
+    // mismo modo, antes de que el SysTick vuelva a avanzar el reloj
+    if (RelojRecuperado(reloj)) {
+        RelojCompensar(reloj, ReinicioPerdidos());
+        RetomarInterfaz();
+        TRAZA(RETOMAR, ReinicioCausa(), ReinicioPerdidos());
+    } else {
+        DisplayToggleDot(board->display, 1);
+        CambiarModo(SIN_CONFIGURAR); // cuando inicia el reloj los digitos parpadean
+    }
+    TiempoInit(INT_PER_SECOND);
+    // Los segundos que se compensaron no se muestran: la tarea de la hora empieza con el SysTick
+    RelojSuscribir(reloj, RELOJ_FILTRO(RELOJ_SEGUNDO) | RELOJ_FILTRO(RELOJ_MEDIO_SEGUNDO),
+                   MarcarSegundo, NULL);
+    SisTick_Init(INT_PER_SECOND);
+#if !defined(DUAL_CORE)
+    // Con dos nucleos la frecuencia no baja: el RIT del M0 y el TIMER3 que marca las teclas cuentan
+    // el reloj base, y en reposo el barrido de la pantalla caeria de 1 kHz a unos 235 Hz
+    EnergiaInit(BoardSetCoreClock, MAX_CLOCK_FREQ, FRECUENCIA_REPOSO, ESPERA_REPOSO);
+#endif
+
+    while (1) {
+        /*
+
+        Problemas: las funciones memset y todas las que modifican reloj->memory, ponen en 0 el bit
+        del punto. La que mas lo hace es DisplayWriteBCD que se la llama cada segundo. Tampoco puedo
+        llamarla cada minuto porque sino nunca podría mostrar los segundos. La solucion mas viable,
+        es cambiar el memset y resetear los 7 LSB de cada elemento de memory manualmente.
+
+
+        */
+        // Sin tareas listas el nucleo duerme hasta la proxima interrupcion (SysTick, teclas o
+        // alarma). Se verifica con las interrupciones deshabilitadas para no perder una activacion
+        // que llegue entre la verificacion y el WFI.
+        __disable_irq();
+        if (!PlanificadorPendiente()) {
+            CpuDormir();
         }
-        if (tick == TICKS_PER_SECOND / 2) {
-            DisplayToggleDot(board->display, 1);
+        __enable_irq();
+
+        while (PlanificadorEjecutar()) {
         }
+        // El SysTick despierta al lazo en cada tick: si una tarea o una interrupcion se cuelga el
+        // perro guardian deja de recibir alimento y reinicia en caliente
+        BoardWatchdogFeed();
+        ReinicioAlimentado();
     }
-    if (modo >= AJUSTANDO_MINUTOS_ACTUAL && modo <= AJUSTANDO_HORAS_ALARMA) {
-        if (tick == 0) {
-            if (flag_idle) {
-                if (cnt_idle) {
-                    cnt_idle--;
-                }
-            }
-        }
+}
+
+// El SysTick solo hace lo que necesita un periodo exacto (barrido de teclas y de la pantalla, cuenta
+// del reloj) y activa las tareas que se ejecutan en el lazo principal. El segundo queda para PendSV
+RAPIDA void SysTick_Handler(void) {
+
+    EstadisticaRegistrar(&latencia_systick, SysTick->LOAD - SysTick->VAL);
+    TiempoTick();
+    PERFIL_INICIO(SYSTICK);
+    CpuTick();
+    TrazaTick();
+    ReinicioTick();
+    // Antes que el reloj, para que las tareas que activan sus eventos tengan la marca de este tick
+    PlanificadorTick();
+    PERFIL_INICIO(TECLAS);
+    DigitalInputsScan();
+    PERFIL_FIN(TECLAS);
+
+    // Los temporizadores van antes que el reloj: la alarma pospuesta solo se cuenta aqui, y
+    // RelojContarTick pide PendSV para publicarla
+    PERFIL_INICIO(TEMPORIZADORES);
+    TemporizadorTick();
+    PERFIL_FIN(TEMPORIZADORES);
+    PERFIL_INICIO(RELOJ);
+    if (RelojContarTick(reloj)) {
+        SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+    }
+    PERFIL_FIN(RELOJ);
+
+    if (DigitalEventsPending() || TemporizadoresPendientes()) {
+        PlanificadorActivar(tarea_interfaz);
+    }
+    PERFIL_INICIO(PANTALLA);
+    BoardDisplayRefresh(board);
+    PERFIL_FIN(PANTALLA);
+
+    // Solo se baja la frecuencia mostrando la hora, sin esperar una pulsacion larga, sin alarma
+    // sonando y sin respuestas de la consola en la UART, cuyo divisor se recalcula en el cambio.
+    // El cambio espera al PLL, asi que se hace en PendSV
+    if (EnergiaTick(DigitalEventsPending() || alarma_sonando || BuzzerIsPlaying(board->buzzer) ||
+                    TemporizadorActivo(pulsacion) || !modos[modo].muestra_hora ||
+                    ConsolaPendiente(board->consola))) {
+        SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
     }
-    DisplayRefresh(board->display);
+    PERFIL_FIN(SYSTICK);
+}
+
+// Mitad inferior, con la menor prioridad: cambia la frecuencia del nucleo si el SysTick lo pidio,
+// avanza la hora, verifica la alarma y publica los eventos. El cambio va primero porque reescala el
+// resto del periodo en curso; su costo lo mide el modulo de energia
+void PendSV_Handler(void) {
+
+    EnergiaAplicar();
+    PERFIL_INICIO(DIFERIDO);
+    RelojProcesarTicks(reloj);
+    PERFIL_FIN(DIFERIDO);
 }
 
 /* === End of documentation ====================================================================*/
@@ -27,7 +27,10 @@ SPDX-License-Identifier: MIT
 
 #include "pantalla.h"
 #include "string.h"
+#include <stdbool.h>
 #include "reloj.h"
+#include "traza.h"
+#include "rapida.h"
 
 /* === Macros definitions ====================================================================== */
 
@@ -35,6 +38,25 @@ SPDX-License-Identifier: MIT
     #define DISPLAY_MAX_DIGITS 8
 #endif
 
+#if DISPLAY_MAX_DIGITS > DISPLAY_FRAME_DIGITS
+    #error "Un cuadro de pantalla no alcanza para DISPLAY_MAX_DIGITS digitos"
+#endif
+
+// Con DISPLAY_DRIVER, el nombre de un encabezado de la placa entre comillas, el controlador se
+// enlaza al compilar: el encabezado define DISPLAY_DRIVER_SCREEN_OFF, DISPLAY_DRIVER_SEGMENTS_ON y
+// DISPLAY_DRIVER_DIGIT_ON y DisplayCreate ignora el controlador que recibe. Sin el, se llama por
+// los punteros de display_driver_s, como en el banco de rendimiento o con varias placas.
+#if defined(DISPLAY_DRIVER)
+    #include DISPLAY_DRIVER
+    #define SCREEN_TURN_OFF(display)            DISPLAY_DRIVER_SCREEN_OFF((display)->active_digit)
+    #define SEGMENTS_TURN_ON(display, segments) DISPLAY_DRIVER_SEGMENTS_ON(segments)
+    #define DIGIT_TURN_ON(display, digit)       DISPLAY_DRIVER_DIGIT_ON(digit)
+#else
+    #define SCREEN_TURN_OFF(display)            (display)->driver->ScreenTurnOff()
+    #define SEGMENTS_TURN_ON(display, segments) (display)->driver->SegmentsTurnOn(segments)
+    #define DIGIT_TURN_ON(display, digit)       (display)->driver->DigitTurnOn(digit)
+#endif
+
 /* === Private data type declarations ========================================================== */
 
 struct display_s {
@@ -45,16 +67,22 @@ struct display_s {
     // particular. DisplayRefresh accede a esa memoria, recorriendola, y sacando los segmentos de
     // cada digito en particular
     uint8_t memory[DISPLAY_MAX_DIGITS];
+#if !defined(DISPLAY_DRIVER)
     struct display_driver_s driver[1];
+#endif
     uint8_t flashing_from;
     uint8_t flashing_to;
     uint16_t flashing_count;
     uint16_t flashing_factor;
+    uint8_t brightness;       // barridos encendidos de cada DISPLAY_BRIGHTNESS_MAX
+    uint8_t brightness_count; // acumulador que reparte los barridos encendidos
+    bool brightness_on;       // el barrido en curso se muestra
+    uint16_t traced;          // ultimos digitos registrados en la traza
 };
 
 /* === Private variable declarations =========================================================== */
 
-static const uint8_t IMAGES[] = {
+static const uint8_t IMAGES[] RAPIDA_DATOS = {
     SEGMENT_A | SEGMENT_B | SEGMENT_C | SEGMENT_D | SEGMENT_E | SEGMENT_F,
     SEGMENT_B | SEGMENT_C,
     SEGMENT_A | SEGMENT_B | SEGMENT_D | SEGMENT_E | SEGMENT_G,
@@ -92,9 +120,17 @@ display_t DisplayCreate(uint8_t digits, display_driver_t driver) {
     display->flashing_factor = 0;
     display->flashing_from = 0;
     display->flashing_to = 0;
+    display->brightness = DISPLAY_BRIGHTNESS_MAX;
+    display->brightness_count = 0;
+    display->brightness_on = true;
+    display->traced = 0;
+#if defined(DISPLAY_DRIVER)
+    (void)driver;
+#else
     memcpy(display->driver, driver, sizeof(display->driver));
+#endif
     memset(display->memory, 0, sizeof(display->memory)); // limpia la memoria
-    display->driver->ScreenTurnOff();                    // apaga todos los digitos
+    SCREEN_TURN_OFF(display);                            // apaga todos los digitos
 
     return display;
 }
@@ -117,19 +153,58 @@ void DisplayWriteBCD(display_t display, uint8_t * numbers, uint8_t size) {
         // Me estaba cleareando el msb de memory (punto)
         (display->memory[i]) |= (IMAGES[numbers[i]]);
     }
+
+    // La hora se reescribe cada segundo: a la traza solo van los cambios
+    uint16_t written = 0;
+    for (int i = 0; i < size && i < 4; i++) {
+        written = (written << 4) | numbers[i];
+    }
+    if (written != display->traced) {
+        display->traced = written;
+        TRAZA(PANTALLA, size, written);
+    }
 }
 
-void DisplayRefresh(display_t display) {
+void DisplayWritePacked(display_t display, bcd_t numbers, uint8_t size) {
+
+    // Los digitos salen de los nibbles desde las horas, sin pasar por un arreglo
+    for (int i = 0; i < display->digits; i++) {
+        uint8_t segments = (i < size && i < 6) ? IMAGES[(numbers >> (4 * (5 - i))) & 0x0F] : 0;
+        display->memory[i] = (display->memory[i] & 0b10000000) | segments;
+    }
+
+    // Los primeros cuatro digitos ya estan como los guarda la traza
+    uint8_t traced = size < 4 ? size : 4;
+    uint16_t written = (numbers >> (4 * (6 - traced))) & ((1 << (4 * traced)) - 1);
+    if (written != display->traced) {
+        display->traced = written;
+        TRAZA(PANTALLA, size, written);
+    }
+}
+
+RAPIDA void DisplayRefresh(display_t display) {
     // Suponiendo un duty factor de 50%: la primera mitad del segundo apago algunos digitos y la
     // segunda mitad prendo todos
 
     uint8_t segments = 0;
 
-    display->driver->ScreenTurnOff();
+    SCREEN_TURN_OFF(display);
     display->active_digit = (display->active_digit + 1) % display->digits;
 
     segments = display->memory[display->active_digit];
 
+    // Cada barrido completo suma el brillo y se muestra cuando el acumulador desborda
+    if (display->active_digit == 0) {
+        display->brightness_count += display->brightness;
+        display->brightness_on = display->brightness_count >= DISPLAY_BRIGHTNESS_MAX;
+        if (display->brightness_on) {
+            display->brightness_count -= DISPLAY_BRIGHTNESS_MAX;
+        }
+    }
+    if (!display->brightness_on) {
+        segments = 0;
+    }
+
     if (display->flashing_factor) {
 
         if (display->active_digit == 0) {
@@ -146,8 +221,8 @@ void DisplayRefresh(display_t display) {
         }
     }
 
-    display->driver->SegmentsTurnOn(segments);
-    display->driver->DigitTurnOn(display->active_digit);
+    SEGMENTS_TURN_ON(display, segments);
+    DIGIT_TURN_ON(display, display->active_digit);
 }
 
 void DisplayFlashDigits(display_t display, uint8_t from, uint8_t to, uint16_t factor) {
@@ -159,6 +234,39 @@ void DisplayFlashDigits(display_t display, uint8_t from, uint8_t to, uint16_t fa
     display->flashing_factor = factor;
 }
 
+void DisplaySetBrightness(display_t display, uint8_t brightness) {
+
+    display->brightness =
+        (brightness > DISPLAY_BRIGHTNESS_MAX) ? DISPLAY_BRIGHTNESS_MAX : brightness;
+}
+
+uint8_t DisplayGetBrightness(display_t display) {
+
+    return display->brightness;
+}
+
+void DisplayGetFrame(display_t display, display_frame_s * frame) {
+
+    memset(frame, 0, sizeof(*frame)); // tambien el relleno, porque el cuadro se compara con memcmp
+    memcpy(frame->memory, display->memory, sizeof(display->memory));
+    frame->flashing_from = display->flashing_from;
+    frame->flashing_to = display->flashing_to;
+    frame->flashing_factor = display->flashing_factor;
+    frame->brightness = display->brightness;
+}
+
+void DisplaySetFrame(display_t display, const display_frame_s * frame) {
+
+    memcpy(display->memory, frame->memory, sizeof(display->memory));
+    if (frame->flashing_from != display->flashing_from ||
+        frame->flashing_to != display->flashing_to ||
+        frame->flashing_factor != display->flashing_factor) {
+        DisplayFlashDigits(display, frame->flashing_from, frame->flashing_to,
+                           frame->flashing_factor);
+    }
+    DisplaySetBrightness(display, frame->brightness);
+}
+
 void DisplayToggleDot(display_t display, uint8_t digit_dot) {
 
     display->memory[digit_dot] ^= 1 << 7;
@@ -0,0 +1,89 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Perfilador de secciones de codigo
+ **
+ ** La sobrecarga se calibra midiendo una seccion vacia: son las dos lecturas de CYCCNT, que es lo
+ ** unico que queda dentro de la seccion medida. El registro de la estadistica ocurre despues de
+ ** tomar el valor final y no se cuenta en la propia sonda, pero si en las que la contienen.
+ **
+ ** \addtogroup perfil Perfil
+ ** \brief Perfilador de secciones de codigo
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "perfil.h"
+#include "rapida.h"
+
+/* === Macros definitions ====================================================================== */
+
+#define PERFIL_CALIBRACIONES 16
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+static uint32_t sobrecarga = 0;
+
+/* === Private function declarations =========================================================== */
+
+/* === Public variable definitions ============================================================= */
+
+perfil_s perfil[PERFIL_SONDAS] = {
+#define PERFIL_SONDA(id, texto) [PERFIL_##id] = {.nombre = texto},
+#include "perfil_sondas.h"
+#undef PERFIL_SONDA
+};
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+/* === Public function implementation ========================================================== */
+
+void PerfilInit(void) {
+
+    uint32_t minimo = UINT32_MAX;
+
+    for (int i = 0; i < PERFIL_CALIBRACIONES; i++) {
+        uint32_t inicio = DWT->CYCCNT;
+        uint32_t ciclos = DWT->CYCCNT - inicio;
+        if (ciclos < minimo) {
+            minimo = ciclos;
+        }
+    }
+    sobrecarga = minimo;
+
+    for (int sonda = 0; sonda < PERFIL_SONDAS; sonda++) {
+        EstadisticaReiniciar(&perfil[sonda].ciclos);
+    }
+}
+
+RAPIDA void PerfilRegistrar(perfil_sonda_t sonda, uint32_t ciclos) {
+
+    EstadisticaRegistrar(&perfil[sonda].ciclos, ciclos > sobrecarga ? ciclos - sobrecarga : 0);
+}
+
+uint32_t PerfilSobrecarga(void) {
+
+    return sobrecarga;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
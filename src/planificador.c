@@ -0,0 +1,192 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Planificador cooperativo de tareas
+ **
+ ** Las tareas listas se marcan en una mascara de bits ordenada por prioridad, por lo que elegir la
+ ** siguiente es buscar el primer bit en uno. Las activaciones que llegan mientras
+ ** la tarea ya esta lista se combinan en una sola; en una tarea periodica eso cuenta como plazo
+ ** perdido.
+ **
+ ** \addtogroup planificador Planificador
+ ** \brief Planificador cooperativo de tareas
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "planificador.h"
+#include "chip.h"
+#include "rapida.h"
+#include <stddef.h>
+#include <string.h>
+
+/* === Macros definitions ====================================================================== */
+
+// Como mucho 32, una tarea por bit de la mascara de listas
+#ifndef PLANIFICADOR_TAREAS
+    #define PLANIFICADOR_TAREAS 8
+#endif
+
+/* === Private data type declarations ========================================================== */
+
+struct tarea_s {
+    tarea_funcion_t funcion;
+    void * contexto;
+    uint16_t cuenta;     // ticks hasta la proxima activacion periodica
+    uint32_t activacion; // tick de la activacion pendiente
+    uint8_t bit;         // posicion en orden y en la mascara de tareas listas
+    tarea_informe_s informe;
+};
+
+/* === Private variable declarations =========================================================== */
+
+static struct tarea_s tareas[PLANIFICADOR_TAREAS];
+static struct tarea_s * orden[PLANIFICADOR_TAREAS]; // tareas de mayor a menor prioridad
+static uint8_t cantidad = 0;
+static volatile uint32_t listas = 0; // bit i: orden[i] lista para ejecutar
+static volatile uint32_t ahora = 0;
+static bool activada = false; // alguna tarea ya se activo: no se crean mas
+
+/* === Private function declarations =========================================================== */
+
+void PlanificadorMarcar(struct tarea_s * tarea);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+// Se llama con las interrupciones deshabilitadas o desde el SysTick
+RAPIDA void PlanificadorMarcar(struct tarea_s * tarea) {
+
+    if (listas & (1UL << tarea->bit)) {
+        if (tarea->informe.periodo) {
+            tarea->informe.plazos_perdidos++;
+        }
+        return;
+    }
+    tarea->activacion = ahora;
+    listas |= 1UL << tarea->bit;
+    activada = true;
+}
+
+/* === Public function implementation ========================================================== */
+
+tarea_t PlanificadorCrear(const char * nombre, tarea_funcion_t funcion, void * contexto,
+                          uint8_t prioridad, uint16_t periodo, uint16_t plazo) {
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (cantidad >= PLANIFICADOR_TAREAS || activada) {
+        __set_PRIMASK(primask);
+        return NULL; // las tareas se crean al inicio, antes de activar ninguna
+    }
+
+    struct tarea_s * tarea = &tareas[cantidad];
+    memset(tarea, 0, sizeof(*tarea));
+
+    // Insercion ordenada: las tareas de igual prioridad quedan en el orden en que se crearon
+    uint8_t bit = cantidad;
+    while (bit > 0 && orden[bit - 1]->informe.prioridad > prioridad) {
+        orden[bit] = orden[bit - 1];
+        orden[bit]->bit = bit;
+        bit--;
+    }
+    orden[bit] = tarea;
+    tarea->bit = bit;
+    cantidad++;
+
+    tarea->funcion = funcion;
+    tarea->contexto = contexto;
+    tarea->cuenta = periodo;
+    tarea->informe.nombre = nombre;
+    tarea->informe.prioridad = prioridad;
+    tarea->informe.periodo = periodo;
+    tarea->informe.plazo = plazo;
+    EstadisticaReiniciar(&tarea->informe.ciclos);
+    __set_PRIMASK(primask);
+
+    return tarea;
+}
+
+RAPIDA void PlanificadorActivar(tarea_t tarea) {
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    PlanificadorMarcar(tarea);
+    __set_PRIMASK(primask);
+}
+
+RAPIDA void PlanificadorTick(void) {
+
+    ahora++;
+    for (uint8_t indice = 0; indice < cantidad; indice++) {
+        struct tarea_s * tarea = &tareas[indice];
+        if (tarea->informe.periodo && --tarea->cuenta == 0) {
+            tarea->cuenta = tarea->informe.periodo;
+            PlanificadorMarcar(tarea);
+        }
+    }
+}
+
+bool PlanificadorEjecutar(void) {
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!listas) {
+        __set_PRIMASK(primask);
+        return false;
+    }
+    struct tarea_s * tarea = orden[__builtin_ctz(listas)];
+    uint32_t activacion = tarea->activacion;
+    listas &= ~(1UL << tarea->bit);
+    __set_PRIMASK(primask);
+
+    uint32_t inicio = DWT->CYCCNT;
+    tarea->funcion(tarea->contexto);
+    EstadisticaRegistrar(&tarea->informe.ciclos, DWT->CYCCNT - inicio);
+
+    uint32_t demora = ahora - activacion;
+    tarea->informe.activaciones++;
+    if (demora > tarea->informe.demora_maxima) {
+        tarea->informe.demora_maxima = demora;
+    }
+    if (tarea->informe.plazo && demora > tarea->informe.plazo) {
+        tarea->informe.plazos_perdidos++;
+    }
+    return true;
+}
+
+bool PlanificadorPendiente(void) {
+
+    return listas != 0;
+}
+
+uint8_t PlanificadorTareas(void) {
+
+    return cantidad;
+}
+
+const tarea_informe_s * PlanificadorInforme(uint8_t indice) {
+
+    return (indice < cantidad) ? &orden[indice]->informe : NULL;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
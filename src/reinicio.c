@@ -0,0 +1,140 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Arranque en caliente
+ **
+ ** Una firma valida en la memoria retenida indica que el procesador se reinicio sin perder la
+ ** alimentacion. La causa sale del perro guardian o de la marca que deja ReinicioPedir, y los ticks
+ ** perdidos de la ultima alimentacion del perro: este vence "espera" ticks despues, y los que no se
+ ** llegaron a contar hasta ese momento se suman a la duracion estimada del arranque.
+ **
+ ** \addtogroup reinicio Reinicio
+ ** \brief Arranque en caliente
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "reinicio.h"
+#include <string.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define REINICIO_FIRMA 0x5245494EUL
+
+// Parametros de FNV-1a de 32 bits
+#define SUMA_BASE      0x811C9DC5UL
+#define SUMA_PRIMO     0x01000193UL
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+static reinicio_causa_t causa = REINICIO_FRIO;
+static uint32_t perdidos = 0;
+static uint32_t arranque = 0; // tick del arranque actual
+
+/* === Private function declarations =========================================================== */
+
+/* === Public variable definitions ============================================================= */
+
+reinicio_s reinicio RETENIDA;
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+/* === Public function implementation ========================================================== */
+
+void ReinicioInit(bool perro, uint32_t espera) {
+
+    if (reinicio.firma != REINICIO_FIRMA) {
+        memset(&reinicio, 0, sizeof(reinicio));
+        reinicio.firma = REINICIO_FIRMA;
+        causa = REINICIO_FRIO;
+        perdidos = 0;
+    } else {
+        causa = perro ? REINICIO_PERRO : (reinicio.pedido ? REINICIO_PEDIDO : REINICIO_EXTERNO);
+        perdidos = REINICIO_ARRANQUE;
+        if (perro) {
+            // Si las interrupciones siguieron activas hasta el final ya se contaron esos ticks
+            uint32_t vencimiento = reinicio.alimentado + espera;
+            if ((int32_t)(vencimiento - reinicio.ticks) > 0) {
+                perdidos += vencimiento - reinicio.ticks;
+            }
+            if (reinicio.seguidos < UINT8_MAX) {
+                reinicio.seguidos++;
+            }
+        } else {
+            reinicio.seguidos = 0;
+        }
+        reinicio.reinicios++;
+        reinicio.ticks += perdidos;
+    }
+    reinicio.pedido = false;
+    reinicio.alimentado = reinicio.ticks;
+    arranque = reinicio.ticks;
+}
+
+reinicio_causa_t ReinicioCausa(void) {
+
+    return causa;
+}
+
+bool ReinicioEnCaliente(void) {
+
+    return causa != REINICIO_FRIO && reinicio.seguidos < REINICIO_PERRO_SEGUIDOS;
+}
+
+uint32_t ReinicioPerdidos(void) {
+
+    return perdidos;
+}
+
+uint32_t ReinicioCantidad(void) {
+
+    return reinicio.reinicios;
+}
+
+uint32_t ReinicioSuma(const void * datos, size_t tamano) {
+
+    const uint8_t * byte = datos;
+    uint32_t suma = (SUMA_BASE ^ (uint32_t)tamano) * SUMA_PRIMO;
+
+    for (size_t indice = 0; indice < tamano; indice++) {
+        suma = (suma ^ byte[indice]) * SUMA_PRIMO;
+    }
+    return suma;
+}
+
+void ReinicioAlimentado(void) {
+
+    uint32_t ticks = reinicio.ticks;
+
+    reinicio.alimentado = ticks;
+    if (reinicio.seguidos && ticks - arranque >= REINICIO_ESTABLE) {
+        reinicio.seguidos = 0;
+    }
+}
+
+void ReinicioPedir(void) {
+
+    reinicio.pedido = true;
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
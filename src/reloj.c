@@ -18,7 +18,19 @@ SPDX-License-Identifier: MIT
 /* === Headers files inclusions =============================================================== */
 
 #include "reloj.h"
-#include <string.h>
+
+// Con RELOJ_PLANTILLA la interfaz la implementa reloj_plantilla.cpp
+#if !defined(RELOJ_PLANTILLA)
+
+    #include "temporizador.h"
+    #include "chip.h"
+    #include "perfil.h"
+    #include "traza.h"
+    #include "reinicio.h"
+    #include "bcd.h"
+    #include "rapida.h"
+    #include <stddef.h>
+    #include <string.h>
 
 /* === Macros definitions ====================================================================== */
 
@@ -26,15 +38,26 @@ SPDX-License-Identifier: MIT
 
 typedef struct reloj_s {
 
-    uint8_t hora_actual[6];
+    // Estado que se retoma despues de un reinicio en caliente, cubierto por la suma
+    bcd_t hora_actual; // 0x00HHMMSS
+    bcd_t alarma;      // 0x00HHMM00, alineada con hora_actual para compararlas sin convertir
     bool hora_valida : 1;
-    int ticks; // cantidad de interrupciones antes de aumentar un segundo
-    int tick_actual;
-    /***********************/
-    uint8_t alarma[4];
     bool alarma_habilitada : 1;
-    callback_disparar disparar_alarma;
-    uint32_t snooze_offset; // tiempo que se suma a alarma al momento de compararse con hora_actual
+    uint32_t posponer_restante; // ticks que le faltaban a la alarma pospuesta en el ultimo segundo
+    uint32_t suma;
+    /***********************/
+    int tick_actual; // fuera de la suma porque cambia en cada tick; se valida con el rango
+    int ticks;       // cantidad de interrupciones antes de aumentar un segundo
+    temporizador_t posponer; // vuelve a disparar la alarma pospuesta
+    uint32_t secuencia;      // impar mientras se escribe la hora o la alarma, ver RelojVista
+    // Los cuenta RelojContarTick y los procesa RelojProcesarTicks; cada uno escribe solo los suyos
+    uint8_t segundos_contados;
+    uint8_t segundos_procesados;
+    uint8_t medios_contados;
+    uint8_t medios_procesados;
+    // Vencimientos de la alarma pospuesta: los cuenta AlarmaPospuesta en el SysTick
+    uint8_t pospuestas_contadas;
+    uint8_t pospuestas_procesadas;
 
 } reloj_s;
 /* === Private variable declarations =========================================================== */
@@ -42,178 +65,320 @@ typedef struct reloj_s {
 // uint8_t hora_actual[] = {0};
 
 /* === Private function declarations =========================================================== */
-void NuevoSegundo(reloj_t reloj);
-
-uint32_t DataTimeASeg(uint8_t * data_time);
+bcd_t NuevoSegundo(reloj_t reloj);
+void SegundoCompleto(reloj_t reloj);
+void AlarmaPospuesta(temporizador_t temporizador, void * contexto);
+void Sellar(reloj_t reloj);
+bool Retenido(reloj_t reloj, int ticks_por_segundo);
+static inline void EscrituraInicio(reloj_t reloj);
+static inline void EscrituraFin(reloj_t reloj);
 /* === Public variable definitions ============================================================= */
 
 /* === Private variable definitions ============================================================ */
 
+static reloj_s self[1] RETENIDA;
+static bool recuperado = false;
+
 /* === Private function implementation ========================================================= */
-void NuevoSegundo(reloj_t reloj) {
-
-    reloj->hora_actual[5]++; // incrementa en 1 los segundos
-                             // false: si se superaron las 10 horas
-
-    if (reloj->hora_actual[5] == 10) {
-        reloj->hora_actual[5] = 0;
-        reloj->hora_actual[4]++; // incrementan las decenas de segundos
-        if (reloj->hora_actual[4] == 6) {
-            reloj->hora_actual[4] = 0;
-            reloj->hora_actual[3]++; // incrementan los minutos
-            if (reloj->hora_actual[3] == 10) {
-                reloj->hora_actual[3] = 0;
-                reloj->hora_actual[2]++; // incrementan las decenas de minutos
-                if (reloj->hora_actual[2] == 6) {
-                    reloj->hora_actual[2] = 0;
-                    reloj->hora_actual[1]++; // incrementan las horas
-                    if (reloj->hora_actual[1] == 10 && reloj->hora_actual[0] < 2) {
-                        reloj->hora_actual[1] = 0;
-                        reloj->hora_actual[0]++; // incrementan las decenas
-                    } else if (reloj->hora_actual[1] == 4 && reloj->hora_actual[0] == 2) {
-                        reloj->hora_actual[1] = 0;
-                        reloj->hora_actual[0] = 0;
-                    }
-                }
-            }
+// Devuelve los campos que cambiaron, para publicar el minuto, la hora y el dia
+bcd_t NuevoSegundo(reloj_t reloj) {
+
+    bcd_t anterior = reloj->hora_actual;
+    bcd_t actual = BcdSegundo(anterior);
+
+    EscrituraInicio(reloj);
+    __atomic_store_n(&reloj->hora_actual, actual, __ATOMIC_RELAXED);
+    EscrituraFin(reloj);
+    return anterior ^ actual;
+}
+// El trabajo de cada segundo, que RelojProcesarTicks hace fuera de la interrupcion del SysTick
+void SegundoCompleto(reloj_t reloj) {
+
+    if (reloj->hora_valida == true) {
+        PERFIL_INICIO(SEGUNDO);
+        bcd_t cambios = NuevoSegundo(reloj);
+        PERFIL_FIN(SEGUNDO);
+        if (cambios >= BCD_MINUTOS) {
+            RelojPublicar(reloj, RELOJ_MINUTO);
+        }
+        if (cambios >= BCD_HORAS) {
+            RelojPublicar(reloj, RELOJ_HORA);
         }
+        if (reloj->hora_actual == 0) {
+            RelojPublicar(reloj, RELOJ_DIA);
+        }
+        PERFIL_INICIO(ALARMA);
+        VerificarAlarma(reloj);
+        PERFIL_FIN(ALARMA);
     }
+    reloj->posponer_restante = TemporizadorRestante(reloj->posponer);
+    Sellar(reloj);
+    RelojPublicar(reloj, RELOJ_SEGUNDO);
+}
+
+// Corre en TemporizadorTick, en el SysTick: como los segundos, solo cuenta el vencimiento y la
+// alarma la publica RelojProcesarTicks
+void AlarmaPospuesta(temporizador_t temporizador, void * contexto) {
+
+    reloj_t reloj = contexto;
+    __atomic_store_n(&reloj->pospuestas_contadas, reloj->pospuestas_contadas + 1, __ATOMIC_RELEASE);
+}
+
+// Recalcula la suma despues de cambiar el estado retenido. Un reinicio entre el cambio y la suma
+// deja el reloj para arrancar en frio, nunca con un estado a medias
+void Sellar(reloj_t reloj) {
+
+    reloj->suma = ReinicioSuma(reloj, offsetof(reloj_s, suma));
+}
+
+bool Retenido(reloj_t reloj, int ticks_por_segundo) {
+
+    return reloj->suma == ReinicioSuma(reloj, offsetof(reloj_s, suma)) &&
+           reloj->tick_actual >= 0 && reloj->tick_actual < ticks_por_segundo;
 }
-// Convierte cualquier array de 4 bytes a un entero sin signo
-uint32_t DataTimeASeg(uint8_t * data_time) {
 
-    // data_time debe tener 4 elementos como minimo, corregir para que no haya comportamiento
-    // indefinido si se pasaran menos elementos
-    uint32_t data_time_seg = (data_time[0] * 10 * 3600) + (data_time[1] * 3600) +
-                             (data_time[2] * 10 * 60) + (data_time[3] * 60);
-    return data_time_seg;
+// Escriben la hora y la alarma RelojProcesarTicks y el lazo principal, que es el unico que lee la
+// vista. El lazo escribe con las interrupciones enmascaradas, desde antes de la secuencia hasta
+// despues de la suma: PendSV no puede sumar un segundo entre la lectura y la escritura de la hora,
+// ni la secuencia ni la suma quedan con un valor anterior al de la interrupcion. Asi leer y guardar
+// la secuencia por separado alcanza, y el Cortex-M0 no tiene instrucciones atomicas de lectura y
+// escritura
+static inline void EscrituraInicio(reloj_t reloj) {
+
+    __atomic_store_n(&reloj->secuencia, reloj->secuencia + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void EscrituraFin(reloj_t reloj) {
+
+    __atomic_store_n(&reloj->secuencia, reloj->secuencia + 1, __ATOMIC_RELEASE);
 }
+
 /* === Public function implementation ========================================================== */
 
-reloj_t ClockCreate(int ticks_por_segundo, callback_disparar funcion_de_disparo) {
+reloj_t ClockCreate(int ticks_por_segundo) {
+
+    static temporizador_t posponer = NULL;
 
-    static reloj_s self[1];
-    memset(self, 0, sizeof(self));
+    if (!posponer) {
+        posponer = TemporizadorCreate(AlarmaPospuesta, self);
+    }
+    TemporizadorDetener(posponer);
+
+    // Despues de un reinicio en caliente se sigue con la hora, la alarma y la alarma pospuesta
+    recuperado = ReinicioEnCaliente() && Retenido(self, ticks_por_segundo);
+    if (!recuperado) {
+        memset(self, 0, sizeof(self));
+        Sellar(self);
+    } else if (self->posponer_restante) {
+        TemporizadorIniciar(posponer, self->posponer_restante, 0);
+    }
     self->ticks = ticks_por_segundo;
-    self->disparar_alarma = funcion_de_disparo;
+    self->posponer = posponer;
+    self->secuencia = 0; // un reinicio en medio de una escritura la pudo dejar impar
+    // Un segundo contado y no procesado antes del reinicio se pierde, como los ticks del reinicio
+    self->segundos_contados = self->segundos_procesados = 0;
+    self->medios_contados = self->medios_procesados = 0;
+    self->pospuestas_contadas = self->pospuestas_procesadas = 0;
     return self;
 }
 
+bool RelojRecuperado(reloj_t reloj) {
+
+    return recuperado;
+}
+
+void RelojCompensar(reloj_t reloj, uint32_t ticks) {
+
+    // Los ticks perdidos tambien corren para la alarma pospuesta, que el reloj no avanza
+    if (TemporizadorActivo(reloj->posponer)) {
+        uint32_t restante = TemporizadorRestante(reloj->posponer);
+        TemporizadorIniciar(reloj->posponer, restante > ticks ? restante - ticks : 1, 0);
+    }
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+        RelojNuevoTick(reloj);
+    }
+}
+
+void RelojVista(reloj_t reloj, reloj_vista_s * vista) {
+
+    uint32_t antes, despues;
+
+    do {
+        antes = __atomic_load_n(&reloj->secuencia, __ATOMIC_ACQUIRE);
+        vista->hora = __atomic_load_n(&reloj->hora_actual, __ATOMIC_RELAXED);
+        vista->alarma = __atomic_load_n(&reloj->alarma, __ATOMIC_RELAXED);
+        vista->hora_valida = reloj->hora_valida;
+        vista->alarma_habilitada = reloj->alarma_habilitada;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        despues = __atomic_load_n(&reloj->secuencia, __ATOMIC_RELAXED);
+    } while ((antes & 1) || antes != despues);
+}
+
 bool GetClockTime(reloj_t reloj, uint8_t * hora, int size) {
 
-    // memset(hora, 0, size);
-    memcpy(hora, reloj->hora_actual, size);
+    reloj_vista_s vista;
+
+    RelojVista(reloj, &vista);
+    BcdDesempaquetar(vista.hora, hora, size);
+    return vista.hora_valida;
+}
+
+// La hora es una palabra alineada que se lee de una vez, y hora_valida solo la cambia el lazo
+// principal: no hace falta la secuencia
+bool GetClockTimePacked(reloj_t reloj, bcd_t * hora) {
 
+    *hora = __atomic_load_n(&reloj->hora_actual, __ATOMIC_RELAXED);
     return reloj->hora_valida;
 }
 
 bool SetClockTime(reloj_t reloj, const uint8_t * hora_nueva, int size) {
 
-    memcpy(reloj->hora_actual, hora_nueva, size);
+    bcd_t nueva = BcdEmpaquetar(hora_nueva, size);
+    uint32_t primask = __get_PRIMASK();
+
+    // Los campos que no se pasan, como los segundos al ajustar HH:MM, siguen como estaban
+    __disable_irq();
+    EscrituraInicio(reloj);
+    __atomic_store_n(&reloj->hora_actual, (reloj->hora_actual & ~BcdMascara(size)) | nueva,
+                     __ATOMIC_RELAXED);
     reloj->hora_valida = true; // indica que la hora actual del reloj es válida
+    EscrituraFin(reloj);
+    Sellar(reloj);
+    __set_PRIMASK(primask);
+    TRAZA(HORA, 0, reloj->hora_actual >> 8);
 
     return true; // hace falta retornar una confirmacion?
 }
 
 // En principio esta funcion es la que llama el systick en cada interrupcion
-int RelojNuevoTick(reloj_t reloj) {
+RAPIDA bool RelojContarTick(reloj_t reloj) {
 
     if ((reloj->tick_actual >= (reloj->ticks - 1))) { // if ((reloj->tick_actual >= reloj->ticks)) {
-        if (reloj->hora_valida == true) {
-            NuevoSegundo(reloj);
-            VerificarAlarma(reloj);
-        }
         reloj->tick_actual = 0;
-    } else {
-        reloj->tick_actual++;
+        __atomic_store_n(&reloj->segundos_contados, reloj->segundos_contados + 1, __ATOMIC_RELEASE);
+        return true;
+    } else if (++reloj->tick_actual == reloj->ticks / 2) {
+        __atomic_store_n(&reloj->medios_contados, reloj->medios_contados + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+    return reloj->pospuestas_contadas != __atomic_load_n(&reloj->pospuestas_procesadas,
+                                                         __ATOMIC_RELAXED);
+}
+
+void RelojProcesarTicks(reloj_t reloj) {
+
+    // La pospuesta vencio en TemporizadorTick, antes de contar el tick
+    while (reloj->pospuestas_procesadas !=
+           __atomic_load_n(&reloj->pospuestas_contadas, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&reloj->pospuestas_procesadas, reloj->pospuestas_procesadas + 1,
+                         __ATOMIC_RELAXED);
+        if (reloj->alarma_habilitada) {
+            RelojPublicar(reloj, RELOJ_ALARMA);
+        }
+    }
+    while (reloj->segundos_procesados !=
+           __atomic_load_n(&reloj->segundos_contados, __ATOMIC_ACQUIRE)) {
+        SegundoCompleto(reloj);
+        reloj->segundos_procesados++;
+    }
+    while (reloj->medios_procesados != __atomic_load_n(&reloj->medios_contados, __ATOMIC_ACQUIRE)) {
+        reloj->medios_procesados++;
+        RelojPublicar(reloj, RELOJ_MEDIO_SEGUNDO);
+    }
+}
+
+int RelojNuevoTick(reloj_t reloj) {
+
+    if (RelojContarTick(reloj)) {
+        RelojProcesarTicks(reloj);
     }
     return reloj->tick_actual;
 }
 
 bool SetAlarmTime(reloj_t reloj, const uint8_t * alarma) {
     // No me debería dejar setear una alarma si nunca se configuró la hora
+    uint32_t primask = __get_PRIMASK();
 
-    memcpy(reloj->alarma, alarma, 4);
+    __disable_irq();
+    EscrituraInicio(reloj);
+    __atomic_store_n(&reloj->alarma, BcdEmpaquetar(alarma, 4), __ATOMIC_RELAXED);
     reloj->alarma_habilitada = true;
+    EscrituraFin(reloj);
+    Sellar(reloj);
+    __set_PRIMASK(primask);
+    TRAZA(AJUSTE_ALARMA, 0, TrazaBCD(alarma));
     return true;
 }
 
 bool GetAlarmTime(reloj_t reloj, uint8_t * alarma) {
 
-    memcpy(alarma, reloj->alarma, 4);
-    return reloj->alarma_habilitada;
+    reloj_vista_s vista;
+
+    RelojVista(reloj, &vista);
+    BcdDesempaquetar(vista.alarma, alarma, 4);
+    return vista.alarma_habilitada;
 }
 
-// La funcion pasa hora_actual y alarma a segundos, esto se hace para facilitar el offset de tiempo
-// que se agrega cuando se pospone la alarma, y compara cada minuto si hay coincidencia.
-// modificacion: Se hace que la funcion devuelva un booleando para saber si la alarma está sonando o
-// no. en funcion del parametro 'mode' la funcion disparará la alarma o avisará que está sonando al
-// encontrar coincidencia
-// mode = 1 : al haber coincidencia dispara la alarma y retorna 1
-// mode = 0 : al haber coincidencia no dispara y retorna 1 y si no hubo coincidencia retorna 0
+// Al comenzar cada minuto compara hora_actual con la alarma, las dos empaquetadas, y si coinciden
+// con la alarma habilitada publica RELOJ_ALARMA. La alarma pospuesta no pasa por aqui: la vuelve a
+// disparar el temporizador posponer.
 void VerificarAlarma(reloj_t reloj) {
-    // Necesito verificar alarma solo cada minuto:
-
-    if ((reloj->hora_actual[4] == 0) && (reloj->hora_actual[5] == 0)) {
 
-        // Convierto hora_actual y alarma a segundos, sumo el snooze a alarma y comparo.
-        uint32_t hora_actual = DataTimeASeg(reloj->hora_actual);
-        uint32_t alarma_actual = DataTimeASeg(reloj->alarma);
-        uint32_t nueva_alarma = alarma_actual + reloj->snooze_offset;
+    // Con los segundos en 00 coinciden si las palabras son iguales
+    if (BCD_CAMPO(reloj->hora_actual, BCD_SEGUNDOS) == 0) {
 
-        // Verifico que nueva_alarma no supere las 24 horas
-        if (nueva_alarma >= 86400) {
-            nueva_alarma -= 86400;
-        }
-        if ((hora_actual == nueva_alarma) & (reloj->alarma_habilitada)) {
-            reloj->disparar_alarma(reloj, true);
+        if ((BcdComparar(reloj->hora_actual, reloj->alarma) == 0) & (reloj->alarma_habilitada)) {
+            RelojPublicar(reloj, RELOJ_ALARMA);
         }
     }
 }
 
 void ToggleHabAlarma(reloj_t reloj) {
 
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    EscrituraInicio(reloj);
     reloj->alarma_habilitada ^= 1;
-    reloj->snooze_offset = 0;
+    EscrituraFin(reloj);
+    TemporizadorDetener(reloj->posponer);
+    reloj->posponer_restante = 0;
+    Sellar(reloj);
+    __set_PRIMASK(primask);
+    TRAZA(HABILITAR_ALARMA, reloj->alarma_habilitada, 0);
 }
 
+// El temporizador cuenta los mismos ticks que RelojNuevoTick, por eso la espera se expresa en ticks
+// del reloj. Como el resto del estado retenido, posponer_restante tambien lo escribe PendSV
 void PosponerAlarma(reloj_t reloj, uint8_t minutos) {
 
-    reloj->snooze_offset += minutos * 60;
-    reloj->disparar_alarma(reloj, false);
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    reloj->posponer_restante = (uint32_t)minutos * 60 * reloj->ticks;
+    TemporizadorIniciar(reloj->posponer, reloj->posponer_restante, 0);
+    Sellar(reloj);
+    TRAZA(POSPONER, minutos, 0);
+    // Los suscriptores siguen enmascarados para no cruzarse con los que llama RelojProcesarTicks
+    RelojPublicar(reloj, RELOJ_POSPONER);
+    __set_PRIMASK(primask);
 }
 
 void CancelarAlarma(reloj_t reloj) {
-    reloj->snooze_offset = 0;
-    reloj->disparar_alarma(reloj, false);
-}
 
-/*
-void DeshabilitarAlarma(reloj_t reloj) {
+    uint32_t primask = __get_PRIMASK();
 
-    reloj->alarma_habilitada = false;
-    reloj->snooze_offset = 0;
+    __disable_irq();
+    TemporizadorDetener(reloj->posponer);
+    reloj->posponer_restante = 0;
+    Sellar(reloj);
+    RelojPublicar(reloj, RELOJ_CANCELAR);
+    __set_PRIMASK(primask);
 }
-*/
+
+#endif /* RELOJ_PLANTILLA */
 
 /* === End of documentation ==================================================================== */
 
 /** @} End of module definition for doxygen */
-
-/*
-int RelojNuevoTick(reloj_t reloj) {
-    bool act_tick;
-
-    if ((reloj->tick_actual >= (reloj->ticks - 1))) { // if ((reloj->tick_actual >= reloj->ticks)) {
-        if (reloj->hora_valida == true) {
-            NuevoSegundo(reloj);
-            VerificarAlarma(reloj);
-        }
-        reloj->tick_actual = 0;
-    } else {
-        reloj->tick_actual++;
-    }
-    return reloj->tick_actual;
-}
-
-*/
\ No newline at end of file
@@ -0,0 +1,93 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Suscriptores de los eventos del reloj
+ **
+ ** Lo comparten src/reloj.c y src/reloj_plantilla.cpp. Cada evento guarda una copia de la funcion y
+ ** el contexto de sus suscriptores en un arreglo propio, asi que publicar es recorrer un arreglo
+ ** contiguo. Suscribirse agrega la entrada y despues incrementa la cantidad, de modo que una
+ ** publicacion desde la interrupcion nunca ve una entrada a medio escribir. La duracion de cada
+ ** publicacion se mide en la sonda del perfil de su evento.
+ **
+ ** \addtogroup reloj Reloj
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "reloj.h"
+#include "perfil.h"
+
+/* === Macros definitions ====================================================================== */
+
+// Cada evento tiene su sonda en perfil_sondas.h, en el orden de reloj_evento_t
+_Static_assert(PERFIL_EVENTO_CANCELAR - PERFIL_EVENTO_SEGUNDO == RELOJ_CANCELAR - RELOJ_SEGUNDO &&
+                   RELOJ_CANCELAR == RELOJ_EVENTOS - 1,
+               "las sondas de los eventos no coinciden con reloj_evento_t");
+
+/* === Private data type declarations ========================================================== */
+
+typedef struct suscriptor_s {
+    reloj_suscriptor_t funcion;
+    void * contexto;
+} suscriptor_s;
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static suscriptor_s suscriptores[RELOJ_EVENTOS][RELOJ_SUSCRIPTORES];
+static uint8_t cantidad[RELOJ_EVENTOS];
+
+/* === Private function implementation ========================================================= */
+
+/* === Public function implementation ========================================================== */
+
+bool RelojSuscribir(reloj_t reloj, uint16_t filtro, reloj_suscriptor_t funcion, void * contexto) {
+
+    (void)reloj;
+    for (int evento = 0; evento < RELOJ_EVENTOS; evento++) {
+        if ((filtro & RELOJ_FILTRO(evento)) && cantidad[evento] >= RELOJ_SUSCRIPTORES) {
+            return false;
+        }
+    }
+    for (int evento = 0; evento < RELOJ_EVENTOS; evento++) {
+        if (filtro & RELOJ_FILTRO(evento)) {
+            suscriptores[evento][cantidad[evento]] = (suscriptor_s){funcion, contexto};
+            __atomic_store_n(&cantidad[evento], cantidad[evento] + 1, __ATOMIC_RELEASE);
+        }
+    }
+    return true;
+}
+
+void RelojPublicar(reloj_t reloj, reloj_evento_t evento) {
+
+    PERFIL_INICIO(EVENTO_SEGUNDO);
+    uint8_t total = __atomic_load_n(&cantidad[evento], __ATOMIC_ACQUIRE);
+    for (const suscriptor_s * suscriptor = suscriptores[evento];
+         suscriptor < &suscriptores[evento][total]; suscriptor++) {
+        suscriptor->funcion(reloj, evento, suscriptor->contexto);
+    }
+    PERFIL_FIN_INDICE(EVENTO_SEGUNDO, evento);
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,393 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Interfaz de reloj.h sobre el motor de reloj.hpp
+ **
+ ** Reemplaza a reloj.c cuando se compila con RELOJ_PLANTILLA: la memoria retenida, la alarma
+ ** pospuesta, la traza y las sondas de perfil son las mismas, y el conteo de ticks y segundos lo
+ ** hace RelojMotor con la frecuencia, el formato y los campos fijados al compilar. El formato es de
+ ** 24 horas con segundos porque main ajusta la hora y la alarma de 00:00 a 23:59.
+ **
+ ** \addtogroup reloj Reloj
+ ** \brief Hora y alarma
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "reloj.h"
+
+#if defined(RELOJ_PLANTILLA)
+
+    #include "reloj.hpp"
+    #include "temporizador.h"
+    #include "chip.h"
+    #include "perfil.h"
+    #include "traza.h"
+    #include "reinicio.h"
+    #include "rapida.h"
+    #include <stddef.h>
+    #include <string.h>
+
+/* === Macros definitions ====================================================================== */
+
+    //! Ticks por segundo fijados al compilar; con 0 valen los que recibe ClockCreate
+    #ifndef RELOJ_TICKS
+        #define RELOJ_TICKS TICKS_PER_SECOND
+    #endif
+
+    //! Forma de guardar la hora: CamposBCD, CamposDigitos o CamposSegundos
+    #ifndef RELOJ_CAMPOS
+        #define RELOJ_CAMPOS CamposBCD
+    #endif
+
+/* === Private data type declarations ========================================================== */
+
+using motor_t = RelojMotor<RELOJ_TICKS, Formato::H24, true, RELOJ_CAMPOS>;
+
+typedef struct reloj_s {
+
+    // Estado que se retoma despues de un reinicio en caliente, cubierto por la suma
+    motor_t::Hora hora_actual;
+    bcd_t alarma; // 0x00HHMM00
+    bool hora_valida : 1;
+    bool alarma_habilitada : 1;
+    uint32_t posponer_restante; // ticks que le faltaban a la alarma pospuesta en el ultimo segundo
+    uint32_t suma;
+    /***********************/
+    motor_t::Contador tick_actual; // fuera de la suma porque cambia en cada tick
+    int ticks;
+    temporizador_t posponer; // vuelve a disparar la alarma pospuesta
+    uint32_t secuencia;      // impar mientras se escribe la hora o la alarma
+    uint8_t segundos_contados; // como en reloj.c, cada mitad del tick escribe solo los suyos
+    uint8_t segundos_procesados;
+    uint8_t medios_contados;
+    uint8_t medios_procesados;
+    uint8_t pospuestas_contadas; // vencimientos de la alarma pospuesta, contados en el SysTick
+    uint8_t pospuestas_procesadas;
+
+} reloj_s;
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+static void SegundoCompleto(reloj_t reloj);
+static void AlarmaPospuesta(temporizador_t temporizador, void * contexto);
+static void Sellar(reloj_t reloj);
+static bool Retenido(reloj_t reloj, int ticks_por_segundo);
+static inline void EscrituraInicio(reloj_t reloj);
+static inline void EscrituraFin(reloj_t reloj);
+static motor_t::Hora LeerHora(reloj_t reloj);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+static reloj_s self[1] RETENIDA;
+static bool recuperado = false;
+
+/* === Private function implementation ========================================================= */
+
+static void SegundoCompleto(reloj_t reloj) {
+
+    if (reloj->hora_valida) {
+        PERFIL_INICIO(SEGUNDO);
+        EscrituraInicio(reloj);
+        bool hora_nueva = reloj->hora_actual.Avanzar();
+        EscrituraFin(reloj);
+        PERFIL_FIN(SEGUNDO);
+        if (reloj->hora_actual.EnPunto()) {
+            RelojPublicar(reloj, RELOJ_MINUTO);
+        }
+        if (hora_nueva) {
+            RelojPublicar(reloj, RELOJ_HORA);
+            if (reloj->hora_actual.Empaquetada() == 0) {
+                RelojPublicar(reloj, RELOJ_DIA);
+            }
+        }
+        PERFIL_INICIO(ALARMA);
+        VerificarAlarma(reloj);
+        PERFIL_FIN(ALARMA);
+    }
+    reloj->posponer_restante = TemporizadorRestante(reloj->posponer);
+    Sellar(reloj);
+    RelojPublicar(reloj, RELOJ_SEGUNDO);
+}
+
+// Como en reloj.c, solo cuenta el vencimiento y la alarma la publica RelojProcesarTicks
+static void AlarmaPospuesta(temporizador_t temporizador, void * contexto) {
+
+    reloj_t reloj = static_cast<reloj_t>(contexto);
+    __atomic_store_n(&reloj->pospuestas_contadas, reloj->pospuestas_contadas + 1, __ATOMIC_RELEASE);
+}
+
+static void Sellar(reloj_t reloj) {
+
+    reloj->suma = ReinicioSuma(reloj, offsetof(reloj_s, suma));
+}
+
+static bool Retenido(reloj_t reloj, int ticks_por_segundo) {
+
+    return reloj->suma == ReinicioSuma(reloj, offsetof(reloj_s, suma)) &&
+           reloj->tick_actual.Valido(ticks_por_segundo);
+}
+
+// Igual que en reloj.c: solo el lazo principal lee, y escribe con las interrupciones enmascaradas
+// desde antes de la secuencia hasta despues de la suma
+static inline void EscrituraInicio(reloj_t reloj) {
+
+    __atomic_store_n(&reloj->secuencia, reloj->secuencia + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void EscrituraFin(reloj_t reloj) {
+
+    __atomic_store_n(&reloj->secuencia, reloj->secuencia + 1, __ATOMIC_RELEASE);
+}
+
+// Con CamposDigitos o CamposSegundos la hora ocupa mas de una palabra y se copia con la secuencia
+static motor_t::Hora LeerHora(reloj_t reloj) {
+
+    reloj_vista_s vista;
+    motor_t::Hora hora;
+
+    if (sizeof(hora) == sizeof(bcd_t)) {
+        return reloj->hora_actual; // CamposBCD: una sola palabra, como en reloj.c
+    }
+    RelojVista(reloj, &vista);
+    hora.Cargar(vista.hora);
+    return hora;
+}
+
+/* === Public function implementation ========================================================== */
+
+// Con la frecuencia fijada al compilar, ClockCreate no puede contar a otra y devuelve NULL
+reloj_t ClockCreate(int ticks_por_segundo) {
+
+    static temporizador_t posponer = NULL;
+
+    if (RELOJ_TICKS && ticks_por_segundo != RELOJ_TICKS) {
+        return NULL;
+    }
+    if (!posponer) {
+        posponer = TemporizadorCreate(AlarmaPospuesta, self);
+    }
+    TemporizadorDetener(posponer);
+
+    recuperado = ReinicioEnCaliente() && Retenido(self, ticks_por_segundo);
+    if (!recuperado) {
+        memset(self, 0, sizeof(self));
+        Sellar(self);
+    } else if (self->posponer_restante) {
+        TemporizadorIniciar(posponer, self->posponer_restante, 0);
+    }
+    self->ticks = ticks_por_segundo;
+    self->posponer = posponer;
+    self->secuencia = 0;
+    self->segundos_contados = self->segundos_procesados = 0;
+    self->medios_contados = self->medios_procesados = 0;
+    self->pospuestas_contadas = self->pospuestas_procesadas = 0;
+    return self;
+}
+
+bool RelojRecuperado(reloj_t reloj) {
+
+    return recuperado;
+}
+
+void RelojCompensar(reloj_t reloj, uint32_t ticks) {
+
+    if (TemporizadorActivo(reloj->posponer)) {
+        uint32_t restante = TemporizadorRestante(reloj->posponer);
+        TemporizadorIniciar(reloj->posponer, restante > ticks ? restante - ticks : 1, 0);
+    }
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+        RelojNuevoTick(reloj);
+    }
+}
+
+void RelojVista(reloj_t reloj, reloj_vista_s * vista) {
+
+    uint32_t antes, despues;
+    motor_t::Hora hora;
+
+    do {
+        antes = __atomic_load_n(&reloj->secuencia, __ATOMIC_ACQUIRE);
+        hora = reloj->hora_actual;
+        vista->alarma = __atomic_load_n(&reloj->alarma, __ATOMIC_RELAXED);
+        vista->hora_valida = reloj->hora_valida;
+        vista->alarma_habilitada = reloj->alarma_habilitada;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        despues = __atomic_load_n(&reloj->secuencia, __ATOMIC_RELAXED);
+    } while ((antes & 1) || antes != despues);
+    vista->hora = hora.Empaquetada();
+}
+
+bool GetClockTime(reloj_t reloj, uint8_t * hora, int size) {
+
+    reloj_vista_s vista;
+
+    RelojVista(reloj, &vista);
+    BcdDesempaquetar(vista.hora, hora, size);
+    return vista.hora_valida;
+}
+
+bool GetClockTimePacked(reloj_t reloj, bcd_t * hora) {
+
+    *hora = LeerHora(reloj).Empaquetada();
+    return reloj->hora_valida;
+}
+
+bool SetClockTime(reloj_t reloj, const uint8_t * hora_nueva, int size) {
+
+    bcd_t nueva = BcdEmpaquetar(hora_nueva, size);
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    bcd_t hora = reloj->hora_actual.Empaquetada();
+    EscrituraInicio(reloj);
+    reloj->hora_actual.Cargar((hora & ~BcdMascara(size)) | nueva);
+    reloj->hora_valida = true;
+    EscrituraFin(reloj);
+    Sellar(reloj);
+    __set_PRIMASK(primask);
+    TRAZA(HORA, 0, reloj->hora_actual.Empaquetada() >> 8);
+    return true;
+}
+
+RAPIDA bool RelojContarTick(reloj_t reloj) {
+
+    uint32_t frecuencia = motor_t::Frecuencia(reloj->ticks);
+
+    if (reloj->tick_actual.Tick(frecuencia)) {
+        __atomic_store_n(&reloj->segundos_contados, reloj->segundos_contados + 1, __ATOMIC_RELEASE);
+        return true;
+    } else if (reloj->tick_actual.actual == frecuencia / 2) {
+        __atomic_store_n(&reloj->medios_contados, reloj->medios_contados + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+    return reloj->pospuestas_contadas != __atomic_load_n(&reloj->pospuestas_procesadas,
+                                                         __ATOMIC_RELAXED);
+}
+
+void RelojProcesarTicks(reloj_t reloj) {
+
+    while (reloj->pospuestas_procesadas !=
+           __atomic_load_n(&reloj->pospuestas_contadas, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&reloj->pospuestas_procesadas, reloj->pospuestas_procesadas + 1,
+                         __ATOMIC_RELAXED);
+        if (reloj->alarma_habilitada) {
+            RelojPublicar(reloj, RELOJ_ALARMA);
+        }
+    }
+    while (reloj->segundos_procesados !=
+           __atomic_load_n(&reloj->segundos_contados, __ATOMIC_ACQUIRE)) {
+        SegundoCompleto(reloj);
+        reloj->segundos_procesados++;
+    }
+    while (reloj->medios_procesados != __atomic_load_n(&reloj->medios_contados, __ATOMIC_ACQUIRE)) {
+        reloj->medios_procesados++;
+        RelojPublicar(reloj, RELOJ_MEDIO_SEGUNDO);
+    }
+}
+
+int RelojNuevoTick(reloj_t reloj) {
+
+    if (RelojContarTick(reloj)) {
+        RelojProcesarTicks(reloj);
+    }
+    return reloj->tick_actual.actual;
+}
+
+bool SetAlarmTime(reloj_t reloj, const uint8_t * alarma) {
+
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    EscrituraInicio(reloj);
+    __atomic_store_n(&reloj->alarma, BcdEmpaquetar(alarma, 4), __ATOMIC_RELAXED);
+    reloj->alarma_habilitada = true;
+    EscrituraFin(reloj);
+    Sellar(reloj);
+    __set_PRIMASK(primask);
+    TRAZA(AJUSTE_ALARMA, 0, TrazaBCD(alarma));
+    return true;
+}
+
+bool GetAlarmTime(reloj_t reloj, uint8_t * alarma) {
+
+    reloj_vista_s vista;
+
+    RelojVista(reloj, &vista);
+    BcdDesempaquetar(vista.alarma, alarma, 4);
+    return vista.alarma_habilitada;
+}
+
+void VerificarAlarma(reloj_t reloj) {
+
+    if (reloj->hora_actual.EnPunto() && reloj->alarma_habilitada &&
+        BcdComparar(reloj->hora_actual.Empaquetada(), reloj->alarma) == 0) {
+        RelojPublicar(reloj, RELOJ_ALARMA);
+    }
+}
+
+void ToggleHabAlarma(reloj_t reloj) {
+
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    EscrituraInicio(reloj);
+    reloj->alarma_habilitada = !reloj->alarma_habilitada;
+    EscrituraFin(reloj);
+    TemporizadorDetener(reloj->posponer);
+    reloj->posponer_restante = 0;
+    Sellar(reloj);
+    __set_PRIMASK(primask);
+    TRAZA(HABILITAR_ALARMA, reloj->alarma_habilitada, 0);
+}
+
+void PosponerAlarma(reloj_t reloj, uint8_t minutos) {
+
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    reloj->posponer_restante = (uint32_t)minutos * 60 * reloj->ticks;
+    TemporizadorIniciar(reloj->posponer, reloj->posponer_restante, 0);
+    Sellar(reloj);
+    TRAZA(POSPONER, minutos, 0);
+    // Los suscriptores siguen enmascarados para no cruzarse con los que llama RelojProcesarTicks
+    RelojPublicar(reloj, RELOJ_POSPONER);
+    __set_PRIMASK(primask);
+}
+
+void CancelarAlarma(reloj_t reloj) {
+
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    TemporizadorDetener(reloj->posponer);
+    reloj->posponer_restante = 0;
+    Sellar(reloj);
+    RelojPublicar(reloj, RELOJ_CANCELAR);
+    __set_PRIMASK(primask);
+}
+
+#endif /* RELOJ_PLANTILLA */
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,311 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Temporizadores por software
+ **
+ ** Rueda jerarquica de cuatro niveles de 64 ranuras. Un temporizador que vence dentro de los
+ ** proximos 64 ticks esta en la ranura de su tick en el nivel 0; uno mas lejano esta en el nivel
+ ** que corresponde a su distancia y baja de nivel (cascada) cuando el nivel inferior da la vuelta.
+ ** Cada ranura es una lista doblemente enlazada, asi que insertar y quitar no recorre nada. En
+ ** cada tick solo se atienden la ranura actual del nivel 0 y, cada 64 ticks, una ranura del nivel
+ ** siguiente; cada temporizador baja como mucho tres veces.
+ **
+ ** \addtogroup temporizador Temporizador
+ ** \brief Temporizadores por software
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "temporizador.h"
+#include "chip.h"
+#include "rapida.h"
+#include <stddef.h>
+
+/* === Macros definitions ====================================================================== */
+
+#ifndef TEMPORIZADOR_INSTANCIAS
+    #define TEMPORIZADOR_INSTANCIAS 8
+#endif
+
+#define BITS_NIVEL    6
+#define RANURAS       (1U << BITS_NIVEL)
+#define MASCARA       (RANURAS - 1)
+#define NIVELES       4
+
+/* === Private data type declarations ========================================================== */
+
+// Enlace de una lista circular doblemente enlazada. Cada ranura es el nodo centinela de su lista.
+typedef struct enlace_s {
+    struct enlace_s * siguiente;
+    struct enlace_s * anterior;
+} enlace_s;
+
+struct temporizador_s {
+    enlace_s enlace; // primer miembro: un enlace de la lista se convierte en su temporizador
+    uint32_t vencimiento; // tick absoluto del proximo vencimiento
+    uint32_t periodo;
+    temporizador_accion_t accion;
+    void * contexto;
+    uint8_t pendientes; // vencimientos sin retirar, solo sin accion
+    bool asignado : 1;
+    bool activo : 1;
+};
+
+/* === Private variable declarations =========================================================== */
+
+static struct temporizador_s instancias[TEMPORIZADOR_INSTANCIAS] = {0};
+static enlace_s rueda[NIVELES][RANURAS];
+static bool rueda_iniciada = false;
+static uint32_t ahora = 0;        // proximo tick a procesar
+static volatile uint16_t pendientes = 0; // vencimientos sin retirar de todos los temporizadores
+
+/* === Private function declarations =========================================================== */
+
+temporizador_t TemporizadorAllocate(void);
+void RuedaIniciar(void);
+void RuedaInsertar(temporizador_t temporizador);
+void RuedaQuitar(temporizador_t temporizador);
+void RuedaRetirar(enlace_s * ranura, enlace_s * lista);
+void RuedaCascada(uint8_t nivel);
+void TemporizadorVencer(temporizador_t temporizador);
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+temporizador_t TemporizadorAllocate(void) {
+    temporizador_t temporizador = NULL;
+
+    for (int i = 0; i < TEMPORIZADOR_INSTANCIAS; i++) {
+        if (instancias[i].asignado == false) {
+            temporizador = &instancias[i];
+            instancias[i].asignado = true;
+            break;
+        }
+    }
+    return temporizador;
+}
+
+void RuedaIniciar(void) {
+
+    for (int nivel = 0; nivel < NIVELES; nivel++) {
+        for (int ranura = 0; ranura < RANURAS; ranura++) {
+            rueda[nivel][ranura].siguiente = &rueda[nivel][ranura];
+            rueda[nivel][ranura].anterior = &rueda[nivel][ranura];
+        }
+    }
+    rueda_iniciada = true;
+}
+
+RAPIDA void RuedaInsertar(temporizador_t temporizador) {
+
+    uint32_t distancia = temporizador->vencimiento - ahora;
+    enlace_s * ranura;
+
+    if ((int32_t)distancia < 0) {
+        ranura = &rueda[0][ahora & MASCARA]; // ya vencido: se atiende en el proximo tick
+    } else if (distancia < RANURAS) {
+        ranura = &rueda[0][temporizador->vencimiento & MASCARA];
+    } else if (distancia < (1UL << (2 * BITS_NIVEL))) {
+        ranura = &rueda[1][(temporizador->vencimiento >> BITS_NIVEL) & MASCARA];
+    } else if (distancia < (1UL << (3 * BITS_NIVEL))) {
+        ranura = &rueda[2][(temporizador->vencimiento >> (2 * BITS_NIVEL)) & MASCARA];
+    } else {
+        ranura = &rueda[3][(temporizador->vencimiento >> (3 * BITS_NIVEL)) & MASCARA];
+    }
+
+    temporizador->enlace.siguiente = ranura;
+    temporizador->enlace.anterior = ranura->anterior;
+    ranura->anterior->siguiente = &temporizador->enlace;
+    ranura->anterior = &temporizador->enlace;
+}
+
+RAPIDA void RuedaQuitar(temporizador_t temporizador) {
+
+    enlace_s * enlace = &temporizador->enlace;
+
+    enlace->anterior->siguiente = enlace->siguiente;
+    enlace->siguiente->anterior = enlace->anterior;
+    enlace->siguiente = NULL;
+    enlace->anterior = NULL;
+}
+
+// Pasa todos los temporizadores de la ranura a la lista, que se recorre sin que las reinserciones
+// (periodicos, cascada) vuelvan a caer en lo que se esta recorriendo
+RAPIDA void RuedaRetirar(enlace_s * ranura, enlace_s * lista) {
+
+    if (ranura->siguiente == ranura) {
+        lista->siguiente = lista;
+        lista->anterior = lista;
+        return;
+    }
+    lista->siguiente = ranura->siguiente;
+    lista->anterior = ranura->anterior;
+    lista->siguiente->anterior = lista;
+    lista->anterior->siguiente = lista;
+    ranura->siguiente = ranura;
+    ranura->anterior = ranura;
+}
+
+// Reparte la ranura actual del nivel entre los niveles inferiores
+RAPIDA void RuedaCascada(uint8_t nivel) {
+
+    enlace_s lista;
+
+    RuedaRetirar(&rueda[nivel][(ahora >> (nivel * BITS_NIVEL)) & MASCARA], &lista);
+    while (lista.siguiente != &lista) {
+        temporizador_t temporizador = (temporizador_t)lista.siguiente;
+        RuedaQuitar(temporizador);
+        RuedaInsertar(temporizador);
+    }
+}
+
+RAPIDA void TemporizadorVencer(temporizador_t temporizador) {
+
+    if (temporizador->periodo) {
+        temporizador->vencimiento += temporizador->periodo;
+        RuedaInsertar(temporizador);
+    } else {
+        temporizador->activo = false;
+    }
+
+    if (temporizador->accion) {
+        temporizador->accion(temporizador, temporizador->contexto);
+    } else if (temporizador->pendientes < UINT8_MAX) {
+        temporizador->pendientes++;
+        pendientes++;
+    }
+}
+
+/* === Public function implementation ========================================================== */
+
+temporizador_t TemporizadorCreate(temporizador_accion_t accion, void * contexto) {
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!rueda_iniciada) {
+        RuedaIniciar();
+    }
+    temporizador_t temporizador = TemporizadorAllocate();
+    __set_PRIMASK(primask);
+
+    if (temporizador) {
+        temporizador->accion = accion;
+        temporizador->contexto = contexto;
+    }
+    return temporizador;
+}
+
+void TemporizadorIniciar(temporizador_t temporizador, uint32_t espera, uint32_t periodo) {
+
+    if (espera == 0) {
+        espera = 1;
+    } else if (espera > TEMPORIZADOR_MAXIMO) {
+        espera = TEMPORIZADOR_MAXIMO;
+    }
+    if (periodo > TEMPORIZADOR_MAXIMO) {
+        periodo = TEMPORIZADOR_MAXIMO;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (temporizador->activo) {
+        RuedaQuitar(temporizador);
+    }
+    temporizador->vencimiento = ahora + espera - 1; // ahora es el tick que todavia no se proceso
+    temporizador->periodo = periodo;
+    temporizador->activo = true;
+    RuedaInsertar(temporizador);
+    __set_PRIMASK(primask);
+}
+
+void TemporizadorDetener(temporizador_t temporizador) {
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (temporizador->activo) {
+        RuedaQuitar(temporizador);
+        temporizador->activo = false;
+    }
+    pendientes -= temporizador->pendientes;
+    temporizador->pendientes = 0;
+    __set_PRIMASK(primask);
+}
+
+RAPIDA bool TemporizadorActivo(temporizador_t temporizador) {
+
+    return temporizador->activo;
+}
+
+uint32_t TemporizadorRestante(temporizador_t temporizador) {
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t restante = temporizador->activo ? temporizador->vencimiento - ahora + 1 : 0;
+    __set_PRIMASK(primask);
+    return restante;
+}
+
+bool TemporizadorVencido(temporizador_t temporizador) {
+
+    bool vencido = false;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (temporizador->pendientes) {
+        temporizador->pendientes--;
+        pendientes--;
+        vencido = true;
+    }
+    __set_PRIMASK(primask);
+    return vencido;
+}
+
+RAPIDA bool TemporizadoresPendientes(void) {
+
+    return pendientes != 0;
+}
+
+RAPIDA void TemporizadorTick(void) {
+
+    if (!rueda_iniciada) {
+        RuedaIniciar();
+    }
+
+    // Al dar la vuelta un nivel baja la ranura que corresponde del nivel siguiente
+    for (uint8_t nivel = 1; nivel < NIVELES; nivel++) {
+        if ((ahora >> ((nivel - 1) * BITS_NIVEL)) & MASCARA) {
+            break;
+        }
+        RuedaCascada(nivel);
+    }
+
+    enlace_s vencidos;
+
+    RuedaRetirar(&rueda[0][ahora & MASCARA], &vencidos);
+    ahora++;
+    while (vencidos.siguiente != &vencidos) {
+        temporizador_t temporizador = (temporizador_t)vencidos.siguiente;
+        RuedaQuitar(temporizador);
+        TemporizadorVencer(temporizador);
+    }
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,117 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Tiempo desde el arranque
+ **
+ ** El SysTick escribe la cuenta de ticks, primero la palabra alta y despues la baja. La lectura toma
+ ** la palabra baja, la alta y el contador, y se repite si mientras tanto la palabra baja cambio: la
+ ** interrupcion corto la lectura. Una lectura desde una interrupcion de mas prioridad, o con las
+ ** interrupciones deshabilitadas, puede encontrar el contador ya recargado y el tick sin contar; eso
+ ** lo indica el pedido pendiente del SysTick, y en ese caso se suma el tick y se vuelve a leer el
+ ** contador, que ya es del periodo siguiente. Entre la entrada al handler y TiempoTick el pedido ya
+ ** no esta pendiente y el tick todavia no se conto, por eso TiempoTick es lo primero que hace el
+ ** handler.
+ **
+ ** La fraccion del periodo se calcula con los ciclos por microsegundo que salen de LOAD, asi que
+ ** sigue siendo correcta despues de un cambio de frecuencia del nucleo (BoardSetCoreClock).
+ **
+ ** \addtogroup tiempo Tiempo
+ ** \brief Base de tiempo comun en microsegundos
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "tiempo.h"
+#include "chip.h"
+#include "rapida.h"
+#include <stdbool.h>
+
+/* === Macros definitions ====================================================================== */
+
+#define MICROS_SEGUNDO 1000000UL
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+static uint32_t periodo = 0; // microsegundos por tick
+static uint32_t bajos = 0;   // ticks contados, 32 bits bajos
+static uint32_t altos = 0;   // ticks contados, 32 bits altos
+
+/* === Private function declarations =========================================================== */
+
+/* === Public variable definitions ============================================================= */
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+/* === Public function implementation ========================================================== */
+
+void TiempoInit(uint16_t ticks_por_segundo) {
+
+    periodo = MICROS_SEGUNDO / ticks_por_segundo;
+    altos = 0;
+    __atomic_store_n(&bajos, 0, __ATOMIC_RELEASE);
+}
+
+RAPIDA void TiempoTick(void) {
+
+    uint32_t siguiente = bajos + 1;
+
+    if (siguiente == 0) {
+        __atomic_store_n(&altos, altos + 1, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&bajos, siguiente, __ATOMIC_RELEASE);
+}
+
+uint64_t TiempoMicros(void) {
+
+    uint32_t bajo, alto, recarga, cuenta;
+    bool pendiente;
+
+    do {
+        bajo = __atomic_load_n(&bajos, __ATOMIC_ACQUIRE);
+        alto = __atomic_load_n(&altos, __ATOMIC_RELAXED);
+        recarga = SysTick->LOAD;
+        cuenta = SysTick->VAL;
+        pendiente = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+        if (pendiente) {
+            cuenta = SysTick->VAL;
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (bajo != __atomic_load_n(&bajos, __ATOMIC_RELAXED));
+
+    // Con las frecuencias del nucleo en MHz enteros la division es exacta; durante el periodo
+    // reducido que deja un cambio de frecuencia la fraccion se limita al periodo
+    uint32_t ciclos = (recarga + 1) / periodo;
+    uint32_t fraccion = ciclos ? (recarga - cuenta) / ciclos : 0;
+    if (fraccion >= periodo) {
+        fraccion = periodo - 1;
+    }
+    uint64_t ticks = (((uint64_t)alto << 32) | bajo) + pendiente;
+    return ticks * periodo + fraccion;
+}
+
+uint32_t TiempoMicros32(void) {
+
+    return (uint32_t)TiempoMicros();
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */
@@ -0,0 +1,85 @@
+/************************************************************************************************
+Copyright (c) 2023, Emiliano Arnedo <emiarnedo@gmail.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+SPDX-License-Identifier: MIT
+*************************************************************************************************/
+
+/** \brief Traza binaria de eventos
+ **
+ ** La traza se ubica en una seccion que el arranque no pone en cero. Al iniciar, una firma valida
+ ** indica que la memoria viene de un reinicio en caliente: se conservan los registros y la marca
+ ** de tiempo, y se agrega un registro de reinicio. Sin firma la memoria tiene basura del encendido
+ ** y se vacia.
+ **
+ ** \addtogroup traza Traza
+ ** \brief Traza binaria de eventos
+ ** @{ */
+
+/* === Headers files inclusions =============================================================== */
+
+#include "traza.h"
+#include <string.h>
+
+/* === Macros definitions ====================================================================== */
+
+#if (TRAZA_REGISTROS & (TRAZA_REGISTROS - 1)) != 0
+    #error "TRAZA_REGISTROS debe ser potencia de 2 para que el indice pase de 2^32 a 0 sin saltos"
+#endif
+
+/* === Private data type declarations ========================================================== */
+
+/* === Private variable declarations =========================================================== */
+
+/* === Private function declarations =========================================================== */
+
+/* === Public variable definitions ============================================================= */
+
+traza_s traza __attribute__((section(TRAZA_SECCION)));
+
+/* === Private variable definitions ============================================================ */
+
+/* === Private function implementation ========================================================= */
+
+/* === Public function implementation ========================================================== */
+
+void TrazaInit(void) {
+
+    if (traza.firma == TRAZA_FIRMA) {
+        traza.reinicios++;
+    } else {
+        memset(&traza, 0, sizeof(traza));
+        traza.firma = TRAZA_FIRMA;
+    }
+    TrazaRegistrar(TRAZA_REINICIO, 0, (uint16_t)traza.reinicios);
+}
+
+uint32_t TrazaPrimero(void) {
+
+    uint32_t siguiente = traza.siguiente;
+    return (siguiente < TRAZA_REGISTROS) ? 0 : siguiente - TRAZA_REGISTROS;
+}
+
+uint32_t TrazaSiguiente(void) {
+
+    return traza.siguiente;
+}
+
+uint64_t TrazaLeer(uint32_t numero) {
+
+    return traza.registros[numero % TRAZA_REGISTROS];
+}
+
+/* === End of documentation ==================================================================== */
+
+/** @} End of module definition for doxygen */